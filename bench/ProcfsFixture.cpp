@@ -0,0 +1,191 @@
+#include "ProcfsFixture.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char* const NAMES[] = {
+        "systemd", "bash", "sshd", "nginx", "postgres", "java", "python3", "node",
+        "chrome", "Web Content", "kworker/0:1", "containerd", "dockerd", "redis-server",
+        "cc1plus", "make", "ld", "rsyslogd", "cron", "(sd-pam)", "envoy", "grpc worker"
+    };
+    const size_t NAME_COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+    int removeEntry(const char* path, const struct stat*, int, struct FTW*) {
+        return ::remove(path);
+    }
+}
+
+ProcfsFixture::ProcfsFixture(const std::string& root, int process_count, unsigned int cpu_count,
+                             unsigned long seed)
+    : root(root), process_count(process_count), cpu_count(cpu_count > 0 ? cpu_count : 1),
+      seed(seed), ticks(100000), keep(false) {}
+
+ProcfsFixture::~ProcfsFixture() {
+    if (!keep && !root.empty() && root != "/" && root != "/proc") {
+        nftw(root.c_str(), removeEntry, 64, FTW_DEPTH | FTW_PHYS);
+    }
+}
+
+unsigned long ProcfsFixture::nextRandom() {
+    // xorshift64: reproducible across runs and platforms
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+void ProcfsFixture::writeFile(const std::string& path, const std::string& content) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return;
+    ssize_t written = ::write(fd, content.data(), content.size());
+    (void)written;
+    ::close(fd);
+}
+
+void ProcfsFixture::writeSystemFiles() {
+    char line[256];
+    std::string stat;
+
+    // Aggregate line followed by one line per CPU, as in proc(5)
+    unsigned long user = ticks * cpu_count / 4, system = ticks * cpu_count / 8;
+    unsigned long idle = ticks * cpu_count - user - system;
+    snprintf(line, sizeof(line), "cpu  %lu 0 %lu %lu 0 0 0 0 0 0\n", user, system, idle);
+    stat += line;
+    for (unsigned int cpu = 0; cpu < cpu_count; cpu++) {
+        snprintf(line, sizeof(line), "cpu%u %lu 0 %lu %lu 0 0 0 0 0 0\n",
+                 cpu, user / cpu_count, system / cpu_count, idle / cpu_count);
+        stat += line;
+    }
+    snprintf(line, sizeof(line), "ctxt %lu\nbtime 1700000000\nprocesses %d\n",
+             ticks * 50, process_count);
+    stat += line;
+    writeFile(root + "/stat", stat);
+
+    // Run-queue counters in ns (one tick = 10 ms), without the domain lines
+    std::string schedstat = "version 15\ntimestamp " + std::to_string(ticks) + "\n";
+    for (unsigned int cpu = 0; cpu < cpu_count; cpu++) {
+        unsigned long long busy_ns = (user + system) / cpu_count * 10000000ULL;
+        snprintf(line, sizeof(line), "cpu%u 0 0 %lu %lu %lu %lu %llu %llu %lu\n",
+                 cpu, ticks * 40, ticks * 10, ticks * 30, ticks * 20,
+                 busy_ns, busy_ns / 20, ticks * 30);
+        schedstat += line;
+    }
+    writeFile(root + "/schedstat", schedstat);
+
+    writeFile(root + "/meminfo",
+              "MemTotal:       65842012 kB\n"
+              "MemFree:        12345678 kB\n"
+              "MemAvailable:   40123456 kB\n"
+              "Buffers:         1234567 kB\n"
+              "Cached:         20123456 kB\n"
+              "SwapCached:            0 kB\n"
+              "Active:         30123456 kB\n"
+              "Inactive:       15123456 kB\n"
+              "SwapTotal:       8388604 kB\n"
+              "SwapFree:        8388604 kB\n");
+
+    // A current kernel's ~190 counters, the ones the collector wants spread
+    // through them; other names are placeholders
+    std::string vmstat;
+    auto counters = [&vmstat, &line](const char* prefix, int count) {
+        for (int i = 0; i < count; i++) {
+            snprintf(line, sizeof(line), "%s_%d %d\n", prefix, i, i * 1000);
+            vmstat += line;
+        }
+    };
+    counters("nr_zone", 60);
+    snprintf(line, sizeof(line), "pswpin %lu\npswpout %lu\n", ticks / 10, ticks / 5);
+    vmstat += line;
+    counters("pgalloc", 25);
+    snprintf(line, sizeof(line),
+             "pgfault %lu\npgmajfault %lu\npgsteal_kswapd %lu\npgsteal_direct %lu\n"
+             "pgscan_kswapd %lu\npgscan_direct %lu\npgscan_direct_throttle 0\n",
+             ticks * 500, ticks / 2, ticks * 8, ticks, ticks * 10, ticks * 2);
+    vmstat += line;
+    counters("compact", 15);
+    vmstat += "oom_kill 0\n";
+    counters("thp", 80);
+    writeFile(root + "/vmstat", vmstat);
+}
+
+void ProcfsFixture::writeProcess(size_t index) {
+    int pid = pids[index];
+    int ppid = index == 0 ? 0 : pids[nextRandom() % index];
+    const char* name = NAMES[(pid * 7 + index) % NAME_COUNT];
+    long rss_pages = 256 + static_cast<long>(nextRandom() % 262144);
+    long utime = cpu_ticks[index] * 2 / 3;
+    long stime = cpu_ticks[index] - utime;
+
+    char stat[512];
+    snprintf(stat, sizeof(stat),
+             "%d (%s) S %d %d %d 0 -1 4194560 %lu 0 %lu 0 %ld %ld 0 0 20 0 1 0 %lu "
+             "%ld %ld 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 %zu 0 0 0 0 0 "
+             "0 0 0 0 0 0 0 0\n",
+             pid, name, ppid, pid, pid, nextRandom() % 100000, nextRandom() % 100,
+             utime, stime, static_cast<unsigned long>(pid) * 10,
+             rss_pages * 4096 * 4, rss_pages, index % cpu_count);
+
+    std::string dir = root + "/" + std::to_string(pid);
+    writeFile(dir + "/stat", stat);
+
+    // run_ns wait_ns timeslices, with about 5% of runnable time spent queued
+    unsigned long long run_ns = cpu_ticks[index] * 10000000ULL;
+    snprintf(stat, sizeof(stat), "%llu %llu %lu\n",
+             run_ns, run_ns / 20, cpu_ticks[index] / 4 + 1);
+    writeFile(dir + "/schedstat", stat);
+}
+
+bool ProcfsFixture::generate() {
+    if (::mkdir(root.c_str(), 0755) != 0 && access(root.c_str(), W_OK) != 0) {
+        return false;
+    }
+
+    pids.clear();
+    cpu_ticks.clear();
+
+    int pid = 1;
+    for (int i = 0; i < process_count; i++) {
+        pids.push_back(pid);
+        cpu_ticks.push_back(static_cast<long>(nextRandom() % 1000000));
+        pid += 1 + static_cast<int>(nextRandom() % 3);
+    }
+
+    writeSystemFiles();
+
+    char rollup[512];
+    for (size_t i = 0; i < pids.size(); i++) {
+        std::string dir = root + "/" + std::to_string(pids[i]);
+        ::mkdir(dir.c_str(), 0755);
+        writeProcess(i);
+
+        long rss = 1024 + static_cast<long>(nextRandom() % 1048576);
+        snprintf(rollup, sizeof(rollup),
+                 "00400000-7fffffffe000 ---p 00000000 00:00 0                          [rollup]\n"
+                 "Rss:            %8ld kB\n"
+                 "Pss:            %8ld kB\n"
+                 "Shared_Clean:   %8ld kB\n"
+                 "Shared_Dirty:          0 kB\n"
+                 "Private_Clean:  %8ld kB\n"
+                 "Private_Dirty:  %8ld kB\n"
+                 "Swap:                  0 kB\n",
+                 rss, rss * 3 / 4, rss / 2, rss / 4, rss / 4);
+        writeFile(dir + "/smaps_rollup", rollup);
+    }
+
+    return true;
+}
+
+void ProcfsFixture::advance(double fraction) {
+    ticks += 100;
+    writeSystemFiles();
+
+    size_t touched = static_cast<size_t>(pids.size() * fraction);
+    for (size_t i = 0; i < touched; i++) {
+        size_t index = nextRandom() % pids.size();
+        cpu_ticks[index] += static_cast<long>(nextRandom() % 100);
+        writeProcess(index);
+    }
+}
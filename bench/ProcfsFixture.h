@@ -0,0 +1,46 @@
+#ifndef PROCFSFIXTURE_H
+#define PROCFSFIXTURE_H
+
+#include <string>
+#include <vector>
+
+// Generates a synthetic procfs tree for benchmarking the Linux collectors
+// against a known, reproducible process count (1k to 100k PIDs).
+//
+// The layout mirrors the subset of /proc the collectors read: stat,
+// meminfo, schedstat, vmstat, and <pid>/{stat,schedstat,smaps_rollup}. Field layouts follow proc(5)
+// so the real parsers run unmodified.
+class ProcfsFixture {
+private:
+    std::string root;
+    int process_count;
+    unsigned int cpu_count;
+    unsigned long seed;
+    unsigned long ticks;
+    std::vector<int> pids;
+    std::vector<long> cpu_ticks;
+    bool keep;
+
+    unsigned long nextRandom();
+    void writeFile(const std::string& path, const std::string& content);
+    void writeSystemFiles();
+    void writeProcess(size_t index);
+
+public:
+    ProcfsFixture(const std::string& root, int process_count, unsigned int cpu_count = 8,
+                  unsigned long seed = 42);
+    ~ProcfsFixture();
+
+    // Builds the tree from scratch; returns false if the root is unusable
+    bool generate();
+
+    // Simulates one tick: advances system counters and rewrites the stat
+    // file of `fraction` of the processes
+    void advance(double fraction = 0.1);
+
+    void setKeep(bool value) { keep = value; }
+    const std::string& getRoot() const { return root; }
+    int getProcessCount() const { return process_count; }
+};
+
+#endif // PROCFSFIXTURE_H
@@ -0,0 +1,683 @@
+#include "ProcfsFixture.h"
+#include "alert/AlertEngine.h"
+#include "monitor/SystemMonitor.h"
+#include "monitor/ProcessTable.h"
+#include "monitor/ProcessFilter.h"
+#include "monitor/CompressedSeries.h"
+#include "monitor/ThermalMonitor.h"
+#include "query/HistoryQuery.h"
+#include "platform/Platform.h"
+#include "visualizer/Visualizer.h"
+#include "exporter/SnapshotReport.h"
+#include "exporter/ShmPublisher.h"
+#include "utils/AllocationCounter.h"
+#include "net/Agent.h"
+#include "net/Aggregator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// read(2)/write(2) syscall counts from the real /proc/self/io. Opens and
+// closes are not included, so this is a lower bound on syscalls.
+unsigned long long readSyscalls() {
+    int fd = ::open("/proc/self/io", O_RDONLY);
+    if (fd < 0) return 0;
+    char buf[512];
+    ssize_t n = ::read(fd, buf, sizeof(buf) - 1);
+    ::close(fd);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+
+    unsigned long long syscr = 0, syscw = 0;
+    const char* r = strstr(buf, "syscr:");
+    const char* w = strstr(buf, "syscw:");
+    if (r) syscr = strtoull(r + 6, nullptr, 10);
+    if (w) syscw = strtoull(w + 6, nullptr, 10);
+    return syscr + syscw;
+}
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) { return n; }
+};
+
+struct Result {
+    double ns_per_op;
+    double syscalls_per_op;
+    double allocs_per_op;
+};
+
+template <typename Fn>
+Result measure(int iterations, Fn fn) {
+    fn();   // warm-up: first-touch allocations, caches, directory streams
+
+    unsigned long long syscalls_before = readSyscalls();
+    unsigned long long allocs_before = AllocationCounter::count();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; i++) {
+        fn();
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    unsigned long long allocs_after = AllocationCounter::count();
+    // The second readSyscalls() itself costs one read
+    unsigned long long syscalls_after = readSyscalls() - 1;
+
+    Result result;
+    result.ns_per_op = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    result.syscalls_per_op = static_cast<double>(syscalls_after - syscalls_before) / iterations;
+    result.allocs_per_op = static_cast<double>(allocs_after - allocs_before) / iterations;
+    return result;
+}
+
+void report(const char* name, int procs, const Result& result) {
+    std::printf("%-24s %8d %14.0f %12.1f %12.1f\n",
+                name, procs, result.ns_per_op, result.syscalls_per_op, result.allocs_per_op);
+    std::fflush(stdout);
+}
+
+std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+void showHelp(const char* program) {
+    std::cout << "USAGE:\n";
+    std::cout << "  " << program << " [options]\n\n";
+    std::cout << "OPTIONS:\n";
+    std::cout << "  --procs <n,n,...>     Synthetic process counts (default: 1000,10000)\n";
+    std::cout << "  --iterations <n>      Iterations per case (default: 20)\n";
+    std::cout << "  --root <dir>          Where fixtures are generated (default: /tmp)\n";
+    std::cout << "  --agents <n>          Loopback agents for the aggregator cases (default: 1000, 0 = skip)\n";
+    std::cout << "  --samples <n>         Samples per series for the history cases (default: 86400, 0 = skip)\n";
+    std::cout << "  --query-frames <n>    Frames in the synthetic recording for the query cases (default: 604800 = a week at 1 Hz, 0 = skip)\n";
+    std::cout << "  --generate <dir>      Only generate a fixture with the first --procs value and keep it\n";
+}
+
+void runSuite(int procs, int iterations, const std::string& base) {
+    std::string root = base + "/sysmonitor-bench-" + std::to_string(getpid()) + "-" + std::to_string(procs);
+    ProcfsFixture fixture(root, procs);
+    if (!fixture.generate()) {
+        std::cerr << "Error: cannot create fixture at " << root << "\n";
+        return;
+    }
+    Platform::setProcRoot(root);
+
+    // Fewer iterations for the big trees so a run stays in the seconds range
+    int iters = procs >= 50000 ? std::max(3, iterations / 5) : iterations;
+
+    report("getProcessList", procs, measure(iters, [] {
+        std::vector<Platform::ProcessData> list = Platform::getProcessList();
+        (void)list;
+    }));
+
+    Platform::VMStats vmstats;
+    report("getVMStats", procs, measure(iterations, [&vmstats] {
+        Platform::getVMStats(vmstats);
+    }));
+
+    ProcessTable table;
+    report("scanProcesses", procs, measure(iters, [&table] {
+        table.beginScan(800, 8);
+        Platform::scanProcesses(table);
+        table.endScan();
+    }));
+    Platform::setHoldProcessFiles(true);
+    report("scanProcesses.held", procs, measure(iters, [&table] {
+        table.beginScan(800, 8);
+        Platform::scanProcesses(table);
+        table.endScan();
+    }));
+    Platform::setHoldProcessFiles(false);
+
+    // Most processes rejected right after the stat parse
+    ProcessFilter filter;
+    std::string filter_error;
+    filter.compile("name~^(java|postgres)$ && rss>1K", filter_error);
+    ProcessTable filtered_table;
+    filtered_table.setFilter(&filter);
+    report("scanProcesses.filtered", procs, measure(iters, [&filtered_table] {
+        filtered_table.beginScan(800, 8);
+        Platform::scanProcesses(filtered_table);
+        filtered_table.endScan();
+    }));
+
+    std::vector<uint32_t> order;
+    report("rank.cpu.top10", procs, measure(iters, [&table, &order] {
+        table.rank(SortKey::CPU, order, 10);
+    }));
+    report("rank.name.full", procs, measure(iters, [&table, &order] {
+        table.rank(SortKey::NAME, order, table.size());
+    }));
+    // One 50-row screen of the scrollable table, mid-way and at the end
+    size_t middle = table.size() / 2;
+    report("rank.window.cpu", procs, measure(iters, [&table, &order, middle] {
+        table.rank(SortKey::CPU, order, middle, middle + 50);
+    }));
+    report("rank.window.name", procs, measure(iters, [&table, &order] {
+        size_t end = table.size();
+        table.rank(SortKey::NAME, order, end > 50 ? end - 50 : 0, end);
+    }));
+
+    // Steady state: every process already has a model, nothing exits
+    MemoryForecaster forecaster;
+    SnapshotDelta quiet;
+    SystemMetrics host;
+    host.total_mem_kb = 16L << 20;
+    host.available_mem_kb = 8L << 20;
+    MemoryForecast forecast;
+    report("forecast.update", procs, measure(iters, [&forecaster, &quiet, &table, &host, &forecast] {
+        quiet.sequence++;
+        host.mem_usage_percent += 0.01;
+        forecaster.update(table, quiet, 1.0, host, forecast);
+    }));
+
+    // A windowed rule per process plus a host percentile, windows filled
+    AlertEngine alerts;
+    std::string alert_error;
+    alerts.compile("leak: proc.rss rate over 1m > 100M/min\ncpu_hot: cpu p95 over 5m > 90\n", alert_error);
+    SystemMetrics alert_host;
+    alert_host.process_table = &table;
+    alert_host.delta = &quiet;
+    std::vector<AlertEvent> alert_events;
+    double alert_clock = 0.0;
+    for (int i = 0; i < 400; i++) {
+        quiet.sequence++;
+        alerts.evaluate(alert_host, alert_clock++, 0, alert_events);
+    }
+    report("alerts.evaluate", procs, measure(iters, [&alerts, &alert_host, &quiet, &alert_events, &alert_clock] {
+        quiet.sequence++;
+        alert_events.clear();
+        alerts.evaluate(alert_host, alert_clock++, 0, alert_events);
+    }));
+
+    // Whole table into /dev/shm, and one reader copying it back out
+    ShmPublisher publisher("sysmonitor-bench-" + std::to_string(getpid()));
+    if (publisher.isOpen()) {
+        report("shm.publish", procs, measure(iters, [&publisher, &alert_host] {
+            publisher.publish(alert_host);
+        }));
+        std::string shm_name = publisher.getPath().substr(9);
+        sysmon_shm_reader reader;
+        if (sysmon_shm_open(&reader, shm_name.c_str()) == 0) {
+            std::vector<sysmon_shm_process> rows(sysmon_shm_capacity(&reader));
+            sysmon_shm_system shm_system;
+            uint32_t copied = 0;
+            report("shm.read", procs, measure(iters, [&reader, &rows, &shm_system, &copied] {
+                sysmon_shm_read(&reader, &shm_system, rows.data(), static_cast<uint32_t>(rows.size()), &copied);
+            }));
+            sysmon_shm_close(&reader);
+        }
+    }
+
+    SystemMonitor monitor;
+    monitor.prime(0);
+    SystemMetrics metrics;
+    report("collectMetrics", procs, measure(iters, [&monitor, &metrics] {
+        metrics = monitor.collectMetrics();
+    }));
+
+    Visualizer visualizer;
+    NullBuffer null_buffer;
+    std::streambuf* saved = std::cout.rdbuf(&null_buffer);
+    Result render = measure(iters, [&visualizer, &metrics] {
+        visualizer.displayMetrics(metrics, true, 10.0, 50.0);
+    });
+    std::cout.rdbuf(saved);
+    report("displayMetrics", procs, render);
+
+    // What `sysmonitor snapshot --json` does after start-up, 100 ms sampling
+    // included; the target is 150 ms at 10k processes
+    std::ostream null_stream(&null_buffer);
+    report("snapshot.e2e", procs, measure(std::min(iters, 5), [&null_stream] {
+        SnapshotReport snapshot;
+        snapshot.collect();
+        snapshot.writeJSON(null_stream);
+    }));
+
+    // Scheduler tracking at steady state (only the sweep re-reads), then
+    // one tick where part of the table ran
+    SystemMonitor sched_monitor;
+    sched_monitor.setSchedTracking(true);
+    sched_monitor.prime(0);
+    report("collectMetrics.sched", procs, measure(iters, [&sched_monitor, &metrics] {
+        metrics = sched_monitor.collectMetrics();
+    }));
+    unsigned long reads_before = sched_monitor.getSchedMonitor().getSchedstatReads();
+    fixture.advance(0.05);
+    sched_monitor.collectMetrics();
+    std::printf("# sched: %lu schedstat reads on a tick where 5%% of %d processes ran\n",
+                sched_monitor.getSchedMonitor().getSchedstatReads() - reads_before, procs);
+
+    // Tree upkeep plus the folded rows the tree view draws
+    SystemMonitor tree_monitor;
+    tree_monitor.setTreeTracking(true);
+    tree_monitor.prime(0);
+    report("collectMetrics.tree", procs, measure(iters, [&tree_monitor, &metrics] {
+        metrics = tree_monitor.collectMetrics();
+    }));
+
+    Platform::setProcRoot("");
+}
+
+// Many agents streaming to one aggregator over loopback. Every agent sends
+// the same host snapshot, so the aggregator does the full per-host work.
+void runLoopback(int agents, int procs, int iterations, const std::string& base) {
+    std::string root = base + "/sysmonitor-bench-" + std::to_string(getpid()) + "-loopback";
+    ProcfsFixture fixture(root, procs);
+    if (!fixture.generate()) {
+        std::cerr << "Error: cannot create fixture at " << root << "\n";
+        return;
+    }
+    Platform::setProcRoot(root);
+
+    // Two descriptors per agent (both ends live in this process)
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    Aggregator aggregator;
+    if (!aggregator.listen(0, "127.0.0.1")) {
+        std::cerr << "Error: aggregator cannot listen on loopback\n";
+        return;
+    }
+
+    std::vector<std::unique_ptr<Agent>> fleet;
+    for (int i = 0; i < agents; i++) {
+        fleet.emplace_back(new Agent("127.0.0.1", aggregator.getPort(), "bench-" + std::to_string(i)));
+    }
+
+    SystemMonitor monitor;
+    monitor.prime(0);
+
+    // Round 0 connects everyone and delivers the keyframes
+    SystemMetrics metrics = monitor.collectMetrics();
+    for (auto& agent : fleet) agent->send(metrics);
+    unsigned long long keyframe_bytes = fleet.empty() ? 0 : fleet[0]->getBytesSent();
+    unsigned long long expected = static_cast<unsigned long long>(agents);
+    for (int spins = 0; aggregator.getFrames() < expected && spins < 10000; spins++) {
+        aggregator.poll(10);
+    }
+    if (aggregator.getFrames() < expected) {
+        std::cerr << "Error: only " << aggregator.getFrames() << " of " << agents << " keyframes arrived\n";
+        Platform::setProcRoot("");
+        return;
+    }
+
+    double send_ns = 0.0, ingest_ns = 0.0;
+    unsigned long long send_sys = 0, ingest_sys = 0, send_allocs = 0, ingest_allocs = 0;
+    unsigned long long bytes_before = fleet[0]->getBytesSent();
+
+    for (int round = 0; round < iterations; round++) {
+        fixture.advance(0.05);
+        metrics = monitor.collectMetrics();
+        expected += static_cast<unsigned long long>(agents);
+
+        unsigned long long sys0 = readSyscalls(), allocs0 = AllocationCounter::count();
+        auto t0 = std::chrono::steady_clock::now();
+        for (auto& agent : fleet) agent->send(metrics);
+        auto t1 = std::chrono::steady_clock::now();
+        unsigned long long sys1 = readSyscalls(), allocs1 = AllocationCounter::count();
+
+        while (aggregator.getFrames() < expected) {
+            if (aggregator.poll(100) == 0 && aggregator.getFrames() < expected) break;
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        unsigned long long sys2 = readSyscalls(), allocs2 = AllocationCounter::count();
+
+        send_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        ingest_ns += std::chrono::duration<double, std::nano>(t2 - t1).count();
+        send_sys += sys1 - sys0 - 1;
+        ingest_sys += sys2 - sys1 - 1;
+        send_allocs += allocs1 - allocs0;
+        ingest_allocs += allocs2 - allocs1;
+    }
+
+    double frames = static_cast<double>(agents) * iterations;
+    Result send = { send_ns / frames, send_sys / frames, send_allocs / frames };
+    Result ingest = { ingest_ns / frames, ingest_sys / frames, ingest_allocs / frames };
+    report("loopback.agent.send", procs, send);
+    report("loopback.aggregate.ingest", procs, ingest);
+
+    FleetMetrics fleet_metrics;
+    report("loopback.aggregate.collect", procs, measure(iterations, [&aggregator, &fleet_metrics] {
+        aggregator.collect(fleet_metrics, 10, 15);
+    }));
+
+    std::printf("# %d agents, %d procs/host: keyframe %llu B, delta %.0f B/frame, "
+                "ingest %.1f%% of one core at 1 Hz\n",
+                agents, procs, keyframe_bytes,
+                static_cast<double>(fleet[0]->getBytesSent() - bytes_before) / iterations,
+                ingest.ns_per_op * agents / 1e7);
+
+    Platform::setProcRoot("");
+}
+
+// A day of 1 Hz system readings shaped like the real collector's: CPU is a
+// ratio of jiffy counters (8 CPUs, ~800 jiffies/s), memory is used/total kB
+// drifting by a few pages, and ticks carry a few ms of scheduling jitter.
+void runSeries(int samples, int iterations) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> jitter(0, 4);
+    std::uniform_int_distribution<int> busy_noise(-40, 40);
+    std::uniform_int_distribution<int> page_drift(-64, 64);
+
+    std::vector<CompressedSeries::Sample> cpu(samples), mem(samples);
+    int64_t timestamp = 1700000000000LL;
+    int busy = 100;
+    long used_kb = 6 * 1024 * 1024;
+    const long total_kb = 16303812;
+    for (int i = 0; i < samples; i++) {
+        timestamp += 1000 + jitter(rng);
+        int total = 800 + jitter(rng);
+        busy = std::min(total, std::max(0, busy + busy_noise(rng)));
+        if (i % 600 == 0) busy = std::min(total, busy + 300);    // periodic job
+        used_kb += page_drift(rng) * 4;
+        cpu[i] = { timestamp, 100.0 * busy / total };
+        mem[i] = { timestamp, 100.0 * used_kb / total_kb };
+    }
+
+    // What the history used to cost: a deque<double>, values only
+    const double raw_bytes = sizeof(double);
+    const char* names[] = { "cpu", "mem" };
+    const std::vector<CompressedSeries::Sample>* inputs[] = { &cpu, &mem };
+    const double resolutions[] = { 0.0, 0.01 };
+
+    for (int s = 0; s < 2; s++) {
+        for (double resolution : resolutions) {
+            CompressedSeries series(static_cast<size_t>(samples), resolution);
+            for (const auto& sample : *inputs[s]) series.append(sample.timestamp_ms, sample.value);
+            double per_sample = static_cast<double>(series.memoryBytes()) / samples;
+            std::printf("# series %-4s %-9s %6.2f B/sample vs %.0f for a raw double (%.1fx)\n",
+                        names[s], resolution > 0.0 ? "0.01 grid" : "lossless",
+                        per_sample, raw_bytes, raw_bytes / per_sample);
+        }
+    }
+
+    int iters = std::max(1, iterations / 10);
+    CompressedSeries series(static_cast<size_t>(samples), 0.01);
+    Result append = measure(iters, [&series, &cpu] {
+        series.clear();
+        for (const auto& sample : cpu) series.append(sample.timestamp_ms, sample.value);
+    });
+    append.ns_per_op /= samples;
+    append.syscalls_per_op /= samples;
+    append.allocs_per_op /= samples;
+    report("series.append", samples, append);
+
+    std::vector<CompressedSeries::Sample> decoded;
+    decoded.reserve(CompressedSeries::BLOCK_SAMPLES);
+    Result decode = measure(iters, [&series, &decoded] {
+        for (size_t b = 0; b < series.getBlockCount(); b++) {
+            decoded.clear();
+            series.decodeBlock(b, decoded);
+        }
+    });
+    decode.ns_per_op /= samples;
+    decode.syscalls_per_op /= samples;
+    decode.allocs_per_op /= samples;
+    report("series.decode", samples, decode);
+
+    std::vector<double> tail;
+    report("series.tail60", samples, measure(iterations, [&series, &tail] {
+        tail.clear();
+        series.tail(60, tail);
+    }));
+}
+
+// A synthetic sysfs with `cpus` CPUs in two packages and a few thermal
+// zones. Returns the paths created, deepest last, for cleanup.
+std::vector<std::string> writeSysfs(const std::string& root, int cpus) {
+    std::vector<std::string> paths;
+    auto dir = [&paths](const std::string& path) {
+        ::mkdir(path.c_str(), 0755);
+        paths.push_back(path);
+    };
+    auto file = [&paths](const std::string& path, const std::string& content) {
+        std::ofstream(path.c_str()) << content << "\n";
+        paths.push_back(path);
+    };
+
+    dir(root);
+    dir(root + "/devices");
+    dir(root + "/devices/system");
+    dir(root + "/devices/system/cpu");
+    file(root + "/devices/system/cpu/present", "0-" + std::to_string(cpus - 1));
+    for (int cpu = 0; cpu < cpus; cpu++) {
+        std::string base = root + "/devices/system/cpu/cpu" + std::to_string(cpu);
+        dir(base);
+        dir(base + "/cpufreq");
+        file(base + "/cpufreq/scaling_cur_freq", std::to_string(2400000 + 1000 * (cpu % 200)));
+        file(base + "/cpufreq/cpuinfo_max_freq", "3500000");
+        dir(base + "/thermal_throttle");
+        file(base + "/thermal_throttle/core_throttle_count", std::to_string(cpu % 3));
+        file(base + "/thermal_throttle/package_throttle_count", "7");
+        dir(base + "/topology");
+        file(base + "/topology/physical_package_id", cpu < cpus / 2 ? "0" : "1");
+    }
+    dir(root + "/class");
+    dir(root + "/class/thermal");
+    for (int zone = 0; zone < 4; zone++) {
+        std::string base = root + "/class/thermal/thermal_zone" + std::to_string(zone);
+        dir(base);
+        file(base + "/type", zone == 0 ? "x86_pkg_temp" : "acpitz");
+        file(base + "/temp", std::to_string(45000 + 5000 * zone));
+    }
+    return paths;
+}
+
+// One thermal tick on a large host: a pread per held descriptor
+void runThermals(int cpus, int iterations, const std::string& base) {
+    std::string root = base + "/sysmonitor-bench-" + std::to_string(getpid()) + "-sys";
+    std::vector<std::string> paths = writeSysfs(root, cpus);
+    Platform::setSysRoot(root);
+
+    ThermalMonitor monitor;
+    CPUThermals thermals;
+    report("thermal.update", cpus, measure(iterations, [&monitor, &thermals] {
+        monitor.update(thermals);
+    }));
+    std::printf("# thermal: %d cpus at %.0f-%.0f MHz of %.0f, %zu zones, hottest %.0f C\n",
+                thermals.cpus, thermals.min_mhz, thermals.max_mhz, thermals.nominal_mhz,
+                thermals.zones.size(),
+                thermals.hottest_zone >= 0 ? thermals.zones[thermals.hottest_zone].celsius : 0.0);
+
+    Platform::setSysRoot("");
+    for (auto it = paths.rbegin(); it != paths.rend(); ++it) {
+        std::remove(it->c_str());
+    }
+}
+
+// Writes a recording in the Recorder's delta format: `procs` processes,
+// a keyframe every 60 frames, a handful of changed rows per tick and an
+// occasional short-lived process.
+bool writeRecording(const std::string& path, int frames, int procs, int64_t start_ms) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fputs("# sysmonitor-record 1\n", out);
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, procs - 1);
+    std::uniform_int_distribution<int> percent(0, 2000);
+    std::vector<double> cpu(procs, 0.5);
+    std::vector<long> rss(procs);
+    for (int i = 0; i < procs; i++) rss[i] = 4096 + 1024L * (i % 200);
+
+    int next_pid = 100000;
+    int64_t ts = start_ms;
+    for (int frame = 0; frame < frames; frame++) {
+        ts += 1000;
+        double sys_cpu = 5.0 + percent(rng) / 100.0;
+        double sys_mem = 40.0 + (frame % 3600) / 360.0;
+        bool keyframe = frame % 60 == 0;
+        std::fprintf(out, "%c %lld %d %.2f %.2f %ld %ld %d\n", keyframe ? 'F' : 'D',
+                     static_cast<long long>(ts), frame, sys_cpu, sys_mem, 6500000L, 16303812L, procs);
+        if (keyframe) {
+            for (int i = 0; i < procs; i++) {
+                std::fprintf(out, "P %d %.2f %ld 0 proc-%d\n", 1000 + i, cpu[i], rss[i], i);
+            }
+            continue;
+        }
+        for (int c = 0; c < 10; c++) {
+            int i = pick(rng);
+            cpu[i] = percent(rng) / 100.0;
+            rss[i] += (percent(rng) - 1000) / 4;
+            if (rss[i] < 1024) rss[i] = 1024;
+            std::fprintf(out, "~ %d %.2f %ld 0\n", 1000 + i, cpu[i], rss[i]);
+        }
+        if (frame % 30 == 1) {
+            std::fprintf(out, "+ %d 12.50 2048 0 cron-job\n", next_pid);
+        } else if (frame % 30 == 3) {
+            std::fprintf(out, "- %d 0.00 2048 0 cron-job\n", next_pid++);
+        }
+    }
+    return std::fclose(out) == 0;
+}
+
+void runQueries(int frames, int iterations, const std::string& base) {
+    const int procs = 200;
+    std::string path = base + "/sysmonitor-bench-" + std::to_string(getpid()) + ".rec";
+    const int64_t start_ms = 1700000000000LL;
+    if (!writeRecording(path, frames, procs, start_ms)) {
+        std::cerr << "Error: cannot write recording at " << path << "\n";
+        return;
+    }
+    std::string index_path = path + ".idx";
+
+    int iters = std::max(1, iterations / 5);
+    report("query.index.build", frames, measure(iters, [&path, &index_path] {
+        std::remove(index_path.c_str());
+        HistoryQuery query(path);
+        query.open();
+    }));
+    report("query.index.load", frames, measure(iterations, [&path] {
+        HistoryQuery query(path);
+        query.open();
+    }));
+
+    // A 15 minute window in the middle of the recording
+    int64_t middle = start_ms + static_cast<int64_t>(frames / 2) * 1000;
+    QueryResult result;
+    HistoryQuery window(path);
+    window.open();
+    report("query.15min.top5", frames, measure(iterations, [&window, &result, middle] {
+        window.run(middle, middle + 15 * 60 * 1000, 5, QueryKey::RSS, result);
+    }));
+
+    HistoryQuery full(path);
+    full.open();
+    int64_t end_ms = start_ms + static_cast<int64_t>(frames + 1) * 1000;
+    report("query.all.system", frames, measure(iters, [&full, &result, start_ms, end_ms] {
+        full.run(start_ms, end_ms, 0, QueryKey::CPU, result);
+    }));
+    report("query.all.top5", frames, measure(iters, [&full, &result, start_ms, end_ms] {
+        full.run(start_ms, end_ms, 5, QueryKey::CPU, result);
+    }));
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    long long size = 0;
+    if (file && fseeko(file, 0, SEEK_END) == 0) size = static_cast<long long>(ftello(file));
+    if (file) std::fclose(file);
+    std::printf("# recording: %d frames, %.1f MB, %zu keyframes indexed\n",
+                frames, size / 1048576.0, full.getIndex().size());
+
+    std::remove(index_path.c_str());
+    std::remove(path.c_str());
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> counts;
+    counts.push_back(1000);
+    counts.push_back(10000);
+    int iterations = 20;
+    std::string base = "/tmp";
+    std::string generate_dir;
+    int agents = 1000;
+    int samples = 86400;
+    int query_frames = 604800;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--procs" && i + 1 < argc) {
+            counts = parseList(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--root" && i + 1 < argc) {
+            base = argv[++i];
+        } else if (arg == "--agents" && i + 1 < argc) {
+            agents = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--samples" && i + 1 < argc) {
+            samples = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--query-frames" && i + 1 < argc) {
+            query_frames = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--generate" && i + 1 < argc) {
+            generate_dir = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            showHelp(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            showHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    if (counts.empty()) {
+        std::cerr << "Error: --procs needs at least one count\n";
+        return 1;
+    }
+
+    if (!generate_dir.empty()) {
+        ProcfsFixture fixture(generate_dir, counts[0]);
+        fixture.setKeep(true);
+        if (!fixture.generate()) {
+            std::cerr << "Error: cannot create fixture at " << generate_dir << "\n";
+            return 1;
+        }
+        std::cout << "Generated " << counts[0] << " processes under " << generate_dir << "\n";
+        return 0;
+    }
+
+    std::printf("%-24s %8s %14s %12s %12s\n", "case", "procs", "ns/op", "rw-sys/op", "allocs/op");
+    for (int procs : counts) {
+        runSuite(procs, iterations, base);
+    }
+    if (agents > 0) {
+        runLoopback(agents, std::min(counts[0], 1000), iterations, base);
+    }
+    runThermals(192, iterations, base);
+    if (samples > 0) {
+        runSeries(samples, iterations);
+    }
+    if (query_frames > 0) {
+        runQueries(query_frames, iterations, base);
+    }
+
+    return 0;
+}
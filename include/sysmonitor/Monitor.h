@@ -0,0 +1,168 @@
+#ifndef SYSMONITOR_MONITOR_H
+#define SYSMONITOR_MONITOR_H
+
+#include "Version.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Embeddable C++ API of libsysmonitor.
+//
+// A Monitor owns the collectors and the process table. Each tick refreshes
+// them in place and hands out a Snapshot: a read-only view straight into
+// that state, with no per-tick copies. A Snapshot (and every pointer it
+// returns) stays valid until the next tick of the same Monitor.
+//
+// Monitors may tick concurrently, from any number of threads. The platform
+// collectors share process-wide state, so the collection step of each tick
+// is serialised across all Monitors in the process; callbacks, reads and
+// ranking run in parallel.
+//
+// Only this header and sysmonitor.h (the C API) are stable; everything
+// under src/ is internal.
+namespace sysmonitor {
+
+enum class Key {
+    CPU,
+    RSS
+};
+
+enum class Series {
+    CPU,
+    MEMORY
+};
+
+// Paging and reclaim over the last tick (Linux /proc/vmstat). Rates are
+// per second; scans, steals and swaps count pages.
+struct PagingSample {
+    bool available;
+    double major_faults_per_sec;
+    double minor_faults_per_sec;
+    double swap_in_per_sec;
+    double swap_out_per_sec;
+    double scan_kswapd_per_sec;
+    double scan_direct_per_sec;
+    double steal_kswapd_per_sec;
+    double steal_direct_per_sec;
+    long long oom_kills;        // This tick
+};
+
+struct SystemSample {
+    uint64_t sequence;          // Tick number
+    int64_t timestamp_ms;       // Wall clock, ms since the epoch
+    double interval_ms;         // Since the previous collection
+    double cpu_percent;
+    double mem_percent;
+    long total_mem_kb;
+    long used_mem_kb;
+    long available_mem_kb;
+    size_t process_count;
+    size_t filtered_count;      // Processes the filter kept out
+    bool clock_available;       // cpufreq readings (Linux)
+    double cpu_mhz;             // Mean current clock
+    double cpu_max_mhz;         // Mean rated maximum
+    long long throttle_events;  // Since boot
+    bool temperature_available;
+    double max_temp_c;          // Hottest thermal zone
+    PagingSample paging;
+};
+
+class Snapshot {
+private:
+    struct Impl;
+    const Impl* impl;
+
+    explicit Snapshot(const Impl* impl) : impl(impl) {}
+    friend class Monitor;
+
+public:
+    const SystemSample& system() const;
+
+    // Process columns, one entry per row; row order is unspecified
+    size_t size() const;
+    const int* pids() const;
+    const double* cpu() const;          // % of one CPU
+    const long* rssKb() const;
+    const int* priorities() const;
+    const float* majorFaultRate() const;    // Faults that needed I/O, per second
+    const char* name(size_t row, size_t* length = nullptr) const;
+
+    bool find(int pid, size_t& row) const;
+
+    // Rows of the `n` largest processes by `key`, largest first. The array
+    // is owned by the monitor and reused by the next top() call.
+    size_t top(Key key, size_t n, const uint32_t** rows) const;
+
+    // Processes that appeared, exited, or moved past the delta epsilons
+    // this tick
+    size_t spawnedCount() const;
+    size_t exitedCount() const;
+    size_t changedCount() const;
+};
+
+class Monitor {
+public:
+    typedef std::function<void(const Snapshot&)> TickCallback;
+
+    struct Options {
+        bool cgroups;               // Per-cgroup aggregation (Linux, cgroup v2)
+        bool optimize;              // Renice busy processes each tick
+        int cpu_threshold;          // With `optimize`, % of one CPU
+        double delta_cpu_epsilon;   // Smallest change counted by changedCount()
+        long delta_rss_epsilon_kb;
+        // Keep every process's stat file open between ticks: rescans cost
+        // one read per process, for one descriptor per process. Meant for
+        // short-lived monitors that tick a few times in quick succession.
+        bool hold_process_files;
+
+        Options() : cgroups(false), optimize(false), cpu_threshold(80),
+                    delta_cpu_epsilon(1.0), delta_rss_epsilon_kb(1024),
+                    hold_process_files(false) {}
+    };
+
+private:
+    std::unique_ptr<Snapshot::Impl> impl;
+
+    Monitor(const Monitor&);
+    Monitor& operator=(const Monitor&);
+
+public:
+    explicit Monitor(const Options& options = Options());
+    ~Monitor();
+
+    // Collects one tick on the calling thread, runs the callbacks and
+    // returns the new snapshot. Not to be mixed with start().
+    const Snapshot& tick();
+
+    // Ticks every `interval_ms` on a background thread. Callbacks run on
+    // that thread while the snapshot is stable.
+    bool start(int interval_ms);
+    void stop();
+    bool isRunning() const;
+
+    // Runs `fn` on the latest snapshot while no tick can replace it. Safe
+    // from any thread, including while start() is active.
+    void read(const TickCallback& fn) const;
+
+    // Limits the process columns to what `expression` matches (the filter
+    // grammar of `sysmonitor --filter`) from the next tick on; an empty
+    // expression clears it. False, with the reason in `error`, if it does
+    // not parse; the current filter is then kept.
+    bool setFilter(const std::string& expression, std::string* error = nullptr);
+
+    // Callbacks may call read(), history(), setFilter() and add or remove
+    // callbacks on their own Monitor
+    int addCallback(const TickCallback& fn);
+    void removeCallback(int id);
+
+    // The most recent `count` samples of a system series, oldest first
+    // (about a day of history is retained, compressed)
+    size_t history(Series series, size_t count, std::vector<double>& out) const;
+};
+
+} // namespace sysmonitor
+
+#endif // SYSMONITOR_MONITOR_H
@@ -0,0 +1,192 @@
+#ifndef SYSMONITOR_SHM_H
+#define SYSMONITOR_SHM_H
+
+/*
+ * Reader for the snapshot `sysmonitor start|agent --shm <name>` publishes
+ * in /dev/shm/<name>. Header-only and Linux-only; needs no libsysmonitor.
+ *
+ * The segment is a fixed header followed by `process_capacity` process
+ * rows. The writer guards each update with a sequence counter (odd while
+ * it writes); sysmon_shm_read() copies the snapshot out and retries if the
+ * counter moved, so readers take no locks and never hold up the writer;
+ * only a reader that keeps finding an update in progress makes syscalls
+ * (yielding and checking the clock). The mapping is read-only.
+ *
+ * A writer that restarts replaces the file: a reader that sees
+ * `writer_pid` 0 or a stale `timestamp_ms` should close and reopen.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYSMON_SHM_MAGIC 0x534d4853u     /* "SHMS" */
+#define SYSMON_SHM_VERSION 1u
+#define SYSMON_SHM_DEFAULT_NAME "sysmonitor"
+#define SYSMON_SHM_NAME_LEN 16
+/* Attempts spun before the reader starts yielding the CPU, and how long it
+ * keeps trying in all: about one tick at the default 2 s interval, since
+ * publishing a large table keeps the counter odd for a while */
+#define SYSMON_SHM_RETRIES 64
+#ifndef SYSMON_SHM_WAIT_MS
+#define SYSMON_SHM_WAIT_MS 2000
+#endif
+
+typedef struct {
+    uint64_t tick;                  /* Collector tick the snapshot is from */
+    int64_t timestamp_ms;
+    double cpu_percent;
+    double mem_percent;
+    int64_t total_mem_kb;
+    int64_t used_mem_kb;
+    int64_t available_mem_kb;
+    double cpu_mhz;                 /* 0 where the clock is not exposed */
+    int64_t throttle_events;        /* During the last tick */
+    double major_faults_per_sec;
+    double swap_in_per_sec;         /* Pages */
+    double swap_out_per_sec;
+    uint32_t process_count;         /* Processes the monitor tracks */
+    uint32_t process_rows;          /* Rows published; at most the capacity */
+} sysmon_shm_system;
+
+typedef struct {
+    int32_t pid;
+    int32_t ppid;
+    double cpu_percent;
+    int64_t rss_kb;
+    float major_faults_per_sec;
+    int32_t priority;
+    char name[SYSMON_SHM_NAME_LEN]; /* NUL-terminated, truncated between UTF-8 characters */
+} sysmon_shm_process;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;           /* Rows start here */
+    uint32_t process_size;
+    uint32_t process_capacity;
+    int32_t writer_pid;             /* 0 once the writer has exited */
+    uint64_t sequence;              /* Odd while an update is in progress */
+    sysmon_shm_system system;
+} sysmon_shm_header;
+
+typedef struct {
+    const uint8_t* base;
+    size_t size;
+} sysmon_shm_reader;
+
+/* Maps /dev/shm/<name> (NULL for the default); 0 on success, -1 if it is
+ * missing, unreadable or not a compatible segment */
+static inline int sysmon_shm_open(sysmon_shm_reader* reader, const char* name) {
+    char path[256];
+    size_t len = strlen(name ? name : SYSMON_SHM_DEFAULT_NAME);
+    if (len == 0 || len + 10 >= sizeof(path)) return -1;
+    memcpy(path, "/dev/shm/", 9);
+    memcpy(path + 9, name ? name : SYSMON_SHM_DEFAULT_NAME, len + 1);
+
+    reader->base = NULL;
+    reader->size = 0;
+    /* Closed again right after mapping */
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat info;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(sysmon_shm_header)) {
+        base = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    const sysmon_shm_header* header = (const sysmon_shm_header*)base;
+    uint64_t rows_end = (uint64_t)header->header_size +
+                        (uint64_t)header->process_size * header->process_capacity;
+    if (header->magic != SYSMON_SHM_MAGIC || header->version != SYSMON_SHM_VERSION ||
+        header->header_size < sizeof(sysmon_shm_header) ||
+        header->process_size != sizeof(sysmon_shm_process) || rows_end > (uint64_t)info.st_size) {
+        munmap(base, (size_t)info.st_size);
+        return -1;
+    }
+    reader->base = (const uint8_t*)base;
+    reader->size = (size_t)info.st_size;
+    return 0;
+}
+
+static inline void sysmon_shm_close(sysmon_shm_reader* reader) {
+    if (reader->base) munmap((void*)reader->base, reader->size);
+    reader->base = NULL;
+    reader->size = 0;
+}
+
+/* Rows a caller needs room for to get every process */
+static inline uint32_t sysmon_shm_capacity(const sysmon_shm_reader* reader) {
+    return ((const sysmon_shm_header*)reader->base)->process_capacity;
+}
+
+static inline int32_t sysmon_shm_writer(const sysmon_shm_reader* reader) {
+    return __atomic_load_n(&((const sysmon_shm_header*)reader->base)->writer_pid, __ATOMIC_RELAXED);
+}
+
+static inline int64_t sysmon_shm_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/* Copies one consistent snapshot: the system totals and up to `capacity`
+ * rows (`rows` may be NULL with capacity 0). `*count` gets the rows copied.
+ * Spins briefly, then yields between attempts. Returns 0, or 1 if no
+ * consistent copy could be taken within SYSMON_SHM_WAIT_MS (nothing
+ * published yet, a stalled writer, or one that exited mid-update). */
+static inline int sysmon_shm_read(const sysmon_shm_reader* reader, sysmon_shm_system* system,
+                                  sysmon_shm_process* rows, uint32_t capacity, uint32_t* count) {
+    const sysmon_shm_header* header = (const sysmon_shm_header*)reader->base;
+    const uint8_t* first_row = reader->base + header->header_size;
+    int64_t deadline = 0;
+    int attempt;
+    for (attempt = 0;; attempt++) {
+        uint64_t before = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        if (before != 0 && !(before & 1)) {
+            memcpy(system, &header->system, sizeof(*system));
+            uint32_t n = system->process_rows;
+            if (n > header->process_capacity) n = header->process_capacity;
+            if (n > capacity) n = capacity;
+            if (n > 0) memcpy(rows, first_row, (size_t)n * sizeof(sysmon_shm_process));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&header->sequence, __ATOMIC_RELAXED) == before) {
+                if (count) *count = n;
+                return 0;
+            }
+        }
+
+        if (attempt < SYSMON_SHM_RETRIES) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+            continue;
+        }
+        /* Nobody will finish an update once the writer is gone */
+        if (sysmon_shm_writer(reader) == 0) return 1;
+        if (deadline == 0) {
+            deadline = sysmon_shm_now_ms() + SYSMON_SHM_WAIT_MS;
+        } else if (sysmon_shm_now_ms() >= deadline) {
+            return 1;
+        }
+        sched_yield();
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYSMONITOR_SHM_H */
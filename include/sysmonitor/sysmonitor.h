@@ -0,0 +1,137 @@
+#ifndef SYSMONITOR_C_H
+#define SYSMONITOR_C_H
+
+/*
+ * C API of libsysmonitor; a thin wrapper over sysmonitor::Monitor.
+ *
+ * A snapshot is a read-only view into the monitor's own state. It and every
+ * pointer obtained from it are valid until the next tick of that monitor;
+ * with sysmon_start() only inside tick callbacks and sysmon_read().
+ * Functions never throw; failures return NULL / 0 / -1.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sysmon_monitor sysmon_monitor;
+typedef struct sysmon_snapshot sysmon_snapshot;
+
+typedef enum {
+    SYSMON_KEY_CPU = 0,
+    SYSMON_KEY_RSS = 1
+} sysmon_key;
+
+typedef enum {
+    SYSMON_SERIES_CPU = 0,
+    SYSMON_SERIES_MEMORY = 1
+} sysmon_series;
+
+typedef struct {
+    uint64_t sequence;
+    int64_t timestamp_ms;
+    double cpu_percent;
+    double mem_percent;
+    long total_mem_kb;
+    long used_mem_kb;
+    long available_mem_kb;
+    size_t process_count;
+} sysmon_system;
+
+/* The rest of a tick's host sample; kept apart from sysmon_system so that
+ * struct keeps its layout. Rates are per second. */
+typedef struct {
+    double interval_ms;             /* since the previous collection */
+    size_t filtered_count;          /* processes the filter kept out */
+    int clock_available;            /* non-zero: cpufreq readings (Linux) */
+    double cpu_mhz;
+    double cpu_max_mhz;
+    long long throttle_events;      /* since boot */
+    int temperature_available;
+    double max_temp_c;
+    int paging_available;           /* non-zero: /proc/vmstat (Linux) */
+    double major_faults_per_sec;
+    double minor_faults_per_sec;
+    double swap_in_per_sec;         /* pages */
+    double swap_out_per_sec;
+    double scan_kswapd_per_sec;
+    double scan_direct_per_sec;
+    double steal_kswapd_per_sec;
+    double steal_direct_per_sec;
+    long long oom_kills;            /* this tick */
+} sysmon_host;
+
+typedef struct {
+    int cgroups;                /* non-zero: per-cgroup aggregation */
+    int optimize;               /* non-zero: renice busy processes each tick */
+    int cpu_threshold;
+    double delta_cpu_epsilon;
+    long delta_rss_epsilon_kb;
+    int hold_process_files;     /* non-zero: keep stat files open between ticks
+                                 * (one descriptor per process; for short-lived
+                                 * monitors that tick a few times) */
+} sysmon_options;
+
+typedef void (*sysmon_tick_fn)(const sysmon_snapshot* snapshot, void* user);
+
+const char* sysmon_version(void);
+
+/* Fills `options` with the defaults */
+void sysmon_default_options(sysmon_options* options);
+
+/* `options` may be NULL for the defaults */
+sysmon_monitor* sysmon_create(const sysmon_options* options);
+void sysmon_destroy(sysmon_monitor* monitor);
+
+/* Collects one tick on the calling thread and runs the callbacks */
+const sysmon_snapshot* sysmon_tick(sysmon_monitor* monitor);
+
+/* Background ticking; 0 on success */
+int sysmon_start(sysmon_monitor* monitor, int interval_ms);
+void sysmon_stop(sysmon_monitor* monitor);
+
+/* Runs `fn` on the latest snapshot while no tick can replace it */
+void sysmon_read(sysmon_monitor* monitor, sysmon_tick_fn fn, void* user);
+
+/* Filters the process columns from the next tick on (the grammar of
+ * `sysmonitor --filter`; NULL or "" clears it). 0 on success, -1 if the
+ * expression does not parse, keeping the current filter. */
+int sysmon_set_filter(sysmon_monitor* monitor, const char* expression);
+
+/* Returns a callback id (> 0), or -1. A callback may call sysmon_read,
+ * sysmon_history, sysmon_set_filter and add or remove callbacks on the
+ * monitor that runs it. */
+int sysmon_add_callback(sysmon_monitor* monitor, sysmon_tick_fn fn, void* user);
+void sysmon_remove_callback(sysmon_monitor* monitor, int id);
+
+/* Copies up to `count` most recent samples, oldest first; returns how many */
+size_t sysmon_history(sysmon_monitor* monitor, sysmon_series series, double* out, size_t count);
+
+void sysmon_system_info(const sysmon_snapshot* snapshot, sysmon_system* out);
+void sysmon_host_info(const sysmon_snapshot* snapshot, sysmon_host* out);
+
+/* Process columns; `sysmon_process_count()` entries each */
+size_t sysmon_process_count(const sysmon_snapshot* snapshot);
+const int* sysmon_pids(const sysmon_snapshot* snapshot);
+const double* sysmon_cpu(const sysmon_snapshot* snapshot);
+const long* sysmon_rss_kb(const sysmon_snapshot* snapshot);
+const int* sysmon_priorities(const sysmon_snapshot* snapshot);
+const float* sysmon_major_fault_rate(const sysmon_snapshot* snapshot);
+/* NUL-terminated; `length` may be NULL */
+const char* sysmon_name(const sysmon_snapshot* snapshot, size_t row, size_t* length);
+
+/* 1 and sets `row` if the PID is present, else 0 */
+int sysmon_find(const sysmon_snapshot* snapshot, int pid, size_t* row);
+
+/* Rows of the `n` largest processes by `key`, largest first; returns the
+ * count. The array is reused by the next sysmon_top() call. */
+size_t sysmon_top(const sysmon_snapshot* snapshot, sysmon_key key, size_t n, const uint32_t** rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYSMONITOR_C_H */
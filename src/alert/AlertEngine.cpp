@@ -0,0 +1,562 @@
+#include "AlertEngine.h"
+#include "../monitor/ProcessTable.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace {
+    struct MetricName {
+        const char* name;
+        AlertEngine::Metric metric;
+    };
+
+    const MetricName METRICS[] = {
+        { "cpu", AlertEngine::Metric::CPU },
+        { "mem", AlertEngine::Metric::MEM },
+        { "mem.available", AlertEngine::Metric::MEM_AVAILABLE },
+        { "majflt", AlertEngine::Metric::MAJFLT },
+        { "swap", AlertEngine::Metric::SWAP },
+        { "scan.direct", AlertEngine::Metric::DIRECT_SCAN },
+        { "oom", AlertEngine::Metric::OOM },
+        { "throttle", AlertEngine::Metric::THROTTLE },
+        { "temp", AlertEngine::Metric::TEMP },
+        { "procs", AlertEngine::Metric::PROCS },
+        { "proc.cpu", AlertEngine::Metric::PROC_CPU },
+        { "proc.rss", AlertEngine::Metric::PROC_RSS },
+        { "proc.majflt", AlertEngine::Metric::PROC_MAJFLT }
+    };
+
+    // Words, operators and numbers-with-units, split on whitespace and at
+    // the edges of comparison operators ("rss>1G" is three tokens)
+    std::vector<std::string> tokenize(const std::string& text) {
+        std::vector<std::string> tokens;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            if (std::isspace(static_cast<unsigned char>(text[pos]))) {
+                pos++;
+                continue;
+            }
+            size_t start = pos;
+            bool op = std::strchr("<>=!", text[pos]) != nullptr;
+            while (pos < text.size() && !std::isspace(static_cast<unsigned char>(text[pos])) &&
+                   (std::strchr("<>=!", text[pos]) != nullptr) == op) {
+                pos++;
+            }
+            tokens.push_back(text.substr(start, pos - start));
+        }
+        return tokens;
+    }
+
+    bool parseDuration(const std::string& text, double& seconds) {
+        const char* start = text.c_str();
+        char* end;
+        seconds = std::strtod(start, &end);
+        if (end == start || std::isnan(seconds) || seconds < 0.0) return false;
+
+        std::string unit(end);
+        if (unit == "m" || unit == "min") seconds *= 60.0;
+        else if (unit == "h") seconds *= 3600.0;
+        else if (!unit.empty() && unit != "s") return false;
+        return true;
+    }
+
+    bool isKilobytes(AlertEngine::Metric metric) {
+        return metric == AlertEngine::Metric::MEM_AVAILABLE || metric == AlertEngine::Metric::PROC_RSS;
+    }
+
+    bool isPercent(AlertEngine::Metric metric) {
+        return metric == AlertEngine::Metric::CPU || metric == AlertEngine::Metric::MEM ||
+               metric == AlertEngine::Metric::PROC_CPU;
+    }
+
+    bool parseThreshold(const std::string& text, AlertEngine::Metric metric, bool rate,
+                        double& value) {
+        const char* start = text.c_str();
+        char* end;
+        value = std::strtod(start, &end);
+        // strtod also takes "nan"; a NaN threshold makes != hold for everything
+        if (end == start || std::isnan(value)) return false;
+
+        std::string unit(end);
+        std::string per;
+        size_t slash = unit.find('/');
+        if (slash != std::string::npos) {
+            per = unit.substr(slash + 1);
+            unit.erase(slash);
+        }
+        std::transform(unit.begin(), unit.end(), unit.begin(), [](char c) {
+            return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        });
+
+        if (isKilobytes(metric)) {
+            if (unit.size() == 2 && unit[1] == 'B') unit.pop_back();
+            if (unit == "M") value *= 1024.0;
+            else if (unit == "G") value *= 1024.0 * 1024.0;
+            else if (unit == "T") value *= 1024.0 * 1024.0 * 1024.0;
+            else if (!unit.empty() && unit != "K") return false;
+        } else if (!unit.empty() && !(unit == "%" && isPercent(metric))) {
+            return false;
+        }
+
+        if (per.empty()) return true;
+        if (!rate) return false;
+        if (per == "min" || per == "m") value /= 60.0;
+        else if (per == "h") value /= 3600.0;
+        else if (per != "s") return false;
+        return true;
+    }
+}
+
+const int AlertEngine::PANES;
+
+AlertEngine::AlertEngine() : last_sequence(0), synced(false) {}
+
+bool AlertEngine::parseRule(const std::string& line, Rule& rule, std::string& error) {
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+        error = "expected 'name: condition'";
+        return false;
+    }
+    size_t name_start = line.find_first_not_of(" \t");
+    size_t name_end = line.find_last_not_of(" \t", colon - 1);
+    if (name_start >= colon || name_end == std::string::npos || name_end < name_start) {
+        error = "missing rule name";
+        return false;
+    }
+    rule.name = line.substr(name_start, name_end - name_start + 1);
+    std::string condition = line.substr(colon + 1);
+    size_t first = condition.find_first_not_of(" \t\r");
+    size_t last = condition.find_last_not_of(" \t\r");
+    rule.text = first == std::string::npos ? "" : condition.substr(first, last - first + 1);
+
+    std::vector<std::string> tokens = tokenize(condition);
+    size_t pos = 0;
+    auto next = [&tokens, &pos]() -> std::string {
+        return pos < tokens.size() ? tokens[pos++] : std::string();
+    };
+
+    std::string word = next();
+    bool known = false;
+    for (const MetricName& entry : METRICS) {
+        if (word == entry.name) {
+            rule.metric = entry.metric;
+            known = true;
+            break;
+        }
+    }
+    if (!known) {
+        error = "unknown metric '" + word + "'";
+        return false;
+    }
+
+    rule.aggregate = Aggregate::LATEST;
+    rule.quantile = 0.0;
+    rule.window_sec = 0.0;
+    word = next();
+    if (word == "avg" || word == "min" || word == "max" || word == "rate" ||
+        (word.size() > 1 && word[0] == 'p' && std::isdigit(static_cast<unsigned char>(word[1])))) {
+        if (word == "avg") rule.aggregate = Aggregate::AVG;
+        else if (word == "min") rule.aggregate = Aggregate::MIN;
+        else if (word == "max") rule.aggregate = Aggregate::MAX;
+        else if (word == "rate") rule.aggregate = Aggregate::RATE;
+        else {
+            char* end;
+            double percentile = std::strtod(word.c_str() + 1, &end);
+            if (*end != '\0' || percentile <= 0.0 || percentile >= 100.0) {
+                error = "bad percentile '" + word + "'";
+                return false;
+            }
+            if (isProcessMetric(rule.metric)) {
+                error = "percentiles are only kept for host metrics";
+                return false;
+            }
+            rule.aggregate = Aggregate::QUANTILE;
+            rule.quantile = percentile / 100.0;
+        }
+        if (next() != "over") {
+            error = "expected 'over <window>' after '" + word + "'";
+            return false;
+        }
+        word = next();
+        if (!parseDuration(word, rule.window_sec) || rule.window_sec <= 0.0) {
+            error = "bad window '" + word + "'";
+            return false;
+        }
+        word = next();
+    }
+
+    if (word == ">") rule.compare = Compare::GT;
+    else if (word == ">=") rule.compare = Compare::GE;
+    else if (word == "<") rule.compare = Compare::LT;
+    else if (word == "<=") rule.compare = Compare::LE;
+    else if (word == "==") rule.compare = Compare::EQ;
+    else if (word == "!=") rule.compare = Compare::NE;
+    else {
+        error = "expected a comparison, got '" + word + "'";
+        return false;
+    }
+
+    word = next();
+    if (!parseThreshold(word, rule.metric, rule.aggregate == Aggregate::RATE, rule.threshold)) {
+        error = "bad threshold '" + word + "'";
+        return false;
+    }
+
+    rule.for_sec = 0.0;
+    word = next();
+    if (word == "for") {
+        word = next();
+        if (!parseDuration(word, rule.for_sec)) {
+            error = "bad duration '" + word + "'";
+            return false;
+        }
+        word = next();
+    }
+    if (!word.empty()) {
+        error = "unexpected '" + word + "'";
+        return false;
+    }
+    return true;
+}
+
+bool AlertEngine::compile(const std::string& text, std::string& error) {
+    std::vector<Rule> parsed;
+    std::istringstream in(text);
+    std::string line;
+    int number = 0;
+    while (std::getline(in, line)) {
+        number++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+
+        Rule rule;
+        std::string message;
+        if (!parseRule(line, rule, message)) {
+            error = "line " + std::to_string(number) + ": " + message;
+            return false;
+        }
+        for (const Rule& other : parsed) {
+            if (other.name == rule.name) {
+                error = "line " + std::to_string(number) + ": duplicate rule '" + rule.name + "'";
+                return false;
+            }
+        }
+        parsed.push_back(rule);
+    }
+
+    rules.swap(parsed);
+    states.clear();
+    states.resize(rules.size());
+    firing.clear();
+    source = text;
+    synced = false;
+    return true;
+}
+
+double AlertEngine::hostValue(Metric metric, const SystemMetrics& metrics) {
+    switch (metric) {
+        case Metric::CPU: return metrics.cpu_usage;
+        case Metric::MEM: return metrics.mem_usage_percent;
+        case Metric::MEM_AVAILABLE: return static_cast<double>(metrics.available_mem_kb);
+        case Metric::MAJFLT: return metrics.paging.major_faults;
+        case Metric::SWAP: return metrics.paging.swap_in + metrics.paging.swap_out;
+        case Metric::DIRECT_SCAN: return metrics.paging.scan_direct;
+        case Metric::OOM: return static_cast<double>(metrics.paging.oom_kills);
+        case Metric::THROTTLE: return static_cast<double>(metrics.cpu_thermals.throttle_events);
+        case Metric::TEMP: {
+            const CPUThermals& thermals = metrics.cpu_thermals;
+            return thermals.hottest_zone >= 0 ? thermals.zones[thermals.hottest_zone].celsius : 0.0;
+        }
+        case Metric::PROCS: return static_cast<double>(metrics.process_count);
+        default: return 0.0;
+    }
+}
+
+bool AlertEngine::holds(const Rule& rule, double value) {
+    switch (rule.compare) {
+        case Compare::GT: return value > rule.threshold;
+        case Compare::GE: return value >= rule.threshold;
+        case Compare::LT: return value < rule.threshold;
+        case Compare::LE: return value <= rule.threshold;
+        case Compare::EQ: return value == rule.threshold;
+        case Compare::NE: return value != rule.threshold;
+    }
+    return false;
+}
+
+void AlertEngine::addHost(const Rule& rule, HostWindow& window, double now, double x) {
+    Point point;
+    point.t = now;
+    point.x = x;
+    window.points.push_back(point);
+    window.sum += x;
+    if (rule.aggregate == Aggregate::MAX) {
+        while (!window.max_queue.empty() && window.max_queue.back().x <= x) window.max_queue.pop_back();
+        window.max_queue.push_back(point);
+    } else if (rule.aggregate == Aggregate::MIN) {
+        while (!window.min_queue.empty() && window.min_queue.back().x >= x) window.min_queue.pop_back();
+        window.min_queue.push_back(point);
+    } else if (rule.aggregate == Aggregate::QUANTILE) {
+        window.sketch.add(x);
+    }
+
+    while (window.points.front().t <= now - rule.window_sec) {
+        const Point& old = window.points.front();
+        window.sum -= old.x;
+        if (rule.aggregate == Aggregate::QUANTILE) window.sketch.remove(old.x);
+        if (!window.max_queue.empty() && window.max_queue.front().t == old.t) window.max_queue.pop_front();
+        if (!window.min_queue.empty() && window.min_queue.front().t == old.t) window.min_queue.pop_front();
+        window.points.pop_front();
+        window.removed++;
+        window.filled = true;
+    }
+
+    // Once per window, so add/remove rounding cannot pile up
+    if (window.removed >= window.points.size()) {
+        window.sum = 0.0;
+        for (const Point& kept : window.points) window.sum += kept.x;
+        window.removed = 0;
+    }
+}
+
+bool AlertEngine::readHost(const Rule& rule, const HostWindow& window, double& value) const {
+    if (!window.filled || window.points.empty()) return false;
+
+    switch (rule.aggregate) {
+        case Aggregate::AVG:
+            value = window.sum / window.points.size();
+            return true;
+        case Aggregate::MIN:
+            value = window.min_queue.front().x;
+            return true;
+        case Aggregate::MAX:
+            value = window.max_queue.front().x;
+            return true;
+        case Aggregate::RATE: {
+            const Point& first = window.points.front();
+            const Point& last = window.points.back();
+            if (last.t <= first.t) return false;
+            value = (last.x - first.x) / (last.t - first.t);
+            return true;
+        }
+        case Aggregate::QUANTILE:
+            value = window.sketch.quantile(rule.quantile);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void AlertEngine::addProcess(const Rule& rule, ProcessWindow& window, double now, double x) {
+    double pane_sec = rule.window_sec / PANES;
+    if (window.used == 0 || now - window.panes[window.head].start >= pane_sec) {
+        if (window.used > 0) window.head = (window.head + 1) % PANES;
+        if (window.used < PANES) {
+            window.used++;
+        } else {
+            window.filled = true;
+        }
+        Pane& pane = window.panes[window.head];
+        pane.start = now;
+        pane.sum = 0.0;
+        pane.count = 0;
+    }
+
+    Pane& pane = window.panes[window.head];
+    if (pane.count == 0) {
+        pane.first_t = now;
+        pane.first = x;
+        pane.min = x;
+        pane.max = x;
+    }
+    pane.last_t = now;
+    pane.last = x;
+    pane.sum += x;
+    pane.min = std::min(pane.min, x);
+    pane.max = std::max(pane.max, x);
+    pane.count++;
+}
+
+bool AlertEngine::readProcess(const Rule& rule, const ProcessWindow& window, double& value) const {
+    if (!window.filled) return false;
+
+    const Pane& newest = window.panes[window.head];
+    const Pane& oldest = window.panes[(window.head + 1) % PANES];
+    switch (rule.aggregate) {
+        case Aggregate::RATE:
+            if (newest.last_t <= oldest.first_t) return false;
+            value = (newest.last - oldest.first) / (newest.last_t - oldest.first_t);
+            return true;
+        case Aggregate::AVG:
+        case Aggregate::MIN:
+        case Aggregate::MAX: {
+            double sum = 0.0;
+            uint32_t count = 0;
+            value = rule.aggregate == Aggregate::MIN ? newest.min : newest.max;
+            for (const Pane& pane : window.panes) {
+                sum += pane.sum;
+                count += pane.count;
+                if (rule.aggregate == Aggregate::MIN) value = std::min(value, pane.min);
+                if (rule.aggregate == Aggregate::MAX) value = std::max(value, pane.max);
+            }
+            if (rule.aggregate == Aggregate::AVG) value = count > 0 ? sum / count : 0.0;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void AlertEngine::transition(size_t index, int pid, const std::string& process, bool condition,
+                             double value, double now, int64_t wall_ms,
+                             std::vector<AlertEvent>& events) {
+    const Rule& rule = rules[index];
+    std::unordered_map<int, Pending>& alerts = states[index].alerts;
+    auto it = alerts.find(pid);
+    if (!condition && it == alerts.end()) return;
+
+    AlertEvent event;
+    if (!condition) {
+        if (it->second.firing) {
+            event.state = AlertEvent::State::RESOLVED;
+            event.value = value;
+            event.active_sec = now - it->second.since;
+            event.process = it->second.process;
+        }
+        alerts.erase(it);
+        if (event.state != AlertEvent::State::RESOLVED) return;
+    } else {
+        if (it == alerts.end()) {
+            Pending pending;
+            pending.since = now;
+            pending.firing = false;
+            pending.process = process;
+            it = alerts.emplace(pid, pending).first;
+        }
+        Pending& pending = it->second;
+        pending.value = value;
+        if (pending.firing || now - pending.since < rule.for_sec) return;
+        pending.firing = true;
+        event.state = AlertEvent::State::FIRING;
+        event.value = value;
+        event.active_sec = now - pending.since;
+        event.process = pending.process;
+    }
+
+    event.rule = rule.name;
+    event.expression = rule.text;
+    event.pid = pid;
+    event.threshold = rule.threshold;
+    event.timestamp_ms = wall_ms;
+    events.push_back(event);
+}
+
+void AlertEngine::forgetExited(const SnapshotDelta* delta, double now, int64_t wall_ms,
+                               std::vector<AlertEvent>& events) {
+    // Exits are only known tick to tick; after a gap, PIDs may have been reused
+    bool gap = !delta || !synced || delta->sequence != last_sequence + 1;
+    if (delta) last_sequence = delta->sequence;
+    synced = delta != nullptr;
+
+    for (size_t i = 0; i < rules.size(); i++) {
+        if (!isProcessMetric(rules[i].metric)) continue;
+        RuleState& state = states[i];
+        if (gap) {
+            state.processes.clear();
+            std::vector<int> pids;
+            for (const auto& entry : state.alerts) pids.push_back(entry.first);
+            for (int pid : pids) {
+                transition(i, pid, "", false, state.alerts[pid].value, now, wall_ms, events);
+            }
+            continue;
+        }
+        for (const auto& proc : delta->exited) {
+            state.processes.erase(proc.pid);
+            auto it = state.alerts.find(proc.pid);
+            if (it != state.alerts.end()) {
+                transition(i, proc.pid, "", false, it->second.value, now, wall_ms, events);
+            }
+        }
+    }
+}
+
+void AlertEngine::evaluate(const SystemMetrics& metrics, double now_sec, int64_t wall_ms,
+                           std::vector<AlertEvent>& events) {
+    if (rules.empty()) return;
+    forgetExited(metrics.delta, now_sec, wall_ms, events);
+
+    const ProcessTable* table = metrics.process_table;
+    for (size_t i = 0; i < rules.size(); i++) {
+        const Rule& rule = rules[i];
+        RuleState& state = states[i];
+
+        if (!isProcessMetric(rule.metric)) {
+            double value = hostValue(rule.metric, metrics);
+            if (rule.aggregate != Aggregate::LATEST) {
+                addHost(rule, state.host, now_sec, value);
+                if (!readHost(rule, state.host, value)) continue;
+            }
+            transition(i, 0, "", holds(rule, value), value, now_sec, wall_ms, events);
+            continue;
+        }
+
+        if (!table) continue;
+        for (size_t row = 0; row < table->size(); row++) {
+            double value = rule.metric == Metric::PROC_CPU ? table->getCPU(row)
+                         : rule.metric == Metric::PROC_RSS ? static_cast<double>(table->getRSS(row))
+                         : table->getFaultRate(row);
+            int pid = table->getPid(row);
+            if (rule.aggregate != Aggregate::LATEST) {
+                auto it = state.processes.find(pid);
+                if (it == state.processes.end()) {
+                    ProcessWindow window;
+                    window.head = 0;
+                    window.used = 0;
+                    window.filled = false;
+                    it = state.processes.emplace(pid, window).first;
+                }
+                addProcess(rule, it->second, now_sec, value);
+                if (!readProcess(rule, it->second, value)) continue;
+            }
+            bool condition = holds(rule, value);
+            // The name is only copied when an alert starts
+            if (condition && state.alerts.find(pid) == state.alerts.end()) {
+                transition(i, pid, table->getName(row), true, value, now_sec, wall_ms, events);
+            } else {
+                transition(i, pid, "", condition, value, now_sec, wall_ms, events);
+            }
+        }
+    }
+
+    firing.clear();
+    for (size_t i = 0; i < rules.size(); i++) {
+        size_t first = firing.size();
+        for (const auto& entry : states[i].alerts) {
+            if (!entry.second.firing) continue;
+            AlertEvent event;
+            event.rule = rules[i].name;
+            event.expression = rules[i].text;
+            event.pid = entry.first;
+            event.process = entry.second.process;
+            event.value = entry.second.value;
+            event.threshold = rules[i].threshold;
+            event.active_sec = now_sec - entry.second.since;
+            event.timestamp_ms = wall_ms;
+            firing.push_back(event);
+        }
+        std::sort(firing.begin() + first, firing.end(),
+                  [](const AlertEvent& a, const AlertEvent& b) { return a.pid < b.pid; });
+    }
+}
+
+size_t AlertEngine::getTrackedWindows() const {
+    size_t count = 0;
+    for (size_t i = 0; i < rules.size(); i++) {
+        if (rules[i].aggregate == Aggregate::LATEST) continue;
+        count += isProcessMetric(rules[i].metric) ? states[i].processes.size() : 1;
+    }
+    return count;
+}
@@ -0,0 +1,205 @@
+#ifndef ALERTENGINE_H
+#define ALERTENGINE_H
+
+#include "../monitor/ProcessInfo.h"
+#include "../monitor/SnapshotDelta.h"
+#include "../monitor/Statistics.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A rule changing state. Process rules fire per process.
+struct AlertEvent {
+    enum class State {
+        FIRING,
+        RESOLVED
+    };
+
+    std::string rule;
+    std::string expression;     // The rule as written
+    State state;
+    int pid;                    // 0 for host rules
+    std::string process;
+    double value;               // Aggregate that crossed (or last seen, when resolved)
+    double threshold;
+    double active_sec;          // Since the condition first held
+    int64_t timestamp_ms;
+
+    AlertEvent() : state(State::FIRING), pid(0), value(0.0), threshold(0.0), active_sec(0.0),
+                   timestamp_ms(0) {}
+};
+
+// Declarative alert rules, evaluated once per tick.
+//
+//   # name: metric [aggregate over window] op threshold [for duration]
+//   cpu_hot:    cpu p95 over 5m > 90 for 1m
+//   leak:       proc.rss rate over 1m > 100M/min
+//   thrashing:  majflt avg over 30s > 200
+//   oom:        oom > 0
+//
+// Host metrics: cpu, mem (%), mem.available (KB), majflt, swap, scan.direct
+// (per second), oom, throttle (events per tick), temp (hottest zone, C),
+// procs. Process metrics, evaluated for every process in the table:
+// proc.cpu, proc.rss (KB), proc.majflt. Aggregates are avg, min, max, rate
+// (change per second, or per /min, /h as a threshold suffix) and, for host
+// metrics, p50/p90/p95/p99. KB thresholds take K/M/G/T suffixes. Without an
+// aggregate the latest value is compared. Durations are seconds or take
+// s/m/h.
+//
+// Host windows keep their samples in a ring with running sums, monotonic
+// min/max queues and a quantile sketch that samples are removed from as
+// they leave, so an update is O(1) and reads are exact to the sketch's 1%.
+// Process windows are a few fixed panes per process (the window slides one
+// pane at a time): under half a kilobyte per process and rule, however
+// long the window. A windowed rule only evaluates once its window has filled.
+//
+// A condition that holds is pending until it has held for the rule's `for`
+// duration, then fires once; it resolves once when the condition stops
+// holding (or the process exits). Nothing repeats while a state persists.
+class AlertEngine {
+public:
+    enum class Metric : uint8_t {
+        CPU,
+        MEM,
+        MEM_AVAILABLE,
+        MAJFLT,
+        SWAP,
+        DIRECT_SCAN,
+        OOM,
+        THROTTLE,
+        TEMP,
+        PROCS,
+        PROC_CPU,
+        PROC_RSS,
+        PROC_MAJFLT
+    };
+
+    enum class Aggregate : uint8_t {
+        LATEST,
+        AVG,
+        MIN,
+        MAX,
+        RATE,
+        QUANTILE
+    };
+
+    enum class Compare : uint8_t {
+        GT,
+        GE,
+        LT,
+        LE,
+        EQ,
+        NE
+    };
+
+    struct Rule {
+        std::string name;
+        std::string text;
+        Metric metric;
+        Aggregate aggregate;
+        double quantile;
+        double window_sec;
+        Compare compare;
+        double threshold;       // In per-second units for rates
+        double for_sec;
+    };
+
+private:
+    static const int PANES = 6;
+
+    struct Point {
+        double t;
+        double x;
+    };
+
+    // Exact sliding window over one host series
+    struct HostWindow {
+        std::deque<Point> points;
+        std::deque<Point> max_queue;    // Decreasing
+        std::deque<Point> min_queue;    // Increasing
+        double sum;
+        size_t removed;         // Since the sum was last recomputed
+        bool filled;
+        QuantileSketch sketch;
+
+        HostWindow() : sum(0.0), removed(0), filled(false) {}
+    };
+
+    struct Pane {
+        double start;
+        double first_t;
+        double first;
+        double last_t;
+        double last;
+        double sum;
+        double min;
+        double max;
+        uint32_t count;
+    };
+
+    // Approximate window over one process series
+    struct ProcessWindow {
+        Pane panes[PANES];
+        int head;               // Newest pane
+        int used;
+        bool filled;
+    };
+
+    struct Pending {
+        double since;
+        double value;
+        bool firing;
+        std::string process;
+    };
+
+    struct RuleState {
+        HostWindow host;
+        std::unordered_map<int, ProcessWindow> processes;
+        std::unordered_map<int, Pending> alerts;    // By PID, 0 for host rules
+    };
+
+    std::vector<Rule> rules;
+    std::vector<RuleState> states;
+    std::vector<AlertEvent> firing;
+    std::string source;
+    unsigned long last_sequence;
+    bool synced;
+
+    static bool parseRule(const std::string& line, Rule& rule, std::string& error);
+    static bool isProcessMetric(Metric metric) { return metric >= Metric::PROC_CPU; }
+    static double hostValue(Metric metric, const SystemMetrics& metrics);
+    static bool holds(const Rule& rule, double value);
+
+    void addHost(const Rule& rule, HostWindow& window, double now, double x);
+    bool readHost(const Rule& rule, const HostWindow& window, double& value) const;
+    void addProcess(const Rule& rule, ProcessWindow& window, double now, double x);
+    bool readProcess(const Rule& rule, const ProcessWindow& window, double& value) const;
+    void transition(size_t index, int pid, const std::string& process, bool condition,
+                    double value, double now, int64_t wall_ms, std::vector<AlertEvent>& events);
+    void forgetExited(const SnapshotDelta* delta, double now, int64_t wall_ms,
+                      std::vector<AlertEvent>& events);
+
+public:
+    AlertEngine();
+
+    // One rule per line; blank lines and lines starting with '#' are
+    // skipped. On an error the rules are left unchanged and `error` names
+    // the line. Replacing the rules forgets all windows and alert states.
+    bool compile(const std::string& text, std::string& error);
+
+    // Feeds one tick. `now_sec` is a monotonic clock, `wall_ms` stamps the
+    // events. Appends this tick's state changes to `events`.
+    void evaluate(const SystemMetrics& metrics, double now_sec, int64_t wall_ms,
+                  std::vector<AlertEvent>& events);
+
+    // Alerts currently firing, host rules first
+    const std::vector<AlertEvent>& getFiring() const { return firing; }
+    const std::vector<Rule>& getRules() const { return rules; }
+    const std::string& getSource() const { return source; }
+    bool empty() const { return rules.empty(); }
+    size_t getTrackedWindows() const;
+};
+
+#endif // ALERTENGINE_H
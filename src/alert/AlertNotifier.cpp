@@ -0,0 +1,261 @@
+#include "AlertNotifier.h"
+#include "../utils/Text.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+    const char* stateName(AlertEvent::State state) {
+        return state == AlertEvent::State::FIRING ? "firing" : "resolved";
+    }
+}
+
+const size_t AlertNotifier::MAX_QUEUE;
+
+AlertNotifier::AlertNotifier(const std::string& hook, const std::string& socket_path,
+                             double hook_timeout_sec)
+    : hook(hook), socket_path(socket_path), hook_timeout_sec(hook_timeout_sec), fd(-1),
+      stopping(false), delivered(0), dropped(0), failed(0) {
+    worker = std::thread(&AlertNotifier::run, this);
+}
+
+AlertNotifier::~AlertNotifier() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+    disconnect();
+}
+
+void AlertNotifier::post(const std::vector<AlertEvent>& events) {
+    if (events.empty()) return;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (const AlertEvent& event : events) {
+            if (queue.size() >= MAX_QUEUE) {
+                queue.pop_front();
+                dropped++;
+            }
+            queue.push_back(event);
+        }
+    }
+    wake.notify_one();
+}
+
+std::string AlertNotifier::toJSON(const AlertEvent& event) {
+    std::string out = "{\"rule\":";
+    Text::appendJSONString(out, event.rule);
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), ",\"state\":\"%s\",\"pid\":%d,", stateName(event.state), event.pid);
+    out += buf;
+    if (event.pid != 0) {
+        out += "\"process\":";
+        Text::appendJSONString(out, event.process);
+        out += ',';
+    }
+    std::snprintf(buf, sizeof(buf),
+                  "\"value\":%.6g,\"threshold\":%.6g,\"active_sec\":%.1f,\"timestamp_ms\":%lld,",
+                  event.value, event.threshold, event.active_sec,
+                  static_cast<long long>(event.timestamp_ms));
+    out += buf;
+    out += "\"expression\":";
+    Text::appendJSONString(out, event.expression);
+    out += "}\n";
+    return out;
+}
+
+void AlertNotifier::run() {
+    // A hook that exits without reading its stdin must not take the whole
+    // process down; the write sees EPIPE instead
+    sigset_t pipe_signal;
+    sigemptyset(&pipe_signal);
+    sigaddset(&pipe_signal, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_signal, nullptr);
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this]() { return stopping || !queue.empty(); });
+        if (stopping) {
+            dropped += queue.size();
+            queue.clear();
+            return;
+        }
+        AlertEvent event = queue.front();
+        queue.pop_front();
+        guard.unlock();
+
+        std::string json = toJSON(event);
+        bool ok = true;
+        if (!hook.empty()) ok = runHook(event, json) && ok;
+        if (!socket_path.empty()) ok = sendSocket(json) && ok;
+        if (ok) {
+            delivered++;
+        } else {
+            failed++;
+        }
+
+        guard.lock();
+    }
+}
+
+bool AlertNotifier::runHook(const AlertEvent& event, const std::string& json) {
+    char number[64];
+    std::vector<std::string> settings;
+    settings.push_back("SYSMON_ALERT_RULE=" + event.rule);
+    settings.push_back(std::string("SYSMON_ALERT_STATE=") + stateName(event.state));
+    settings.push_back("SYSMON_ALERT_PID=" + std::to_string(event.pid));
+    settings.push_back("SYSMON_ALERT_PROCESS=" + event.process);
+    std::snprintf(number, sizeof(number), "%.6g", event.value);
+    settings.push_back(std::string("SYSMON_ALERT_VALUE=") + number);
+    std::snprintf(number, sizeof(number), "%.6g", event.threshold);
+    settings.push_back(std::string("SYSMON_ALERT_THRESHOLD=") + number);
+    settings.push_back("SYSMON_ALERT_EXPRESSION=" + event.expression);
+    std::snprintf(number, sizeof(number), "%.1f", event.active_sec);
+    settings.push_back(std::string("SYSMON_ALERT_ACTIVE_SEC=") + number);
+    settings.push_back("SYSMON_ALERT_TIMESTAMP_MS=" + std::to_string(event.timestamp_ms));
+
+    std::vector<char*> env;
+    for (char** entry = environ; *entry; entry++) {
+        if (std::strncmp(*entry, "SYSMON_ALERT_", 13) != 0) env.push_back(*entry);
+    }
+    for (std::string& setting : settings) env.push_back(&setting[0]);
+    env.push_back(nullptr);
+
+    int input[2];
+    if (pipe2(input, O_CLOEXEC) != 0) return false;
+
+    // stdout and stderr would scribble over the TUI
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, input[0], STDIN_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+    // Its own process group, so a timeout kills whatever the shell started;
+    // and none of this thread's blocked SIGPIPE
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attributes, &signals);
+    sigaddset(&signals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &signals);
+    posix_spawnattr_setpgroup(&attributes, 0);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK |
+                                          POSIX_SPAWN_SETSIGDEF);
+
+    const char* shell = "/bin/sh";
+    char* argv[] = { const_cast<char*>(shell), const_cast<char*>("-c"), &hook[0], nullptr };
+    pid_t pid;
+    int rc = posix_spawn(&pid, shell, &actions, &attributes, argv, env.data());
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    close(input[0]);
+    if (rc != 0) {
+        close(input[1]);
+        return false;
+    }
+
+    // A hook may exit without reading its stdin; that is not a failure
+    size_t written = 0;
+    while (written < json.size()) {
+        ssize_t n = write(input[1], json.data() + written, json.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+    }
+    close(input[1]);
+    if (written < json.size()) {
+        // Take the blocked SIGPIPE back off the thread
+        sigset_t pipe_signal;
+        sigemptyset(&pipe_signal);
+        sigaddset(&pipe_signal, SIGPIPE);
+        timespec zero = { 0, 0 };
+        while (sigtimedwait(&pipe_signal, nullptr, &zero) == SIGPIPE) {}
+    }
+
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(static_cast<long long>(hook_timeout_sec * 1000.0));
+    int status = 0;
+    while (true) {
+        pid_t done = waitpid(pid, &status, WNOHANG);
+        if (done == pid) break;
+        if (done < 0 && errno != EINTR) return false;
+
+        // The destructor does not wait out a slow hook either
+        bool stop;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            stop = wake.wait_for(guard, std::chrono::milliseconds(10), [this]() { return stopping; });
+        }
+        if (stop || std::chrono::steady_clock::now() >= deadline) {
+            kill(-pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            return false;
+        }
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool AlertNotifier::connect() {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) return false;
+    memcpy(address.sun_path, socket_path.c_str(), socket_path.size());
+
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) return false;
+
+    timeval timeout;
+    timeout.tv_sec = 2;
+    timeout.tv_usec = 0;
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (::connect(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(sock);
+        return false;
+    }
+    fd = sock;
+    return true;
+}
+
+void AlertNotifier::disconnect() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool AlertNotifier::sendSocket(const std::string& json) {
+    // A receiver that restarted leaves a dead connection: one fresh attempt
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (fd < 0 && !connect()) return false;
+
+        size_t sent = 0;
+        while (sent < json.size()) {
+            ssize_t n = ::send(fd, json.data() + sent, json.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+        if (sent == json.size()) return true;
+        disconnect();
+        // Half a line may have gone out; retrying would garble the stream
+        if (sent > 0) return false;
+    }
+    return false;
+}
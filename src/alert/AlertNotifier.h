@@ -0,0 +1,67 @@
+#ifndef ALERTNOTIFIER_H
+#define ALERTNOTIFIER_H
+
+#include "AlertEngine.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Delivers alert events off the sampling thread.
+//
+// post() only queues; a worker thread runs the hook and writes to the
+// socket, so a slow or dead receiver costs the sampling loop nothing. The
+// queue is bounded: when it is full the oldest events are dropped and
+// counted. Each event is one JSON line.
+//
+// The hook is run as `/bin/sh -c <command>` with the event on stdin and in
+// SYSMON_ALERT_* environment variables (RULE, STATE, PID, PROCESS, VALUE,
+// THRESHOLD, EXPRESSION, ACTIVE_SEC, TIMESTAMP_MS), its stdout and stderr
+// on /dev/null. It runs in its own process group, which is killed if the
+// hook runs past the timeout or the notifier is destroyed. The socket is a
+// unix stream socket, connected on first use and reconnected after any
+// failure.
+class AlertNotifier {
+private:
+    static const size_t MAX_QUEUE = 256;
+
+    std::string hook;
+    std::string socket_path;
+    double hook_timeout_sec;
+    int fd;
+
+    std::deque<AlertEvent> queue;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread worker;
+    bool stopping;
+
+    std::atomic<unsigned long long> delivered;
+    std::atomic<unsigned long long> dropped;
+    std::atomic<unsigned long long> failed;
+
+    void run();
+    bool runHook(const AlertEvent& event, const std::string& json);
+    bool sendSocket(const std::string& json);
+    bool connect();
+    void disconnect();
+
+public:
+    // Either target may be empty
+    AlertNotifier(const std::string& hook, const std::string& socket_path,
+                  double hook_timeout_sec = 10.0);
+    ~AlertNotifier();
+
+    void post(const std::vector<AlertEvent>& events);
+
+    static std::string toJSON(const AlertEvent& event);
+
+    unsigned long long getDelivered() const { return delivered; }
+    unsigned long long getDropped() const { return dropped; }
+    unsigned long long getFailed() const { return failed; }
+};
+
+#endif // ALERTNOTIFIER_H
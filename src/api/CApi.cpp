@@ -0,0 +1,218 @@
+#include "sysmonitor/sysmonitor.h"
+#include "sysmonitor/Monitor.h"
+#include <exception>
+#include <new>
+#include <vector>
+
+using sysmonitor::Monitor;
+using sysmonitor::Snapshot;
+
+struct sysmon_monitor {
+    Monitor monitor;
+    std::vector<double> history;
+
+    explicit sysmon_monitor(const Monitor::Options& options) : monitor(options) {}
+};
+
+namespace {
+    const Snapshot* view(const sysmon_snapshot* snapshot) {
+        return reinterpret_cast<const Snapshot*>(snapshot);
+    }
+
+    const sysmon_snapshot* handle(const Snapshot& snapshot) {
+        return reinterpret_cast<const sysmon_snapshot*>(&snapshot);
+    }
+
+    Monitor::TickCallback wrap(sysmon_tick_fn fn, void* user) {
+        return [fn, user](const Snapshot& snapshot) { fn(handle(snapshot), user); };
+    }
+}
+
+extern "C" {
+
+const char* sysmon_version(void) {
+    return SYSMONITOR_VERSION;
+}
+
+void sysmon_default_options(sysmon_options* options) {
+    if (!options) return;
+    Monitor::Options defaults;
+    options->cgroups = defaults.cgroups ? 1 : 0;
+    options->optimize = defaults.optimize ? 1 : 0;
+    options->cpu_threshold = defaults.cpu_threshold;
+    options->delta_cpu_epsilon = defaults.delta_cpu_epsilon;
+    options->delta_rss_epsilon_kb = defaults.delta_rss_epsilon_kb;
+    options->hold_process_files = defaults.hold_process_files ? 1 : 0;
+}
+
+sysmon_monitor* sysmon_create(const sysmon_options* options) {
+    Monitor::Options settings;
+    if (options) {
+        settings.cgroups = options->cgroups != 0;
+        settings.optimize = options->optimize != 0;
+        settings.cpu_threshold = options->cpu_threshold;
+        settings.delta_cpu_epsilon = options->delta_cpu_epsilon;
+        settings.delta_rss_epsilon_kb = options->delta_rss_epsilon_kb;
+        settings.hold_process_files = options->hold_process_files != 0;
+    }
+    try {
+        return new sysmon_monitor(settings);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void sysmon_destroy(sysmon_monitor* monitor) {
+    delete monitor;
+}
+
+const sysmon_snapshot* sysmon_tick(sysmon_monitor* monitor) {
+    if (!monitor) return nullptr;
+    try {
+        return handle(monitor->monitor.tick());
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+int sysmon_start(sysmon_monitor* monitor, int interval_ms) {
+    if (!monitor) return -1;
+    try {
+        return monitor->monitor.start(interval_ms) ? 0 : -1;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+void sysmon_stop(sysmon_monitor* monitor) {
+    if (monitor) monitor->monitor.stop();
+}
+
+void sysmon_read(sysmon_monitor* monitor, sysmon_tick_fn fn, void* user) {
+    if (!monitor || !fn) return;
+    try {
+        monitor->monitor.read(wrap(fn, user));
+    } catch (const std::exception&) {
+    }
+}
+
+int sysmon_set_filter(sysmon_monitor* monitor, const char* expression) {
+    if (!monitor) return -1;
+    try {
+        return monitor->monitor.setFilter(expression ? expression : "") ? 0 : -1;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int sysmon_add_callback(sysmon_monitor* monitor, sysmon_tick_fn fn, void* user) {
+    if (!monitor || !fn) return -1;
+    try {
+        return monitor->monitor.addCallback(wrap(fn, user));
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+void sysmon_remove_callback(sysmon_monitor* monitor, int id) {
+    if (monitor) monitor->monitor.removeCallback(id);
+}
+
+size_t sysmon_history(sysmon_monitor* monitor, sysmon_series series, double* out, size_t count) {
+    if (!monitor || !out || count == 0) return 0;
+    try {
+        monitor->history.clear();
+        size_t n = monitor->monitor.history(series == SYSMON_SERIES_MEMORY ? sysmonitor::Series::MEMORY
+                                                                           : sysmonitor::Series::CPU,
+                                            count, monitor->history);
+        for (size_t i = 0; i < n; i++) out[i] = monitor->history[i];
+        return n;
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+void sysmon_system_info(const sysmon_snapshot* snapshot, sysmon_system* out) {
+    if (!snapshot || !out) return;
+    const sysmonitor::SystemSample& system = view(snapshot)->system();
+    out->sequence = system.sequence;
+    out->timestamp_ms = system.timestamp_ms;
+    out->cpu_percent = system.cpu_percent;
+    out->mem_percent = system.mem_percent;
+    out->total_mem_kb = system.total_mem_kb;
+    out->used_mem_kb = system.used_mem_kb;
+    out->available_mem_kb = system.available_mem_kb;
+    out->process_count = system.process_count;
+}
+
+void sysmon_host_info(const sysmon_snapshot* snapshot, sysmon_host* out) {
+    if (!snapshot || !out) return;
+    const sysmonitor::SystemSample& system = view(snapshot)->system();
+    out->interval_ms = system.interval_ms;
+    out->filtered_count = system.filtered_count;
+    out->clock_available = system.clock_available ? 1 : 0;
+    out->cpu_mhz = system.cpu_mhz;
+    out->cpu_max_mhz = system.cpu_max_mhz;
+    out->throttle_events = system.throttle_events;
+    out->temperature_available = system.temperature_available ? 1 : 0;
+    out->max_temp_c = system.max_temp_c;
+    const sysmonitor::PagingSample& paging = system.paging;
+    out->paging_available = paging.available ? 1 : 0;
+    out->major_faults_per_sec = paging.major_faults_per_sec;
+    out->minor_faults_per_sec = paging.minor_faults_per_sec;
+    out->swap_in_per_sec = paging.swap_in_per_sec;
+    out->swap_out_per_sec = paging.swap_out_per_sec;
+    out->scan_kswapd_per_sec = paging.scan_kswapd_per_sec;
+    out->scan_direct_per_sec = paging.scan_direct_per_sec;
+    out->steal_kswapd_per_sec = paging.steal_kswapd_per_sec;
+    out->steal_direct_per_sec = paging.steal_direct_per_sec;
+    out->oom_kills = paging.oom_kills;
+}
+
+size_t sysmon_process_count(const sysmon_snapshot* snapshot) {
+    return snapshot ? view(snapshot)->size() : 0;
+}
+
+const int* sysmon_pids(const sysmon_snapshot* snapshot) {
+    return snapshot ? view(snapshot)->pids() : nullptr;
+}
+
+const double* sysmon_cpu(const sysmon_snapshot* snapshot) {
+    return snapshot ? view(snapshot)->cpu() : nullptr;
+}
+
+const long* sysmon_rss_kb(const sysmon_snapshot* snapshot) {
+    return snapshot ? view(snapshot)->rssKb() : nullptr;
+}
+
+const int* sysmon_priorities(const sysmon_snapshot* snapshot) {
+    return snapshot ? view(snapshot)->priorities() : nullptr;
+}
+
+const float* sysmon_major_fault_rate(const sysmon_snapshot* snapshot) {
+    return snapshot ? view(snapshot)->majorFaultRate() : nullptr;
+}
+
+const char* sysmon_name(const sysmon_snapshot* snapshot, size_t row, size_t* length) {
+    if (!snapshot || row >= view(snapshot)->size()) return nullptr;
+    return view(snapshot)->name(row, length);
+}
+
+int sysmon_find(const sysmon_snapshot* snapshot, int pid, size_t* row) {
+    size_t found;
+    if (!snapshot || !view(snapshot)->find(pid, found)) return 0;
+    if (row) *row = found;
+    return 1;
+}
+
+size_t sysmon_top(const sysmon_snapshot* snapshot, sysmon_key key, size_t n, const uint32_t** rows) {
+    if (!snapshot) return 0;
+    try {
+        return view(snapshot)->top(key == SYSMON_KEY_RSS ? sysmonitor::Key::RSS : sysmonitor::Key::CPU,
+                                   n, rows);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+} // extern "C"
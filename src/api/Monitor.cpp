@@ -0,0 +1,267 @@
+#include "sysmonitor/Monitor.h"
+#include "../monitor/SystemMonitor.h"
+#include "../optimizer/Optimizer.h"
+#include "../platform/Platform.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace sysmonitor {
+
+struct Snapshot::Impl {
+    Snapshot view;              // The one view handed out; never changes
+    SystemMonitor monitor;
+    SystemMetrics metrics;
+    SystemSample system;
+    Optimizer optimizer;
+    Monitor::Options options;
+    mutable std::vector<uint32_t> order;
+    std::chrono::steady_clock::time_point last_collect;
+
+    // Collecting and filter changes take state_lock; everything that looks
+    // at the view (a tick from collection through its callbacks, read(),
+    // history()) takes view_lock, which a callback may take again
+    std::mutex state_lock;
+    mutable std::recursive_mutex view_lock;
+    std::mutex callback_lock;
+    std::vector<std::pair<int, Monitor::TickCallback>> callbacks;
+    int next_callback;
+
+    std::thread worker;
+    std::mutex worker_lock;
+    std::condition_variable wake;
+    std::atomic<bool> running;
+
+    explicit Impl(const Monitor::Options& options)
+        : view(this), optimizer(options.cpu_threshold), options(options), next_callback(1),
+          running(false) {
+        system = SystemSample();
+        monitor.setCgroupTracking(options.cgroups);
+        monitor.setDeltaEpsilon(options.delta_cpu_epsilon, options.delta_rss_epsilon_kb);
+        if (options.hold_process_files) Platform::setHoldProcessFiles(true);
+        // Seeds the CPU counters so the first tick has a real interval
+        last_collect = std::chrono::steady_clock::now();
+        monitor.prime(0);
+    }
+
+    ~Impl() {
+        if (options.hold_process_files) Platform::setHoldProcessFiles(false);
+    }
+
+    void collect() {
+        std::lock_guard<std::mutex> guard(state_lock);
+        auto started = std::chrono::steady_clock::now();
+        metrics = monitor.collectMetrics();
+
+        system.sequence = metrics.delta ? metrics.delta->sequence : system.sequence + 1;
+        system.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        system.interval_ms = std::chrono::duration<double, std::milli>(started - last_collect).count();
+        last_collect = started;
+        system.cpu_percent = metrics.cpu_usage;
+        system.mem_percent = metrics.mem_usage_percent;
+        system.total_mem_kb = metrics.total_mem_kb;
+        system.used_mem_kb = metrics.used_mem_kb;
+        system.available_mem_kb = metrics.available_mem_kb;
+        system.process_count = monitor.getProcessTable().size();
+        system.filtered_count = monitor.getProcessTable().getFilteredCount();
+
+        const CPUThermals& thermals = metrics.cpu_thermals;
+        system.clock_available = thermals.available;
+        system.cpu_mhz = thermals.avg_mhz;
+        system.cpu_max_mhz = thermals.nominal_mhz;
+        system.throttle_events = thermals.throttle_events;
+        system.temperature_available = thermals.hottest_zone >= 0;
+        system.max_temp_c = system.temperature_available ? thermals.zones[thermals.hottest_zone].celsius : 0.0;
+
+        const PagingRates& paging = metrics.paging;
+        system.paging.available = paging.available;
+        system.paging.major_faults_per_sec = paging.major_faults;
+        system.paging.minor_faults_per_sec = paging.minor_faults;
+        system.paging.swap_in_per_sec = paging.swap_in;
+        system.paging.swap_out_per_sec = paging.swap_out;
+        system.paging.scan_kswapd_per_sec = paging.scan_kswapd;
+        system.paging.scan_direct_per_sec = paging.scan_direct;
+        system.paging.steal_kswapd_per_sec = paging.steal_kswapd;
+        system.paging.steal_direct_per_sec = paging.steal_direct;
+        system.paging.oom_kills = paging.oom_kills;
+
+        if (options.optimize) {
+            if (metrics.delta) optimizer.forgetExited(*metrics.delta);
+            optimizer.optimizeProcesses(metrics.top_processes);
+        }
+    }
+
+    void notify(const Snapshot& snapshot) {
+        // Copied so callbacks may add or remove callbacks
+        std::vector<std::pair<int, Monitor::TickCallback>> current;
+        {
+            std::lock_guard<std::mutex> guard(callback_lock);
+            current = callbacks;
+        }
+        for (const auto& entry : current) {
+            entry.second(snapshot);
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Snapshot
+// ---------------------------------------------------------------------------
+
+const SystemSample& Snapshot::system() const {
+    return impl->system;
+}
+
+size_t Snapshot::size() const {
+    return impl->monitor.getProcessTable().size();
+}
+
+const int* Snapshot::pids() const {
+    return impl->monitor.getProcessTable().getPids().data();
+}
+
+const double* Snapshot::cpu() const {
+    return impl->monitor.getProcessTable().getCPUColumn().data();
+}
+
+const long* Snapshot::rssKb() const {
+    return impl->monitor.getProcessTable().getRSSColumn().data();
+}
+
+const int* Snapshot::priorities() const {
+    return impl->monitor.getProcessTable().getPriorityColumn().data();
+}
+
+const float* Snapshot::majorFaultRate() const {
+    return impl->monitor.getProcessTable().getFaultRateColumn().data();
+}
+
+const char* Snapshot::name(size_t row, size_t* length) const {
+    const std::string& value = impl->monitor.getProcessTable().getName(row);
+    if (length) *length = value.size();
+    return value.c_str();
+}
+
+bool Snapshot::find(int pid, size_t& row) const {
+    return impl->monitor.getProcessTable().find(pid, row);
+}
+
+size_t Snapshot::top(Key key, size_t n, const uint32_t** rows) const {
+    const ProcessTable& table = impl->monitor.getProcessTable();
+    n = std::min(n, table.size());
+    table.rank(key == Key::RSS ? SortKey::RSS : SortKey::CPU, impl->order, n);
+    if (rows) *rows = impl->order.data();
+    return n;
+}
+
+size_t Snapshot::spawnedCount() const {
+    return impl->monitor.getLastDelta().spawned.size();
+}
+
+size_t Snapshot::exitedCount() const {
+    return impl->monitor.getLastDelta().exited.size();
+}
+
+size_t Snapshot::changedCount() const {
+    return impl->monitor.getLastDelta().changed.size();
+}
+
+// ---------------------------------------------------------------------------
+// Monitor
+// ---------------------------------------------------------------------------
+
+Monitor::Monitor(const Options& options) : impl(new Snapshot::Impl(options)) {}
+
+Monitor::~Monitor() {
+    stop();
+}
+
+const Snapshot& Monitor::tick() {
+    std::lock_guard<std::recursive_mutex> guard(impl->view_lock);
+    impl->collect();
+    impl->notify(impl->view);
+    return impl->view;
+}
+
+bool Monitor::start(int interval_ms) {
+    if (interval_ms <= 0 || impl->running.exchange(true)) return false;
+
+    Snapshot::Impl* state = impl.get();
+    impl->worker = std::thread([state, interval_ms] {
+        auto next = std::chrono::steady_clock::now();
+        while (state->running.load()) {
+            {
+                std::lock_guard<std::recursive_mutex> guard(state->view_lock);
+                state->collect();
+                state->notify(state->view);
+            }
+
+            next += std::chrono::milliseconds(interval_ms);
+            std::unique_lock<std::mutex> lock(state->worker_lock);
+            state->wake.wait_until(lock, next, [state] { return !state->running.load(); });
+        }
+    });
+    return true;
+}
+
+void Monitor::stop() {
+    if (!impl->running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> guard(impl->worker_lock);
+        impl->wake.notify_all();
+    }
+    if (impl->worker.joinable()) impl->worker.join();
+}
+
+bool Monitor::isRunning() const {
+    return impl->running.load();
+}
+
+void Monitor::read(const TickCallback& fn) const {
+    std::lock_guard<std::recursive_mutex> guard(impl->view_lock);
+    fn(impl->view);
+}
+
+bool Monitor::setFilter(const std::string& expression, std::string* error) {
+    ProcessFilter filter;
+    std::string reason;
+    if (!expression.empty() && !filter.compile(expression, reason)) {
+        if (error) *error = reason;
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(impl->state_lock);
+    impl->monitor.setFilter(filter);
+    return true;
+}
+
+int Monitor::addCallback(const TickCallback& fn) {
+    std::lock_guard<std::mutex> guard(impl->callback_lock);
+    int id = impl->next_callback++;
+    impl->callbacks.push_back(std::make_pair(id, fn));
+    return id;
+}
+
+void Monitor::removeCallback(int id) {
+    std::lock_guard<std::mutex> guard(impl->callback_lock);
+    for (auto it = impl->callbacks.begin(); it != impl->callbacks.end(); ++it) {
+        if (it->first == id) {
+            impl->callbacks.erase(it);
+            return;
+        }
+    }
+}
+
+size_t Monitor::history(Series series, size_t count, std::vector<double>& out) const {
+    std::lock_guard<std::recursive_mutex> guard(impl->view_lock);
+    const CompressedSeries& source = series == Series::MEMORY ? impl->monitor.getMemHistory()
+                                                              : impl->monitor.getCPUHistory();
+    size_t before = out.size();
+    source.tail(count, out);
+    return out.size() - before;
+}
+
+} // namespace sysmonitor
@@ -0,0 +1,44 @@
+#include "HistoryExport.h"
+#include <cstdio>
+#include <fstream>
+
+namespace HistoryExport {
+
+bool writeCSV(const std::string& filename, const std::vector<Column>& columns) {
+    std::ofstream out(filename, std::ios::out | std::ios::trunc);
+    if (!out.is_open() || columns.empty()) return false;
+
+    out << "timestamp_ms";
+    for (const auto& column : columns) out << "," << column.name;
+    out << "\n";
+
+    const CompressedSeries& first = *columns[0].series;
+    for (const auto& column : columns) {
+        if (column.series->size() != first.size() ||
+            column.series->getBlockCount() != first.getBlockCount()) {
+            return false;
+        }
+    }
+
+    std::vector<std::vector<CompressedSeries::Sample>> blocks(columns.size());
+    char field[32];
+    for (size_t b = 0; b < first.getBlockCount(); b++) {
+        for (size_t c = 0; c < columns.size(); c++) {
+            blocks[c].clear();
+            columns[c].series->decodeBlock(b, blocks[c]);
+        }
+
+        for (size_t i = 0; i < blocks[0].size(); i++) {
+            out << blocks[0][i].timestamp_ms;
+            for (size_t c = 0; c < columns.size(); c++) {
+                snprintf(field, sizeof(field), ",%.2f", blocks[c][i].value);
+                out << field;
+            }
+            out << "\n";
+        }
+    }
+
+    return out.good();
+}
+
+} // namespace HistoryExport
@@ -0,0 +1,21 @@
+#ifndef HISTORYEXPORT_H
+#define HISTORYEXPORT_H
+
+#include "../monitor/CompressedSeries.h"
+#include <string>
+#include <vector>
+
+// CSV export of retained in-memory history.
+namespace HistoryExport {
+    struct Column {
+        std::string name;
+        const CompressedSeries* series;
+    };
+
+    // Writes `timestamp_ms,<name>...` rows. The columns must have been
+    // appended in lockstep (same ticks, same retention), which lets them be
+    // decoded one block at a time side by side.
+    bool writeCSV(const std::string& filename, const std::vector<Column>& columns);
+}
+
+#endif // HISTORYEXPORT_H
@@ -0,0 +1,237 @@
+#include "Recorder.h"
+#include "../monitor/ProcessTable.h"
+#include "../monitor/SnapshotDelta.h"
+#include "../utils/Instrumentation.h"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+    bool isControl(char c) {
+        return static_cast<unsigned char>(c) < 0x20 || c == 0x7f;
+    }
+}
+
+Recorder::Recorder(const std::string& filename, Mode mode, int keyframe_interval)
+    : out(filename.c_str(), std::ios::out | std::ios::app), mode(mode),
+      keyframe_interval(keyframe_interval > 0 ? keyframe_interval : 1),
+      frames(0), bytes_written(0) {
+    if (out.is_open() && out.tellp() == 0) {
+        const char banner[] = "# sysmonitor-record 1\n";
+        out.write(banner, sizeof(banner) - 1);
+        bytes_written += sizeof(banner) - 1;
+    }
+}
+
+// Names come last on their line, so spaces are fine, but a newline in a
+// comm (PR_SET_NAME) or an agent's process name would start a record of
+// its own: control characters are written as '_'
+const char* Recorder::lineSafe(const std::string& name) {
+    size_t i = 0;
+    while (i < name.size() && !isControl(name[i])) i++;
+    if (i == name.size()) return name.c_str();
+    
+    name_scratch = name;
+    for (; i < name_scratch.size(); i++) {
+        if (isControl(name_scratch[i])) name_scratch[i] = '_';
+    }
+    return name_scratch.c_str();
+}
+
+void Recorder::writeHeader(char type, const SystemMetrics& metrics) {
+    long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    unsigned long sequence = metrics.delta ? metrics.delta->sequence : frames;
+
+    char line[256];
+    int len = snprintf(line, sizeof(line), "%c %lld %lu %.2f %.2f %ld %ld %d\n",
+                       type, now_ms, sequence, metrics.cpu_usage, metrics.mem_usage_percent,
+                       metrics.used_mem_kb, metrics.total_mem_kb, metrics.process_count);
+    if (len <= 0) return;
+    if (len >= static_cast<int>(sizeof(line))) len = sizeof(line) - 1;
+
+    out.write(line, len);
+    bytes_written += len;
+}
+
+void Recorder::writeProcess(char type, const ProcessInfo& proc) {
+    char line[320];
+    int len = snprintf(line, sizeof(line), "%c %d %.2f %ld %d %s\n",
+                       type, proc.pid, proc.cpu_usage, proc.memory_kb, proc.priority,
+                       lineSafe(proc.name));
+    if (len <= 0) return;
+    if (len >= static_cast<int>(sizeof(line))) {
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';
+    }
+
+    out.write(line, len);
+    bytes_written += len;
+}
+
+void Recorder::writeOverhead() {
+    Instrumentation::StageSummary summary;
+    for (int i = 0; i < static_cast<int>(Instrumentation::Stage::COUNT); i++) {
+        Instrumentation::Stage stage = static_cast<Instrumentation::Stage>(i);
+        Instrumentation::summarize(stage, summary);
+        if (summary.calls == 0) continue;
+        
+        char line[160];
+        int len = snprintf(line, sizeof(line), "O %s %llu %.1f %.1f %.1f %.1f %.2f %.2f\n",
+                           Instrumentation::stageName(stage), summary.calls, summary.mean_us,
+                           summary.p50_us, summary.p99_us, summary.max_us,
+                           summary.syscalls_per_call, summary.allocs_per_call);
+        if (len <= 0 || len >= static_cast<int>(sizeof(line))) continue;
+        out.write(line, len);
+        bytes_written += len;
+    }
+}
+
+void Recorder::writeForecast(const MemoryForecast& forecast) {
+    if (forecast.seconds_to_exhaustion < 0.0 && forecast.growing.empty()) return;
+    
+    char line[320];
+    int len = snprintf(line, sizeof(line), "M %.0f %.0f %.0f %.3f\n",
+                       forecast.seconds_to_exhaustion, forecast.regression_seconds,
+                       forecast.holt_seconds, forecast.trend_percent_per_hour);
+    if (len > 0 && len < static_cast<int>(sizeof(line))) {
+        out.write(line, len);
+        bytes_written += len;
+    }
+    
+    for (const auto& proc : forecast.growing) {
+        len = snprintf(line, sizeof(line), "W %d %.1f %ld %.0f %s\n",
+                       proc.pid, proc.growth_kb_per_sec, proc.rss_kb,
+                       proc.seconds_to_exhaustion, lineSafe(proc.name));
+        if (len <= 0) continue;
+        if (len >= static_cast<int>(sizeof(line))) {
+            len = sizeof(line) - 1;
+            line[len - 1] = '\n';
+        }
+        out.write(line, len);
+        bytes_written += len;
+    }
+}
+
+void Recorder::writeThermals(const CPUThermals& thermals) {
+    if (!thermals.available) return;
+    
+    double hottest = thermals.hottest_zone >= 0 ? thermals.zones[thermals.hottest_zone].celsius : -1.0;
+    char line[160];
+    int len = snprintf(line, sizeof(line), "C %.0f %.0f %.0f %.0f %d %lld %.1f\n",
+                       thermals.avg_mhz, thermals.min_mhz, thermals.max_mhz, thermals.nominal_mhz,
+                       thermals.throttled_cpus, thermals.throttle_events, hottest);
+    if (len > 0 && len < static_cast<int>(sizeof(line))) {
+        out.write(line, len);
+        bytes_written += len;
+    }
+}
+
+void Recorder::writePaging(const PagingRates& paging) {
+    if (!paging.available) return;
+    
+    char line[192];
+    int len = snprintf(line, sizeof(line), "V %.1f %.1f %.1f %.1f %.1f %.1f %.1f %.1f %lld\n",
+                       paging.major_faults, paging.minor_faults, paging.swap_in, paging.swap_out,
+                       paging.scan_kswapd, paging.scan_direct, paging.steal_kswapd,
+                       paging.steal_direct, paging.oom_kills);
+    if (len > 0 && len < static_cast<int>(sizeof(line))) {
+        out.write(line, len);
+        bytes_written += len;
+    }
+}
+
+void Recorder::writeFrame(const SystemMetrics& metrics) {
+    if (!out.is_open()) return;
+    SYSMON_STAGE(EXPORT);
+
+    bool keyframe = mode == Mode::FULL || !metrics.delta ||
+                    frames % keyframe_interval == 0;
+    frames++;
+
+    if (keyframe) {
+        writeHeader('F', metrics);
+        if (Instrumentation::enabled()) {
+            writeOverhead();
+        }
+        writeForecast(metrics.memory_forecast);
+        writeThermals(metrics.cpu_thermals);
+        writePaging(metrics.paging);
+        if (metrics.process_table) {
+            ProcessInfo proc;
+            for (size_t row = 0; row < metrics.process_table->size(); row++) {
+                metrics.process_table->fill(row, proc);
+                writeProcess('P', proc);
+            }
+        } else {
+            for (const auto& proc : metrics.top_processes) {
+                writeProcess('P', proc);
+            }
+        }
+        return;
+    }
+
+    writeHeader('D', metrics);
+    writeForecast(metrics.memory_forecast);
+    if (metrics.cpu_thermals.throttle_events > 0) {
+        writeThermals(metrics.cpu_thermals);
+    }
+    const PagingRates& paging = metrics.paging;
+    if (paging.major_faults > 0.0 || paging.swap_in > 0.0 || paging.swap_out > 0.0 ||
+        paging.scan_direct > 0.0 || paging.oom_kills > 0) {
+        writePaging(paging);
+    }
+
+    const SnapshotDelta& delta = *metrics.delta;
+    // Exits first: an exec is reported as exit + spawn of the same PID
+    for (const auto& proc : delta.exited) {
+        writeProcess('-', proc);
+    }
+    for (const auto& proc : delta.spawned) {
+        writeProcess('+', proc);
+    }
+    for (const auto& change : delta.changed) {
+        char line[128];
+        int len = snprintf(line, sizeof(line), "~ %d %.2f %ld %d\n",
+                           change.pid, change.cpu_usage, change.memory_kb, change.priority);
+        if (len <= 0 || len >= static_cast<int>(sizeof(line))) continue;
+        out.write(line, len);
+        bytes_written += len;
+    }
+}
+
+void Recorder::writeFleetFrame(const FleetMetrics& fleet) {
+    if (!out.is_open()) return;
+    SYSMON_STAGE(EXPORT);
+    
+    long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    char line[384];
+    int len = snprintf(line, sizeof(line), "G %lld %lu %d %d %lld %.2f %.2f\n",
+                       now_ms, frames, fleet.host_count, fleet.connected_hosts,
+                       fleet.process_count, fleet.mean_cpu, fleet.mean_mem_percent);
+    frames++;
+    if (len > 0 && len < static_cast<int>(sizeof(line))) {
+        out.write(line, len);
+        bytes_written += len;
+    }
+    
+    for (const auto& host : fleet.top_hosts) {
+        len = snprintf(line, sizeof(line), "H %.2f %.2f %ld %ld %d %s\n",
+                       host.cpu_usage, host.mem_usage_percent, host.used_mem_kb,
+                       host.total_mem_kb, host.process_count, lineSafe(host.name));
+        if (len <= 0 || len >= static_cast<int>(sizeof(line))) continue;
+        out.write(line, len);
+        bytes_written += len;
+    }
+    
+    // Host names carry no spaces, so the process name can still come last
+    for (const auto& proc : fleet.top_processes) {
+        len = snprintf(line, sizeof(line), "T %d %.2f %ld %d %s %s\n",
+                       proc.pid, proc.cpu_usage, proc.memory_kb, proc.priority,
+                       proc.host.c_str(), lineSafe(proc.name));
+        if (len <= 0 || len >= static_cast<int>(sizeof(line))) continue;
+        out.write(line, len);
+        bytes_written += len;
+    }
+}
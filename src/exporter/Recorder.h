@@ -0,0 +1,80 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include "../monitor/ProcessInfo.h"
+#include "../net/FleetMetrics.h"
+#include <fstream>
+#include <string>
+
+// Line-oriented recording of monitor snapshots.
+//
+//   # sysmonitor-record 1
+//   F <ts_ms> <seq> <cpu%> <mem%> <used_kb> <total_kb> <procs>   keyframe header
+//   P <pid> <cpu%> <rss_kb> <prio> <name>                        keyframe row
+//   D <ts_ms> <seq> <cpu%> <mem%> <used_kb> <total_kb> <procs>   delta header
+//   + <pid> <cpu%> <rss_kb> <prio> <name>                        spawned
+//   - <pid> <cpu%> <rss_kb> <prio> <name>                        exited (final stats)
+//   ~ <pid> <cpu%> <rss_kb> <prio>                               changed
+//   O <stage> <calls> <mean_us> <p50_us> <p99_us> <max_us> <sys/op> <allocs/op>
+//                                                                monitor overhead
+//   M <tte_s> <regression_s> <holt_s> <trend %/h>                memory forecast
+//   W <pid> <growth_kb/s> <rss_kb> <tte_s> <name>                 growing process
+//   C <avg_mhz> <min_mhz> <max_mhz> <nominal_mhz> <throttled_cpus> <events> <hottest_c>
+//                                                                CPU clock/throttling
+//   V <majflt/s> <minflt/s> <swpin/s> <swpout/s> <scan_kswapd/s> <scan_direct/s>
+//     <steal_kswapd/s> <steal_direct/s> <oom_kills>                paging (one line)
+//
+// Aggregators record fleet frames instead (always full):
+//
+//   G <ts_ms> <frame> <hosts> <connected> <procs> <mean_cpu%> <mean_mem%>
+//   H <cpu%> <mem%> <used_kb> <total_kb> <procs> <host>           top host
+//   T <pid> <cpu%> <rss_kb> <prio> <host> <name>                  top process
+//
+// Names come last so they may contain spaces; control characters in them
+// are written as '_'. Readers must ignore record
+// types they do not understand. In delta mode a keyframe is written every
+// `keyframe_interval` frames so a reader can start mid-file; between them
+// a quiet host costs one header line per tick. Overhead lines (lifetime
+// per-stage summaries) follow each keyframe header in instrumented builds.
+// Forecast lines (times in seconds, -1 for none projected) follow any
+// header while exhaustion is projected or some process keeps growing.
+// Clock lines follow each keyframe header and any header of a tick with
+// throttle events (hottest_c is -1 without thermal zones). Paging lines
+// follow each keyframe header and any header of a tick with major faults,
+// swapping, direct reclaim or OOM kills; rates are pages (faults) per second.
+class Recorder {
+public:
+    enum class Mode {
+        FULL,
+        DELTA
+    };
+
+private:
+    std::ofstream out;
+    Mode mode;
+    int keyframe_interval;
+    unsigned long frames;
+    unsigned long bytes_written;
+    std::string name_scratch;
+
+    const char* lineSafe(const std::string& name);
+    void writeHeader(char type, const SystemMetrics& metrics);
+    void writeProcess(char type, const ProcessInfo& proc);
+    void writeOverhead();
+    void writeForecast(const MemoryForecast& forecast);
+    void writeThermals(const CPUThermals& thermals);
+    void writePaging(const PagingRates& paging);
+
+public:
+    Recorder(const std::string& filename, Mode mode = Mode::DELTA, int keyframe_interval = 60);
+
+    bool isOpen() const { return out.is_open(); }
+    void writeFrame(const SystemMetrics& metrics);
+    void writeFleetFrame(const FleetMetrics& fleet);
+    void flush() { out.flush(); }
+
+    unsigned long getFrames() const { return frames; }
+    unsigned long getBytesWritten() const { return bytes_written; }
+};
+
+#endif // RECORDER_H
@@ -0,0 +1,126 @@
+#include "ShmPublisher.h"
+#include "../monitor/ProcessTable.h"
+#include "../utils/Instrumentation.h"
+#include "../utils/Text.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(sysmon_shm_process) == 48, "shm row layout changed: bump SYSMON_SHM_VERSION");
+static_assert(sizeof(sysmon_shm_header) % 8 == 0, "shm rows must stay 8-byte aligned");
+
+const uint32_t ShmPublisher::DEFAULT_CAPACITY;
+
+ShmPublisher::ShmPublisher(const std::string& name, uint32_t capacity)
+    : path("/dev/shm/" + name), fd(-1), base(nullptr), size(0),
+      capacity(capacity > 0 ? capacity : 1), published(0) {
+    if (name.empty() || name.find('/') != std::string::npos) return;
+
+    std::string temporary = "/dev/shm/." + name + "." + std::to_string(getpid());
+    int file = open(temporary.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (file < 0) return;
+    // Readers need to open it whatever our umask is
+    fchmod(file, 0644);
+
+    size_t bytes = sizeof(sysmon_shm_header) + static_cast<size_t>(this->capacity) * sizeof(sysmon_shm_process);
+    void* mapping = MAP_FAILED;
+    if (ftruncate(file, static_cast<off_t>(bytes)) == 0) {
+        mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    }
+    if (mapping == MAP_FAILED) {
+        close(file);
+        unlink(temporary.c_str());
+        return;
+    }
+
+    base = static_cast<uint8_t*>(mapping);
+    size = bytes;
+    sysmon_shm_header* head = header();
+    head->magic = SYSMON_SHM_MAGIC;
+    head->version = SYSMON_SHM_VERSION;
+    head->header_size = sizeof(sysmon_shm_header);
+    head->process_size = sizeof(sysmon_shm_process);
+    head->process_capacity = this->capacity;
+    head->writer_pid = getpid();
+    head->sequence = 0;
+
+    if (rename(temporary.c_str(), path.c_str()) != 0) {
+        munmap(base, size);
+        base = nullptr;
+        size = 0;
+        close(file);
+        unlink(temporary.c_str());
+        return;
+    }
+    fd = file;
+}
+
+ShmPublisher::~ShmPublisher() {
+    if (!base) return;
+    __atomic_store_n(&header()->writer_pid, 0, __ATOMIC_RELAXED);
+
+    // Only remove the file if a newer writer has not replaced it
+    struct stat ours;
+    struct stat current;
+    if (fstat(fd, &ours) == 0 && stat(path.c_str(), &current) == 0 &&
+        ours.st_dev == current.st_dev && ours.st_ino == current.st_ino) {
+        unlink(path.c_str());
+    }
+    munmap(base, size);
+    close(fd);
+}
+
+void ShmPublisher::publish(const SystemMetrics& metrics) {
+    if (!base) return;
+    SYSMON_STAGE(EXPORT);
+    sysmon_shm_header* head = header();
+
+    // Seqlock: odd while writing; readers retry if it moved under them
+    uint64_t sequence = head->sequence;
+    __atomic_store_n(&head->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    sysmon_shm_system& system = head->system;
+    system.tick = metrics.delta ? metrics.delta->sequence : published + 1;
+    system.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    system.cpu_percent = metrics.cpu_usage;
+    system.mem_percent = metrics.mem_usage_percent;
+    system.total_mem_kb = metrics.total_mem_kb;
+    system.used_mem_kb = metrics.used_mem_kb;
+    system.available_mem_kb = metrics.available_mem_kb;
+    system.cpu_mhz = metrics.cpu_thermals.available ? metrics.cpu_thermals.avg_mhz : 0.0;
+    system.throttle_events = metrics.cpu_thermals.throttle_events;
+    system.major_faults_per_sec = metrics.paging.major_faults;
+    system.swap_in_per_sec = metrics.paging.swap_in;
+    system.swap_out_per_sec = metrics.paging.swap_out;
+
+    const ProcessTable* table = metrics.process_table;
+    size_t count = table ? table->size() : 0;
+    size_t rows = count < capacity ? count : capacity;
+    system.process_count = static_cast<uint32_t>(count);
+    system.process_rows = static_cast<uint32_t>(rows);
+
+    sysmon_shm_process* out = reinterpret_cast<sysmon_shm_process*>(base + sizeof(sysmon_shm_header));
+    for (size_t row = 0; row < rows; row++) {
+        sysmon_shm_process& proc = out[row];
+        proc.pid = table->getPid(row);
+        proc.ppid = table->getPpid(row);
+        proc.cpu_percent = table->getCPU(row);
+        proc.rss_kb = table->getRSS(row);
+        proc.major_faults_per_sec = table->getFaultRate(row);
+        proc.priority = table->getPriority(row);
+        const std::string& name = table->getName(row);
+        // Cut on a character boundary so readers never see half a character
+        size_t len = Text::utf8Prefix(name.data(), name.size(), SYSMON_SHM_NAME_LEN - 1);
+        std::memcpy(proc.name, name.data(), len);
+        std::memset(proc.name + len, 0, SYSMON_SHM_NAME_LEN - len);
+    }
+
+    __atomic_store_n(&head->sequence, sequence + 2, __ATOMIC_RELEASE);
+    published++;
+}
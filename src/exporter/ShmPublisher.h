@@ -0,0 +1,47 @@
+#ifndef SHMPUBLISHER_H
+#define SHMPUBLISHER_H
+
+#include "../monitor/ProcessInfo.h"
+#include "sysmonitor/shm.h"
+#include <cstdint>
+#include <string>
+
+// Publishes each tick into /dev/shm/<name> for local readers
+// (include/sysmonitor/shm.h, `sysmonitor read-shm`).
+//
+// The segment is created under a temporary name, sized for `capacity`
+// process rows, mapped once and renamed into place, so a reader never maps
+// a half-initialised file and a restart never truncates a mapping someone
+// still holds. A publish is one seqlock-guarded copy into the mapping: no
+// syscalls, no locks, nothing a reader can delay. Processes beyond the
+// capacity are counted but not published.
+class ShmPublisher {
+private:
+    std::string path;
+    int fd;
+    uint8_t* base;
+    size_t size;
+    uint32_t capacity;
+    unsigned long long published;
+
+    sysmon_shm_header* header() { return reinterpret_cast<sysmon_shm_header*>(base); }
+
+public:
+    static const uint32_t DEFAULT_CAPACITY = 32768;
+
+    explicit ShmPublisher(const std::string& name = SYSMON_SHM_DEFAULT_NAME,
+                          uint32_t capacity = DEFAULT_CAPACITY);
+    ~ShmPublisher();
+
+    ShmPublisher(const ShmPublisher&) = delete;
+    ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+    void publish(const SystemMetrics& metrics);
+
+    bool isOpen() const { return base != nullptr; }
+    const std::string& getPath() const { return path; }
+    size_t getSize() const { return size; }
+    unsigned long long getPublished() const { return published; }
+};
+
+#endif // SHMPUBLISHER_H
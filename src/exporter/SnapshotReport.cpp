@@ -0,0 +1,129 @@
+#include "SnapshotReport.h"
+#include "../utils/Text.h"
+#include <cstdio>
+#include <thread>
+
+SnapshotReport::SnapshotReport(const Options& options)
+    : options(options), started(std::chrono::steady_clock::now()), monitor(monitorOptions()), snapshot(nullptr), rows(nullptr), row_count(0) {}
+
+sysmonitor::Monitor::Options SnapshotReport::monitorOptions() {
+    // The second scan re-reads the stat files the first one opened, which
+    // is most of the gap between the two reads on large tables
+    sysmonitor::Monitor::Options settings;
+    settings.hold_process_files = true;
+    return settings;
+}
+
+bool SnapshotReport::applyFilter(std::string& error) {
+    return monitor.setFilter(options.filter, &error);
+}
+
+bool SnapshotReport::collect() {
+    // On large tables the first scan itself is a sizeable part of the interval
+    std::this_thread::sleep_until(started + std::chrono::milliseconds(options.sample_ms));
+    snapshot = &monitor.tick();
+    if (snapshot->system().total_mem_kb <= 0) return false;
+    row_count = snapshot->top(options.key, options.top, &rows);
+    return true;
+}
+
+void SnapshotReport::writeText(std::ostream& out) const {
+    const sysmonitor::SystemSample& system = snapshot->system();
+    char line[256];
+    std::snprintf(line, sizeof(line), "CPU: %.2f%%  Memory: %.2f%% (%.1f / %.1f MB)  Processes: %zu\n",
+                  system.cpu_percent, system.mem_percent, system.used_mem_kb / 1024.0,
+                  system.total_mem_kb / 1024.0, system.process_count);
+    out << line;
+    if (system.clock_available) {
+        std::snprintf(line, sizeof(line), "Clock: %.0f MHz (max %.0f)  Throttle events: %lld\n",
+                      system.cpu_mhz, system.cpu_max_mhz, system.throttle_events);
+        out << line;
+    }
+    const sysmonitor::PagingSample& paging = system.paging;
+    if (paging.available) {
+        std::snprintf(line, sizeof(line),
+                      "Paging: %.0f major faults/s  swap in/out %.0f/%.0f pages/s  direct scan %.0f pages/s"
+                      "  OOM kills: %lld\n",
+                      paging.major_faults_per_sec, paging.swap_in_per_sec, paging.swap_out_per_sec,
+                      paging.scan_direct_per_sec, paging.oom_kills);
+        out << line;
+    }
+    if (!options.filter.empty()) {
+        out << "Filter: " << options.filter << " (" << system.process_count << " of "
+            << system.process_count + system.filtered_count << ")\n";
+    }
+    if (row_count == 0) return;
+
+    std::snprintf(line, sizeof(line), "\n%8s  %-24s %8s %10s %5s %8s\n", "PID", "NAME", "CPU %", "RSS MB",
+                  "PRIO", "MAJF/s");
+    out << line;
+    for (size_t i = 0; i < row_count; i++) {
+        uint32_t row = rows[i];
+        size_t length = 0;
+        const char* name = snapshot->name(row, &length);
+        std::string shown(name, Text::utf8Prefix(name, length, 24));
+        std::snprintf(line, sizeof(line), "%8d  %-24s %8.2f %10.1f %5d %8.0f\n",
+                      snapshot->pids()[row], shown.c_str(), snapshot->cpu()[row],
+                      snapshot->rssKb()[row] / 1024.0, snapshot->priorities()[row],
+                      snapshot->majorFaultRate()[row]);
+        out << line;
+    }
+}
+
+void SnapshotReport::writeJSONString(std::ostream& out, const std::string& value) {
+    std::string quoted;
+    Text::appendJSONString(quoted, value);
+    out << quoted;
+}
+
+void SnapshotReport::writeJSON(std::ostream& out) const {
+    const sysmonitor::SystemSample& system = snapshot->system();
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"timestamp_ms\":%lld,\"interval_ms\":%.1f,\"cpu_percent\":%.2f,"
+                  "\"mem_percent\":%.2f,\"mem_total_kb\":%ld,\"mem_used_kb\":%ld,"
+                  "\"mem_available_kb\":%ld,\"process_count\":%zu,\"sort\":\"%s\"",
+                  static_cast<long long>(system.timestamp_ms), system.interval_ms, system.cpu_percent,
+                  system.mem_percent, system.total_mem_kb, system.used_mem_kb,
+                  system.available_mem_kb, system.process_count,
+                  options.key == sysmonitor::Key::RSS ? "rss" : "cpu");
+    out << buf;
+    if (system.clock_available) {
+        std::snprintf(buf, sizeof(buf), ",\"cpu_mhz\":%.0f,\"cpu_max_mhz\":%.0f,\"throttle_events\":%lld",
+                      system.cpu_mhz, system.cpu_max_mhz, system.throttle_events);
+        out << buf;
+    }
+    if (system.temperature_available) {
+        std::snprintf(buf, sizeof(buf), ",\"max_temp_c\":%.1f", system.max_temp_c);
+        out << buf;
+    }
+    const sysmonitor::PagingSample& paging = system.paging;
+    if (paging.available) {
+        std::snprintf(buf, sizeof(buf),
+                      ",\"paging\":{\"major_faults_per_sec\":%.1f,\"minor_faults_per_sec\":%.1f,"
+                      "\"swap_in_per_sec\":%.1f,\"swap_out_per_sec\":%.1f,\"scan_kswapd_per_sec\":%.1f,"
+                      "\"scan_direct_per_sec\":%.1f,\"steal_kswapd_per_sec\":%.1f,"
+                      "\"steal_direct_per_sec\":%.1f,\"oom_kills\":%lld}",
+                      paging.major_faults_per_sec, paging.minor_faults_per_sec, paging.swap_in_per_sec,
+                      paging.swap_out_per_sec, paging.scan_kswapd_per_sec, paging.scan_direct_per_sec,
+                      paging.steal_kswapd_per_sec, paging.steal_direct_per_sec, paging.oom_kills);
+        out << buf;
+    }
+    if (!options.filter.empty()) {
+        out << ",\"filter\":";
+        writeJSONString(out, options.filter);
+    }
+    out << ",\"top\":[";
+    for (size_t i = 0; i < row_count; i++) {
+        uint32_t row = rows[i];
+        std::snprintf(buf, sizeof(buf), "%s{\"pid\":%d,\"name\":", i > 0 ? "," : "", snapshot->pids()[row]);
+        out << buf;
+        writeJSONString(out, snapshot->name(row));
+        std::snprintf(buf, sizeof(buf),
+                      ",\"cpu_percent\":%.2f,\"rss_kb\":%ld,\"priority\":%d,\"major_faults_per_sec\":%.1f}",
+                      snapshot->cpu()[row], snapshot->rssKb()[row], snapshot->priorities()[row],
+                      snapshot->majorFaultRate()[row]);
+        out << buf;
+    }
+    out << "]}\n";
+}
@@ -0,0 +1,50 @@
+#ifndef SNAPSHOTREPORT_H
+#define SNAPSHOTREPORT_H
+
+#include "sysmonitor/Monitor.h"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// One-shot report for scripts and health checks: two samples `sample_ms`
+// apart, then the system totals and the top processes as text or JSON.
+// Built on the public sysmonitor::Monitor API only; nothing of the
+// interactive UI is touched.
+class SnapshotReport {
+public:
+    struct Options {
+        int sample_ms;
+        size_t top;
+        sysmonitor::Key key;
+        std::string filter;     // Filter expression, empty for none
+
+        Options() : sample_ms(100), top(10), key(sysmonitor::Key::CPU) {}
+    };
+
+private:
+    Options options;
+    std::chrono::steady_clock::time_point started;
+    sysmonitor::Monitor monitor;     // Takes the first sample when constructed
+    const sysmonitor::Snapshot* snapshot;
+    const uint32_t* rows;
+    size_t row_count;
+
+    static sysmonitor::Monitor::Options monitorOptions();
+
+public:
+    static void writeJSONString(std::ostream& out, const std::string& value);
+
+    explicit SnapshotReport(const Options& options = Options());
+
+    // False with the reason in `error` if the filter does not parse
+    bool applyFilter(std::string& error);
+
+    // False if the system counters could not be read
+    bool collect();
+
+    void writeText(std::ostream& out) const;
+    void writeJSON(std::ostream& out) const;
+};
+
+#endif // SNAPSHOTREPORT_H
@@ -1,15 +1,38 @@
 ﻿#include "sysmonitor/Version.h"
 #include "monitor/SystemMonitor.h"
+#include "monitor/OverheadGovernor.h"
 #include "visualizer/Visualizer.h"
 #include "optimizer/Optimizer.h"
+#include "alert/AlertEngine.h"
 #include "utils/Config.h"
 #include "utils/Logger.h"
+#include "exporter/Recorder.h"
+#include "exporter/HistoryExport.h"
+#include "exporter/SnapshotReport.h"
+#include "query/HistoryQuery.h"
+#include "platform/Platform.h"
+#include "utils/Instrumentation.h"
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <thread>
 #include <chrono>
 #include <csignal>
 #include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+#ifdef __linux__
+#include "net/Agent.h"
+#include "net/Aggregator.h"
+#include "alert/AlertNotifier.h"
+#include "exporter/ShmPublisher.h"
+#include "sysmonitor/shm.h"
+#include <unistd.h>
+#endif
 
 std::atomic<bool> running(true);
 
@@ -27,17 +50,50 @@ void showHelp(const char* program) {
     std::cout << "  " << program << " <command> [options]\n\n";
     std::cout << "COMMANDS:\n";
     std::cout << "  start              Start monitoring\n";
+    std::cout << "  agent              Stream metrics to an aggregator (-c host:port)\n";
+    std::cout << "  aggregate          Merge agent streams into a fleet view (-l port)\n";
+    std::cout << "  query <file>       Window statistics over a recording (--from/--to/--top/--by)\n";
+    std::cout << "  snapshot           Print one sample and exit (--json/--top/--by/--sample-ms/--filter)\n";
+    std::cout << "  read-shm           Print the snapshot a running monitor publishes with --shm (--name/--json/--top/--by)\n";
     std::cout << "  --help, -h         Show this help\n";
     std::cout << "  --version, -v      Show version\n\n";
     std::cout << "OPTIONS:\n";
     std::cout << "  -o, --optimize              Enable auto-optimization\n";
     std::cout << "  -i, --interval <seconds>    Update interval (default: 2)\n";
     std::cout << "  -t, --threshold <percent>   CPU threshold (default: 80)\n";
+    std::cout << "  -a, --anomaly-trigger       Renice runaway CPU anomalies (with -o)\n";
+    std::cout << "  -r, --record <file>         Append snapshots to a recording (deltas + keyframes)\n";
+    std::cout << "      --record-full           Record a full frame every tick\n";
+    std::cout << "      --view <processes|cgroups|sched|tree|numa>  Initial view (switch with 'g' / 'd' / 't' / 'n')\n";
+    std::cout << "      --delay-threshold <pct>     With -o, renice CPU hogs while a process waits this much for a CPU\n";
+    std::cout << "      --oom-trigger <minutes>     With -o, expose the processes behind projected memory exhaustion to the OOM killer\n";
+    std::cout << "      --optimize-subtrees         With -o, renice whole process families over the CPU threshold\n";
+    std::cout << "      --numa-affinity             With -o, pin large processes to the NUMA node holding their memory\n";
+    std::cout << "      --filter <expr>             Only track matching processes, e.g. 'name~^java && rss>1G'\n";
+    std::cout << "      --filter-file <file>        Read the filter from a file, reloaded when it changes\n";
+    std::cout << "      --alerts <file>             Alert rules, one per line; reloaded when it changes\n";
+    std::cout << "      --alert-hook <command>      Run for every alert change (event on stdin and SYSMON_ALERT_*)\n";
+    std::cout << "      --alert-socket <path>       Send alert changes as JSON lines to a unix socket\n";
+    std::cout << "      --shm <name>                Publish every tick to /dev/shm/<name> for local readers (start, agent)\n";
+    std::cout << "      --cpu-budget <percent>      Keep the monitor under this share of one core, shedding detail (start, agent)\n";
+    std::cout << "      --overhead              Show the monitor overhead panel (toggle with 'v')\n";
+    std::cout << "      --export-history <file> Write the retained CPU/memory history as CSV on exit\n";
+    std::cout << "  -c, --connect <host:port>   Aggregator to push to (agent)\n";
+    std::cout << "  -l, --listen <port>         Port to accept agents on (aggregate, default: 7070)\n";
+    std::cout << "      --name <hostname>       Name reported by the agent (default: hostname)\n";
     std::cout << "  -q, --quiet                 Minimal output\n\n";
     std::cout << "EXAMPLES:\n";
     std::cout << "  " << program << " start\n";
     std::cout << "  " << program << " start -o -i 5\n";
-    std::cout << "  " << program << " start --optimize --interval 3\n\n";
+    std::cout << "  " << program << " start --optimize --interval 3\n";
+    std::cout << "  " << program << " aggregate -l 7070\n";
+    std::cout << "  " << program << " agent -c monitor.example.com:7070 -i 1\n";
+    std::cout << "  " << program << " query history.rec --from 02:00 --to 02:15 --top 5 --by rss\n";
+    std::cout << "  " << program << " snapshot --json --top 5 --by rss\n";
+    std::cout << "  " << program << " read-shm --json --top 5\n";
+    std::cout << "  " << program << " start --filter 'user==build || name~^make'\n";
+    std::cout << "  " << program << " start --alerts alerts.rules --alert-hook 'logger -t sysmon'\n";
+    std::cout << "  " << program << " agent -c monitor.example.com:7070 --cpu-budget 0.5\n\n";
 }
 
 void showVersion() {
@@ -45,6 +101,431 @@ void showVersion() {
     std::cout << "Platform: Windows\n";
 }
 
+// Filter files may span lines; lines starting with '#' are comments
+bool readFilterFile(const std::string& path, std::string& expression) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    
+    expression.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+        if (!expression.empty()) expression += ' ';
+        expression += line.substr(start);
+    }
+    return true;
+}
+
+bool readAlertFile(const std::string& path, std::string& text) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    
+    text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool loadFilter(const std::string& expression, const std::string& file, ProcessFilter& filter) {
+    std::string source = expression;
+    if (!file.empty() && !readFilterFile(file, source)) {
+        std::cerr << "Error: cannot read filter file " << file << "\n";
+        return false;
+    }
+    
+    std::string error;
+    if (!filter.compile(source, error)) {
+        std::cerr << "Error: invalid filter: " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+#ifdef __linux__
+int runAgent(const std::string& target, const std::string& name, int interval, bool quiet,
+             const ProcessFilter& filter, const std::string& shm_name, double cpu_budget) {
+    size_t colon = target.rfind(':');
+    if (colon == std::string::npos || colon == 0) {
+        std::cerr << "Error: --connect expects host:port\n";
+        return 1;
+    }
+    std::string address = target.substr(0, colon);
+    int port = std::stoi(target.substr(colon + 1));
+    
+    std::string hostname = name;
+    if (hostname.empty()) {
+        char buf[256];
+        hostname = gethostname(buf, sizeof(buf)) == 0 ? std::string(buf) : "unknown";
+    }
+    
+    SystemMonitor monitor;
+    monitor.setFilter(filter);
+    Agent agent(address, port, hostname);
+    std::unique_ptr<ShmPublisher> publisher;
+    if (!shm_name.empty()) {
+        publisher.reset(new ShmPublisher(shm_name));
+        if (!publisher->isOpen()) {
+            std::cerr << "Error: cannot create " << publisher->getPath() << "\n";
+            return 1;
+        }
+    }
+    std::unique_ptr<OverheadGovernor> governor;
+    if (cpu_budget > 0.0) governor.reset(new OverheadGovernor(cpu_budget, interval));
+    monitor.prime();
+    
+    if (!quiet) {
+        std::cout << "Streaming " << hostname << " to " << address << ":" << port
+                  << " every " << interval << "s\n";
+    }
+    
+    bool was_connected = false;
+    while (running) {
+        auto metrics = monitor.collectMetrics();
+        if (publisher) publisher->publish(metrics);
+        bool sent = agent.send(metrics);
+        
+        if (!quiet && sent != was_connected) {
+            std::cout << (sent ? "Connected to aggregator\n" : "Aggregator unreachable, retrying\n");
+        }
+        was_connected = sent;
+        
+        if (governor && governor->update(monitor) && !quiet) {
+            std::cout << "Overhead governor: " << governor->describe() << "\n";
+        }
+        double wait = governor ? governor->getInterval() : interval;
+        std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long long>(wait * 1000.0)));
+    }
+    return 0;
+}
+
+int runAggregator(int port, int interval, bool quiet, bool show_overhead,
+                  const std::string& record_file) {
+    Aggregator aggregator;
+    if (!aggregator.listen(port)) {
+        std::cerr << "Error: cannot listen on port " << port << "\n";
+        return 1;
+    }
+    
+    std::unique_ptr<Recorder> recorder;
+    if (!record_file.empty()) {
+        recorder.reset(new Recorder(record_file, Recorder::Mode::FULL));
+        if (!recorder->isOpen()) {
+            std::cerr << "Error: cannot open recording file " << record_file << "\n";
+            return 1;
+        }
+    }
+    
+    Visualizer visualizer;
+    visualizer.setShowOverhead(show_overhead);
+    bool interactive = !quiet && Platform::enableRawInput();
+    if (!quiet) {
+        std::cout << "Aggregating on port " << aggregator.getPort() << "\n";
+    }
+    
+    FleetMetrics fleet;
+    auto next_tick = std::chrono::steady_clock::now();
+    while (running) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_tick) {
+            aggregator.collect(fleet, 10, 15);
+            if (!quiet) visualizer.displayFleet(fleet, aggregator.getPort());
+            if (recorder) recorder->writeFleetFrame(fleet);
+            next_tick = now + std::chrono::seconds(interval);
+        }
+        
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            next_tick - std::chrono::steady_clock::now()).count();
+        aggregator.poll(static_cast<int>(std::max<long long>(0, std::min<long long>(remaining, 100))));
+        
+        if (interactive) {
+            int key = Platform::waitForKey(0);
+            if (key == 'q' || key == 'Q') {
+                running = false;
+            } else if (key == 'v' || key == 'V') {
+                visualizer.toggleOverhead();
+                visualizer.displayFleet(fleet, aggregator.getPort());
+            }
+        }
+    }
+    
+    Platform::restoreInput();
+    return 0;
+}
+#endif
+
+int runQuery(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Error: query needs a recording file\n";
+        return 1;
+    }
+
+    std::string file = argv[2];
+    std::string from_text, to_text;
+    size_t top = 5;
+    QueryKey by = QueryKey::CPU;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--from" && i + 1 < argc) {
+            from_text = argv[++i];
+        } else if (arg == "--to" && i + 1 < argc) {
+            to_text = argv[++i];
+        } else if (arg == "--top" && i + 1 < argc) {
+            top = static_cast<size_t>(std::max(0, std::stoi(argv[++i])));
+        } else if (arg == "--by" && i + 1 < argc) {
+            std::string key = argv[++i];
+            if (key == "rss") {
+                by = QueryKey::RSS;
+            } else if (key != "cpu") {
+                std::cerr << "Unknown key: " << key << " (expected cpu or rss)\n";
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown query option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    HistoryQuery query(file);
+    if (!query.open()) {
+        std::cerr << "Error: cannot read recording " << file << "\n";
+        return 1;
+    }
+    const RecordingIndex& index = query.getIndex();
+    if (index.empty()) {
+        std::cerr << "Error: " << file << " has no keyframes\n";
+        return 1;
+    }
+
+    int64_t from_ms = index.getFirstTimestamp();
+    int64_t to_ms = index.getLastTimestamp();
+    if (!from_text.empty() && !HistoryQuery::parseTime(from_text, index.getLastTimestamp(), from_ms)) {
+        std::cerr << "Error: cannot parse time '" << from_text << "'\n";
+        return 1;
+    }
+    if (!to_text.empty() && !HistoryQuery::parseTime(to_text, index.getLastTimestamp(), to_ms)) {
+        std::cerr << "Error: cannot parse time '" << to_text << "'\n";
+        return 1;
+    }
+
+    QueryResult result;
+    if (!query.run(from_ms, to_ms, top, by, result)) {
+        std::cerr << "Error: cannot read recording " << file << "\n";
+        return 1;
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+
+    std::cout << "Window: " << HistoryQuery::formatTime(from_ms) << " .. "
+              << HistoryQuery::formatTime(to_ms) << "\n";
+    if (result.frames == 0) {
+        std::cout << "No frames in window\n";
+        return 0;
+    }
+    std::cout << "Frames: " << result.frames << " (" << HistoryQuery::formatTime(result.first_ms)
+              << " .. " << HistoryQuery::formatTime(result.last_ms) << ")\n\n";
+
+    printf("%-10s %8s %8s %8s %8s %8s %8s\n", "", "min", "avg", "p50", "p90", "p99", "max");
+    const char* labels[] = { "CPU %", "Memory %" };
+    const RunningStats* stats[] = { &result.cpu, &result.mem };
+    const QuantileSketch* sketches[] = { &result.cpu_sketch, &result.mem_sketch };
+    for (int i = 0; i < 2; i++) {
+        printf("%-10s %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f\n", labels[i],
+               stats[i]->min(), stats[i]->mean(), sketches[i]->quantile(0.50),
+               sketches[i]->quantile(0.90), sketches[i]->quantile(0.99), stats[i]->max());
+    }
+
+    if (top > 0) {
+        std::cout << "\nTop " << top << " processes by peak " << (by == QueryKey::RSS ? "RSS" : "CPU")
+                  << " in window:\n";
+        printf("%8s  %-24s %9s %9s %12s %12s %8s\n",
+               "PID", "NAME", "PEAK CPU", "AVG CPU", "PEAK RSS MB", "AVG RSS MB", "FRAMES");
+        for (const auto& proc : result.top) {
+            printf("%8d  %-24s %8.2f%% %8.2f%% %12.1f %12.1f %8llu\n",
+                   proc.pid, proc.name.substr(0, 24).c_str(), proc.peak_cpu, proc.avg_cpu,
+                   proc.peak_rss_kb / 1024.0, proc.avg_rss_kb / 1024.0,
+                   static_cast<unsigned long long>(proc.frames));
+        }
+    }
+
+    printf("\nRead %.1f MB of recording (+%.1f MB indexed, %zu keyframes) in %.0f ms\n",
+           result.bytes_read / 1048576.0, result.index_bytes_scanned / 1048576.0,
+           index.size(), elapsed_ms);
+    return 0;
+}
+
+// Collectors behind the non-default views only run while something needs them
+void applyView(SystemMonitor& monitor, Visualizer::View view, double delay_threshold,
+               bool optimize_subtrees, bool numa_affinity) {
+    monitor.setCgroupTracking(view == Visualizer::View::CGROUPS);
+    monitor.setSchedTracking(view == Visualizer::View::SCHED || delay_threshold > 0.0);
+    monitor.setTreeTracking(view == Visualizer::View::TREE || optimize_subtrees);
+    monitor.setNumaTracking(view == Visualizer::View::NUMA || numa_affinity);
+}
+
+int runSnapshot(int argc, char* argv[]) {
+    SnapshotReport::Options options;
+    bool json = false;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--top" && i + 1 < argc) {
+            options.top = static_cast<size_t>(std::max(0, std::stoi(argv[++i])));
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--sample-ms" && i + 1 < argc) {
+            options.sample_ms = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--by" && i + 1 < argc) {
+            std::string key = argv[++i];
+            if (key == "rss") {
+                options.key = sysmonitor::Key::RSS;
+            } else if (key != "cpu") {
+                std::cerr << "Unknown key: " << key << " (expected cpu or rss)\n";
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown snapshot option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    SnapshotReport report(options);
+    std::string error;
+    if (!report.applyFilter(error)) {
+        std::cerr << "Error: invalid filter: " << error << "\n";
+        return 1;
+    }
+    if (!report.collect()) {
+        std::cerr << "Error: cannot read system counters\n";
+        return 1;
+    }
+    if (json) {
+        report.writeJSON(std::cout);
+    } else {
+        report.writeText(std::cout);
+    }
+    return 0;
+}
+
+#ifdef __linux__
+// Reads what a running monitor publishes with --shm; never touches /proc
+int runReadShm(int argc, char* argv[]) {
+    std::string name = SYSMON_SHM_DEFAULT_NAME;
+    size_t top = 10;
+    bool by_rss = false;
+    bool json = false;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--name" && i + 1 < argc) {
+            name = argv[++i];
+        } else if (arg == "--top" && i + 1 < argc) {
+            top = static_cast<size_t>(std::max(0, std::stoi(argv[++i])));
+        } else if (arg == "--by" && i + 1 < argc) {
+            std::string key = argv[++i];
+            if (key == "rss") {
+                by_rss = true;
+            } else if (key != "cpu") {
+                std::cerr << "Unknown key: " << key << " (expected cpu or rss)\n";
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown read-shm option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    sysmon_shm_reader reader;
+    if (sysmon_shm_open(&reader, name.c_str()) != 0) {
+        std::cerr << "Error: no snapshot published at /dev/shm/" << name << "\n";
+        return 1;
+    }
+    sysmon_shm_system system;
+    std::vector<sysmon_shm_process> rows(sysmon_shm_capacity(&reader));
+    uint32_t count = 0;
+    int32_t writer = sysmon_shm_writer(&reader);
+    int status = sysmon_shm_read(&reader, &system, rows.data(), static_cast<uint32_t>(rows.size()), &count);
+    int32_t writer_now = sysmon_shm_writer(&reader);
+    sysmon_shm_close(&reader);
+    if (status != 0) {
+        std::cerr << "Error: no consistent snapshot in /dev/shm/" << name;
+        if (writer_now == 0) {
+            std::cerr << " (the writer has exited)\n";
+        } else {
+            std::cerr << " within " << SYSMON_SHM_WAIT_MS << " ms (writer PID " << writer_now
+                      << " is still mid-update; try again)\n";
+        }
+        return 1;
+    }
+    rows.resize(count);
+
+    top = std::min(top, rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + top, rows.end(),
+                      [by_rss](const sysmon_shm_process& a, const sysmon_shm_process& b) {
+                          return by_rss ? a.rss_kb > b.rss_kb : a.cpu_percent > b.cpu_percent;
+                      });
+    long long age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() - system.timestamp_ms;
+
+    char line[256];
+    if (json) {
+        std::snprintf(line, sizeof(line),
+                      "{\"tick\":%llu,\"timestamp_ms\":%lld,\"age_ms\":%lld,\"writer_pid\":%d,"
+                      "\"cpu_percent\":%.2f,\"mem_percent\":%.2f,\"mem_total_kb\":%lld,",
+                      static_cast<unsigned long long>(system.tick), static_cast<long long>(system.timestamp_ms),
+                      age_ms, writer, system.cpu_percent, system.mem_percent,
+                      static_cast<long long>(system.total_mem_kb));
+        std::cout << line;
+        std::snprintf(line, sizeof(line),
+                      "\"mem_used_kb\":%lld,\"mem_available_kb\":%lld,\"cpu_mhz\":%.0f,"
+                      "\"throttle_events\":%lld,\"major_faults_per_sec\":%.1f,\"swap_in_per_sec\":%.1f,"
+                      "\"swap_out_per_sec\":%.1f,\"process_count\":%u,\"top\":[",
+                      static_cast<long long>(system.used_mem_kb), static_cast<long long>(system.available_mem_kb),
+                      system.cpu_mhz, static_cast<long long>(system.throttle_events),
+                      system.major_faults_per_sec, system.swap_in_per_sec, system.swap_out_per_sec,
+                      system.process_count);
+        std::cout << line;
+        for (size_t i = 0; i < top; i++) {
+            const sysmon_shm_process& proc = rows[i];
+            std::snprintf(line, sizeof(line), "%s{\"pid\":%d,\"ppid\":%d,\"name\":", i > 0 ? "," : "",
+                          proc.pid, proc.ppid);
+            std::cout << line;
+            SnapshotReport::writeJSONString(std::cout, proc.name);
+            std::snprintf(line, sizeof(line),
+                          ",\"cpu_percent\":%.2f,\"rss_kb\":%lld,\"priority\":%d,\"major_faults_per_sec\":%.1f}",
+                          proc.cpu_percent, static_cast<long long>(proc.rss_kb), proc.priority,
+                          proc.major_faults_per_sec);
+            std::cout << line;
+        }
+        std::cout << "]}\n";
+        return 0;
+    }
+
+    std::cout << "/dev/shm/" << name << ": tick " << system.tick << ", " << age_ms << " ms old, "
+              << (writer != 0 ? "writer PID " + std::to_string(writer) : std::string("writer exited")) << "\n";
+    std::snprintf(line, sizeof(line), "CPU: %.1f%%  Memory: %.1f%% (%lld / %lld MB, %lld MB available)\n",
+                  system.cpu_percent, system.mem_percent, static_cast<long long>(system.used_mem_kb / 1024),
+                  static_cast<long long>(system.total_mem_kb / 1024),
+                  static_cast<long long>(system.available_mem_kb / 1024));
+    std::cout << line;
+    std::snprintf(line, sizeof(line), "Processes: %u (%u published)\n", system.process_count, system.process_rows);
+    std::cout << line;
+    if (top == 0) return 0;
+
+    std::snprintf(line, sizeof(line), "\n%8s  %-16s %8s %10s %5s %8s\n", "PID", "NAME", "CPU %", "RSS MB",
+                  "PRIO", "MAJF/s");
+    std::cout << line;
+    for (size_t i = 0; i < top; i++) {
+        const sysmon_shm_process& proc = rows[i];
+        std::snprintf(line, sizeof(line), "%8d  %-16s %8.2f %10.1f %5d %8.0f\n", proc.pid, proc.name,
+                      proc.cpu_percent, proc.rss_kb / 1024.0, proc.priority, proc.major_faults_per_sec);
+        std::cout << line;
+    }
+    return 0;
+}
+#endif
+
 int main(int argc, char* argv[]) {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
@@ -54,6 +535,26 @@ int main(int argc, char* argv[]) {
     bool auto_optimize = false;
     int threshold = 80;
     bool quiet = false;
+    bool anomaly_trigger = false;
+    std::string record_file;
+    bool record_full = false;
+    bool show_overhead = false;
+    std::string history_file;
+    Visualizer::View view = Visualizer::View::PROCESSES;
+    double delay_threshold = 0.0;
+    double oom_minutes = 0.0;
+    bool optimize_subtrees = false;
+    bool numa_affinity = false;
+    std::string filter_expression;
+    std::string filter_file;
+    std::string alerts_file;
+    std::string alert_hook;
+    std::string alert_socket;
+    std::string shm_name;
+    double cpu_budget = 0.0;
+    std::string connect_target;
+    int listen_port = 7070;
+    std::string agent_name;
     
     if (argc > 1) {
         command = argv[1];
@@ -68,7 +569,39 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         
-        if (command == "start") {
+        if (command == "query") {
+            try {
+                return runQuery(argc, argv);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+        }
+        
+        if (command == "snapshot") {
+            try {
+                return runSnapshot(argc, argv);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+        }
+        
+        if (command == "read-shm") {
+#ifdef __linux__
+            try {
+                return runReadShm(argc, argv);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+#else
+            std::cerr << "Error: read-shm is only supported on Linux\n";
+            return 1;
+#endif
+        }
+        
+        if (command == "start" || command == "agent" || command == "aggregate") {
             for (int i = 2; i < argc; i++) {
                 std::string arg = argv[i];
                 
@@ -85,6 +618,108 @@ int main(int argc, char* argv[]) {
                         threshold = std::stoi(argv[++i]);
                     }
                 }
+                else if (arg == "-a" || arg == "--anomaly-trigger") {
+                    anomaly_trigger = true;
+                }
+                else if (arg == "-r" || arg == "--record") {
+                    if (i + 1 < argc) {
+                        record_file = argv[++i];
+                    }
+                }
+                else if (arg == "--record-full") {
+                    record_full = true;
+                }
+                else if (arg == "--view") {
+                    if (i + 1 < argc) {
+                        std::string name = argv[++i];
+                        if (name == "cgroups") {
+                            view = Visualizer::View::CGROUPS;
+                        } else if (name == "sched") {
+                            view = Visualizer::View::SCHED;
+                        } else if (name == "tree") {
+                            view = Visualizer::View::TREE;
+                        } else if (name == "numa") {
+                            view = Visualizer::View::NUMA;
+                        } else if (name != "processes") {
+                            std::cerr << "Unknown view: " << name << "\n";
+                            return 1;
+                        }
+                    }
+                }
+                else if (arg == "--delay-threshold") {
+                    if (i + 1 < argc) {
+                        delay_threshold = std::stod(argv[++i]);
+                    }
+                }
+                else if (arg == "--oom-trigger") {
+                    if (i + 1 < argc) {
+                        oom_minutes = std::stod(argv[++i]);
+                    }
+                }
+                else if (arg == "--filter") {
+                    if (i + 1 < argc) {
+                        filter_expression = argv[++i];
+                    }
+                }
+                else if (arg == "--filter-file") {
+                    if (i + 1 < argc) {
+                        filter_file = argv[++i];
+                    }
+                }
+                else if (arg == "--alerts") {
+                    if (i + 1 < argc) {
+                        alerts_file = argv[++i];
+                    }
+                }
+                else if (arg == "--alert-hook") {
+                    if (i + 1 < argc) {
+                        alert_hook = argv[++i];
+                    }
+                }
+                else if (arg == "--alert-socket") {
+                    if (i + 1 < argc) {
+                        alert_socket = argv[++i];
+                    }
+                }
+                else if (arg == "--shm") {
+                    if (i + 1 < argc) {
+                        shm_name = argv[++i];
+                    }
+                }
+                else if (arg == "--cpu-budget") {
+                    if (i + 1 < argc) {
+                        cpu_budget = std::stod(argv[++i]);
+                    }
+                }
+                else if (arg == "--optimize-subtrees") {
+                    optimize_subtrees = true;
+                }
+                else if (arg == "--numa-affinity") {
+                    numa_affinity = true;
+                }
+                else if (arg == "--overhead") {
+                    show_overhead = true;
+                }
+                else if (arg == "--export-history") {
+                    if (i + 1 < argc) {
+                        history_file = argv[++i];
+                    }
+                }
+                else if (arg == "-c" || arg == "--connect") {
+                    if (i + 1 < argc) {
+                        connect_target = argv[++i];
+                    }
+                }
+                else if (arg == "-l" || arg == "--listen") {
+                    if (i + 1 < argc) {
+                        listen_port = std::stoi(argv[++i]);
+                    }
+                }
+                else if (arg == "--name") {
+                    if (i + 1 < argc) {
+                        agent_name = argv[++i];
+                    }
+                }
                 else if (arg == "-q" || arg == "--quiet") {
                     quiet = true;
                 }
@@ -92,6 +727,12 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    ProcessFilter filter;
+    if ((command == "start" || command == "agent") &&
+        !loadFilter(filter_expression, filter_file, filter)) {
+        return 1;
+    }
+    
     if (command == "start") {
         try {
             Config config;
@@ -102,7 +743,73 @@ int main(int argc, char* argv[]) {
             Logger logger("");
             SystemMonitor monitor;
             Visualizer visualizer;
+            visualizer.setShowOverhead(show_overhead);
+            visualizer.setView(view);
+            visualizer.setHistory(&monitor.getCPUHistory(), &monitor.getMemHistory());
+            visualizer.setThrottleHistory(&monitor.getThrottleHistory());
+            monitor.setFilter(filter);
+            visualizer.setFilter(filter.getText());
+            std::string filter_source = filter.getText();
+            applyView(monitor, view, delay_threshold, optimize_subtrees, numa_affinity);
             Optimizer optimizer(threshold);
+            optimizer.setAnomalyTrigger(anomaly_trigger);
+            optimizer.setDelayThreshold(delay_threshold);
+            optimizer.setOOMHorizon(oom_minutes * 60.0);
+            optimizer.setNumaAffinity(numa_affinity);
+            
+            AlertEngine alerts;
+            std::string alert_source;
+            if (!alerts_file.empty()) {
+                std::string error;
+                if (!readAlertFile(alerts_file, alert_source)) {
+                    std::cerr << "Error: cannot read alerts file " << alerts_file << "\n";
+                    return 1;
+                }
+                if (!alerts.compile(alert_source, error)) {
+                    std::cerr << "Error: invalid alert rule: " << error << "\n";
+                    return 1;
+                }
+            }
+            visualizer.setAlerts(&alerts.getFiring());
+            std::vector<AlertEvent> alert_events;
+#ifdef __linux__
+            // Delivery runs on its own thread; sampling never waits for it
+            std::unique_ptr<AlertNotifier> notifier;
+            if (!alert_hook.empty() || !alert_socket.empty()) {
+                notifier.reset(new AlertNotifier(alert_hook, alert_socket));
+            }
+            std::unique_ptr<ShmPublisher> publisher;
+            if (!shm_name.empty()) {
+                publisher.reset(new ShmPublisher(shm_name));
+                if (!publisher->isOpen()) {
+                    std::cerr << "Error: cannot create " << publisher->getPath() << "\n";
+                    return 1;
+                }
+            }
+#else
+            if (!alert_hook.empty() || !alert_socket.empty()) {
+                std::cerr << "Error: alert delivery is only supported on Linux\n";
+                return 1;
+            }
+            if (!shm_name.empty()) {
+                std::cerr << "Error: --shm is only supported on Linux\n";
+                return 1;
+            }
+#endif
+            std::unique_ptr<OverheadGovernor> governor;
+            if (cpu_budget > 0.0) governor.reset(new OverheadGovernor(cpu_budget, interval));
+            visualizer.setGovernor(governor.get());
+            auto start_time = std::chrono::steady_clock::now();
+            
+            std::unique_ptr<Recorder> recorder;
+            if (!record_file.empty()) {
+                recorder.reset(new Recorder(record_file, record_full ? Recorder::Mode::FULL
+                                                                     : Recorder::Mode::DELTA));
+                if (!recorder->isOpen()) {
+                    std::cerr << "Error: cannot open recording file " << record_file << "\n";
+                    return 1;
+                }
+            }
             
             if (!quiet) {
                 std::cout << "\nSysMonitor v" << SYSMONITOR_VERSION << " Starting...\n\n";
@@ -112,18 +819,76 @@ int main(int argc, char* argv[]) {
                 std::cout << "  CPU Threshold: " << threshold << "%\n\n";
             }
             
-            logger.log("Establishing baseline metrics...");
-            monitor.establishBaseline();
+            monitor.prime();
             
             if (auto_optimize && !quiet) {
                 std::cout << "Auto-optimization: ENABLED\n";
                 std::cout << "Note: Run as Administrator for best results\n\n";
             }
             
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            bool interactive = !quiet && Platform::enableRawInput();
             
             while (running) {
+                // Hot reload: a broken edit keeps the previous filter
+                std::string expression;
+                if (!filter_file.empty() && readFilterFile(filter_file, expression) &&
+                    expression != filter_source) {
+                    std::string error;
+                    ProcessFilter next;
+                    if (next.compile(expression, error)) {
+                        monitor.setFilter(next);
+                        visualizer.setFilter(next.getText());
+                        logger.log("Filter reloaded: " + expression);
+                    } else {
+                        logger.log("Filter not reloaded: " + error);
+                    }
+                    filter_source = expression;
+                }
+                
+                // Same for the alert rules; a new rule set starts with empty windows
+                std::string rules;
+                if (!alerts_file.empty() && readAlertFile(alerts_file, rules) && rules != alert_source) {
+                    std::string error;
+                    std::vector<AlertEvent> retired = alerts.getFiring();
+                    if (alerts.compile(rules, error)) {
+                        logger.log("Alert rules reloaded: " + std::to_string(alerts.getRules().size()) +
+                                   " rules");
+                        // Receivers hear the old rules' alerts end
+                        for (auto& event : retired) event.state = AlertEvent::State::RESOLVED;
+#ifdef __linux__
+                        if (notifier) notifier->post(retired);
+#endif
+                    } else {
+                        logger.log("Alert rules not reloaded: " + error);
+                    }
+                    alert_source = rules;
+                }
+                
                 auto metrics = monitor.collectMetrics();
+#ifdef __linux__
+                if (publisher) publisher->publish(metrics);
+#endif
+                
+                if (!alerts.empty()) {
+                    SYSMON_STAGE(ALERT);
+                    auto now = std::chrono::steady_clock::now();
+                    int64_t wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+                    alert_events.clear();
+                    alerts.evaluate(metrics, std::chrono::duration<double>(now - start_time).count(),
+                                    wall_ms, alert_events);
+                    for (const auto& event : alert_events) {
+                        std::string subject = event.pid != 0
+                            ? " " + event.process + " (PID: " + std::to_string(event.pid) + ")" : "";
+                        logger.log((event.state == AlertEvent::State::FIRING ? "Alert firing: "
+                                                                             : "Alert resolved: ") +
+                                   event.rule + subject + " [" + event.expression + "] value " +
+                                   std::to_string(event.value));
+                    }
+#ifdef __linux__
+                    if (notifier) notifier->post(alert_events);
+#endif
+                }
                 
                 if (!quiet) {
                     visualizer.displayMetrics(metrics, auto_optimize, 
@@ -131,24 +896,173 @@ int main(int argc, char* argv[]) {
                                              monitor.getBaselineMem());
                 }
                 
+                if (recorder) {
+                    recorder->writeFrame(metrics);
+                }
+                
+                if (metrics.delta) {
+                    optimizer.forgetExited(*metrics.delta);
+                }
+                
                 if (auto_optimize) {
+                    SYSMON_STAGE(OPTIMIZE);
                     auto optimized = optimizer.optimizeProcesses(metrics.top_processes);
                     for (const auto& proc : optimized) {
                         logger.log("Optimized process: " + proc.name + 
                                   " (PID: " + std::to_string(proc.pid) + ")");
                     }
+                    
+                    auto calmed = optimizer.optimizeAnomalies(metrics.anomalies);
+                    for (const auto& anomaly : calmed) {
+                        logger.log("Optimized anomalous process: " + anomaly.name +
+                                  " (PID: " + std::to_string(anomaly.pid) + ")");
+                    }
+                    
+                    auto yielded = optimizer.optimizeContention(metrics.top_processes, metrics.top_sched);
+                    for (const auto& proc : yielded) {
+                        logger.log("Optimized process under run-queue contention: " + proc.name +
+                                  " (PID: " + std::to_string(proc.pid) + ")");
+                    }
+                    
+                    auto exposed = optimizer.optimizeMemory(metrics.memory_forecast, metrics.total_mem_kb);
+                    for (const auto& proc : exposed) {
+                        logger.log("Raised OOM score of growing process: " + proc.name +
+                                  " (PID: " + std::to_string(proc.pid) + ", " +
+                                  std::to_string(static_cast<long>(proc.growth_kb_per_sec)) + " KB/s)");
+                    }
+                    
+                    auto pinned = optimizer.optimizeNuma(metrics.numa_placements, metrics.numa_nodes);
+                    for (const auto& proc : pinned) {
+                        logger.log("Pinned process to NUMA node " + std::to_string(proc.suggested_node) +
+                                  ": " + proc.name + " (PID: " + std::to_string(proc.pid) + ")");
+                    }
+                    
+                    if (optimize_subtrees && metrics.process_table) {
+                        auto families = optimizer.optimizeSubtrees(monitor.getProcessTree(),
+                                                                   *metrics.process_table);
+                        for (const auto& subtree : families) {
+                            logger.log("Optimized process subtree: " + subtree.name +
+                                      " (PID: " + std::to_string(subtree.pid) + ", " +
+                                      std::to_string(subtree.subtree_processes) + " processes)");
+                        }
+                    }
+                }
+                
+                if (governor && governor->update(monitor)) {
+                    char usage[64];
+                    std::snprintf(usage, sizeof(usage), "%.2f%% of a core (budget %.2f%%)",
+                                  governor->getUsagePercent(), governor->getBudgetPercent());
+                    std::string change = std::string("Overhead governor at ") + usage + ": " + governor->describe();
+                    logger.log(change);
+                    // Otherwise the header shows it
+                    if (quiet) std::cerr << change << "\n";
                 }
+                auto wait = std::chrono::milliseconds(static_cast<long long>(
+                    (governor ? governor->getInterval() : interval) * 1000.0));
                 
-                std::this_thread::sleep_for(std::chrono::seconds(interval));
+                if (!interactive) {
+                    std::this_thread::sleep_for(wait);
+                    continue;
+                }
+                
+                // Sleep until the next tick, reacting to key presses meanwhile
+                auto next_tick = std::chrono::steady_clock::now() + wait;
+                while (running) {
+                    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        next_tick - std::chrono::steady_clock::now()).count();
+                    if (remaining <= 0) break;
+                    
+                    int key = Platform::waitForKey(static_cast<int>(remaining));
+                    if (key == 'q' || key == 'Q') {
+                        running = false;
+                        continue;
+                    }
+                    
+                    if (key == 'o' || key == 'O') {
+                        auto_optimize = !auto_optimize;
+                    } else if (key == 'g' || key == 'G' || key == 'd' || key == 'D' ||
+                               key == 't' || key == 'T' || key == 'n') {
+                        // Data of the new view appears from the next tick ('N' sorts by PID)
+                        Visualizer::View target = key == 'g' || key == 'G' ? Visualizer::View::CGROUPS
+                                                : key == 'd' || key == 'D' ? Visualizer::View::SCHED
+                                                : key == 'n' ? Visualizer::View::NUMA
+                                                : Visualizer::View::TREE;
+                        visualizer.setView(visualizer.getView() != target ? target
+                                                                          : Visualizer::View::PROCESSES);
+                        applyView(monitor, visualizer.getView(), delay_threshold, optimize_subtrees,
+                                  numa_affinity);
+                    } else if (key == '[' || key == ']') {
+                        // Folding takes effect on the next tick's rows
+                        monitor.setTreeDepth(monitor.getTreeDepth() + (key == ']' ? 1 : -1));
+                    } else if (key == 'v' || key == 'V') {
+                        visualizer.toggleOverhead();
+                    } else if (key == Platform::KEY_UP || key == 'k') {
+                        // Scrolling and sorting re-rank this tick's table
+                        visualizer.scrollBy(-1);
+                    } else if (key == Platform::KEY_DOWN || key == 'j') {
+                        visualizer.scrollBy(1);
+                    } else if (key == Platform::KEY_PAGE_UP) {
+                        visualizer.scrollPages(-1);
+                    } else if (key == Platform::KEY_PAGE_DOWN || key == ' ') {
+                        visualizer.scrollPages(1);
+                    } else if (key == Platform::KEY_HOME) {
+                        visualizer.scrollHome();
+                    } else if (key == Platform::KEY_END) {
+                        visualizer.scrollEnd();
+                    } else if (key == 'P' || key == 'M' || key == 'N' || key == 'A') {
+                        visualizer.setSortKey(key == 'P' ? SortKey::CPU
+                                            : key == 'M' ? SortKey::RSS
+                                            : key == 'N' ? SortKey::PID : SortKey::NAME);
+                    } else {
+                        continue;
+                    }
+                    visualizer.displayMetrics(metrics, auto_optimize,
+                                             monitor.getBaselineCPU(),
+                                             monitor.getBaselineMem());
+                }
             }
             
+            Platform::restoreInput();
             logger.log("Monitoring stopped");
+            
+            if (!history_file.empty()) {
+                if (HistoryExport::writeCSV(history_file, {
+                        { "cpu_percent", &monitor.getCPUHistory() },
+                        { "mem_percent", &monitor.getMemHistory() },
+                        { "throttle_events", &monitor.getThrottleHistory() },
+                        { "major_faults_per_sec", &monitor.getFaultHistory() },
+                        { "swap_pages_per_sec", &monitor.getSwapHistory() } })) {
+                    std::cout << "\nHistory written to " << history_file << " ("
+                              << monitor.getCPUHistory().size() << " samples)\n";
+                } else {
+                    std::cerr << "Error: cannot write history to " << history_file << "\n";
+                }
+            }
             std::cout << "\nMonitoring stopped successfully\n";
             
         } catch (const std::exception& e) {
             std::cerr << "Error: " << e.what() << "\n";
             return 1;
         }
+    } else if (command == "agent" || command == "aggregate") {
+#ifdef __linux__
+        try {
+            if (command == "agent") {
+                if (connect_target.empty()) {
+                    std::cerr << "Error: agent needs --connect host:port\n";
+                    return 1;
+                }
+                return runAgent(connect_target, agent_name, interval, quiet, filter, shm_name, cpu_budget);
+            }
+            return runAggregator(listen_port, interval, quiet, show_overhead, record_file);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+#else
+        std::cerr << "Error: " << command << " is only supported on Linux\n";
+        return 1;
+#endif
     } else {
         std::cerr << "Unknown command: " << command << "\n";
         std::cerr << "Use --help for usage information\n";
@@ -0,0 +1,192 @@
+#include "AnomalyDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // ~20 sample horizon for the per-process baselines
+    const float ALPHA = 0.1f;
+
+    // Deviation floors keep near-constant series from flagging on noise
+    const double CPU_DEV_FLOOR = 2.0;        // percentage points
+    const double RSS_DEV_FLOOR_KB = 4096.0;
+    const double RSS_DEV_FLOOR_RATIO = 0.01;
+
+    // Models not refreshed by the latest update are considered exited
+    const uint32_t STALE_TICKS = 2;
+    const size_t MIN_SWEEP_SLOTS = 64;
+
+    inline size_t hashPid(int pid) {
+        return static_cast<size_t>(static_cast<uint32_t>(pid) * 2654435761u);
+    }
+}
+
+const uint32_t AnomalyDetector::WARMUP_SAMPLES;
+const uint32_t AnomalyDetector::LEAK_MIN_SAMPLES;
+const uint16_t AnomalyDetector::LEAK_MIN_STREAK;
+
+AnomalyDetector::AnomalyDetector(size_t capacity)
+    : mask(0), live(0), sweep_cursor(0), tick(0), untracked(0),
+      cpu_sigma(4.0), rss_sigma(6.0), min_cpu(20.0), leak_kb_per_sec(256.0) {
+    size_t size = 64;
+    while (size < capacity) size <<= 1;
+
+    Model empty;
+    std::memset(&empty, 0, sizeof(empty));
+    table.assign(size, empty);
+    mask = size - 1;
+}
+
+AnomalyDetector::Model* AnomalyDetector::findOrInsert(int pid) {
+    size_t slot = hashPid(pid) & mask;
+
+    for (size_t probe = 0; probe <= mask; probe++) {
+        Model& model = table[slot];
+        if (model.pid == pid) return &model;
+
+        if (model.pid == 0) {
+            // Keep the load factor below 7/8 so probe chains stay short
+            if (live >= table.size() - table.size() / 8) {
+                untracked++;
+                return nullptr;
+            }
+            std::memset(&model, 0, sizeof(model));
+            model.pid = pid;
+            live++;
+            return &model;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    untracked++;
+    return nullptr;
+}
+
+void AnomalyDetector::erase(size_t slot) {
+    // Backward-shift deletion keeps linear probing chains intact without
+    // tombstones
+    size_t hole = slot;
+    table[hole].pid = 0;
+    live--;
+
+    size_t next = hole;
+    while (true) {
+        next = (next + 1) & mask;
+        if (table[next].pid == 0) break;
+
+        size_t home = hashPid(table[next].pid) & mask;
+        bool reachable = (hole <= next) ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+        if (!reachable) {
+            table[hole] = table[next];
+            table[next].pid = 0;
+            hole = next;
+        }
+    }
+}
+
+void AnomalyDetector::sweep(size_t slots) {
+    for (size_t i = 0; i < slots; i++) {
+        Model& model = table[sweep_cursor];
+        if (model.pid != 0 && tick - model.last_seen >= STALE_TICKS) {
+            // A neighbour may shift into this slot; look at it again next step
+            erase(sweep_cursor);
+            continue;
+        }
+        sweep_cursor = (sweep_cursor + 1) & mask;
+    }
+}
+
+void AnomalyDetector::update(const ProcessTable& processes, double interval_sec,
+                             std::vector<ProcessAnomaly>& anomalies) {
+    tick++;
+
+    const std::vector<int>& pids = processes.getPids();
+    const std::vector<double>& cpus = processes.getCPUColumn();
+    const std::vector<long>& rsss = processes.getRSSColumn();
+
+    for (size_t row = 0; row < pids.size(); row++) {
+        int pid = pids[row];
+        Model* model = findOrInsert(pid);
+        if (!model) continue;
+
+        // PID was absent for a while: most likely reused by a new process
+        if (model->samples > 0 && tick - model->last_seen > 1) {
+            std::memset(model, 0, sizeof(*model));
+            model->pid = pid;
+        }
+        model->last_seen = tick;
+
+        double cpu = cpus[row];
+        double rss = static_cast<double>(rsss[row]);
+
+        if (model->samples == 0) {
+            model->cpu_mean = static_cast<float>(cpu);
+            model->rss_mean = static_cast<float>(rss);
+            model->last_rss = static_cast<float>(rss);
+            model->samples = 1;
+            continue;
+        }
+
+        if (model->samples >= WARMUP_SAMPLES) {
+            double cpu_dev = std::max(static_cast<double>(model->cpu_dev), CPU_DEV_FLOOR);
+            double cpu_score = (cpu - model->cpu_mean) / cpu_dev;
+            if (cpu >= min_cpu && cpu_score >= cpu_sigma) {
+                ProcessAnomaly anomaly;
+                anomaly.pid = pid;
+                anomaly.name = processes.getName(row);
+                anomaly.type = AnomalyType::CPU_SPIKE;
+                anomaly.value = cpu;
+                anomaly.expected = model->cpu_mean;
+                anomaly.score = cpu_score;
+                anomalies.push_back(anomaly);
+            }
+
+            double rss_dev = std::max(static_cast<double>(model->rss_dev),
+                                      std::max(model->rss_mean * RSS_DEV_FLOOR_RATIO, RSS_DEV_FLOOR_KB));
+            double rss_score = (rss - model->rss_mean) / rss_dev;
+            if (rss_score >= rss_sigma) {
+                ProcessAnomaly anomaly;
+                anomaly.pid = pid;
+                anomaly.name = processes.getName(row);
+                anomaly.type = AnomalyType::RSS_SPIKE;
+                anomaly.value = rss;
+                anomaly.expected = model->rss_mean;
+                anomaly.score = rss_score;
+                anomalies.push_back(anomaly);
+            }
+        }
+
+        double delta = rss - model->last_rss;
+        double rate = interval_sec > 0.0 ? delta / interval_sec : 0.0;
+        model->rss_slope += ALPHA * (static_cast<float>(rate) - model->rss_slope);
+
+        if (delta > 0) {
+            if (model->growth_streak < 0xFFFF) model->growth_streak++;
+        } else if (delta < 0) {
+            model->growth_streak = 0;
+        }
+
+        if (model->samples >= LEAK_MIN_SAMPLES && model->growth_streak >= LEAK_MIN_STREAK &&
+            model->rss_slope >= leak_kb_per_sec) {
+            ProcessAnomaly anomaly;
+            anomaly.pid = pid;
+            anomaly.name = processes.getName(row);
+            anomaly.type = AnomalyType::RSS_LEAK;
+            anomaly.value = model->rss_slope;
+            anomaly.expected = leak_kb_per_sec;
+            anomaly.score = model->rss_slope / leak_kb_per_sec;
+            anomalies.push_back(anomaly);
+        }
+
+        model->cpu_dev += ALPHA * (static_cast<float>(std::fabs(cpu - model->cpu_mean)) - model->cpu_dev);
+        model->cpu_mean += ALPHA * (static_cast<float>(cpu) - model->cpu_mean);
+        model->rss_dev += ALPHA * (static_cast<float>(std::fabs(rss - model->rss_mean)) - model->rss_dev);
+        model->rss_mean += ALPHA * (static_cast<float>(rss) - model->rss_mean);
+        model->last_rss = static_cast<float>(rss);
+        if (model->samples < 0xFFFFFFFFu) model->samples++;
+    }
+
+    sweep(std::max(MIN_SWEEP_SLOTS, table.size() / 256));
+}
@@ -0,0 +1,75 @@
+#ifndef ANOMALYDETECTOR_H
+#define ANOMALYDETECTOR_H
+
+#include "ProcessInfo.h"
+#include "ProcessTable.h"
+#include <cstdint>
+#include <vector>
+
+// Flags processes whose CPU or RSS departs from their own recent behaviour.
+//
+// Each PID gets a compact model (EWMA mean and mean absolute deviation for
+// CPU and RSS, plus an EWMA of the RSS growth rate for leak detection) kept
+// in a fixed-capacity open-addressing table. Updates are O(1) per sample and
+// the table never grows, so memory is bounded by the capacity chosen at
+// construction regardless of how many processes the host runs. Models for
+// exited PIDs are reclaimed by an incremental sweep that touches a constant
+// number of slots per tick.
+class AnomalyDetector {
+private:
+    struct Model {
+        int32_t pid;            // 0 marks an empty slot
+        uint32_t last_seen;
+        uint32_t samples;
+        uint16_t growth_streak;
+        uint16_t reserved;
+        float cpu_mean;
+        float cpu_dev;
+        float rss_mean;
+        float rss_dev;
+        float rss_slope;        // KB per second
+        float last_rss;
+    };
+
+    std::vector<Model> table;
+    size_t mask;
+    size_t live;
+    size_t sweep_cursor;
+    uint32_t tick;
+    unsigned long untracked;
+
+    double cpu_sigma;
+    double rss_sigma;
+    double min_cpu;
+    double leak_kb_per_sec;
+
+    Model* findOrInsert(int pid);
+    void erase(size_t slot);
+    void sweep(size_t slots);
+
+public:
+    static const uint32_t WARMUP_SAMPLES = 5;
+    static const uint32_t LEAK_MIN_SAMPLES = 30;
+    static const uint16_t LEAK_MIN_STREAK = 10;
+
+    // capacity is rounded up to a power of two; memory use is
+    // capacity * sizeof(Model) (40 bytes), e.g. 2.5 MB for 64k slots
+    explicit AnomalyDetector(size_t capacity = 65536);
+
+    // Feeds one sample per process. `interval_sec` is the time since the
+    // previous call and is only used to express RSS growth per second.
+    void update(const ProcessTable& processes, double interval_sec,
+                std::vector<ProcessAnomaly>& anomalies);
+
+    void setCPUSigma(double sigma) { cpu_sigma = sigma; }
+    void setRSSSigma(double sigma) { rss_sigma = sigma; }
+    void setMinCPU(double percent) { min_cpu = percent; }
+    void setLeakThreshold(double kb_per_sec) { leak_kb_per_sec = kb_per_sec; }
+
+    size_t getCapacity() const { return table.size(); }
+    size_t getTracked() const { return live; }
+    unsigned long getUntracked() const { return untracked; }
+    size_t getMemoryBytes() const { return table.size() * sizeof(Model); }
+};
+
+#endif // ANOMALYDETECTOR_H
@@ -0,0 +1,150 @@
+#include "CgroupMonitor.h"
+#include "../platform/Platform.h"
+#include <algorithm>
+
+const unsigned long CgroupMonitor::EVICT_AFTER;
+const size_t CgroupMonitor::REVALIDATE_PER_TICK;
+
+CgroupMonitor::CgroupMonitor()
+    : tick(0), last_sequence(0), revalidate_cursor(0), synced(false), available(true),
+      cgroup_reads(0) {}
+
+void CgroupMonitor::assign(int pid) {
+    if (!Platform::getProcessCgroup(pid, scratch)) {
+        unassign(pid);
+        return;
+    }
+
+    auto it = groups.find(scratch);
+    if (it == groups.end()) {
+        it = groups.insert(std::make_pair(scratch, Group())).first;
+        it->second.info.path = scratch;
+    }
+    Group* group = &it->second;
+
+    auto cached = pid_groups.find(pid);
+    if (cached != pid_groups.end()) {
+        if (cached->second == group) return;
+        cached->second->info.process_count--;
+        cached->second = group;
+    } else {
+        pid_groups[pid] = group;
+    }
+    group->info.process_count++;
+}
+
+void CgroupMonitor::unassign(int pid) {
+    auto cached = pid_groups.find(pid);
+    if (cached == pid_groups.end()) return;
+    cached->second->info.process_count--;
+    pid_groups.erase(cached);
+}
+
+void CgroupMonitor::resync(const ProcessTable& processes) {
+    pid_groups.clear();
+    for (auto& entry : groups) {
+        entry.second.info.process_count = 0;
+    }
+    for (int pid : processes.getPids()) {
+        assign(pid);
+    }
+    synced = true;
+}
+
+void CgroupMonitor::readGroup(Group& group, double interval_sec) {
+    Platform::CgroupStats stats;
+    cgroup_reads++;
+    if (!Platform::getCgroupStats(group.info.path, stats)) {
+        group.has_sample = false;
+        return;
+    }
+
+    group.info.memory_kb = stats.memory_kb;
+    if (group.has_sample && interval_sec > 0.0) {
+        group.info.cpu_usage = std::max(0.0,
+            (stats.cpu_usage_usec - group.last_cpu_usec) / (interval_sec * 1e6) * 100.0);
+        group.info.io_read_kbps = std::max(0.0,
+            (stats.io_read_bytes - group.last_read_bytes) / 1024.0 / interval_sec);
+        group.info.io_write_kbps = std::max(0.0,
+            (stats.io_write_bytes - group.last_write_bytes) / 1024.0 / interval_sec);
+    }
+
+    group.last_cpu_usec = stats.cpu_usage_usec;
+    group.last_read_bytes = stats.io_read_bytes;
+    group.last_write_bytes = stats.io_write_bytes;
+    group.has_sample = true;
+}
+
+void CgroupMonitor::evictStale() {
+    for (auto it = groups.begin(); it != groups.end(); ) {
+        if (it->second.info.process_count <= 0 && tick - it->second.last_seen > EVICT_AFTER) {
+            it = groups.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void CgroupMonitor::update(const ProcessTable& processes, const SnapshotDelta& delta,
+                           double interval_sec, size_t top, SystemMetrics& metrics) {
+    tick++;
+
+    // A missed tick means missed spawns/exits: rebuild the cache from the table
+    if (!synced || delta.sequence != last_sequence + 1) {
+        resync(processes);
+    } else {
+        // Exits first: an exec is reported as exit + spawn of the same PID
+        for (const auto& proc : delta.exited) {
+            unassign(proc.pid);
+        }
+        for (const auto& proc : delta.spawned) {
+            assign(proc.pid);
+        }
+
+        // Follow migrations (systemd-run --scope, container moves) lazily
+        const std::vector<int>& pids = processes.getPids();
+        size_t count = std::min(REVALIDATE_PER_TICK, pids.size());
+        for (size_t i = 0; i < count; i++) {
+            if (revalidate_cursor >= pids.size()) revalidate_cursor = 0;
+            assign(pids[revalidate_cursor++]);
+        }
+    }
+    last_sequence = delta.sequence;
+
+    ranked.clear();
+    for (auto& entry : groups) {
+        Group& group = entry.second;
+        if (group.info.process_count <= 0) {
+            // Rates restart from scratch if the group is repopulated
+            group.has_sample = false;
+            continue;
+        }
+        group.last_seen = tick;
+        readGroup(group, interval_sec);
+        if (group.has_sample) ranked.push_back(&group);
+    }
+    evictStale();
+
+    available = !ranked.empty();
+
+    size_t shown = std::min(top, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + shown, ranked.end(),
+                      [](const Group* a, const Group* b) {
+                          return a->info.cpu_usage > b->info.cpu_usage;
+                      });
+
+    metrics.cgroup_count = static_cast<int>(ranked.size());
+    metrics.top_cgroups.resize(shown);
+    for (size_t i = 0; i < shown; i++) {
+        metrics.top_cgroups[i] = ranked[i]->info;
+    }
+}
+
+void CgroupMonitor::reset() {
+    pid_groups.clear();
+    for (auto& entry : groups) {
+        entry.second.info.process_count = 0;
+        entry.second.has_sample = false;
+    }
+    synced = false;
+}
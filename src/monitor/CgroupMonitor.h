@@ -0,0 +1,71 @@
+#ifndef CGROUPMONITOR_H
+#define CGROUPMONITOR_H
+
+#include "ProcessInfo.h"
+#include "ProcessTable.h"
+#include "SnapshotDelta.h"
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Per-cgroup usage from the kernel's cgroup v2 counters.
+//
+// PIDs are mapped to their cgroup once, when they first appear (from the
+// scan's SnapshotDelta), and the mapping is cached; a small number of
+// cached PIDs is re-resolved each tick to follow migrations. Usage is then
+// read from cpu.stat, memory.current and io.stat of each populated group,
+// so the cost scales with the number of groups rather than processes.
+class CgroupMonitor {
+private:
+    static const unsigned long EVICT_AFTER = 64;
+    static const size_t REVALIDATE_PER_TICK = 16;
+
+    struct Group {
+        long long last_cpu_usec;
+        long long last_read_bytes;
+        long long last_write_bytes;
+        bool has_sample;
+        unsigned long last_seen;
+        CgroupInfo info;
+
+        Group() : last_cpu_usec(0), last_read_bytes(0), last_write_bytes(0),
+                  has_sample(false), last_seen(0) {}
+    };
+
+    // std::map nodes are stable, so the PID cache can point into it
+    std::map<std::string, Group> groups;
+    std::unordered_map<int, Group*> pid_groups;
+    std::vector<Group*> ranked;
+    std::string scratch;
+    unsigned long tick;
+    unsigned long last_sequence;
+    size_t revalidate_cursor;
+    bool synced;
+    bool available;
+    unsigned long cgroup_reads;
+
+    void assign(int pid);
+    void unassign(int pid);
+    void resync(const ProcessTable& processes);
+    void readGroup(Group& group, double interval_sec);
+    void evictStale();
+
+public:
+    CgroupMonitor();
+
+    // Applies this tick's spawns/exits, re-reads every populated group and
+    // fills metrics.top_cgroups with the `top` busiest groups by CPU.
+    void update(const ProcessTable& processes, const SnapshotDelta& delta,
+                double interval_sec, size_t top, SystemMetrics& metrics);
+
+    // Drops the PID cache; the next update() resolves every process again
+    void reset();
+
+    bool isAvailable() const { return available; }
+    size_t getGroupCount() const { return groups.size(); }
+    size_t getCachedPids() const { return pid_groups.size(); }
+    unsigned long getCgroupReads() const { return cgroup_reads; }
+};
+
+#endif // CGROUPMONITOR_H
@@ -0,0 +1,245 @@
+#include "CompressedSeries.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    int leadingZeros(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(x);
+#else
+        int n = 0;
+        for (uint64_t bit = uint64_t(1) << 63; !(x & bit); bit >>= 1) n++;
+        return n;
+#endif
+    }
+
+    int trailingZeros(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(x);
+#else
+        int n = 0;
+        for (; !(x & 1); x >>= 1) n++;
+        return n;
+#endif
+    }
+
+    class BitReader {
+    private:
+        const uint64_t* words;
+        uint64_t pos;
+
+    public:
+        explicit BitReader(const uint64_t* words) : words(words), pos(0) {}
+
+        uint64_t read(int width) {
+            size_t index = static_cast<size_t>(pos >> 6);
+            int offset = static_cast<int>(pos & 63);
+            uint64_t value = words[index] << offset;
+            if (width > 64 - offset) value |= words[index + 1] >> (64 - offset);
+            pos += width;
+            return value >> (64 - width);
+        }
+
+        int64_t readSigned(int width) {
+            uint64_t value = read(width);
+            if (value & (uint64_t(1) << (width - 1))) value |= ~uint64_t(0) << width;
+            return static_cast<int64_t>(value);
+        }
+    };
+
+    // Delta-of-delta buckets: control prefix, prefix length, payload width
+    const struct {
+        uint64_t prefix;
+        int prefix_bits;
+        int width;
+    } DOD_BUCKETS[] = {
+        { 0x2, 2, 4 },      // 10    [-8, 7]: a few ms of tick jitter
+        { 0x6, 3, 9 },      // 110   [-256, 255]
+        { 0xe, 4, 12 },     // 1110  [-2048, 2047]
+    };
+    
+    // Timestamps are arbitrary int64s: deltas wrap instead of overflowing
+    int64_t wrappingSub(int64_t a, int64_t b) {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+    }
+    
+    int64_t wrappingAdd(int64_t a, int64_t b) {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    }
+}
+
+void CompressedSeries::Block::write(uint64_t value, int width) {
+    if (width < 64) value &= (uint64_t(1) << width) - 1;
+    int offset = static_cast<int>(bits & 63);
+    if (offset == 0) words.push_back(0);
+
+    int room = 64 - offset;
+    if (width <= room) {
+        words.back() |= value << (room - width);
+    } else {
+        words.back() |= value >> (width - room);
+        words.push_back(value << (64 - (width - room)));
+    }
+    bits += width;
+}
+
+CompressedSeries::CompressedSeries(size_t max_samples, double resolution)
+    : max_samples(max_samples), resolution(resolution > 0.0 ? resolution : 0.0), total(0),
+      last_timestamp(0), last_delta(0), last_bits(0), last_leading(-1), last_trailing(0) {}
+
+uint64_t CompressedSeries::encodeValue(double value) const {
+    if (resolution > 0.0) value = std::floor(value / resolution + 0.5);
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double CompressedSeries::decodeValue(uint64_t bits) const {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return resolution > 0.0 ? value * resolution : value;
+}
+
+void CompressedSeries::append(int64_t timestamp_ms, double value) {
+    uint64_t bits = encodeValue(value);
+
+    if (blocks.empty() || blocks.back().count == BLOCK_SAMPLES) {
+        if (!blocks.empty()) blocks.back().words.shrink_to_fit();
+        blocks.emplace_back();
+        Block& block = blocks.back();
+        block.words.reserve(BLOCK_SAMPLES / 2);
+        block.write(static_cast<uint64_t>(timestamp_ms), 64);
+        block.write(bits, 64);
+        block.count = 1;
+
+        last_timestamp = timestamp_ms;
+        last_delta = 0;
+        last_bits = bits;
+        last_leading = -1;
+        total++;
+
+        // Drop the oldest block once the rest still cover the retention
+        if (max_samples > 0 && total - blocks.front().count >= max_samples) {
+            total -= blocks.front().count;
+            blocks.pop_front();
+        }
+        return;
+    }
+
+    Block& block = blocks.back();
+
+    int64_t delta = wrappingSub(timestamp_ms, last_timestamp);
+    int64_t dod = wrappingSub(delta, last_delta);
+    if (dod == 0) {
+        block.write(0, 1);
+    } else {
+        bool written = false;
+        for (const auto& bucket : DOD_BUCKETS) {
+            int64_t limit = int64_t(1) << (bucket.width - 1);
+            if (dod >= -limit && dod < limit) {
+                block.write(bucket.prefix, bucket.prefix_bits);
+                block.write(static_cast<uint64_t>(dod), bucket.width);
+                written = true;
+                break;
+            }
+        }
+        if (!written) {
+            block.write(0xf, 4);
+            block.write(static_cast<uint64_t>(dod), 64);
+        }
+    }
+    last_timestamp = timestamp_ms;
+    last_delta = delta;
+
+    uint64_t x = bits ^ last_bits;
+    if (x == 0) {
+        block.write(0, 1);
+    } else {
+        int leading = std::min(leadingZeros(x), 31);
+        int trailing = trailingZeros(x);
+        if (last_leading >= 0 && leading >= last_leading && trailing >= last_trailing) {
+            // Fits the previous window; reuse it
+            block.write(0x2, 2);
+            block.write(x >> last_trailing, 64 - last_leading - last_trailing);
+        } else {
+            int meaningful = 64 - leading - trailing;
+            block.write(0x3, 2);
+            block.write(static_cast<uint64_t>(leading), 5);
+            block.write(static_cast<uint64_t>(meaningful & 63), 6);
+            block.write(x >> trailing, meaningful);
+            last_leading = leading;
+            last_trailing = trailing;
+        }
+    }
+    last_bits = bits;
+
+    block.count++;
+    total++;
+}
+
+void CompressedSeries::clear() {
+    blocks.clear();
+    total = 0;
+    last_leading = -1;
+}
+
+void CompressedSeries::decodeBlock(size_t index, std::vector<Sample>& out) const {
+    const Block& block = blocks[index];
+    BitReader reader(block.words.data());
+
+    int64_t timestamp = static_cast<int64_t>(reader.read(64));
+    uint64_t bits = reader.read(64);
+    out.push_back({ timestamp, decodeValue(bits) });
+
+    int64_t delta = 0;
+    int leading = 0;
+    int trailing = 0;
+    for (uint32_t i = 1; i < block.count; i++) {
+        if (reader.read(1)) {
+            int64_t dod;
+            if (!reader.read(1)) dod = reader.readSigned(4);
+            else if (!reader.read(1)) dod = reader.readSigned(9);
+            else if (!reader.read(1)) dod = reader.readSigned(12);
+            else dod = static_cast<int64_t>(reader.read(64));
+            delta = wrappingAdd(delta, dod);
+        }
+        timestamp = wrappingAdd(timestamp, delta);
+
+        if (reader.read(1)) {
+            if (reader.read(1)) {
+                leading = static_cast<int>(reader.read(5));
+                int meaningful = static_cast<int>(reader.read(6));
+                if (meaningful == 0) meaningful = 64;
+                trailing = 64 - leading - meaningful;
+            }
+            bits ^= reader.read(64 - leading - trailing) << trailing;
+        }
+        out.push_back({ timestamp, decodeValue(bits) });
+    }
+}
+
+void CompressedSeries::tail(size_t count, std::vector<double>& out) const {
+    count = std::min(count, total);
+    size_t first = blocks.size();
+    size_t covered = 0;
+    while (first > 0 && covered < count) {
+        covered += blocks[--first].count;
+    }
+
+    std::vector<Sample> samples;
+    samples.reserve(covered);
+    for (size_t i = first; i < blocks.size(); i++) decodeBlock(i, samples);
+
+    for (size_t i = samples.size() - count; i < samples.size(); i++) {
+        out.push_back(samples[i].value);
+    }
+}
+
+size_t CompressedSeries::memoryBytes() const {
+    size_t bytes = sizeof(*this);
+    for (const auto& block : blocks) {
+        bytes += sizeof(Block) + block.words.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
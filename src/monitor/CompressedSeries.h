@@ -0,0 +1,81 @@
+#ifndef COMPRESSEDSERIES_H
+#define COMPRESSEDSERIES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Append-only (timestamp, value) series compressed in fixed-size blocks,
+// after Facebook's Gorilla TSDB.
+//
+// Each block stores its first timestamp and value raw; after that a
+// timestamp costs the delta of its delta from the previous one (one bit for
+// a perfectly regular tick) and a value costs the XOR against the previous
+// value, written as the run of meaningful bits between its leading and
+// trailing zeros (one bit for an unchanged value). Blocks are independent,
+// so readers decode one block at a time and retention drops whole blocks.
+//
+// With a non-zero `resolution` values are snapped to that grid before
+// encoding. Grid points are stored as integer-valued doubles, which have
+// few significant mantissa bits and XOR far better than the raw readings.
+class CompressedSeries {
+public:
+    struct Sample {
+        int64_t timestamp_ms;
+        double value;
+    };
+
+    static const size_t BLOCK_SAMPLES = 1024;
+
+private:
+    struct Block {
+        std::vector<uint64_t> words;
+        uint64_t bits;
+        uint32_t count;
+
+        Block() : bits(0), count(0) {}
+        void write(uint64_t value, int width);
+    };
+
+    std::deque<Block> blocks;
+    size_t max_samples;
+    double resolution;
+    size_t total;
+
+    // Encoder state for the open (last) block
+    int64_t last_timestamp;
+    int64_t last_delta;
+    uint64_t last_bits;
+    int last_leading;
+    int last_trailing;
+
+    uint64_t encodeValue(double value) const;
+    double decodeValue(uint64_t bits) const;
+
+public:
+    // Keeps at least `max_samples` of the most recent samples; older blocks
+    // are dropped whole, so up to one extra block may be retained.
+    explicit CompressedSeries(size_t max_samples = 0, double resolution = 0.0);
+
+    void append(int64_t timestamp_ms, double value);
+    void clear();
+
+    size_t size() const { return total; }
+    bool empty() const { return total == 0; }
+    size_t getBlockCount() const { return blocks.size(); }
+    size_t getBlockSize(size_t block) const { return blocks[block].count; }
+    double getResolution() const { return resolution; }
+
+    // Appends the samples of one block, oldest first
+    void decodeBlock(size_t block, std::vector<Sample>& out) const;
+
+    // The most recent `count` values, oldest first; only the blocks that
+    // hold them are decoded
+    void tail(size_t count, std::vector<double>& out) const;
+
+    // Heap and object bytes held by the series
+    size_t memoryBytes() const;
+};
+
+#endif // COMPRESSEDSERIES_H
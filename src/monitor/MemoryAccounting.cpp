@@ -0,0 +1,143 @@
+#include "MemoryAccounting.h"
+#include "../platform/Platform.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace {
+    // RSS drift (relative to the RSS seen at the last rollup read) that
+    // forces a refresh before the scheduled interval expires
+    const double FORCE_REFRESH_DRIFT = 0.10;
+    const double STABLE_DRIFT = 0.02;
+}
+
+const int MemoryAccounting::MIN_INTERVAL;
+const int MemoryAccounting::MAX_INTERVAL;
+const unsigned long MemoryAccounting::EVICT_AFTER;
+
+MemoryAccounting::MemoryAccounting(size_t top_k, size_t reads_per_tick)
+    : tick(0), top_k(top_k), reads_per_tick(reads_per_tick > 0 ? reads_per_tick : 1),
+      rollup_reads(0) {}
+
+bool MemoryAccounting::refresh(int pid, long rss_kb, Entry& entry) {
+    Platform::MemoryRollup rollup;
+    rollup_reads++;
+
+    if (!Platform::getMemoryRollup(pid, rollup)) {
+        // Usually a permission problem; don't hammer it every tick
+        entry.valid = false;
+        entry.next_refresh = tick + MAX_INTERVAL;
+        return false;
+    }
+
+    if (entry.valid) {
+        long base = std::max(entry.rss_at_read, 1L);
+        double drift = static_cast<double>(std::labs(rss_kb - entry.rss_at_read)) / base;
+
+        if (drift > FORCE_REFRESH_DRIFT) {
+            entry.interval = std::max(MIN_INTERVAL, entry.interval / 2);
+        } else if (drift < STABLE_DRIFT) {
+            entry.interval = std::min(MAX_INTERVAL, entry.interval * 2);
+        }
+    }
+
+    entry.pss_kb = rollup.pss_kb;
+    entry.uss_kb = rollup.uss_kb;
+    entry.swap_kb = rollup.swap_kb;
+    entry.rss_at_read = rss_kb;
+    entry.next_refresh = tick + entry.interval;
+    entry.valid = true;
+    return true;
+}
+
+void MemoryAccounting::evictStale() {
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (tick - it->second.last_seen > EVICT_AFTER) {
+            it = cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MemoryAccounting::update(const ProcessTable& processes, SystemMetrics& metrics) {
+    tick++;
+
+    const std::vector<long>& rss = processes.getRSSColumn();
+    size_t k = std::min(top_k, rss.size());
+    order.resize(rss.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<uint32_t>(i);
+
+    std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                      [&rss](uint32_t a, uint32_t b) {
+                          return rss[a] > rss[b];
+                      });
+
+    // Rank the candidates that need a read: never-read first, then RSS that
+    // drifted past the threshold, then by how overdue the refresh is
+    due.clear();
+    for (size_t i = 0; i < k; i++) {
+        size_t row = order[i];
+        Entry& entry = cache[processes.getPid(row)];
+        entry.last_seen = tick;
+
+        if (!entry.valid) {
+            if (tick >= entry.next_refresh) due.push_back(std::make_pair(LONG_MAX, i));
+            continue;
+        }
+
+        long base = std::max(entry.rss_at_read, 1L);
+        double drift = static_cast<double>(std::labs(rss[row] - entry.rss_at_read)) / base;
+
+        if (drift > FORCE_REFRESH_DRIFT) {
+            due.push_back(std::make_pair(LONG_MAX - 1, i));
+        } else if (tick >= entry.next_refresh) {
+            due.push_back(std::make_pair(static_cast<long>(tick - entry.next_refresh), i));
+        }
+    }
+
+    std::sort(due.begin(), due.end(),
+              [](const std::pair<long, size_t>& a, const std::pair<long, size_t>& b) {
+                  return a.first > b.first;
+              });
+
+    size_t reads = std::min(reads_per_tick, due.size());
+    for (size_t i = 0; i < reads; i++) {
+        size_t row = order[due[i].second];
+        int pid = processes.getPid(row);
+        refresh(pid, rss[row], cache[pid]);
+    }
+
+    metrics.accounted_processes = 0;
+    metrics.accounted_rss_kb = 0;
+    metrics.accounted_pss_kb = 0;
+    metrics.accounted_uss_kb = 0;
+    metrics.accounted_swap_kb = 0;
+
+    for (size_t i = 0; i < k; i++) {
+        size_t row = order[i];
+        const Entry& entry = cache[processes.getPid(row)];
+        if (!entry.valid) continue;
+
+        metrics.accounted_processes++;
+        metrics.accounted_rss_kb += rss[row];
+        metrics.accounted_pss_kb += entry.pss_kb;
+        metrics.accounted_uss_kb += entry.uss_kb;
+        metrics.accounted_swap_kb += entry.swap_kb;
+    }
+
+    if (tick % 16 == 0) {
+        evictStale();
+    }
+}
+
+bool MemoryAccounting::annotate(ProcessInfo& info) const {
+    auto it = cache.find(info.pid);
+    if (it == cache.end() || !it->second.valid) return false;
+
+    info.mem_accounted = true;
+    info.pss_kb = it->second.pss_kb;
+    info.uss_kb = it->second.uss_kb;
+    info.swap_kb = it->second.swap_kb;
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include "ProcessInfo.h"
+#include "ProcessTable.h"
+#include <map>
+#include <vector>
+
+// Lazy PSS/USS/Swap accounting for the top-K memory consumers.
+//
+// smaps_rollup walks every VMA of the target process, so it is far too
+// expensive to read for every PID on every tick. Results are cached per PID
+// and refreshed on an interval that shrinks while RSS is moving and grows
+// while it is stable. At most `reads_per_tick` rollups are read per call so
+// the cost is spread across ticks instead of spiking on the first one.
+class MemoryAccounting {
+private:
+    static const int MIN_INTERVAL = 1;
+    static const int MAX_INTERVAL = 32;
+    static const unsigned long EVICT_AFTER = 64;
+
+    struct Entry {
+        long pss_kb;
+        long uss_kb;
+        long swap_kb;
+        long rss_at_read;
+        unsigned long next_refresh;
+        unsigned long last_seen;
+        int interval;
+        bool valid;
+
+        Entry() : pss_kb(0), uss_kb(0), swap_kb(0), rss_at_read(0), next_refresh(0),
+                  last_seen(0), interval(MIN_INTERVAL), valid(false) {}
+    };
+
+    std::map<int, Entry> cache;
+    std::vector<uint32_t> order;
+    std::vector<std::pair<long, size_t>> due;
+    unsigned long tick;
+    size_t top_k;
+    size_t reads_per_tick;
+    unsigned long rollup_reads;
+
+    bool refresh(int pid, long rss_kb, Entry& entry);
+    void evictStale();
+
+public:
+    MemoryAccounting(size_t top_k = 10, size_t reads_per_tick = 4);
+
+    // Refreshes the top-K processes (by RSS) that are due and fills the
+    // accounted_* totals of `metrics`.
+    void update(const ProcessTable& processes, SystemMetrics& metrics);
+
+    // Copies the cached breakdown for `info.pid`, if one is known
+    bool annotate(ProcessInfo& info) const;
+
+    void setTopK(size_t k) { top_k = k; }
+    void setReadsPerTick(size_t n) { reads_per_tick = n > 0 ? n : 1; }
+    size_t getTopK() const { return top_k; }
+    size_t getReadsPerTick() const { return reads_per_tick; }
+    size_t getCachedCount() const { return cache.size(); }
+    unsigned long getRollupReads() const { return rollup_reads; }
+};
+
+#endif // MEMORYACCOUNTING_H
@@ -0,0 +1,180 @@
+#include "MemoryForecaster.h"
+#include <algorithm>
+
+namespace {
+    // Level follows within a few samples; the trend over ~20
+    const double ALPHA = 0.2;
+    const double BETA = 0.05;
+
+    double secondsUntil(double remaining, double rate) {
+        if (rate <= 0.0) return -1.0;
+        double seconds = std::max(0.0, remaining) / rate;
+        return seconds <= MemoryForecaster::MAX_HORIZON_SEC ? seconds : -1.0;
+    }
+}
+
+const size_t MemoryForecaster::WINDOW;
+const size_t MemoryForecaster::MIN_SAMPLES;
+const uint32_t MemoryForecaster::PROCESS_MIN_SAMPLES;
+const size_t MemoryForecaster::TOP_GROWING;
+const double MemoryForecaster::MAX_HORIZON_SEC = 7 * 86400.0;
+
+MemoryForecaster::MemoryForecaster() : min_growth_kb_per_sec(32.0) {
+    window.reserve(WINDOW);
+    reset();
+}
+
+void MemoryForecaster::reset() {
+    window.clear();
+    head = 0;
+    count = 0;
+    since_resum = 0;
+    origin = 0.0;
+    sum_t = sum_x = sum_tt = sum_tx = 0.0;
+    clock = 0.0;
+    host = Holt();
+    processes.clear();
+    last_sequence = 0;
+    synced = false;
+}
+
+void MemoryForecaster::smooth(Holt& model, double x, double dt) {
+    if (model.samples == 0) {
+        model.level = x;
+        model.trend = 0.0;
+        model.samples = 1;
+        return;
+    }
+
+    // A sample with no time since the last one only moves the level
+    double predicted = model.level + model.trend * std::max(0.0, dt);
+    double level = predicted + ALPHA * (x - predicted);
+    if (dt > 0.0) model.trend += BETA * ((level - model.level) / dt - model.trend);
+    model.level = level;
+    if (model.samples < 0xFFFFFFFFu) model.samples++;
+}
+
+void MemoryForecaster::addPoint(double t, double x) {
+    if (count == WINDOW) {
+        const Point& old = window[head];
+        double dt = old.t - origin;
+        sum_t -= dt;
+        sum_x -= old.x;
+        sum_tt -= dt * dt;
+        sum_tx -= dt * old.x;
+        window[head].t = t;
+        window[head].x = x;
+    } else {
+        Point point;
+        point.t = t;
+        point.x = x;
+        window.push_back(point);
+        count++;
+    }
+    head = (head + 1) % WINDOW;
+
+    double dt = t - origin;
+    sum_t += dt;
+    sum_x += x;
+    sum_tt += dt * dt;
+    sum_tx += dt * x;
+
+    if (++since_resum >= WINDOW) resum();
+}
+
+void MemoryForecaster::resum() {
+    // Once per window, so still O(1) per sample
+    origin = window[count == WINDOW ? head : 0].t;
+    sum_t = sum_x = sum_tt = sum_tx = 0.0;
+    for (const auto& point : window) {
+        double dt = point.t - origin;
+        sum_t += dt;
+        sum_x += point.x;
+        sum_tt += dt * dt;
+        sum_tx += dt * point.x;
+    }
+    since_resum = 0;
+}
+
+double MemoryForecaster::regressionSlope(double& fitted) const {
+    double n = static_cast<double>(count);
+    double mean_t = sum_t / n;
+    double mean_x = sum_x / n;
+    double sxx = sum_tt - sum_t * mean_t;
+    double sxy = sum_tx - sum_t * mean_x;
+    double slope = sxx > 0.0 ? sxy / sxx : 0.0;
+    fitted = mean_x + slope * (clock - origin - mean_t);
+    return slope;
+}
+
+void MemoryForecaster::update(const ProcessTable& table, const SnapshotDelta& delta,
+                              double interval_sec, const SystemMetrics& metrics,
+                              MemoryForecast& forecast) {
+    forecast = MemoryForecast();
+    clock += std::max(0.0, interval_sec);
+
+    if (metrics.total_mem_kb > 0) {
+        double usage = metrics.mem_usage_percent;
+        addPoint(clock, usage);
+        smooth(host, usage, interval_sec);
+
+        if (count >= 2) {
+            double fitted;
+            double slope = regressionSlope(fitted);
+            forecast.trend_percent_per_hour = slope * 3600.0;
+            forecast.regression_seconds = secondsUntil(100.0 - fitted, slope);
+            forecast.holt_seconds = secondsUntil(100.0 - host.level, host.trend);
+        }
+        forecast.ready = count >= MIN_SAMPLES;
+        if (forecast.ready && forecast.regression_seconds >= 0.0 && forecast.holt_seconds >= 0.0) {
+            forecast.seconds_to_exhaustion = std::min(forecast.regression_seconds,
+                                                      forecast.holt_seconds);
+        }
+    }
+
+    updateProcesses(table, delta, interval_sec, metrics.available_mem_kb, forecast);
+}
+
+void MemoryForecaster::updateProcesses(const ProcessTable& table, const SnapshotDelta& delta,
+                                       double interval_sec, long available_kb,
+                                       MemoryForecast& forecast) {
+    // Exits are only known tick to tick; after a gap, PIDs may have been reused
+    if (!synced || delta.sequence != last_sequence + 1) {
+        processes.clear();
+    } else {
+        for (const auto& proc : delta.exited) {
+            processes.erase(proc.pid);
+        }
+    }
+    last_sequence = delta.sequence;
+    synced = true;
+
+    ranked.clear();
+    const std::vector<int>& pids = table.getPids();
+    const std::vector<long>& rss = table.getRSSColumn();
+    for (size_t row = 0; row < pids.size(); row++) {
+        Holt& model = processes[pids[row]];
+        smooth(model, static_cast<double>(rss[row]), interval_sec);
+        if (model.samples >= PROCESS_MIN_SAMPLES && model.trend >= min_growth_kb_per_sec) {
+            Ranked entry;
+            entry.row = static_cast<uint32_t>(row);
+            entry.growth = model.trend;
+            ranked.push_back(entry);
+        }
+    }
+
+    size_t top = std::min(ranked.size(), TOP_GROWING);
+    std::partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(),
+                      [](const Ranked& a, const Ranked& b) { return a.growth > b.growth; });
+
+    forecast.growing.resize(top);
+    for (size_t i = 0; i < top; i++) {
+        MemoryGrowth& growth = forecast.growing[i];
+        growth.pid = pids[ranked[i].row];
+        growth.name = table.getName(ranked[i].row);
+        growth.rss_kb = rss[ranked[i].row];
+        growth.growth_kb_per_sec = ranked[i].growth;
+        growth.seconds_to_exhaustion = secondsUntil(static_cast<double>(available_kb),
+                                                    ranked[i].growth);
+    }
+}
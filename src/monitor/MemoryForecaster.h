@@ -0,0 +1,86 @@
+#ifndef MEMORYFORECASTER_H
+#define MEMORYFORECASTER_H
+
+#include "ProcessInfo.h"
+#include "ProcessTable.h"
+#include "SnapshotDelta.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Time-to-exhaustion estimates from the memory trend.
+//
+// The host's memory usage is fitted two ways, both O(1) per sample: a
+// least-squares line over the last WINDOW samples (running sums over a
+// ring, re-summed once per window so add/remove rounding cannot pile up)
+// and Holt's linear smoothing, which follows a change of slope sooner but
+// is noisier. Exhaustion is only projected while both see memory growing,
+// and the sooner estimate is reported. Every process gets a Holt model of
+// its RSS; the fastest growers are reported with the time each would take
+// on its own to use up what is still available.
+class MemoryForecaster {
+private:
+    static const size_t WINDOW = 300;
+    static const size_t MIN_SAMPLES = 30;
+    static const uint32_t PROCESS_MIN_SAMPLES = 10;
+    static const size_t TOP_GROWING = 5;
+
+    struct Holt {
+        double level;
+        double trend;           // Units per second
+        uint32_t samples;
+    };
+
+    struct Point {
+        double t;
+        double x;
+    };
+
+    struct Ranked {
+        uint32_t row;
+        double growth;
+    };
+
+    std::vector<Point> window;
+    size_t head;
+    size_t count;
+    size_t since_resum;
+    double origin;              // Sums are over t - origin to keep them small
+    double sum_t;
+    double sum_x;
+    double sum_tt;
+    double sum_tx;
+    double clock;
+    Holt host;
+    std::unordered_map<int, Holt> processes;
+    std::vector<Ranked> ranked;
+    unsigned long last_sequence;
+    bool synced;
+    double min_growth_kb_per_sec;
+
+    static void smooth(Holt& model, double x, double dt);
+    void addPoint(double t, double x);
+    void resum();
+    double regressionSlope(double& fitted) const;
+    void updateProcesses(const ProcessTable& table, const SnapshotDelta& delta,
+                         double interval_sec, long available_kb, MemoryForecast& forecast);
+
+public:
+    // Longest projection reported; further out counts as no exhaustion
+    static const double MAX_HORIZON_SEC;
+
+    MemoryForecaster();
+
+    // Feeds one tick. `interval_sec` is the time since the previous call
+    // (0 on the first).
+    void update(const ProcessTable& table, const SnapshotDelta& delta, double interval_sec,
+                const SystemMetrics& metrics, MemoryForecast& forecast);
+
+    void reset();
+
+    // Processes growing slower than this are never reported
+    void setMinGrowth(double kb_per_sec) { min_growth_kb_per_sec = kb_per_sec; }
+    size_t getTrackedPids() const { return processes.size(); }
+};
+
+#endif // MEMORYFORECASTER_H
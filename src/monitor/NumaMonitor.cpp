@@ -0,0 +1,171 @@
+#include "NumaMonitor.h"
+#include <algorithm>
+
+namespace {
+    double perSecond(long long now, long long before, double interval_sec) {
+        return now > before ? (now - before) / interval_sec : 0.0;
+    }
+}
+
+const size_t NumaMonitor::TOP_PLACEMENTS;
+const unsigned long NumaMonitor::PLACEMENT_REFRESH;
+const unsigned long NumaMonitor::TOPOLOGY_REFRESH;
+const int NumaMonitor::HOME_PERCENT;
+const long NumaMonitor::SUGGEST_MIN_RSS_KB;
+
+NumaMonitor::NumaMonitor()
+    : tick(0), topology_tick(0), last_sequence(0), synced(false), available(true),
+      numa_maps_reads(0) {}
+
+void NumaMonitor::readTopology() {
+    std::vector<Platform::NumaNode> topology;
+    available = Platform::getNumaTopology(topology);
+    topology_tick = tick;
+
+    // Counters stay comparable as long as the same nodes are online
+    bool same = topology.size() == nodes.size();
+    for (size_t i = 0; same && i < topology.size(); i++) {
+        same = topology[i].node == nodes[i].topology.node;
+    }
+    if (!same) {
+        nodes.assign(topology.size(), Node());
+        placements.clear();
+    }
+    for (size_t i = 0; i < topology.size(); i++) {
+        if (!same) nodes[i].has_last = false;
+        nodes[i].topology.node = topology[i].node;
+        nodes[i].topology.cpus.swap(topology[i].cpus);
+    }
+}
+
+void NumaMonitor::updateNodes(double interval_sec, SystemMetrics& metrics) {
+    bool have_cpus = Platform::getPerCPUStats(cpu_current);
+    bool cpu_rates = have_cpus && cpu_last.size() == cpu_current.size();
+
+    metrics.numa_nodes.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        Node& node = nodes[i];
+        NumaNodeInfo& info = metrics.numa_nodes[i];
+        info = NumaNodeInfo();
+        info.node = node.topology.node;
+        info.cpus = node.topology.cpus;
+
+        Platform::NumaNodeStats stats;
+        if (!Platform::getNumaNodeStats(node.topology.node, stats)) {
+            node.has_last = false;
+            continue;
+        }
+        info.total_kb = stats.total_kb;
+        info.free_kb = stats.free_kb;
+        if (node.has_last && interval_sec > 0.0) {
+            info.local_pages_per_sec = perSecond(stats.local_node, node.last.local_node, interval_sec);
+            info.remote_pages_per_sec = perSecond(stats.other_node, node.last.other_node, interval_sec);
+            info.miss_pages_per_sec = perSecond(stats.numa_miss, node.last.numa_miss, interval_sec);
+        }
+        node.last = stats;
+        node.has_last = true;
+
+        if (cpu_rates) {
+            long busy = 0;
+            long total = 0;
+            for (int cpu : node.topology.cpus) {
+                if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_current.size()) continue;
+                long total_diff = cpu_current[cpu].total - cpu_last[cpu].total;
+                long idle_diff = cpu_current[cpu].idle - cpu_last[cpu].idle;
+                if (total_diff <= 0) continue;
+                total += total_diff;
+                busy += std::max(0L, total_diff - idle_diff);
+            }
+            info.cpu_percent = total > 0 ? 100.0 * busy / total : 0.0;
+        }
+    }
+
+    if (have_cpus) {
+        cpu_last.swap(cpu_current);
+    } else {
+        cpu_last.clear();
+    }
+}
+
+void NumaMonitor::updatePlacements(const ProcessTable& processes, SystemMetrics& metrics) {
+    size_t top = std::min(TOP_PLACEMENTS, processes.size());
+    processes.rank(SortKey::RSS, order, top);
+
+    metrics.numa_placements.clear();
+    for (size_t i = 0; i < top; i++) {
+        uint32_t row = order[i];
+        int pid = processes.getPid(row);
+
+        auto it = placements.find(pid);
+        if (it == placements.end() || tick - it->second.read_tick >= PLACEMENT_REFRESH) {
+            numa_maps_reads++;
+            if (!Platform::getProcessNumaPlacement(pid, node_scratch)) {
+                // Kernel threads, and other users' processes without ptrace access
+                if (it != placements.end()) placements.erase(it);
+                continue;
+            }
+            if (it == placements.end()) it = placements.insert(std::make_pair(pid, Placement())).first;
+            it->second.node_kb.swap(node_scratch);
+            it->second.read_tick = tick;
+        }
+
+        const std::vector<long>& node_kb = it->second.node_kb;
+        long resident = 0;
+        for (long kb : node_kb) resident += kb;
+        if (resident <= 0) continue;
+
+        NumaPlacement info;
+        info.pid = pid;
+        info.name = processes.getName(row);
+        info.cpu_usage = processes.getCPU(row);
+        info.rss_kb = processes.getRSS(row);
+        info.node_kb = node_kb;
+        auto home = std::max_element(node_kb.begin(), node_kb.end());
+        info.home_node = static_cast<int>(home - node_kb.begin());
+        info.home_percent = 100.0 * *home / resident;
+        if (info.home_percent >= HOME_PERCENT && resident >= SUGGEST_MIN_RSS_KB) {
+            info.suggested_node = info.home_node;
+        }
+        metrics.numa_placements.push_back(info);
+    }
+
+    // Processes that left the top set are re-read if they come back
+    for (auto it = placements.begin(); it != placements.end(); ) {
+        if (tick - it->second.read_tick > 3 * PLACEMENT_REFRESH) {
+            it = placements.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void NumaMonitor::update(const ProcessTable& processes, const SnapshotDelta& delta,
+                         double interval_sec, SystemMetrics& metrics) {
+    tick++;
+    if (nodes.empty() || tick - topology_tick >= TOPOLOGY_REFRESH) readTopology();
+
+    // A missed tick means missed exits, and PIDs may have been reused
+    if (!synced || delta.sequence != last_sequence + 1) {
+        placements.clear();
+        synced = true;
+    } else {
+        for (const auto& proc : delta.exited) {
+            placements.erase(proc.pid);
+        }
+    }
+    last_sequence = delta.sequence;
+
+    metrics.numa_nodes.clear();
+    metrics.numa_placements.clear();
+    if (!available) return;
+
+    updateNodes(interval_sec, metrics);
+    if (nodes.size() > 1) updatePlacements(processes, metrics);
+}
+
+void NumaMonitor::reset() {
+    nodes.clear();
+    cpu_last.clear();
+    placements.clear();
+    synced = false;
+}
@@ -0,0 +1,74 @@
+#ifndef NUMAMONITOR_H
+#define NUMAMONITOR_H
+
+#include "ProcessInfo.h"
+#include "ProcessTable.h"
+#include "SnapshotDelta.h"
+#include "../platform/Platform.h"
+#include <unordered_map>
+#include <vector>
+
+// Per-node memory, allocation locality and CPU load on NUMA hosts.
+//
+// Each tick reads every node's meminfo and numastat (two small sysfs
+// files per node) and the per-CPU lines of /proc/stat, which the
+// topology maps onto nodes. Process placement comes from numa_maps, whose
+// read walks the process's page tables, so it is only taken for the
+// largest processes by RSS and re-read at most every PLACEMENT_REFRESH
+// ticks. Single-node hosts get the node view but no placements.
+class NumaMonitor {
+private:
+    static const size_t TOP_PLACEMENTS = 8;
+    static const unsigned long PLACEMENT_REFRESH = 10;
+    static const unsigned long TOPOLOGY_REFRESH = 60;   // Catches CPU/memory hotplug
+    // Affinity is suggested once this much of a process's memory is on one
+    // node, for processes big enough for remote access to matter
+    static const int HOME_PERCENT = 75;
+    static const long SUGGEST_MIN_RSS_KB = 64 * 1024;
+
+    struct Node {
+        Platform::NumaNode topology;
+        Platform::NumaNodeStats last;
+        bool has_last;
+    };
+
+    struct Placement {
+        std::vector<long> node_kb;
+        unsigned long read_tick;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Platform::CPUTicks> cpu_current;
+    std::vector<Platform::CPUTicks> cpu_last;
+    std::unordered_map<int, Placement> placements;
+    std::vector<uint32_t> order;
+    std::vector<long> node_scratch;
+    unsigned long tick;
+    unsigned long topology_tick;
+    unsigned long last_sequence;
+    bool synced;
+    bool available;
+    unsigned long numa_maps_reads;
+
+    void readTopology();
+    void updateNodes(double interval_sec, SystemMetrics& metrics);
+    void updatePlacements(const ProcessTable& processes, SystemMetrics& metrics);
+
+public:
+    NumaMonitor();
+
+    // `interval_sec` is the time since the previous call (0 on the first,
+    // which only records counters)
+    void update(const ProcessTable& processes, const SnapshotDelta& delta, double interval_sec,
+                SystemMetrics& metrics);
+
+    // Forgets every counter and placement; the topology is re-read
+    void reset();
+
+    bool isAvailable() const { return available; }
+    size_t getNodeCount() const { return nodes.size(); }
+    size_t getTrackedPids() const { return placements.size(); }
+    unsigned long getNumaMapsReads() const { return numa_maps_reads; }
+};
+
+#endif // NUMAMONITOR_H
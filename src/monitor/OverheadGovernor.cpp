@@ -0,0 +1,123 @@
+#include "OverheadGovernor.h"
+#include "SystemMonitor.h"
+#include "../platform/Platform.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+const double OverheadGovernor::SMOOTHING = 0.3;
+const double OverheadGovernor::RECOVER_MARGIN = 0.7;
+const size_t OverheadGovernor::REDUCED_TOP_K;
+
+OverheadGovernor::OverheadGovernor(double budget_percent, double interval_sec, double max_stretch)
+    : budget(std::max(budget_percent, 0.001) / 100.0), base_interval(std::max(interval_sec, 0.001)),
+      max_interval(base_interval * std::max(max_stretch, 1.0)), interval(base_interval),
+      level(Level::FULL), cost(0.0), usage(0.0), cost_before(0.0), last_cpu(0.0), last_now(0.0),
+      ticks_at_level(0), recover_ticks(0), primed(false), has_cost(false), full_top_k(0),
+      full_reads(0) {
+    ratio[0] = ratio[1] = ratio[2] = 0.0;
+}
+
+bool OverheadGovernor::update(SystemMonitor& monitor) {
+    double cpu_sec;
+    if (!Platform::getSelfCPUTime(cpu_sec)) return false;
+    double now_sec = std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return update(monitor, cpu_sec, now_sec);
+}
+
+bool OverheadGovernor::update(SystemMonitor& monitor, double cpu_sec, double now_sec) {
+    if (!primed) {
+        // What FULL restores to
+        full_top_k = monitor.getMemoryAccounting().getTopK();
+        full_reads = monitor.getMemoryAccounting().getReadsPerTick();
+        last_cpu = cpu_sec;
+        last_now = now_sec;
+        primed = true;
+        return false;
+    }
+
+    // No time passed: what was spent meanwhile counts towards the next tick
+    double wall = now_sec - last_now;
+    if (wall <= 0.0) return false;
+    double spent = std::max(0.0, cpu_sec - last_cpu);
+    last_cpu = cpu_sec;
+    last_now = now_sec;
+
+    usage = usage > 0.0 ? usage + SMOOTHING * (spent / wall - usage) : spent / wall;
+    cost = has_cost ? cost + SMOOTHING * (spent - cost) : spent;
+    has_cost = true;
+    if (++ticks_at_level < SETTLE_TICKS) return false;
+
+    int index = static_cast<int>(level);
+    // Only after a step down: on the way up cost_before is stale
+    if (ticks_at_level == SETTLE_TICKS && cost_before > 0.0) {
+        ratio[index] = std::max(1.0, cost_before / std::max(cost, 1e-9));
+        cost_before = 0.0;
+    }
+
+    Level previous_level = level;
+    double previous_interval = interval;
+    // Per-tick cost hardly depends on the interval, so this is the usage
+    // the current level would have at the configured one
+    double at_base = cost / base_interval;
+
+    if (at_base > budget && level != Level::DETAIL) {
+        cost_before = cost;
+        level = static_cast<Level>(index + 1);
+        recover_ticks = 0;
+    } else if (level == Level::DETAIL && at_base > budget) {
+        // Nothing left to shed: spread the ticks out instead
+        double target = std::min(max_interval, cost / budget);
+        if (target > interval * 1.1 || target < interval * 0.8) interval = target;
+        recover_ticks = 0;
+    } else {
+        interval = base_interval;
+        // What the level above would cost now, from the ratio seen on the way down
+        if (level != Level::FULL && ratio[index] > 0.0 &&
+            cost * ratio[index] / base_interval < budget * RECOVER_MARGIN) {
+            if (++recover_ticks >= RECOVER_TICKS) {
+                level = static_cast<Level>(index - 1);
+                recover_ticks = 0;
+            }
+        } else {
+            recover_ticks = 0;
+        }
+    }
+
+    if (level != previous_level) {
+        // The smoothed cost restarts at the new level
+        ticks_at_level = 0;
+        has_cost = false;
+        apply(monitor);
+    }
+    return level != previous_level || interval != previous_interval;
+}
+
+void OverheadGovernor::apply(SystemMonitor& monitor) {
+    MemoryAccounting& accounting = monitor.getMemoryAccounting();
+    if (level == Level::FULL) {
+        accounting.setTopK(full_top_k);
+        accounting.setReadsPerTick(full_reads);
+    } else {
+        accounting.setTopK(std::min(full_top_k, REDUCED_TOP_K));
+        accounting.setReadsPerTick(1);
+    }
+    monitor.setDetailSuspended(level == Level::DETAIL);
+}
+
+std::string OverheadGovernor::describe() const {
+    if (!isDegraded()) return "full fidelity";
+
+    std::string text;
+    if (level != Level::FULL) {
+        text = "PSS accounting top-" + std::to_string(std::min(full_top_k, REDUCED_TOP_K));
+    }
+    if (level == Level::DETAIL) text += ", detail collectors paused";
+    if (interval > base_interval) {
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "%sinterval %.1fs", text.empty() ? "" : ", ", interval);
+        text += buf;
+    }
+    return text;
+}
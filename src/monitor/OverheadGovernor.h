@@ -0,0 +1,80 @@
+#ifndef OVERHEADGOVERNOR_H
+#define OVERHEADGOVERNOR_H
+
+#include <string>
+
+class SystemMonitor;
+
+// Keeps the monitor's own CPU use under a budget (percent of one core).
+//
+// Once per tick it reads the process's CPU time (getrusage; every thread,
+// rendering and exports included) and keeps a smoothed cost per tick.
+// While that cost at the configured interval is over budget, fidelity is
+// shed one step at a time, cheapest loss first:
+//
+//   TOP_K    PSS accounting covers the 3 largest processes, one rollup a tick
+//   DETAIL   cgroup, sched, NUMA and tree collectors are paused as well
+//
+// and if that is still not enough the interval is stretched to whatever
+// the budget allows, up to `max_stretch` times the configured one. Each
+// step waits a few ticks for the cost to settle. Going back up uses the
+// cost ratio measured when the step was taken: a level is restored once
+// the current cost scaled by that ratio fits comfortably, so a level is
+// not restored only to be shed again on the next tick.
+class OverheadGovernor {
+public:
+    enum class Level {
+        FULL,
+        TOP_K,
+        DETAIL
+    };
+
+private:
+    static const int SETTLE_TICKS = 3;
+    static const int RECOVER_TICKS = 5;
+    static const double SMOOTHING;
+    static const double RECOVER_MARGIN;     // Of the budget, for restoring a level
+    static const size_t REDUCED_TOP_K = 3;
+
+    double budget;                  // Fraction of one core
+    double base_interval;
+    double max_interval;
+    double interval;
+    Level level;
+    double cost;                    // Smoothed CPU seconds per tick
+    double usage;                   // Smoothed CPU seconds per wall second
+    double ratio[3];                // Cost of the level above / this level, 0 until measured
+    double cost_before;             // Smoothed cost before a step down, 0 once its ratio is known
+    double last_cpu;
+    double last_now;
+    int ticks_at_level;
+    int recover_ticks;
+    bool primed;
+    bool has_cost;
+    size_t full_top_k;
+    size_t full_reads;
+
+    void apply(SystemMonitor& monitor);
+
+public:
+    OverheadGovernor(double budget_percent, double interval_sec, double max_stretch = 16.0);
+
+    // Call once per tick, after the tick's work. True if the level or the
+    // interval changed (see describe()).
+    bool update(SystemMonitor& monitor);
+    // Same, with the process CPU time and a monotonic clock supplied
+    bool update(SystemMonitor& monitor, double cpu_sec, double now_sec);
+
+    // Seconds to wait before the next tick
+    double getInterval() const { return interval; }
+    Level getLevel() const { return level; }
+    bool isDegraded() const { return level != Level::FULL || interval > base_interval; }
+    // Over budget even at full stretch
+    bool isOverBudget() const { return has_cost && usage > budget * 1.05 && interval >= max_interval; }
+    double getUsagePercent() const { return usage * 100.0; }
+    double getBudgetPercent() const { return budget * 100.0; }
+    // e.g. "PSS accounting top-3, detail collectors paused, interval 6.0s"
+    std::string describe() const;
+};
+
+#endif // OVERHEADGOVERNOR_H
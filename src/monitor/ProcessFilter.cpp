@@ -0,0 +1,421 @@
+#include "ProcessFilter.h"
+#include "../platform/Platform.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    const size_t MAX_EXPRESSION = 4096;
+    const int MAX_DEPTH = 64;
+    // Distinct names seen by one regex between resets; real hosts run a
+    // few hundred
+    const size_t MEMO_LIMIT = 4096;
+
+    bool isIdentifier(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+}
+
+const int32_t ProcessFilter::ACCEPT;
+const int32_t ProcessFilter::REJECT;
+
+// ---------------------------------------------------------------------------
+// Parser
+// ---------------------------------------------------------------------------
+
+class ProcessFilter::Parser {
+private:
+    const std::string& src;
+    size_t pos;
+    int depth;
+    std::vector<Node>& nodes;
+    std::vector<Pattern>& patterns;
+
+    int fail(const std::string& message) {
+        if (error.empty()) error = "column " + std::to_string(pos + 1) + ": " + message;
+        return -1;
+    }
+
+    void skipSpace() {
+        while (pos < src.size() && std::isspace(static_cast<unsigned char>(src[pos]))) pos++;
+    }
+
+    bool accept(const char* token) {
+        size_t len = std::strlen(token);
+        if (src.compare(pos, len, token) != 0) return false;
+        pos += len;
+        return true;
+    }
+
+    int add(Node::Type type, int left, int right) {
+        Node node;
+        node.type = type;
+        node.left = left;
+        node.right = right;
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size() - 1);
+    }
+
+    bool readValue(std::string& value) {
+        value.clear();
+        if (pos < src.size() && (src[pos] == '"' || src[pos] == '\'')) {
+            char quote = src[pos++];
+            while (pos < src.size() && src[pos] != quote) {
+                // Only the quote itself needs escaping; regex escapes pass through
+                if (src[pos] == '\\' && pos + 1 < src.size() && src[pos + 1] == quote) pos++;
+                value += src[pos++];
+            }
+            if (pos >= src.size()) return false;
+            pos++;
+            return true;
+        }
+
+        // A ')' only ends the value when it closes a group opened before it
+        int open = 0;
+        while (pos < src.size() && !std::isspace(static_cast<unsigned char>(src[pos])) &&
+               (src[pos] != ')' || open > 0) && src.compare(pos, 2, "&&") != 0 &&
+               src.compare(pos, 2, "||") != 0) {
+            if (src[pos] == '(') open++;
+            else if (src[pos] == ')') open--;
+            value += src[pos++];
+        }
+        return !value.empty();
+    }
+
+    bool parseNumber(const std::string& value, Field field, double& number) {
+        const char* start = value.c_str();
+        char* end;
+        number = std::strtod(start, &end);
+        // strtod also takes "nan" and "inf"; a NaN would make != match everything
+        if (end == start || std::isnan(number)) return false;
+
+        std::string unit(end);
+        std::transform(unit.begin(), unit.end(), unit.begin(), [](char c) {
+            return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        });
+        if (field == Field::RSS) {
+            if (!unit.empty() && unit.back() == 'B' && unit.size() == 2) unit.pop_back();
+            if (unit == "M") number *= 1024.0;
+            else if (unit == "G") number *= 1024.0 * 1024.0;
+            else if (unit == "T") number *= 1024.0 * 1024.0 * 1024.0;
+            else if (!unit.empty() && unit != "K") return false;
+            return true;
+        }
+        if (field == Field::CPU) return unit.empty() || unit == "%";
+        return unit.empty();
+    }
+
+    bool addPattern(const std::string& value, Compare compare, int32_t& index) {
+        Pattern pattern;
+        if (compare == Compare::EQ || compare == Compare::NE) {
+            pattern.kind = Pattern::Kind::EXACT;
+            pattern.text = value;
+        } else {
+            bool anchored_start = !value.empty() && value[0] == '^';
+            bool anchored_end = value.size() > 1 && value.back() == '$';
+            std::string core = value.substr(anchored_start ? 1 : 0);
+            if (anchored_end) core.pop_back();
+
+            if (core.find_first_of(".[]()*+?{}|\\^$") == std::string::npos) {
+                pattern.kind = anchored_start && anchored_end ? Pattern::Kind::EXACT
+                             : anchored_start ? Pattern::Kind::PREFIX
+                             : anchored_end ? Pattern::Kind::SUFFIX : Pattern::Kind::CONTAINS;
+                pattern.text = core;
+            } else {
+                pattern.kind = Pattern::Kind::REGEX;
+                pattern.text = value;
+                try {
+                    pattern.regex.assign(value, std::regex::ECMAScript | std::regex::optimize);
+                } catch (const std::regex_error&) {
+                    return false;
+                }
+            }
+        }
+        patterns.push_back(pattern);
+        index = static_cast<int32_t>(patterns.size() - 1);
+        return true;
+    }
+
+    int parseTest() {
+        size_t start = pos;
+        while (pos < src.size() && isIdentifier(src[pos])) pos++;
+        std::string name = src.substr(start, pos - start);
+        if (name.empty()) return fail("expected a field name");
+
+        Instruction test;
+        test.pattern = -1;
+        test.value = 0.0;
+        test.on_true = ACCEPT;
+        test.on_false = REJECT;
+        if (name == "pid") test.field = Field::PID;
+        else if (name == "ppid") test.field = Field::PPID;
+        else if (name == "cpu") test.field = Field::CPU;
+        else if (name == "rss") test.field = Field::RSS;
+        else if (name == "prio" || name == "priority") test.field = Field::PRIO;
+        else if (name == "nice") test.field = Field::NICE;
+        else if (name == "user" || name == "uid") test.field = Field::USER;
+        else if (name == "name") test.field = Field::NAME;
+        else {
+            pos = start;
+            return fail("unknown field '" + name + "'");
+        }
+
+        skipSpace();
+        size_t op_pos = pos;
+        if (accept("==")) test.compare = Compare::EQ;
+        else if (accept("!=")) test.compare = Compare::NE;
+        else if (accept("!~")) test.compare = Compare::NO_MATCH;
+        else if (accept("<=")) test.compare = Compare::LE;
+        else if (accept(">=")) test.compare = Compare::GE;
+        else if (accept("<")) test.compare = Compare::LT;
+        else if (accept(">")) test.compare = Compare::GT;
+        else if (accept("~")) test.compare = Compare::MATCH;
+        else return fail("expected an operator after '" + name + "'");
+
+        bool ordered = test.compare != Compare::EQ && test.compare != Compare::NE;
+        bool regex = test.compare == Compare::MATCH || test.compare == Compare::NO_MATCH;
+        if ((test.field == Field::NAME && ordered && !regex) ||
+            (test.field == Field::USER && ordered) ||
+            (test.field != Field::NAME && regex)) {
+            pos = op_pos;
+            return fail("operator not supported for '" + name + "'");
+        }
+
+        skipSpace();
+        size_t value_pos = pos;
+        std::string value;
+        if (!readValue(value)) return fail("expected a value");
+
+        if (test.field == Field::NAME) {
+            if (!addPattern(value, test.compare, test.pattern)) {
+                pos = value_pos;
+                return fail("invalid regular expression");
+            }
+        } else if (test.field == Field::USER) {
+            int uid;
+            char* end;
+            long number = std::strtol(value.c_str(), &end, 10);
+            if (*end == '\0') {
+                uid = static_cast<int>(number);
+            } else if (!Platform::lookupUser(value, uid)) {
+                pos = value_pos;
+                return fail("unknown user '" + value + "'");
+            }
+            test.value = uid;
+            uses_user = true;
+        } else {
+            if (!parseNumber(value, test.field, test.value)) {
+                pos = value_pos;
+                return fail("invalid number '" + value + "'");
+            }
+            if (test.field == Field::CPU) uses_cpu = true;
+        }
+
+        Node node;
+        node.type = Node::Type::TEST;
+        node.left = -1;
+        node.right = -1;
+        node.test = test;
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size() - 1);
+    }
+
+    int parseUnary() {
+        skipSpace();
+        if (accept("!")) {
+            if (++depth > MAX_DEPTH) return fail("nested too deeply");
+            int operand = parseUnary();
+            depth--;
+            return operand < 0 ? -1 : add(Node::Type::NOT, operand, -1);
+        }
+        if (accept("(")) {
+            if (++depth > MAX_DEPTH) return fail("nested too deeply");
+            int inner = parseOr();
+            if (inner < 0) return -1;
+            skipSpace();
+            if (!accept(")")) return fail("expected ')'");
+            depth--;
+            return inner;
+        }
+        return parseTest();
+    }
+
+    int parseAnd() {
+        int left = parseUnary();
+        while (left >= 0) {
+            skipSpace();
+            if (!accept("&&")) break;
+            int right = parseUnary();
+            if (right < 0) return -1;
+            left = add(Node::Type::AND, left, right);
+        }
+        return left;
+    }
+
+public:
+    std::string error;
+    bool uses_cpu;
+    bool uses_user;
+
+    Parser(const std::string& src, std::vector<Node>& nodes, std::vector<Pattern>& patterns)
+        : src(src), pos(0), depth(0), nodes(nodes), patterns(patterns),
+          uses_cpu(false), uses_user(false) {}
+
+    int parseOr() {
+        int left = parseAnd();
+        while (left >= 0) {
+            skipSpace();
+            if (!accept("||")) break;
+            int right = parseAnd();
+            if (right < 0) return -1;
+            left = add(Node::Type::OR, left, right);
+        }
+        return left;
+    }
+
+    int parse() {
+        int root = parseOr();
+        if (root < 0) return -1;
+        skipSpace();
+        if (pos != src.size()) return fail("unexpected '" + src.substr(pos, 16) + "'");
+        return root;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// ProcessFilter
+// ---------------------------------------------------------------------------
+
+ProcessFilter::ProcessFilter() : entry(ACCEPT), uses_cpu(false), uses_user(false) {}
+
+void ProcessFilter::clear() {
+    text.clear();
+    program.clear();
+    patterns.clear();
+    entry = ACCEPT;
+    uses_cpu = false;
+    uses_user = false;
+}
+
+int32_t ProcessFilter::emit(const std::vector<Node>& nodes, int node, int32_t on_true,
+                            int32_t on_false) {
+    const Node& current = nodes[node];
+    switch (current.type) {
+        case Node::Type::AND:
+            return emit(nodes, current.left, emit(nodes, current.right, on_true, on_false), on_false);
+        case Node::Type::OR:
+            return emit(nodes, current.left, on_true, emit(nodes, current.right, on_true, on_false));
+        case Node::Type::NOT:
+            return emit(nodes, current.left, on_false, on_true);
+        case Node::Type::TEST:
+            break;
+    }
+
+    program.push_back(current.test);
+    program.back().on_true = on_true;
+    program.back().on_false = on_false;
+    return static_cast<int32_t>(program.size() - 1);
+}
+
+bool ProcessFilter::compile(const std::string& expression, std::string& error) {
+    if (expression.size() > MAX_EXPRESSION) {
+        error = "expression longer than " + std::to_string(MAX_EXPRESSION) + " characters";
+        return false;
+    }
+    if (expression.find_first_not_of(" \t\r\n") == std::string::npos) {
+        clear();
+        return true;
+    }
+
+    std::vector<Node> nodes;
+    std::vector<Pattern> parsed_patterns;
+    Parser parser(expression, nodes, parsed_patterns);
+    int root = parser.parse();
+    if (root < 0) {
+        error = parser.error;
+        return false;
+    }
+
+    clear();
+    text = expression;
+    patterns.swap(parsed_patterns);
+    entry = emit(nodes, root, ACCEPT, REJECT);
+    uses_cpu = parser.uses_cpu;
+    uses_user = parser.uses_user;
+    return true;
+}
+
+bool ProcessFilter::matchName(const Pattern& pattern, const char* name, size_t len) const {
+    const std::string& text = pattern.text;
+    switch (pattern.kind) {
+        case Pattern::Kind::EXACT:
+            return len == text.size() && std::memcmp(name, text.data(), len) == 0;
+        case Pattern::Kind::PREFIX:
+            return len >= text.size() && std::memcmp(name, text.data(), text.size()) == 0;
+        case Pattern::Kind::SUFFIX:
+            return len >= text.size() &&
+                   std::memcmp(name + len - text.size(), text.data(), text.size()) == 0;
+        case Pattern::Kind::CONTAINS:
+            return std::search(name, name + len, text.begin(), text.end()) != name + len ||
+                   text.empty();
+        case Pattern::Kind::REGEX:
+            break;
+    }
+
+    // Names repeat across PIDs and ticks; stat names fit the small-string buffer
+    std::string key(name, len);
+    auto it = pattern.memo.find(key);
+    if (it != pattern.memo.end()) return it->second;
+
+    bool result = std::regex_search(key, pattern.regex);
+    if (pattern.memo.size() >= MEMO_LIMIT) pattern.memo.clear();
+    pattern.memo.emplace(key, result);
+    return result;
+}
+
+bool ProcessFilter::test(const Instruction& instruction, Candidate& candidate) const {
+    double value;
+    switch (instruction.field) {
+        case Field::PID: value = candidate.pid; break;
+        case Field::PPID: value = candidate.ppid; break;
+        case Field::CPU: value = candidate.cpu; break;
+        case Field::RSS: value = static_cast<double>(candidate.rss_kb); break;
+        case Field::PRIO: value = candidate.priority; break;
+        case Field::NICE: value = candidate.priority - 20; break;
+        case Field::USER:
+            // Unreadable owners (-2) equal no user
+            if (candidate.uid == -1 && !Platform::getProcessUid(candidate.pid, candidate.uid)) {
+                candidate.uid = -2;
+            }
+            value = candidate.uid;
+            break;
+        case Field::NAME: {
+            bool matched = matchName(patterns[instruction.pattern], candidate.name, candidate.name_len);
+            bool negated = instruction.compare == Compare::NE || instruction.compare == Compare::NO_MATCH;
+            return matched != negated;
+        }
+        default:
+            return false;
+    }
+
+    switch (instruction.compare) {
+        case Compare::EQ: return value == instruction.value;
+        case Compare::NE: return value != instruction.value;
+        case Compare::LT: return value < instruction.value;
+        case Compare::LE: return value <= instruction.value;
+        case Compare::GT: return value > instruction.value;
+        case Compare::GE: return value >= instruction.value;
+        default: return false;
+    }
+}
+
+bool ProcessFilter::matches(Candidate& candidate) const {
+    int32_t pc = entry;
+    while (pc >= 0) {
+        const Instruction& instruction = program[pc];
+        pc = test(instruction, candidate) ? instruction.on_true : instruction.on_false;
+    }
+    return pc == ACCEPT;
+}
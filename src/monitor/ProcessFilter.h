@@ -0,0 +1,138 @@
+#ifndef PROCESSFILTER_H
+#define PROCESSFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Process filter expressions, compiled once into a flat branch program.
+//
+//   name~^java && rss>1G
+//   user==build || (cpu>=50 && !name~"^(bash|sh)$")
+//
+// A test is `field op value`; tests combine with `&&`, `||`, `!` and
+// parentheses. Fields: pid, ppid, cpu (%), rss (KB, or with a K/M/G/T
+// suffix), prio (stat priority), nice, user (name or uid), name. Numbers
+// compare with == != < <= > >=; names with == != ~ !~ (ECMAScript regex,
+// unanchored); users with == !=. Values may be quoted; unquoted ones end at
+// whitespace, `&&`, `||` or a `)` they did not open.
+//
+// Each test becomes one instruction holding the next instruction for both
+// outcomes, so evaluation is a loop over the program with short-circuiting
+// built in and no stack or recursion. The user test is the
+// only one that reads anything beyond the stat line, and only if reached.
+class ProcessFilter {
+public:
+    // What the scan knows about a process before it becomes a table row
+    struct Candidate {
+        int pid;
+        int ppid;
+        const char* name;
+        size_t name_len;
+        long rss_kb;
+        int priority;
+        double cpu;     // 0 until the process has been seen twice
+        int uid;        // -1 until a user test fetches it
+    };
+
+private:
+    enum class Field : uint8_t {
+        PID,
+        PPID,
+        CPU,
+        RSS,
+        PRIO,
+        NICE,
+        USER,
+        NAME
+    };
+
+    enum class Compare : uint8_t {
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE,
+        MATCH,
+        NO_MATCH
+    };
+
+    static const int32_t ACCEPT = -1;
+    static const int32_t REJECT = -2;
+
+    struct Instruction {
+        Field field;
+        Compare compare;
+        int32_t pattern;        // Into patterns, for name tests
+        double value;
+        int32_t on_true;        // Next instruction, or ACCEPT / REJECT
+        int32_t on_false;
+    };
+
+    // Anchored or unanchored literals skip the regex engine
+    struct Pattern {
+        enum class Kind : uint8_t {
+            EXACT,
+            PREFIX,
+            SUFFIX,
+            CONTAINS,
+            REGEX
+        };
+
+        Kind kind;
+        std::string text;
+        std::regex regex;
+        mutable std::unordered_map<std::string, bool> memo;
+    };
+
+    // Parse tree; only lives during compile()
+    struct Node {
+        enum class Type : uint8_t {
+            AND,
+            OR,
+            NOT,
+            TEST
+        };
+
+        Type type;
+        int left;
+        int right;
+        Instruction test;
+    };
+
+    class Parser;
+
+    std::string text;
+    std::vector<Instruction> program;
+    std::vector<Pattern> patterns;
+    int32_t entry;
+    bool uses_cpu;
+    bool uses_user;
+
+    int32_t emit(const std::vector<Node>& nodes, int node, int32_t on_true, int32_t on_false);
+    bool test(const Instruction& instruction, Candidate& candidate) const;
+    bool matchName(const Pattern& pattern, const char* name, size_t len) const;
+
+public:
+    ProcessFilter();
+
+    // Replaces the program. On a syntax error the filter is left unchanged
+    // and `error` says where. An empty or blank expression matches all.
+    bool compile(const std::string& expression, std::string& error);
+    void clear();
+
+    // May fill candidate.uid
+    bool matches(Candidate& candidate) const;
+
+    bool empty() const { return program.empty(); }
+    bool usesCPU() const { return uses_cpu; }
+    bool usesUser() const { return uses_user; }
+    const std::string& getText() const { return text; }
+    size_t getInstructionCount() const { return program.size(); }
+};
+
+#endif // PROCESSFILTER_H
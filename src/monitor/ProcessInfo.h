@@ -4,15 +4,220 @@
 #include <string>
 #include <vector>
 
+class ProcessTable;
+struct SnapshotDelta;
+
 struct ProcessInfo {
     int pid;
+    int ppid;
     std::string name;
     double cpu_usage;
     long memory_kb;
     int priority;
     int nice_value;
+    double major_fault_rate;    // Faults per second that needed I/O
+    
+    // Filled lazily by MemoryAccounting for the top memory consumers only
+    bool mem_accounted;
+    long pss_kb;
+    long uss_kb;
+    long swap_kb;
+    
+    ProcessInfo() : pid(0), ppid(0), cpu_usage(0.0), memory_kb(0), priority(0), nice_value(0),
+                    major_fault_rate(0.0), mem_accounted(false), pss_kb(0), uss_kb(0), swap_kb(0) {}
+};
+
+enum class AnomalyType {
+    CPU_SPIKE,
+    RSS_SPIKE,
+    RSS_LEAK
+};
+
+struct ProcessAnomaly {
+    int pid;
+    std::string name;
+    AnomalyType type;
+    double value;       // CPU %, RSS KB, or RSS growth KB/s for leaks
+    double expected;
+    double score;
+    
+    ProcessAnomaly() : pid(0), type(AnomalyType::CPU_SPIKE), value(0.0), expected(0.0), score(0.0) {}
+};
+
+// Usage of one cgroup, from the kernel's own per-group counters
+struct CgroupInfo {
+    std::string path;
+    double cpu_usage;       // % of one CPU, like ProcessInfo::cpu_usage
+    long memory_kb;
+    double io_read_kbps;
+    double io_write_kbps;
+    int process_count;
+    
+    CgroupInfo() : cpu_usage(0.0), memory_kb(0), io_read_kbps(0.0), io_write_kbps(0.0),
+                   process_count(0) {}
+};
+
+// One process with the totals of the subtree it roots (itself included)
+struct SubtreeInfo {
+    int pid;
+    std::string name;
+    int depth;              // 0 for roots of the tree
+    double cpu_usage;       // The process alone
+    double subtree_cpu;
+    long subtree_rss_kb;
+    int subtree_processes;
+    int hidden_children;    // Children folded away (depth limit or row budget)
+    
+    SubtreeInfo() : pid(0), depth(0), cpu_usage(0.0), subtree_cpu(0.0), subtree_rss_kb(0),
+                    subtree_processes(0), hidden_children(0) {}
+};
+
+// Run-queue contention of one process, from its schedstat counters
+struct SchedInfo {
+    int pid;
+    std::string name;
+    double cpu_usage;
+    double delay_percent;   // % of wall time runnable but waiting for a CPU
+    double avg_wait_us;     // Mean wait before each timeslice
+    double slices_per_sec;
+    
+    SchedInfo() : pid(0), cpu_usage(0.0), delay_percent(0.0), avg_wait_us(0.0),
+                  slices_per_sec(0.0) {}
+};
+
+// One CPU's run queue over the last tick, from /proc/schedstat
+struct CPUSchedInfo {
+    double busy_percent;
+    double wait_percent;    // Summed wait of its queued tasks; may exceed 100
+    double avg_wait_us;
+    
+    CPUSchedInfo() : busy_percent(0.0), wait_percent(0.0), avg_wait_us(0.0) {}
+};
+
+struct ThermalZoneInfo {
+    std::string type;
+    double celsius;
+    
+    ThermalZoneInfo() : celsius(0.0) {}
+};
+
+// Effective CPU clock and throttling over the last tick. Throttle events
+// are new increments of the kernel's thermal_throttle counters; package
+// events are counted once per package.
+struct CPUThermals {
+    bool available;                 // Some CPU reports cpufreq
+    int cpus;                       // CPUs with a clock reading
+    double avg_mhz;
+    double min_mhz;
+    double max_mhz;
+    double nominal_mhz;             // Mean cpuinfo_max_freq
+    int throttled_cpus;             // Core counter rose this tick
+    long long throttle_events;
+    std::vector<ThermalZoneInfo> zones;
+    int hottest_zone;               // Index into zones, or -1
     
-    ProcessInfo() : pid(0), cpu_usage(0.0), memory_kb(0), priority(0), nice_value(0) {}
+    CPUThermals() : available(false), cpus(0), avg_mhz(0.0), min_mhz(0.0), max_mhz(0.0),
+                    nominal_mhz(0.0), throttled_cpus(0), throttle_events(0), hottest_zone(-1) {}
+};
+
+// One NUMA node over the last tick. Allocation rates are pages per second
+// from the node's numastat; "remote" pages were placed here for a task
+// running on another node.
+struct NumaNodeInfo {
+    int node;
+    std::vector<int> cpus;
+    long total_kb;
+    long free_kb;
+    double cpu_percent;             // Mean busy time of the node's CPUs
+    double local_pages_per_sec;
+    double remote_pages_per_sec;
+    double miss_pages_per_sec;      // Placed here although another node was preferred
+    
+    NumaNodeInfo() : node(0), total_kb(0), free_kb(0), cpu_percent(0.0), local_pages_per_sec(0.0),
+                     remote_pages_per_sec(0.0), miss_pages_per_sec(0.0) {}
+};
+
+// Where a large process's resident memory lives, from its numa_maps
+struct NumaPlacement {
+    int pid;
+    std::string name;
+    double cpu_usage;
+    long rss_kb;
+    std::vector<long> node_kb;      // Indexed by node id
+    int home_node;                  // Node holding the most of it
+    double home_percent;
+    int suggested_node;             // Worth pinning to, or -1
+    
+    NumaPlacement() : pid(0), cpu_usage(0.0), rss_kb(0), home_node(-1), home_percent(0.0),
+                      suggested_node(-1) {}
+};
+
+// One process whose RSS keeps growing, from MemoryForecaster
+struct MemoryGrowth {
+    int pid;
+    std::string name;
+    long rss_kb;
+    double growth_kb_per_sec;       // Smoothed trend
+    double seconds_to_exhaustion;   // At this rate alone, of what is available; -1 if beyond the horizon
+    
+    MemoryGrowth() : pid(0), rss_kb(0), growth_kb_per_sec(0.0), seconds_to_exhaustion(-1.0) {}
+};
+
+// Kernel paging activity over the last tick (/proc/vmstat), per second.
+// Faults are counted per fault, everything else in pages. Direct scans
+// mean allocations stalled to reclaim memory themselves; together with
+// steady swap-in and major faults, that is thrashing.
+struct PagingRates {
+    bool available;
+    double major_faults;
+    double minor_faults;
+    double swap_in;
+    double swap_out;
+    double scan_kswapd;
+    double scan_direct;
+    double steal_kswapd;
+    double steal_direct;
+    long long oom_kills;            // This tick, not per second
+    
+    PagingRates() : available(false), major_faults(0.0), minor_faults(0.0), swap_in(0.0),
+                    swap_out(0.0), scan_kswapd(0.0), scan_direct(0.0), steal_kswapd(0.0),
+                    steal_direct(0.0), oom_kills(0) {}
+    
+    // Share of scanned pages that were reclaimed; low means reclaim is struggling
+    double reclaimEfficiency() const {
+        double scanned = scan_kswapd + scan_direct;
+        return scanned > 0.0 ? 100.0 * (steal_kswapd + steal_direct) / scanned : 100.0;
+    }
+};
+
+// Projected host memory exhaustion. Times are seconds from now, -1 when
+// no exhaustion is projected within the forecaster's horizon.
+struct MemoryForecast {
+    bool ready;                     // Enough history for the host estimates
+    double trend_percent_per_hour;  // Regression slope of mem_usage_percent
+    double regression_seconds;
+    double holt_seconds;
+    double seconds_to_exhaustion;   // Set only while both models project growth
+    std::vector<MemoryGrowth> growing;  // Fastest first
+    
+    MemoryForecast() : ready(false), trend_percent_per_hour(0.0), regression_seconds(-1.0),
+                       holt_seconds(-1.0), seconds_to_exhaustion(-1.0) {}
+};
+
+// Rolling view of one metric series, produced by SeriesStats
+struct SeriesSummary {
+    unsigned long long samples;
+    double mean;
+    double stddev;
+    double ewma_fast;
+    double ewma_medium;
+    double ewma_slow;
+    double p50;
+    double p95;
+    double p99;
+    
+    SeriesSummary() : samples(0), mean(0.0), stddev(0.0), ewma_fast(0.0), ewma_medium(0.0),
+                      ewma_slow(0.0), p50(0.0), p95(0.0), p99(0.0) {}
 };
 
 struct SystemMetrics {
@@ -21,10 +226,51 @@ struct SystemMetrics {
     long used_mem_kb;
     long available_mem_kb;
     double mem_usage_percent;
+    
+    // Attributable usage summed over the accounted processes
+    int accounted_processes;
+    long accounted_rss_kb;
+    long accounted_pss_kb;
+    long accounted_uss_kb;
+    long accounted_swap_kb;
+    
+    SeriesSummary cpu_summary;
+    SeriesSummary mem_summary;
+    CPUThermals cpu_thermals;
+    PagingRates paging;
+    MemoryForecast memory_forecast;
+    
     std::vector<ProcessInfo> top_processes;
+    std::vector<ProcessAnomaly> anomalies;
+    int process_count;
+    
+    // Only filled while cgroup tracking is enabled on the SystemMonitor
+    std::vector<CgroupInfo> top_cgroups;
+    int cgroup_count;
+    
+    // Only filled while tree tracking is enabled on the SystemMonitor:
+    // depth-first, siblings by subtree CPU
+    std::vector<SubtreeInfo> process_tree;
+    
+    // Only filled while scheduler tracking is enabled on the SystemMonitor
+    std::vector<SchedInfo> top_sched;
+    std::vector<CPUSchedInfo> cpu_sched;
+    double runqueue_waiting;    // Average tasks runnable but not running
+    
+    // Only filled while NUMA tracking is enabled on the SystemMonitor;
+    // placements (largest processes first) only on multi-node hosts
+    std::vector<NumaNodeInfo> numa_nodes;
+    std::vector<NumaPlacement> numa_placements;
+    
+    // Full snapshot owned by the SystemMonitor; valid until the next collectMetrics()
+    const ProcessTable* process_table;
+    const SnapshotDelta* delta;
     
     SystemMetrics() : cpu_usage(0.0), total_mem_kb(0), used_mem_kb(0), 
-                     available_mem_kb(0), mem_usage_percent(0.0) {}
+                     available_mem_kb(0), mem_usage_percent(0.0),
+                     accounted_processes(0), accounted_rss_kb(0), accounted_pss_kb(0),
+                     accounted_uss_kb(0), accounted_swap_kb(0), process_count(0), cgroup_count(0),
+                     runqueue_waiting(0.0), process_table(nullptr), delta(nullptr) {}
 };
 
 #endif // PROCESSINFO_H
@@ -0,0 +1,345 @@
+#include "ProcessTable.h"
+#include "ProcessFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// NamePool
+// ---------------------------------------------------------------------------
+
+uint32_t NamePool::intern(const char* data, size_t len) {
+    // scratch keeps its capacity, so building the lookup key is free once
+    // it has seen the longest name
+    scratch.assign(data, len);
+
+    auto it = ids.find(scratch);
+    if (it != ids.end()) {
+        refs[it->second]++;
+        return it->second;
+    }
+
+    uint32_t id;
+    if (!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+        names[id] = scratch;
+        refs[id] = 1;
+    } else {
+        id = static_cast<uint32_t>(names.size());
+        names.push_back(scratch);
+        refs.push_back(1);
+    }
+
+    ids.emplace(scratch, id);
+    return id;
+}
+
+void NamePool::release(uint32_t id) {
+    if (--refs[id] > 0) return;
+
+    ids.erase(names[id]);
+    free_ids.push_back(id);
+}
+
+bool NamePool::equals(uint32_t id, const char* data, size_t len) const {
+    const std::string& name = names[id];
+    return name.size() == len && std::memcmp(name.data(), data, len) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// ProcessTable
+// ---------------------------------------------------------------------------
+
+ProcessTable::ProcessTable()
+    : filter(nullptr), filtered(0), generation(0), total_diff(0), cpu_count(1), interval(0.0),
+      cpu_epsilon(1.0),
+      rss_epsilon_kb(1024) {}
+
+void ProcessTable::setDeltaEpsilon(double cpu_percent, long rss_kb) {
+    cpu_epsilon = cpu_percent;
+    rss_epsilon_kb = rss_kb;
+}
+
+void ProcessTable::setFilter(const ProcessFilter* value) {
+    filter = value && !value->empty() ? value : nullptr;
+    outside.clear();
+}
+
+void ProcessTable::beginScan(long total_ticks_diff, unsigned int cpus, double interval_sec) {
+    generation++;
+    filtered = 0;
+    total_diff = total_ticks_diff;
+    cpu_count = cpus > 0 ? cpus : 1;
+    interval = interval_sec;
+
+    delta.clear();
+    delta.sequence = generation;
+}
+
+void ProcessTable::recordSpawn(size_t row) {
+    delta.spawned.push_back(ProcessInfo());
+    fill(row, delta.spawned.back());
+    reported_cpu[row] = cpu[row];
+    reported_rss[row] = rss[row];
+    reported_priority[row] = priority[row];
+}
+
+void ProcessTable::recordExit(size_t row) {
+    delta.exited.push_back(ProcessInfo());
+    fill(row, delta.exited.back());
+}
+
+double ProcessTable::rate(long ticks, long previous_ticks) const {
+    if (ticks > 0 && total_diff > 0 && ticks >= previous_ticks) {
+        return 100.0 * (ticks - previous_ticks) * cpu_count / total_diff;
+    }
+    return 0.0;
+}
+
+bool ProcessTable::admit(const Platform::ProcessSample& sample, int row, int& uid,
+                         double& rate_known) {
+    ProcessFilter::Candidate candidate;
+    candidate.pid = sample.pid;
+    candidate.ppid = sample.ppid;
+    candidate.name = sample.name;
+    candidate.name_len = sample.name_len;
+    candidate.rss_kb = sample.memory_kb;
+    candidate.priority = sample.priority;
+    candidate.cpu = 0.0;
+    candidate.uid = -1;
+
+    bool track = filter->usesCPU() || filter->usesUser();
+    auto previous = outside.end();
+    if (row >= 0) {
+        candidate.cpu = rate(sample.cpu_ticks, cpu_ticks[row]);
+        // An exec may have switched owners (setuid binaries)
+        if (names.equals(name_ids[row], sample.name, sample.name_len)) candidate.uid = uids[row];
+    } else if (track) {
+        previous = outside.find(sample.pid);
+        if (previous != outside.end()) {
+            candidate.cpu = rate(sample.cpu_ticks, previous->second.cpu_ticks);
+            candidate.uid = previous->second.uid;
+        }
+    }
+
+    if (filter->matches(candidate)) {
+        uid = candidate.uid;
+        rate_known = candidate.cpu;
+        if (previous != outside.end()) outside.erase(previous);
+        return true;
+    }
+
+    filtered++;
+    if (track) {
+        Outside& entry = previous != outside.end() ? previous->second : outside[sample.pid];
+        entry.cpu_ticks = sample.cpu_ticks;
+        entry.uid = candidate.uid;
+        entry.seen = generation;
+    }
+    return false;
+}
+
+void ProcessTable::visit(const Platform::ProcessSample& sample) {
+    auto it = rows.find(sample.pid);
+
+    // Rows that fail are not marked seen, so endScan() retires them
+    int uid = -1;
+    double rate_known = 0.0;
+    if (filter && !admit(sample, it != rows.end() ? static_cast<int>(it->second) : -1, uid,
+                         rate_known)) {
+        return;
+    }
+
+    if (it == rows.end()) {
+        rows.emplace(sample.pid, static_cast<uint32_t>(pids.size()));
+        pids.push_back(sample.pid);
+        ppids.push_back(sample.ppid);
+        // Known when the process was followed outside the filter before
+        cpu.push_back(rate_known);
+        rss.push_back(sample.memory_kb);
+        priority.push_back(sample.priority);
+        name_ids.push_back(names.intern(sample.name, sample.name_len));
+        cpu_ticks.push_back(sample.cpu_ticks);
+        major_faults.push_back(sample.major_faults);
+        fault_rate.push_back(0.0f);
+        seen.push_back(generation);
+        uids.push_back(uid);
+        reported_cpu.push_back(0.0);
+        reported_rss.push_back(0);
+        reported_priority.push_back(0);
+        recordSpawn(pids.size() - 1);
+        return;
+    }
+
+    size_t row = it->second;
+
+    // Only an exec changes the name of a live PID; consumers see it as the
+    // old image exiting and the new one spawning
+    bool exec = false;
+    if (!names.equals(name_ids[row], sample.name, sample.name_len)) {
+        recordExit(row);
+        uint32_t id = names.intern(sample.name, sample.name_len);
+        names.release(name_ids[row]);
+        name_ids[row] = id;
+        exec = true;
+    }
+
+    cpu[row] = rate(sample.cpu_ticks, cpu_ticks[row]);
+    rss[row] = sample.memory_kb;
+    priority[row] = sample.priority;
+    cpu_ticks[row] = sample.cpu_ticks;
+    fault_rate[row] = interval > 0.0 && sample.major_faults >= major_faults[row]
+        ? static_cast<float>((sample.major_faults - major_faults[row]) / interval) : 0.0f;
+    major_faults[row] = sample.major_faults;
+    seen[row] = generation;
+    uids[row] = uid;
+    
+    if (ppids[row] != sample.ppid) {
+        ppids[row] = sample.ppid;
+        if (!exec) delta.reparented.push_back(sample.pid);
+    }
+
+    if (exec) {
+        recordSpawn(row);
+        return;
+    }
+
+    if (std::fabs(cpu[row] - reported_cpu[row]) > cpu_epsilon ||
+        std::labs(rss[row] - reported_rss[row]) > rss_epsilon_kb ||
+        priority[row] != reported_priority[row]) {
+        ProcessChange change;
+        change.pid = pids[row];
+        change.cpu_usage = cpu[row];
+        change.memory_kb = rss[row];
+        change.priority = priority[row];
+        delta.changed.push_back(change);
+
+        reported_cpu[row] = cpu[row];
+        reported_rss[row] = rss[row];
+        reported_priority[row] = priority[row];
+    }
+}
+
+void ProcessTable::removeRow(size_t row) {
+    size_t last = pids.size() - 1;
+
+    recordExit(row);
+    names.release(name_ids[row]);
+    rows.erase(pids[row]);
+
+    if (row != last) {
+        pids[row] = pids[last];
+        ppids[row] = ppids[last];
+        cpu[row] = cpu[last];
+        rss[row] = rss[last];
+        priority[row] = priority[last];
+        name_ids[row] = name_ids[last];
+        cpu_ticks[row] = cpu_ticks[last];
+        major_faults[row] = major_faults[last];
+        fault_rate[row] = fault_rate[last];
+        seen[row] = seen[last];
+        uids[row] = uids[last];
+        reported_cpu[row] = reported_cpu[last];
+        reported_rss[row] = reported_rss[last];
+        reported_priority[row] = reported_priority[last];
+        rows[pids[row]] = static_cast<uint32_t>(row);
+    }
+
+    pids.pop_back();
+    ppids.pop_back();
+    cpu.pop_back();
+    rss.pop_back();
+    priority.pop_back();
+    name_ids.pop_back();
+    cpu_ticks.pop_back();
+    major_faults.pop_back();
+    fault_rate.pop_back();
+    seen.pop_back();
+    uids.pop_back();
+    reported_cpu.pop_back();
+    reported_rss.pop_back();
+    reported_priority.pop_back();
+}
+
+void ProcessTable::endScan() {
+    for (auto it = outside.begin(); it != outside.end();) {
+        if (it->second.seen != generation) {
+            it = outside.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    size_t row = 0;
+    while (row < pids.size()) {
+        if (seen[row] != generation) {
+            // The last row moves into this slot; examine it before advancing
+            removeRow(row);
+        } else {
+            row++;
+        }
+    }
+}
+
+template <typename Less>
+void ProcessTable::rankRange(std::vector<uint32_t>& order, size_t first, size_t last,
+                             Less less) const {
+    order.resize(pids.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<uint32_t>(i);
+
+    last = std::min(last, order.size());
+    if (first >= last) return;
+    if (first > 0) std::nth_element(order.begin(), order.begin() + first, order.end(), less);
+    std::partial_sort(order.begin() + first, order.begin() + last, order.end(), less);
+}
+
+void ProcessTable::rank(SortKey key, std::vector<uint32_t>& order, size_t top) const {
+    rank(key, order, 0, top);
+}
+
+void ProcessTable::rank(SortKey key, std::vector<uint32_t>& order, size_t first,
+                        size_t last) const {
+    switch (key) {
+        case SortKey::CPU:
+            rankRange(order, first, last, [this](uint32_t a, uint32_t b) {
+                return cpu[a] != cpu[b] ? cpu[a] > cpu[b] : pids[a] < pids[b];
+            });
+            break;
+        case SortKey::RSS:
+            rankRange(order, first, last, [this](uint32_t a, uint32_t b) {
+                return rss[a] != rss[b] ? rss[a] > rss[b] : pids[a] < pids[b];
+            });
+            break;
+        case SortKey::PID:
+            rankRange(order, first, last, [this](uint32_t a, uint32_t b) {
+                return pids[a] < pids[b];
+            });
+            break;
+        case SortKey::NAME:
+            rankRange(order, first, last, [this](uint32_t a, uint32_t b) {
+                const std::string& na = names.get(name_ids[a]);
+                const std::string& nb = names.get(name_ids[b]);
+                return na != nb ? na < nb : pids[a] < pids[b];
+            });
+            break;
+    }
+}
+
+bool ProcessTable::find(int pid, size_t& row) const {
+    auto it = rows.find(pid);
+    if (it == rows.end()) return false;
+    row = it->second;
+    return true;
+}
+
+void ProcessTable::fill(size_t row, ProcessInfo& info) const {
+    info.pid = pids[row];
+    info.ppid = ppids[row];
+    info.name = names.get(name_ids[row]);
+    info.cpu_usage = cpu[row];
+    info.memory_kb = rss[row];
+    info.priority = priority[row];
+    info.major_fault_rate = fault_rate[row];
+}
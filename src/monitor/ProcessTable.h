@@ -0,0 +1,157 @@
+#ifndef PROCESSTABLE_H
+#define PROCESSTABLE_H
+
+#include "ProcessInfo.h"
+#include "SnapshotDelta.h"
+#include "../platform/Platform.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ProcessFilter;
+
+// Reference-counted string interning for process names. Names are only
+// copied into the pool when a new PID appears or a process execs; steady
+// state ticks just compare bytes against the pooled copy.
+class NamePool {
+private:
+    std::vector<std::string> names;
+    std::vector<uint32_t> refs;
+    std::vector<uint32_t> free_ids;
+    std::unordered_map<std::string, uint32_t> ids;
+    std::string scratch;
+
+public:
+    uint32_t intern(const char* data, size_t len);
+    void release(uint32_t id);
+    bool equals(uint32_t id, const char* data, size_t len) const;
+    const std::string& get(uint32_t id) const { return names[id]; }
+    size_t size() const { return ids.size(); }
+};
+
+enum class SortKey {
+    CPU,
+    RSS,
+    PID,
+    NAME
+};
+
+// Persistent process snapshot in struct-of-arrays layout.
+//
+// Rows live across ticks: a scan updates existing rows in place, appends
+// rows for new PIDs and swap-removes rows for PIDs that were not seen. Each
+// column is a contiguous array so ranking and aggregation passes only touch
+// the fields they need. Row order is unspecified and changes on removal.
+//
+// The table is fed directly by Platform::scanProcesses() and is shared by
+// ranking, anomaly detection, accounting and rendering without copying.
+// Each scan also produces a SnapshotDelta (spawned, exited and changed
+// processes) as a by-product of the in-place updates.
+//
+// With a filter set, processes are tested as they are visited and the ones
+// that fail never become rows, so everything downstream only sees the
+// matching set. A row that stops matching leaves as an exit; a process
+// that starts matching arrives as a spawn.
+class ProcessTable : public Platform::ProcessVisitor {
+private:
+    // Enough of a filtered-out process to rate its CPU and keep its owner;
+    // only kept while the filter tests cpu or user
+    struct Outside {
+        long cpu_ticks;
+        int uid;
+        uint32_t seen;
+    };
+
+    std::vector<int> pids;
+    std::vector<int> ppids;
+    std::vector<double> cpu;
+    std::vector<long> rss;
+    std::vector<int> priority;
+    std::vector<uint32_t> name_ids;
+    std::vector<long> cpu_ticks;
+    std::vector<long> major_faults;     // Cumulative, from the stat line
+    std::vector<float> fault_rate;      // Major faults per second
+    std::vector<uint32_t> seen;
+    std::vector<int> uids;              // -1 until a filter asks
+
+    // Values as of the last emitted spawn/change event, for delta tracking
+    std::vector<double> reported_cpu;
+    std::vector<long> reported_rss;
+    std::vector<int> reported_priority;
+
+    std::unordered_map<int, uint32_t> rows;
+    NamePool names;
+    const ProcessFilter* filter;
+    std::unordered_map<int, Outside> outside;
+    size_t filtered;
+
+    uint32_t generation;
+    long total_diff;
+    unsigned int cpu_count;
+    double interval;
+
+    SnapshotDelta delta;
+    double cpu_epsilon;
+    long rss_epsilon_kb;
+
+    void removeRow(size_t row);
+    void recordExit(size_t row);
+    void recordSpawn(size_t row);
+    double rate(long ticks, long previous_ticks) const;
+    template <typename Less>
+    void rankRange(std::vector<uint32_t>& order, size_t first, size_t last, Less less) const;
+    bool admit(const Platform::ProcessSample& sample, int row, int& uid, double& rate_known);
+
+public:
+    ProcessTable();
+
+    // `total_ticks_diff` is the system-wide CPU tick delta since the last
+    // scan; per-process rates are expressed so one busy core reads 100%.
+    // `interval_sec` is the time since that scan, for fault rates (0 if
+    // unknown: rates read 0).
+    void beginScan(long total_ticks_diff, unsigned int cpus, double interval_sec = 0.0);
+    void visit(const Platform::ProcessSample& sample);
+    void endScan();
+
+    size_t size() const { return pids.size(); }
+
+    // Changes smaller than these are not reported in the delta
+    void setDeltaEpsilon(double cpu_percent, long rss_kb);
+    // Not owned; nullptr or an empty filter admits everything. Applies
+    // from the next scan.
+    void setFilter(const ProcessFilter* filter);
+    // Processes the filter kept out of the last scan
+    size_t getFilteredCount() const { return filtered; }
+    const SnapshotDelta& getDelta() const { return delta; }
+
+    // Fills `order` with row indices whose first `top` entries are sorted by
+    // `key` (descending for CPU/RSS, ascending for PID/name). The table
+    // itself is never reordered.
+    void rank(SortKey key, std::vector<uint32_t>& order, size_t top) const;
+    // Only positions [first, last) of the full order are placed and sorted,
+    // in O(n + (n - first) log(last - first)): one screen of a scrolled
+    // table costs about as much as the top of it. Ties break by PID so
+    // adjacent windows neither repeat nor skip rows.
+    void rank(SortKey key, std::vector<uint32_t>& order, size_t first, size_t last) const;
+
+    bool find(int pid, size_t& row) const;
+    void fill(size_t row, ProcessInfo& info) const;
+
+    int getPid(size_t row) const { return pids[row]; }
+    int getPpid(size_t row) const { return ppids[row]; }
+    double getCPU(size_t row) const { return cpu[row]; }
+    long getRSS(size_t row) const { return rss[row]; }
+    int getPriority(size_t row) const { return priority[row]; }
+    float getFaultRate(size_t row) const { return fault_rate[row]; }
+    const std::string& getName(size_t row) const { return names.get(name_ids[row]); }
+
+    const std::vector<int>& getPids() const { return pids; }
+    const std::vector<double>& getCPUColumn() const { return cpu; }
+    const std::vector<long>& getRSSColumn() const { return rss; }
+    const std::vector<int>& getPriorityColumn() const { return priority; }
+    const std::vector<float>& getFaultRateColumn() const { return fault_rate; }
+    const NamePool& getNamePool() const { return names; }
+};
+
+#endif // PROCESSTABLE_H
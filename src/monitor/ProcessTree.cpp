@@ -0,0 +1,285 @@
+#include "ProcessTree.h"
+#include <algorithm>
+
+const uint32_t ProcessTree::NONE;
+const unsigned long ProcessTree::REBUILD_EVERY;
+
+namespace {
+    // Slots let roots and child lists drop an entry in O(1)
+    void removeSlot(std::vector<uint32_t>& list, uint32_t slot, uint32_t& moved) {
+        moved = list.back();
+        list[slot] = moved;
+        list.pop_back();
+    }
+}
+
+ProcessTree::ProcessTree() : last_sequence(0), updates_since_rebuild(0), synced(false) {}
+
+uint32_t ProcessTree::insert(int pid, int ppid) {
+    uint32_t id;
+    if (!free_nodes.empty()) {
+        id = free_nodes.back();
+        free_nodes.pop_back();
+    } else {
+        id = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node());
+    }
+
+    Node& node = nodes[id];
+    node.pid = pid;
+    node.ppid = ppid;
+    node.parent = NONE;
+    node.slot = static_cast<uint32_t>(roots.size());
+    node.children.clear();
+    node.cpu = 0.0;
+    node.rss_kb = 0;
+    node.subtree_cpu = 0.0;
+    node.subtree_rss_kb = 0;
+    node.subtree_count = 1;
+
+    roots.push_back(id);
+    index[pid] = id;
+    pending.push_back(id);
+    return id;
+}
+
+void ProcessTree::propagate(uint32_t from, double cpu, long rss_kb, int count) {
+    for (uint32_t id = from; id != NONE; id = nodes[id].parent) {
+        Node& node = nodes[id];
+        node.subtree_cpu += cpu;
+        node.subtree_rss_kb += rss_kb;
+        node.subtree_count += count;
+    }
+}
+
+void ProcessTree::attach(uint32_t id) {
+    Node& node = nodes[id];
+    if (node.parent != NONE) return;
+
+    auto it = index.find(node.ppid);
+    if (it == index.end() || node.ppid == node.pid) return;
+    uint32_t parent = it->second;
+
+    // A reused PID can make a stale ppid point into the node's own subtree
+    for (uint32_t up = parent; up != NONE; up = nodes[up].parent) {
+        if (up == id) return;
+    }
+
+    uint32_t moved;
+    removeSlot(roots, node.slot, moved);
+    nodes[moved].slot = node.slot;
+
+    node.parent = parent;
+    node.slot = static_cast<uint32_t>(nodes[parent].children.size());
+    nodes[parent].children.push_back(id);
+    propagate(parent, node.subtree_cpu, node.subtree_rss_kb, node.subtree_count);
+}
+
+void ProcessTree::detach(uint32_t id) {
+    Node& node = nodes[id];
+    if (node.parent == NONE) return;
+
+    propagate(node.parent, -node.subtree_cpu, -node.subtree_rss_kb, -node.subtree_count);
+    uint32_t moved;
+    removeSlot(nodes[node.parent].children, node.slot, moved);
+    nodes[moved].slot = node.slot;
+
+    node.parent = NONE;
+    node.slot = static_cast<uint32_t>(roots.size());
+    roots.push_back(id);
+}
+
+void ProcessTree::remove(uint32_t id) {
+    detach(id);
+
+    // Orphans are roots until their reparent shows up
+    Node& node = nodes[id];
+    for (uint32_t child : node.children) {
+        nodes[child].parent = NONE;
+        nodes[child].slot = static_cast<uint32_t>(roots.size());
+        roots.push_back(child);
+        pending.push_back(child);
+    }
+    node.children.clear();
+
+    uint32_t moved;
+    removeSlot(roots, node.slot, moved);
+    nodes[moved].slot = node.slot;
+
+    index.erase(node.pid);
+    free_nodes.push_back(id);
+}
+
+void ProcessTree::rebuild(const ProcessTable& processes) {
+    nodes.clear();
+    free_nodes.clear();
+    index.clear();
+    roots.clear();
+    pending.clear();
+
+    for (size_t row = 0; row < processes.size(); row++) {
+        insert(processes.getPid(row), processes.getPpid(row));
+    }
+    for (uint32_t id : pending) {
+        attach(id);
+    }
+    pending.clear();
+    updates_since_rebuild = 0;
+    synced = true;
+}
+
+void ProcessTree::applyValues(const ProcessTable& processes) {
+    for (size_t row = 0; row < processes.size(); row++) {
+        auto it = index.find(processes.getPid(row));
+        if (it == index.end()) continue;
+
+        Node& node = nodes[it->second];
+        double cpu = processes.getCPU(row) - node.cpu;
+        long rss_kb = processes.getRSS(row) - node.rss_kb;
+        if (cpu == 0.0 && rss_kb == 0) continue;
+
+        node.cpu += cpu;
+        node.rss_kb += rss_kb;
+        propagate(it->second, cpu, rss_kb, 0);
+    }
+}
+
+void ProcessTree::update(const ProcessTable& processes, const SnapshotDelta& delta) {
+    // A missed tick means missed links; rebuilding also resets the sums
+    if (!synced || delta.sequence != last_sequence + 1 || ++updates_since_rebuild >= REBUILD_EVERY) {
+        rebuild(processes);
+    } else {
+        // Exits first: an exec is reported as exit + spawn of the same PID
+        for (const auto& proc : delta.exited) {
+            auto it = index.find(proc.pid);
+            if (it != index.end()) remove(it->second);
+        }
+        for (const auto& proc : delta.spawned) {
+            if (index.find(proc.pid) == index.end()) insert(proc.pid, proc.ppid);
+        }
+        for (int pid : delta.reparented) {
+            auto it = index.find(pid);
+            size_t row;
+            if (it == index.end() || !processes.find(pid, row)) continue;
+            detach(it->second);
+            nodes[it->second].ppid = processes.getPpid(row);
+            pending.push_back(it->second);
+        }
+
+        for (uint32_t id : pending) {
+            // Skip nodes freed after they were queued
+            auto it = index.find(nodes[id].pid);
+            if (it != index.end() && it->second == id) attach(id);
+        }
+        pending.clear();
+    }
+    last_sequence = delta.sequence;
+
+    applyValues(processes);
+}
+
+void ProcessTree::reset() {
+    synced = false;
+}
+
+void ProcessTree::sortedChildren(const std::vector<uint32_t>& ids, size_t limit,
+                                 std::vector<uint32_t>& out) const {
+    out = ids;
+    limit = std::min(limit, out.size());
+    std::partial_sort(out.begin(), out.begin() + limit, out.end(),
+                      [this](uint32_t a, uint32_t b) {
+                          const Node& na = nodes[a];
+                          const Node& nb = nodes[b];
+                          if (na.subtree_cpu != nb.subtree_cpu) return na.subtree_cpu > nb.subtree_cpu;
+                          return na.subtree_rss_kb > nb.subtree_rss_kb;
+                      });
+    out.resize(limit);
+}
+
+void ProcessTree::fill(const ProcessTable& processes, const Node& node, int depth,
+                       SubtreeInfo& info) const {
+    size_t row;
+    info.pid = node.pid;
+    info.name = processes.find(node.pid, row) ? processes.getName(row) : std::string();
+    info.depth = depth;
+    info.cpu_usage = node.cpu;
+    // Incremental sums can drift a hair below zero between rebuilds
+    info.subtree_cpu = std::max(0.0, node.subtree_cpu);
+    info.subtree_rss_kb = std::max(0L, node.subtree_rss_kb);
+    info.subtree_processes = node.subtree_count;
+    info.hidden_children = 0;
+}
+
+void ProcessTree::appendRows(const ProcessTable& processes, uint32_t id, int depth, int max_depth,
+                             size_t max_children, size_t max_rows,
+                             std::vector<SubtreeInfo>& rows) const {
+    const Node& node = nodes[id];
+    size_t self = rows.size();
+    rows.push_back(SubtreeInfo());
+    fill(processes, node, depth, rows[self]);
+    if (node.children.empty()) return;
+
+    size_t shown = 0;
+    if (depth < max_depth) {
+        std::vector<uint32_t> children;
+        sortedChildren(node.children, max_children, children);
+        for (uint32_t child : children) {
+            if (rows.size() >= max_rows) break;
+            appendRows(processes, child, depth + 1, max_depth, max_children, max_rows, rows);
+            shown++;
+        }
+    }
+    rows[self].hidden_children = static_cast<int>(node.children.size() - shown);
+}
+
+void ProcessTree::collect(const ProcessTable& processes, int max_depth, size_t max_children,
+                          size_t max_rows, std::vector<SubtreeInfo>& rows) const {
+    rows.clear();
+    sortedChildren(roots, roots.size(), order);
+    for (uint32_t id : order) {
+        if (rows.size() >= max_rows) break;
+        appendRows(processes, id, 0, max_depth, max_children, max_rows, rows);
+    }
+}
+
+void ProcessTree::collectHeavy(const ProcessTable& processes, uint32_t id, double threshold,
+                               std::vector<SubtreeInfo>& out) const {
+    const Node& node = nodes[id];
+    if (node.subtree_cpu <= threshold) return;
+
+    bool heavy_child = false;
+    for (uint32_t child : node.children) {
+        if (nodes[child].subtree_cpu > threshold) {
+            heavy_child = true;
+            collectHeavy(processes, child, threshold, out);
+        }
+    }
+    if (heavy_child || node.cpu > threshold || node.subtree_count < 2 || node.pid == 1) return;
+
+    out.push_back(SubtreeInfo());
+    fill(processes, node, 0, out.back());
+}
+
+void ProcessTree::findHeavySubtrees(const ProcessTable& processes, double threshold,
+                                    std::vector<SubtreeInfo>& out) const {
+    out.clear();
+    for (uint32_t id : roots) {
+        // kthreadd parents every kernel thread
+        if (nodes[id].pid == 2) continue;
+        collectHeavy(processes, id, threshold, out);
+    }
+}
+
+bool ProcessTree::getSubtree(int pid, std::vector<int>& pids) const {
+    auto it = index.find(pid);
+    if (it == index.end()) return false;
+
+    std::vector<uint32_t> stack(1, it->second);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        pids.push_back(node.pid);
+        stack.insert(stack.end(), node.children.begin(), node.children.end());
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+#ifndef PROCESSTREE_H
+#define PROCESSTREE_H
+
+#include "ProcessInfo.h"
+#include "ProcessTable.h"
+#include "SnapshotDelta.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Parent/child index over the process table, with CPU and RSS rolled up
+// per subtree.
+//
+// Links only change on the delta's spawns, exits and reparents. Each tick
+// then pushes every process's change in CPU/RSS up its ancestor chain, so
+// subtree totals are maintained rather than recomputed (a periodic rebuild
+// drops accumulated rounding). Processes whose parent is not visible are
+// roots; children of an exiting process stay roots until their reparent
+// (or the parent PID's re-spawn on exec) is seen.
+class ProcessTree {
+private:
+    static const uint32_t NONE = 0xffffffffu;
+    static const unsigned long REBUILD_EVERY = 3600;
+
+    struct Node {
+        int pid;
+        int ppid;
+        uint32_t parent;
+        uint32_t slot;          // Position in the parent's children, or in roots
+        std::vector<uint32_t> children;
+        double cpu;             // Own values as last applied
+        long rss_kb;
+        double subtree_cpu;     // Including this process
+        long subtree_rss_kb;
+        int subtree_count;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> free_nodes;
+    std::unordered_map<int, uint32_t> index;
+    std::vector<uint32_t> roots;
+    std::vector<uint32_t> pending;
+    mutable std::vector<uint32_t> order;
+    unsigned long last_sequence;
+    unsigned long updates_since_rebuild;
+    bool synced;
+
+    uint32_t insert(int pid, int ppid);
+    void remove(uint32_t id);
+    void attach(uint32_t id);
+    void detach(uint32_t id);
+    void propagate(uint32_t from, double cpu, long rss_kb, int count);
+    void rebuild(const ProcessTable& processes);
+    void applyValues(const ProcessTable& processes);
+    void sortedChildren(const std::vector<uint32_t>& ids, size_t limit,
+                        std::vector<uint32_t>& out) const;
+    void appendRows(const ProcessTable& processes, uint32_t id, int depth, int max_depth,
+                    size_t max_children, size_t max_rows, std::vector<SubtreeInfo>& rows) const;
+    void fill(const ProcessTable& processes, const Node& node, int depth, SubtreeInfo& info) const;
+    void collectHeavy(const ProcessTable& processes, uint32_t id, double threshold,
+                      std::vector<SubtreeInfo>& out) const;
+
+public:
+    ProcessTree();
+
+    // Applies this tick's spawns, exits and reparents, then the value changes
+    void update(const ProcessTable& processes, const SnapshotDelta& delta);
+
+    // Rebuilds from the table on the next update()
+    void reset();
+
+    // Depth-first rows, siblings by subtree CPU. Subtrees deeper than
+    // `max_depth`, siblings past `max_children` and anything past `max_rows`
+    // are folded into their parent's hidden_children.
+    void collect(const ProcessTable& processes, int max_depth, size_t max_children,
+                 size_t max_rows, std::vector<SubtreeInfo>& rows) const;
+
+    // The deepest subtrees whose combined CPU exceeds `threshold` while no
+    // single child subtree (nor the root process itself) does: load spread
+    // across a process family, like a build's compilers. init and kernel
+    // threads are never reported.
+    void findHeavySubtrees(const ProcessTable& processes, double threshold,
+                           std::vector<SubtreeInfo>& out) const;
+
+    // `pid` and all its descendants
+    bool getSubtree(int pid, std::vector<int>& pids) const;
+
+    size_t size() const { return index.size(); }
+    size_t getRootCount() const { return roots.size(); }
+};
+
+#endif // PROCESSTREE_H
@@ -0,0 +1,157 @@
+#include "SchedMonitor.h"
+#include <algorithm>
+#include <chrono>
+
+const size_t SchedMonitor::SWEEP_PER_TICK;
+
+SchedMonitor::SchedMonitor()
+    : cpu_read_ns(0), last_sequence(0), sweep_cursor(0), synced(false), available(true),
+      cpu_available(true), schedstat_reads(0) {}
+
+void SchedMonitor::readProcess(const ProcessTable& processes, uint32_t row, int64_t now_ns) {
+    int pid = processes.getPid(row);
+    Platform::SchedStats stats;
+    schedstat_reads++;
+    if (!Platform::getProcessSchedStats(pid, stats)) {
+        entries.erase(pid);
+        return;
+    }
+    available = true;
+
+    auto it = entries.find(pid);
+    if (it == entries.end()) {
+        Entry entry;
+        entry.last = stats;
+        entry.read_ns = now_ns;
+        entry.watched = false;
+        entries.insert(std::make_pair(pid, entry));
+        return;
+    }
+
+    Entry& entry = it->second;
+    double span_ns = static_cast<double>(now_ns - entry.read_ns);
+    long long waited = std::max(0LL, stats.wait_ns - entry.last.wait_ns);
+    long long slices = std::max(0LL, stats.timeslices - entry.last.timeslices);
+    entry.last = stats;
+    entry.read_ns = now_ns;
+    if (span_ns <= 0.0 || waited == 0) return;
+
+    Ranked ranking;
+    ranking.row = row;
+    ranking.delay_percent = 100.0 * waited / span_ns;
+    ranking.avg_wait_us = slices > 0 ? waited / 1000.0 / slices : 0.0;
+    ranking.slices_per_sec = slices / (span_ns / 1e9);
+    ranked.push_back(ranking);
+}
+
+void SchedMonitor::updateCPUs(int64_t now_ns, SystemMetrics& metrics) {
+    metrics.cpu_sched.clear();
+    metrics.runqueue_waiting = 0.0;
+    if (!Platform::getCPUSchedStats(cpu_current)) {
+        cpu_available = false;
+        cpu_last.clear();
+        return;
+    }
+    cpu_available = true;
+
+    // CPU hotplug changes the line count; start over rather than mismatch
+    double span_ns = static_cast<double>(now_ns - cpu_read_ns);
+    if (cpu_last.size() == cpu_current.size() && span_ns > 0.0) {
+        metrics.cpu_sched.resize(cpu_current.size());
+        for (size_t i = 0; i < cpu_current.size(); i++) {
+            long long ran = std::max(0LL, cpu_current[i].run_ns - cpu_last[i].run_ns);
+            long long waited = std::max(0LL, cpu_current[i].wait_ns - cpu_last[i].wait_ns);
+            long long slices = std::max(0LL, cpu_current[i].timeslices - cpu_last[i].timeslices);
+
+            CPUSchedInfo& info = metrics.cpu_sched[i];
+            info.busy_percent = std::min(100.0, 100.0 * ran / span_ns);
+            info.wait_percent = 100.0 * waited / span_ns;
+            info.avg_wait_us = slices > 0 ? waited / 1000.0 / slices : 0.0;
+            metrics.runqueue_waiting += waited / span_ns;
+        }
+    }
+    cpu_last.swap(cpu_current);
+    cpu_read_ns = now_ns;
+}
+
+void SchedMonitor::watch(const ProcessTable& processes, size_t shown) {
+    for (int pid : watched_pids) {
+        auto it = entries.find(pid);
+        if (it != entries.end()) it->second.watched = false;
+    }
+    watched_pids.clear();
+    for (size_t i = 0; i < shown; i++) {
+        int pid = processes.getPid(ranked[i].row);
+        auto it = entries.find(pid);
+        if (it == entries.end()) continue;
+        it->second.watched = true;
+        watched_pids.push_back(pid);
+    }
+}
+
+void SchedMonitor::update(const ProcessTable& processes, const SnapshotDelta& delta,
+                          size_t top, SystemMetrics& metrics) {
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // A missed tick means missed exits, and PIDs may have been reused
+    if (!synced || delta.sequence != last_sequence + 1) {
+        entries.clear();
+        synced = true;
+    } else {
+        for (const auto& proc : delta.exited) {
+            entries.erase(proc.pid);
+        }
+    }
+    last_sequence = delta.sequence;
+
+    ranked.clear();
+    available = false;
+    size_t count = processes.size();
+    size_t sweep = std::min(SWEEP_PER_TICK, count);
+    if (sweep_cursor >= count) sweep_cursor = 0;
+    size_t sweep_end = sweep_cursor + sweep;
+
+    // Waiting without running at all is rare; the sweep finds it and the
+    // watch list keeps it in view
+    const std::vector<double>& cpu = processes.getCPUColumn();
+    for (size_t row = 0; row < count; row++) {
+        bool swept = (row >= sweep_cursor && row < sweep_end) || row + count < sweep_end;
+        bool read = cpu[row] > 0.0 || swept;
+        if (!read) {
+            auto it = entries.find(processes.getPid(row));
+            read = it == entries.end() || it->second.watched;
+        }
+        if (read) readProcess(processes, static_cast<uint32_t>(row), now_ns);
+    }
+    sweep_cursor = sweep_end >= count ? sweep_end - count : sweep_end;
+
+    size_t shown = std::min(top, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + shown, ranked.end(),
+                      [](const Ranked& a, const Ranked& b) {
+                          return a.delay_percent > b.delay_percent;
+                      });
+
+    watch(processes, shown);
+
+    metrics.top_sched.resize(shown);
+    for (size_t i = 0; i < shown; i++) {
+        SchedInfo& info = metrics.top_sched[i];
+        uint32_t row = ranked[i].row;
+        info.pid = processes.getPid(row);
+        info.name = processes.getName(row);
+        info.cpu_usage = processes.getCPU(row);
+        info.delay_percent = ranked[i].delay_percent;
+        info.avg_wait_us = ranked[i].avg_wait_us;
+        info.slices_per_sec = ranked[i].slices_per_sec;
+    }
+
+    updateCPUs(now_ns, metrics);
+}
+
+void SchedMonitor::reset() {
+    entries.clear();
+    watched_pids.clear();
+    cpu_last.clear();
+    synced = false;
+}
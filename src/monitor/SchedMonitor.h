@@ -0,0 +1,73 @@
+#ifndef SCHEDMONITOR_H
+#define SCHEDMONITOR_H
+
+#include "ProcessInfo.h"
+#include "ProcessTable.h"
+#include "SnapshotDelta.h"
+#include "../platform/Platform.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Run-queue contention from the kernel's schedstat counters.
+//
+// Per process, /proc/<pid>/schedstat is re-read only for processes that
+// used CPU this tick, the ones shown as most delayed last tick, and a small
+// round-robin sweep of the rest, so the cost follows the active set rather
+// than the table. A starved process (waiting, never running) is found by
+// the sweep and then followed every tick while it keeps waiting. The
+// counters are cumulative: a process skipped for a few ticks loses no wait
+// time, its rate just covers the longer span since its last read. Per CPU,
+// one read of /proc/schedstat gives each run queue's busy and wait time.
+class SchedMonitor {
+private:
+    static const size_t SWEEP_PER_TICK = 128;
+
+    struct Entry {
+        Platform::SchedStats last;
+        int64_t read_ns;
+        bool watched;           // Among last tick's top waiters
+    };
+
+    struct Ranked {
+        uint32_t row;
+        double delay_percent;
+        double avg_wait_us;
+        double slices_per_sec;
+    };
+
+    std::unordered_map<int, Entry> entries;
+    std::vector<Ranked> ranked;
+    std::vector<int> watched_pids;
+    std::vector<Platform::SchedStats> cpu_current;
+    std::vector<Platform::SchedStats> cpu_last;
+    int64_t cpu_read_ns;
+    unsigned long last_sequence;
+    size_t sweep_cursor;
+    bool synced;
+    bool available;
+    bool cpu_available;
+    unsigned long schedstat_reads;
+
+    void readProcess(const ProcessTable& processes, uint32_t row, int64_t now_ns);
+    void updateCPUs(int64_t now_ns, SystemMetrics& metrics);
+    void watch(const ProcessTable& processes, size_t shown);
+
+public:
+    SchedMonitor();
+
+    // Applies this tick's exits, re-reads the active processes and fills
+    // metrics.top_sched with the `top` most delayed, plus the per-CPU view
+    void update(const ProcessTable& processes, const SnapshotDelta& delta,
+                size_t top, SystemMetrics& metrics);
+
+    // Forgets every counter; rates restart from the next two reads
+    void reset();
+
+    bool isAvailable() const { return available; }
+    bool isCPUAvailable() const { return cpu_available; }
+    size_t getTrackedPids() const { return entries.size(); }
+    unsigned long getSchedstatReads() const { return schedstat_reads; }
+};
+
+#endif // SCHEDMONITOR_H
@@ -0,0 +1,45 @@
+#ifndef SNAPSHOTDELTA_H
+#define SNAPSHOTDELTA_H
+
+#include "ProcessInfo.h"
+#include <vector>
+
+// A process whose tracked fields moved past the configured epsilon since
+// they were last reported. The name is omitted: consumers learn it from the
+// spawn event (or a keyframe) and it only changes on exec, which is
+// reported as an exit followed by a spawn.
+struct ProcessChange {
+    int pid;
+    double cpu_usage;
+    long memory_kb;
+    int priority;
+};
+
+// What changed between two consecutive process scans. Building it costs
+// O(changes) on top of the scan itself; on a quiet host all three lists are
+// empty.
+struct SnapshotDelta {
+    unsigned long sequence;
+    std::vector<ProcessInfo> spawned;
+    std::vector<ProcessInfo> exited;    // Final stats as of the last scan that saw them
+    std::vector<ProcessChange> changed;
+    // PIDs whose parent changed (their parent exited, or setsid/daemonize).
+    // Not part of empty()/size(): recordings and the wire do not carry
+    // parents.
+    std::vector<int> reparented;
+
+    SnapshotDelta() : sequence(0) {}
+
+    bool empty() const { return spawned.empty() && exited.empty() && changed.empty(); }
+    size_t size() const { return spawned.size() + exited.size() + changed.size(); }
+
+    // Keeps capacity so steady-state ticks do not reallocate
+    void clear() {
+        spawned.clear();
+        exited.clear();
+        changed.clear();
+        reparented.clear();
+    }
+};
+
+#endif // SNAPSHOTDELTA_H
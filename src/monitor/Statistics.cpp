@@ -0,0 +1,205 @@
+#include "Statistics.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// ---------------------------------------------------------------------------
+// RunningStats
+// ---------------------------------------------------------------------------
+
+RunningStats::RunningStats() {
+    reset();
+}
+
+void RunningStats::reset() {
+    n = 0;
+    m = 0.0;
+    m2 = 0.0;
+    min_val = std::numeric_limits<double>::infinity();
+    max_val = -std::numeric_limits<double>::infinity();
+}
+
+void RunningStats::add(double x) {
+    n++;
+    double delta = x - m;
+    m += delta / n;
+    m2 += delta * (x - m);
+    if (x < min_val) min_val = x;
+    if (x > max_val) max_val = x;
+}
+
+void RunningStats::merge(const RunningStats& other) {
+    if (other.n == 0) return;
+    if (n == 0) {
+        *this = other;
+        return;
+    }
+
+    uint64_t combined = n + other.n;
+    double delta = other.m - m;
+    m += delta * other.n / combined;
+    m2 += other.m2 + delta * delta * (static_cast<double>(n) * other.n / combined);
+    n = combined;
+    min_val = std::min(min_val, other.min_val);
+    max_val = std::max(max_val, other.max_val);
+}
+
+double RunningStats::stddev() const {
+    return std::sqrt(variance());
+}
+
+// ---------------------------------------------------------------------------
+// Ewma
+// ---------------------------------------------------------------------------
+
+Ewma::Ewma(double horizon)
+    : alpha(2.0 / (std::max(horizon, 1.0) + 1.0)), val(0.0), initialized(false) {}
+
+void Ewma::add(double x) {
+    if (!initialized) {
+        val = x;
+        initialized = true;
+        return;
+    }
+    val += alpha * (x - val);
+}
+
+// ---------------------------------------------------------------------------
+// QuantileSketch
+// ---------------------------------------------------------------------------
+
+const double QuantileSketch::MIN_TRACKED = 1e-6;
+
+QuantileSketch::QuantileSketch(double accuracy)
+    : gamma((1.0 + accuracy) / (1.0 - accuracy)), log_gamma(std::log(gamma)),
+      accuracy(accuracy), offset(0), zero_count(0), total(0) {}
+
+int QuantileSketch::bucketIndex(double x) const {
+    return static_cast<int>(std::ceil(std::log(x) / log_gamma));
+}
+
+void QuantileSketch::ensureBucket(int index) {
+    if (buckets.empty()) {
+        buckets.assign(1, 0);
+        offset = index;
+        return;
+    }
+
+    if (index < offset) {
+        buckets.insert(buckets.begin(), offset - index, 0);
+        offset = index;
+    } else if (index >= offset + static_cast<int>(buckets.size())) {
+        buckets.resize(index - offset + 1, 0);
+    }
+}
+
+void QuantileSketch::add(double x) {
+    total++;
+    if (!(x > MIN_TRACKED)) {
+        zero_count++;
+        return;
+    }
+
+    int index = bucketIndex(x);
+    ensureBucket(index);
+    buckets[index - offset]++;
+}
+
+void QuantileSketch::remove(double x) {
+    if (total == 0) return;
+    if (!(x > MIN_TRACKED)) {
+        if (zero_count > 0) {
+            zero_count--;
+            total--;
+        }
+        return;
+    }
+
+    int index = bucketIndex(x) - offset;
+    if (index >= 0 && index < static_cast<int>(buckets.size()) && buckets[index] > 0) {
+        buckets[index]--;
+        total--;
+    }
+}
+
+bool QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.gamma != gamma) return false;
+
+    zero_count += other.zero_count;
+    total += other.total;
+
+    if (other.buckets.empty()) return true;
+
+    ensureBucket(other.offset);
+    ensureBucket(other.offset + static_cast<int>(other.buckets.size()) - 1);
+    for (size_t i = 0; i < other.buckets.size(); i++) {
+        buckets[other.offset + i - offset] += other.buckets[i];
+    }
+    return true;
+}
+
+void QuantileSketch::reset() {
+    buckets.clear();
+    offset = 0;
+    zero_count = 0;
+    total = 0;
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (total == 0) return 0.0;
+
+    q = std::min(1.0, std::max(0.0, q));
+    uint64_t rank = static_cast<uint64_t>(q * (total - 1));
+
+    if (rank < zero_count) return 0.0;
+
+    uint64_t seen = zero_count;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen > rank) {
+            // Midpoint (in relative terms) of the bucket's range
+            int index = offset + static_cast<int>(i);
+            return 2.0 * std::pow(gamma, index) / (gamma + 1.0);
+        }
+    }
+
+    return 2.0 * std::pow(gamma, offset + static_cast<int>(buckets.size()) - 1) / (gamma + 1.0);
+}
+
+// ---------------------------------------------------------------------------
+// SeriesStats
+// ---------------------------------------------------------------------------
+
+SeriesStats::SeriesStats() : fast(10.0), medium(60.0), slow(300.0) {}
+
+void SeriesStats::add(double x) {
+    lifetime.add(x);
+    fast.add(x);
+    medium.add(x);
+    slow.add(x);
+    sketch.add(x);
+}
+
+void SeriesStats::reset() {
+    lifetime.reset();
+    fast.reset();
+    medium.reset();
+    slow.reset();
+    sketch.reset();
+}
+
+SeriesSummary SeriesStats::summarize() const {
+    SeriesSummary summary;
+    summary.samples = lifetime.count();
+    if (summary.samples == 0) return summary;
+
+    summary.mean = lifetime.mean();
+    summary.stddev = lifetime.stddev();
+    summary.ewma_fast = fast.value();
+    summary.ewma_medium = medium.value();
+    summary.ewma_slow = slow.value();
+    summary.p50 = sketch.quantile(0.50);
+    summary.p95 = sketch.quantile(0.95);
+    summary.p99 = sketch.quantile(0.99);
+    return summary;
+}
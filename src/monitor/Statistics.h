@@ -0,0 +1,108 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include "ProcessInfo.h"
+#include <cstdint>
+#include <vector>
+
+// Online statistics with O(1) updates per sample. Nothing here keeps the
+// raw samples around, so every estimator is usable from the first tick and
+// stays cheap on arbitrarily long runs.
+
+// Welford mean/variance. Two instances can be merged (Chan et al.), which
+// lets per-interval accumulators be combined into wider windows.
+class RunningStats {
+private:
+    uint64_t n;
+    double m;
+    double m2;
+    double min_val;
+    double max_val;
+
+public:
+    RunningStats();
+    void add(double x);
+    void merge(const RunningStats& other);
+    void reset();
+
+    uint64_t count() const { return n; }
+    double mean() const { return m; }
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+    double stddev() const;
+    double min() const { return min_val; }
+    double max() const { return max_val; }
+};
+
+// Exponentially weighted moving average over a horizon of roughly
+// `horizon` samples (alpha = 2 / (horizon + 1)).
+class Ewma {
+private:
+    double alpha;
+    double val;
+    bool initialized;
+
+public:
+    explicit Ewma(double horizon = 10.0);
+    void add(double x);
+    void reset() { initialized = false; val = 0.0; }
+    double value() const { return val; }
+    bool ready() const { return initialized; }
+};
+
+// Log-bucketed quantile sketch with bounded relative error. Bucket i covers
+// (gamma^(i-1), gamma^i], so any quantile is reported within `accuracy` of
+// the true sample value. Sketches with the same accuracy merge by adding
+// bucket counts, which makes them suitable for per-interval rollups.
+class QuantileSketch {
+private:
+    double gamma;
+    double log_gamma;
+    double accuracy;
+    std::vector<uint32_t> buckets;
+    int offset;
+    uint64_t zero_count;
+    uint64_t total;
+
+    int bucketIndex(double x) const;
+    void ensureBucket(int index);
+
+public:
+    // Values at or below this are counted in a dedicated zero bucket
+    static const double MIN_TRACKED;
+
+    explicit QuantileSketch(double accuracy = 0.01);
+    void add(double x);
+    // Takes back an earlier add(x), so a sketch can follow a sliding window
+    void remove(double x);
+    bool merge(const QuantileSketch& other);
+    void reset();
+
+    double quantile(double q) const;
+    uint64_t count() const { return total; }
+    double relativeAccuracy() const { return accuracy; }
+};
+
+// Everything the monitor tracks for one metric series.
+class SeriesStats {
+private:
+    RunningStats lifetime;
+    Ewma fast;
+    Ewma medium;
+    Ewma slow;
+    QuantileSketch sketch;
+
+public:
+    // Horizons in samples: ~10 ticks, ~1 minute and ~5 minutes at 1 Hz
+    SeriesStats();
+    void add(double x);
+    void reset();
+
+    const RunningStats& getLifetime() const { return lifetime; }
+    const QuantileSketch& getSketch() const { return sketch; }
+    double getFast() const { return fast.value(); }
+    double getMedium() const { return medium.value(); }
+    double getSlow() const { return slow.value(); }
+    SeriesSummary summarize() const;
+};
+
+#endif // STATISTICS_H
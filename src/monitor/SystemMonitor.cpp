@@ -1,74 +1,209 @@
 #include "SystemMonitor.h"
 #include "../platform/Platform.h"
+#include "../utils/Instrumentation.h"
 #include <algorithm>
-#include <iostream>
+#include <mutex>
 #include <thread>
-#include <chrono>
 
 SystemMonitor::SystemMonitor() 
-    : prev_total(0), prev_idle(0), baseline_samples(0), 
-      baseline_cpu(0.0), baseline_mem(0.0) {}
+    : prev_total(0), prev_idle(0), tick_count(0),
+      cpu_count(std::max(1u, std::thread::hardware_concurrency())),
+      cpu_history(HISTORY_SAMPLES, 0.01), mem_history(HISTORY_SAMPLES, 0.01),
+      throttle_history(HISTORY_SAMPLES, 1.0), fault_history(HISTORY_SAMPLES, 0.1),
+      swap_history(HISTORY_SAMPLES, 0.1), cgroup_tracking(false),
+      sched_tracking(false), numa_tracking(false), tree_tracking(false), tree_depth(3),
+      detail_suspended(false) {}
 
 SystemMetrics SystemMonitor::collectMetrics() {
+    // Taken before the stage timer so waiting on another monitor is not
+    // counted as collection time
+    std::lock_guard<std::mutex> guard(Platform::collectorLock());
+    SYSMON_STAGE(COLLECT);
     SystemMetrics metrics;
     
     long total, idle;
-    Platform::getCPUStats(total, idle);
+    {
+        SYSMON_STAGE(CPU);
+        Platform::getCPUStats(total, idle);
+    }
     metrics.cpu_usage = Platform::calculateCPUUsage(prev_total, prev_idle, total, idle);
+    bool cpu_valid = prev_total != 0 && total != prev_total;
+    long total_diff = prev_total != 0 ? total - prev_total : 0;
     prev_total = total;
     prev_idle = idle;
     
-    Platform::getMemoryInfo(metrics.total_mem_kb, metrics.available_mem_kb, metrics.used_mem_kb);
+    {
+        SYSMON_STAGE(THERMAL);
+        thermal_monitor.update(metrics.cpu_thermals);
+    }
+    
+    {
+        SYSMON_STAGE(MEMORY);
+        Platform::getMemoryInfo(metrics.total_mem_kb, metrics.available_mem_kb, metrics.used_mem_kb);
+    }
     metrics.mem_usage_percent = 100.0 * metrics.used_mem_kb / metrics.total_mem_kb;
     
-    auto proc_list = Platform::getProcessList();
-    for (const auto& p : proc_list) {
-        ProcessInfo proc;
-        proc.pid = p.pid;
-        proc.name = p.name;
-        proc.cpu_usage = p.cpu_usage;
-        proc.memory_kb = p.memory_kb;
-        proc.priority = p.priority;
-        metrics.top_processes.push_back(proc);
+    auto now = std::chrono::steady_clock::now();
+    double interval_sec = tick_count > 0
+        ? std::chrono::duration<double>(now - last_collect).count() : 0.0;
+    last_collect = now;
+    tick_count++;
+    
+    {
+        SYSMON_STAGE(PAGING);
+        vmstat_monitor.update(interval_sec, metrics.paging);
+    }
+    
+    {
+        SYSMON_STAGE(SCAN);
+        process_table.beginScan(total_diff, cpu_count, interval_sec);
+        Platform::scanProcesses(process_table);
+        process_table.endScan();
     }
     
-    std::sort(metrics.top_processes.begin(), metrics.top_processes.end(),
-              [](const ProcessInfo& a, const ProcessInfo& b) {
-                  return a.cpu_usage > b.cpu_usage;
-              });
+    metrics.process_table = &process_table;
+    metrics.delta = &process_table.getDelta();
+    metrics.process_count = static_cast<int>(process_table.size());
     
-    if (metrics.top_processes.size() > 10) {
-        metrics.top_processes.resize(10);
+    {
+        SYSMON_STAGE(ANOMALY);
+        anomaly_detector.update(process_table, interval_sec, metrics.anomalies);
+        std::sort(metrics.anomalies.begin(), metrics.anomalies.end(),
+                  [](const ProcessAnomaly& a, const ProcessAnomaly& b) {
+                      return a.score > b.score;
+                  });
     }
     
-    cpu_history.push_back(metrics.cpu_usage);
-    mem_history.push_back(metrics.mem_usage_percent);
+    {
+        SYSMON_STAGE(ACCOUNTING);
+        mem_accounting.update(process_table, metrics);
+    }
     
-    if (cpu_history.size() > MAX_HISTORY) cpu_history.pop_front();
-    if (mem_history.size() > MAX_HISTORY) mem_history.pop_front();
+    {
+        SYSMON_STAGE(FORECAST);
+        mem_forecaster.update(process_table, process_table.getDelta(), interval_sec, metrics,
+                              metrics.memory_forecast);
+    }
     
-    return metrics;
-}
-
-void SystemMonitor::establishBaseline(int samples) {
-    std::cout << "Establishing baseline metrics..." << std::flush;
+    if (cgroup_tracking && !detail_suspended) {
+        SYSMON_STAGE(CGROUPS);
+        cgroup_monitor.update(process_table, process_table.getDelta(), interval_sec,
+                              TOP_CGROUPS, metrics);
+    }
+    
+    if (sched_tracking && !detail_suspended) {
+        SYSMON_STAGE(SCHED);
+        sched_monitor.update(process_table, process_table.getDelta(), TOP_SCHED, metrics);
+    }
     
-    double total_cpu = 0.0;
-    double total_mem = 0.0;
+    if (numa_tracking && !detail_suspended) {
+        SYSMON_STAGE(NUMA);
+        numa_monitor.update(process_table, process_table.getDelta(), interval_sec, metrics);
+    }
+    
+    if (tree_tracking && !detail_suspended) {
+        SYSMON_STAGE(TREE);
+        process_tree.update(process_table, process_table.getDelta());
+        process_tree.collect(process_table, tree_depth, TREE_CHILDREN, TREE_ROWS,
+                             metrics.process_tree);
+    }
     
-    for (int i = 0; i < samples; i++) {
-        auto metrics = collectMetrics();
-        total_cpu += metrics.cpu_usage;
-        total_mem += metrics.mem_usage_percent;
-        std::cout << "." << std::flush;
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    // Rank through an index permutation; only the winners become ProcessInfo
+    size_t top = std::min(process_table.size(), static_cast<size_t>(TOP_PROCESSES));
+    {
+        SYSMON_STAGE(RANK);
+        process_table.rank(SortKey::CPU, rank_order, top);
+        
+        metrics.top_processes.resize(top);
+        for (size_t i = 0; i < top; i++) {
+            process_table.fill(rank_order[i], metrics.top_processes[i]);
+            mem_accounting.annotate(metrics.top_processes[i]);
+        }
     }
     
-    baseline_cpu = total_cpu / samples;
-    baseline_mem = total_mem / samples;
-    baseline_samples = samples;
+    SYSMON_STAGE(STATISTICS);
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    cpu_history.append(now_ms, metrics.cpu_usage);
+    mem_history.append(now_ms, metrics.mem_usage_percent);
+    throttle_history.append(now_ms, static_cast<double>(metrics.cpu_thermals.throttle_events));
+    fault_history.append(now_ms, metrics.paging.major_faults);
+    swap_history.append(now_ms, metrics.paging.swap_in + metrics.paging.swap_out);
+    
+    // The very first CPU reading has no previous counters to diff against
+    if (cpu_valid) cpu_stats.add(metrics.cpu_usage);
+    mem_stats.add(metrics.mem_usage_percent);
+    metrics.cpu_summary = cpu_stats.summarize();
+    metrics.mem_summary = mem_stats.summarize();
+    
+    return metrics;
+}
+
+void SystemMonitor::prime(int settle_ms) {
+    // A throwaway sample records the system and per-process counters
+    auto started = std::chrono::steady_clock::now();
+    collectMetrics();
     
-    std::cout << " Done!\n";
-    std::cout << "Baseline CPU: " << baseline_cpu << "%\n";
-    std::cout << "Baseline Memory: " << baseline_mem << "%\n\n";
-}
\ No newline at end of file
+    // On large tables the scan itself is a sizeable part of the interval
+    int elapsed_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count());
+    if (settle_ms > elapsed_ms) {
+        Platform::sleep(settle_ms - elapsed_ms);
+    }
+}
+
+void SystemMonitor::setDeltaEpsilon(double cpu_percent, long rss_kb) {
+    process_table.setDeltaEpsilon(cpu_percent, rss_kb);
+}
+
+void SystemMonitor::setFilter(const ProcessFilter& filter) {
+    process_filter = filter;
+    process_table.setFilter(&process_filter);
+}
+
+void SystemMonitor::setCgroupTracking(bool enabled) {
+    if (enabled && !cgroup_tracking) {
+        // Spawns and exits were not followed while disabled
+        cgroup_monitor.reset();
+    }
+    cgroup_tracking = enabled;
+}
+
+void SystemMonitor::setSchedTracking(bool enabled) {
+    if (enabled && !sched_tracking) {
+        // Counters read before the pause would span it
+        sched_monitor.reset();
+    }
+    sched_tracking = enabled;
+}
+
+void SystemMonitor::setNumaTracking(bool enabled) {
+    if (enabled && !numa_tracking) {
+        numa_monitor.reset();
+    }
+    numa_tracking = enabled;
+}
+
+void SystemMonitor::setTreeTracking(bool enabled) {
+    if (enabled && !tree_tracking) {
+        // Links were not followed while disabled
+        process_tree.reset();
+    }
+    tree_tracking = enabled;
+}
+
+void SystemMonitor::setDetailSuspended(bool suspended) {
+    if (!suspended && detail_suspended) {
+        // Same as re-enabling each one: nothing was followed meanwhile
+        cgroup_monitor.reset();
+        sched_monitor.reset();
+        numa_monitor.reset();
+        process_tree.reset();
+    }
+    detail_suspended = suspended;
+}
+
+void SystemMonitor::resetBaseline() {
+    cpu_stats.reset();
+    mem_stats.reset();
+}
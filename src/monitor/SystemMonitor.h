@@ -2,21 +2,61 @@
 #define SYSTEMMONITOR_H
 
 #include "ProcessInfo.h"
-#include <map>
-#include <deque>
+#include "MemoryAccounting.h"
+#include "Statistics.h"
+#include "AnomalyDetector.h"
+#include "ProcessTable.h"
+#include "CgroupMonitor.h"
+#include "SchedMonitor.h"
+#include "NumaMonitor.h"
+#include "ThermalMonitor.h"
+#include "VMStatMonitor.h"
+#include "ProcessTree.h"
+#include "MemoryForecaster.h"
+#include "ProcessFilter.h"
+#include "CompressedSeries.h"
+#include <chrono>
 #include <vector>
 
 class SystemMonitor {
 private:
     long prev_total;
     long prev_idle;
-    std::map<int, std::pair<long, long>> prev_proc_stats;
-    int baseline_samples;
-    double baseline_cpu;
-    double baseline_mem;
-    std::deque<double> cpu_history;
-    std::deque<double> mem_history;
-    static const int MAX_HISTORY = 120;
+    unsigned long tick_count;
+    unsigned int cpu_count;
+    std::chrono::steady_clock::time_point last_collect;
+    ProcessTable process_table;
+    ProcessFilter process_filter;
+    std::vector<uint32_t> rank_order;
+    SeriesStats cpu_stats;
+    SeriesStats mem_stats;
+    // A day at 1 Hz, kept at the 0.01% precision the monitor reports
+    static const size_t HISTORY_SAMPLES = 86400;
+    CompressedSeries cpu_history;
+    CompressedSeries mem_history;
+    CompressedSeries throttle_history;  // Throttle events per tick
+    CompressedSeries fault_history;     // Major faults per second
+    CompressedSeries swap_history;      // Pages swapped in + out per second
+    ThermalMonitor thermal_monitor;
+    VMStatMonitor vmstat_monitor;
+    static const int TOP_PROCESSES = 10;
+    MemoryAccounting mem_accounting;
+    AnomalyDetector anomaly_detector;
+    MemoryForecaster mem_forecaster;
+    CgroupMonitor cgroup_monitor;
+    bool cgroup_tracking;
+    static const int TOP_CGROUPS = 10;
+    SchedMonitor sched_monitor;
+    bool sched_tracking;
+    static const int TOP_SCHED = 10;
+    NumaMonitor numa_monitor;
+    bool numa_tracking;
+    ProcessTree process_tree;
+    bool tree_tracking;
+    int tree_depth;
+    bool detail_suspended;
+    static const int TREE_ROWS = 24;
+    static const int TREE_CHILDREN = 8;
     
     void getCPUStats(long& total, long& idle);
     double calculateCPUUsage();
@@ -26,11 +66,58 @@ private:
 public:
     SystemMonitor();
     SystemMetrics collectMetrics();
-    void establishBaseline(int samples = 5);
-    double getBaselineCPU() const { return baseline_cpu; }
-    double getBaselineMem() const { return baseline_mem; }
-    const std::deque<double>& getCPUHistory() const { return cpu_history; }
-    const std::deque<double>& getMemHistory() const { return mem_history; }
+    // Seeds the CPU counters so the first collectMetrics() has a real delta,
+    // `settle_ms` after this sample started. The baseline itself is the
+    // slow EWMA and needs no warm-up period.
+    void prime(int settle_ms = 100);
+    void resetBaseline();
+    void setDeltaEpsilon(double cpu_percent, long rss_kb);
+    // Scopes the process table, and with it every view, export and
+    // optimizer target, from the next tick on. System totals stay host-wide.
+    void setFilter(const ProcessFilter& filter);
+    const ProcessFilter& getFilter() const { return process_filter; }
+    // Per-cgroup aggregation is off by default; it costs one read per
+    // new PID plus a few reads per populated group each tick
+    void setCgroupTracking(bool enabled);
+    bool getCgroupTracking() const { return cgroup_tracking; }
+    // Scheduler (run-queue delay) tracking is off by default; it reads
+    // schedstat for every process that ran this tick
+    void setSchedTracking(bool enabled);
+    bool getSchedTracking() const { return sched_tracking; }
+    // NUMA node tracking is off by default; it reads two sysfs files per
+    // node each tick and numa_maps of the largest processes now and then
+    void setNumaTracking(bool enabled);
+    bool getNumaTracking() const { return numa_tracking; }
+    // Process tree index with subtree rollups, off by default; fills
+    // metrics.process_tree expanded to `depth` levels below the roots
+    void setTreeTracking(bool enabled);
+    bool getTreeTracking() const { return tree_tracking; }
+    // Skips the per-process detail collectors above (cgroups, sched, NUMA,
+    // tree) without forgetting which are enabled; used to shed load
+    void setDetailSuspended(bool suspended);
+    bool getDetailSuspended() const { return detail_suspended; }
+    void setTreeDepth(int depth) { tree_depth = depth < 0 ? 0 : depth; }
+    int getTreeDepth() const { return tree_depth; }
+    double getBaselineCPU() const { return cpu_stats.getSlow(); }
+    double getBaselineMem() const { return mem_stats.getSlow(); }
+    const SeriesStats& getCPUStats() const { return cpu_stats; }
+    const SeriesStats& getMemStats() const { return mem_stats; }
+    const CompressedSeries& getCPUHistory() const { return cpu_history; }
+    const CompressedSeries& getMemHistory() const { return mem_history; }
+    const CompressedSeries& getThrottleHistory() const { return throttle_history; }
+    const CompressedSeries& getFaultHistory() const { return fault_history; }
+    const CompressedSeries& getSwapHistory() const { return swap_history; }
+    MemoryAccounting& getMemoryAccounting() { return mem_accounting; }
+    AnomalyDetector& getAnomalyDetector() { return anomaly_detector; }
+    MemoryForecaster& getMemoryForecaster() { return mem_forecaster; }
+    CgroupMonitor& getCgroupMonitor() { return cgroup_monitor; }
+    SchedMonitor& getSchedMonitor() { return sched_monitor; }
+    NumaMonitor& getNumaMonitor() { return numa_monitor; }
+    ThermalMonitor& getThermalMonitor() { return thermal_monitor; }
+    VMStatMonitor& getVMStatMonitor() { return vmstat_monitor; }
+    const ProcessTree& getProcessTree() const { return process_tree; }
+    const ProcessTable& getProcessTable() const { return process_table; }
+    const SnapshotDelta& getLastDelta() const { return process_table.getDelta(); }
 };
 
 #endif // SYSTEMMONITOR_H
\ No newline at end of file
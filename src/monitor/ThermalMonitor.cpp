@@ -0,0 +1,76 @@
+#include "ThermalMonitor.h"
+#include <algorithm>
+
+const unsigned long ThermalMonitor::SENSOR_REFRESH;
+
+ThermalMonitor::ThermalMonitor() : tick(0) {}
+
+void ThermalMonitor::update(CPUThermals& thermals) {
+    thermals = CPUThermals();
+    // Counters are cumulative per CPU, so throttle events carry across
+    if (++tick % SENSOR_REFRESH == 0) Platform::refreshSensors();
+
+    if (Platform::getThermalZones(zones)) {
+        thermals.zones.resize(zones.size());
+        for (size_t i = 0; i < zones.size(); i++) {
+            thermals.zones[i].type = zones[i].type;
+            thermals.zones[i].celsius = zones[i].celsius;
+            if (thermals.hottest_zone < 0 || zones[i].celsius > zones[thermals.hottest_zone].celsius) {
+                thermals.hottest_zone = static_cast<int>(i);
+            }
+        }
+    }
+
+    if (!Platform::getCPUFrequencies(current)) {
+        last.clear();
+        return;
+    }
+    thermals.available = true;
+
+    double sum_khz = 0.0;
+    double sum_max_khz = 0.0;
+    int rated = 0;
+    bool compare = last.size() == current.size();
+    package_events.clear();
+    for (size_t i = 0; i < current.size(); i++) {
+        const Platform::CPUFrequency& cpu = current[i];
+        if (cpu.cur_khz > 0) {
+            double mhz = cpu.cur_khz / 1000.0;
+            if (thermals.cpus == 0 || mhz < thermals.min_mhz) thermals.min_mhz = mhz;
+            if (thermals.cpus == 0 || mhz > thermals.max_mhz) thermals.max_mhz = mhz;
+            sum_khz += cpu.cur_khz;
+            thermals.cpus++;
+        }
+        if (cpu.max_khz > 0) {
+            sum_max_khz += cpu.max_khz;
+            rated++;
+        }
+        if (!compare) continue;
+
+        const Platform::CPUFrequency& before = last[i];
+        if (cpu.core_throttles > before.core_throttles && before.core_throttles >= 0) {
+            thermals.throttled_cpus++;
+            thermals.throttle_events += cpu.core_throttles - before.core_throttles;
+        }
+        // Every CPU of a package reports the same package counter
+        if (cpu.package_throttles > before.package_throttles && before.package_throttles >= 0 &&
+            cpu.package >= 0 && cpu.package < 4096) {
+            if (static_cast<size_t>(cpu.package) >= package_events.size()) {
+                package_events.resize(cpu.package + 1, 0);
+            }
+            package_events[cpu.package] = std::max(package_events[cpu.package],
+                                                   cpu.package_throttles - before.package_throttles);
+        }
+    }
+    for (long long events : package_events) {
+        thermals.throttle_events += events;
+    }
+
+    if (thermals.cpus > 0) thermals.avg_mhz = sum_khz / thermals.cpus / 1000.0;
+    if (rated > 0) thermals.nominal_mhz = sum_max_khz / rated / 1000.0;
+    last.swap(current);
+}
+
+void ThermalMonitor::reset() {
+    last.clear();
+}
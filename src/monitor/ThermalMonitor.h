@@ -0,0 +1,37 @@
+#ifndef THERMALMONITOR_H
+#define THERMALMONITOR_H
+
+#include "ProcessInfo.h"
+#include "../platform/Platform.h"
+#include <vector>
+
+// CPU clock, thermal throttling and thermal zone temperatures.
+//
+// A host reading 40% busy can still be slow when its cores run below
+// their rated clock. Every tick reads scaling_cur_freq and the
+// thermal_throttle counters of each CPU plus each thermal zone's
+// temperature, all through descriptors the platform layer keeps open, so
+// the cost is one pread per file. Throttling shows up as counter
+// increments between ticks. Every SENSOR_REFRESH ticks the descriptors are
+// dropped and sysfs is scanned again, so hotplugged CPUs and new zones
+// appear without a restart.
+class ThermalMonitor {
+private:
+    static const unsigned long SENSOR_REFRESH = 60;
+
+    unsigned long tick;
+    std::vector<Platform::CPUFrequency> current;
+    std::vector<Platform::CPUFrequency> last;
+    std::vector<Platform::ThermalZone> zones;
+    std::vector<long long> package_events;
+
+public:
+    ThermalMonitor();
+
+    void update(CPUThermals& thermals);
+
+    // Forgets the throttle counters; events restart from the next two reads
+    void reset();
+};
+
+#endif // THERMALMONITOR_H
@@ -0,0 +1,36 @@
+#include "VMStatMonitor.h"
+
+namespace {
+    // Counters only go back on reboot-like events (a new procfs root)
+    double perSecond(long long now, long long before, double interval_sec) {
+        return now >= before ? static_cast<double>(now - before) / interval_sec : 0.0;
+    }
+}
+
+void VMStatMonitor::update(double interval_sec, PagingRates& rates) {
+    rates = PagingRates();
+
+    Platform::VMStats current;
+    if (!Platform::getVMStats(current)) {
+        primed = false;
+        return;
+    }
+    rates.available = true;
+
+    if (primed && interval_sec > 0.0) {
+        long long minor = current.page_faults - current.major_faults;
+        long long last_minor = last.page_faults - last.major_faults;
+        rates.major_faults = perSecond(current.major_faults, last.major_faults, interval_sec);
+        rates.minor_faults = perSecond(minor, last_minor, interval_sec);
+        rates.swap_in = perSecond(current.swap_in, last.swap_in, interval_sec);
+        rates.swap_out = perSecond(current.swap_out, last.swap_out, interval_sec);
+        rates.scan_kswapd = perSecond(current.scan_kswapd, last.scan_kswapd, interval_sec);
+        rates.scan_direct = perSecond(current.scan_direct, last.scan_direct, interval_sec);
+        rates.steal_kswapd = perSecond(current.steal_kswapd, last.steal_kswapd, interval_sec);
+        rates.steal_direct = perSecond(current.steal_direct, last.steal_direct, interval_sec);
+        if (current.oom_kills > last.oom_kills) rates.oom_kills = current.oom_kills - last.oom_kills;
+    }
+
+    last = current;
+    primed = true;
+}
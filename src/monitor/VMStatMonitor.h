@@ -0,0 +1,29 @@
+#ifndef VMSTATMONITOR_H
+#define VMSTATMONITOR_H
+
+#include "ProcessInfo.h"
+#include "../platform/Platform.h"
+
+// Paging, swap and reclaim rates from the kernel's /proc/vmstat counters.
+//
+// Memory usage alone does not tell a full but healthy page cache from a
+// host that is thrashing. The counters do: major faults and swap-in mean
+// tasks are waiting on I/O for memory, and direct scans mean allocations
+// are stalling to reclaim. One read per tick; the platform layer resolves
+// the file's keys to line positions once, so the read is a walk over the
+// lines without string comparisons.
+class VMStatMonitor {
+private:
+    Platform::VMStats last;
+    bool primed;
+
+public:
+    VMStatMonitor() : primed(false) {}
+
+    // `interval_sec` is the time since the previous call; rates stay 0
+    // until two reads are a positive interval apart
+    void update(double interval_sec, PagingRates& rates);
+    void reset() { primed = false; }
+};
+
+#endif // VMSTATMONITOR_H
@@ -0,0 +1,96 @@
+#include "Agent.h"
+#include <cstdio>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+Agent::Agent(const std::string& address, int port, const std::string& hostname,
+             int keyframe_interval)
+    : address(address), port(port), hostname(hostname),
+      keyframe_interval(keyframe_interval > 0 ? keyframe_interval : 1), fd(-1),
+      frames_since_keyframe(0), bytes_sent(0), frames_sent(0) {}
+
+Agent::~Agent() {
+    disconnect();
+}
+
+void Agent::disconnect() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool Agent::connect() {
+    char service[16];
+    snprintf(service, sizeof(service), "%d", port);
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* result = nullptr;
+    if (getaddrinfo(address.c_str(), service, &hints, &result) != 0) return false;
+
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        int sock = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (sock < 0) continue;
+
+        // A stuck aggregator must not stall the agent's own sampling loop
+        timeval timeout;
+        timeout.tv_sec = 2;
+        timeout.tv_usec = 0;
+        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        int one = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (::connect(sock, ai->ai_addr, ai->ai_addrlen) == 0) {
+            fd = sock;
+            break;
+        }
+        close(sock);
+    }
+    freeaddrinfo(result);
+    if (fd < 0) return false;
+
+    buffer.clear();
+    Wire::encodeHello(hostname, buffer);
+    // Deltas are relative to what the aggregator already has: start over
+    frames_since_keyframe = 0;
+    return true;
+}
+
+bool Agent::sendBuffer() {
+    size_t sent = 0;
+    while (sent < buffer.size()) {
+        ssize_t n = ::send(fd, buffer.data() + sent, buffer.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            disconnect();
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    bytes_sent += sent;
+    return true;
+}
+
+bool Agent::send(const SystemMetrics& metrics) {
+    if (fd < 0) {
+        if (!connect()) return false;
+    } else {
+        buffer.clear();
+    }
+
+    bool keyframe = frames_since_keyframe % keyframe_interval == 0;
+    Wire::encodeFrame(metrics, keyframe, buffer, scratch);
+    frames_since_keyframe++;
+
+    if (!sendBuffer()) return false;
+    frames_sent++;
+    return true;
+}
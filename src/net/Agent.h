@@ -0,0 +1,45 @@
+#ifndef AGENT_H
+#define AGENT_H
+
+#include "../monitor/ProcessInfo.h"
+#include "Wire.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Pushes this host's metrics to an aggregator as Wire frames.
+//
+// The connection is opened lazily and re-opened on the next send() after
+// any failure; the first frame on every connection is a keyframe, then
+// deltas with a keyframe every `keyframe_interval` frames.
+class Agent {
+private:
+    std::string address;
+    int port;
+    std::string hostname;
+    int keyframe_interval;
+    int fd;
+    unsigned long frames_since_keyframe;
+    std::vector<uint8_t> buffer;
+    Wire::EncodeScratch scratch;
+    unsigned long long bytes_sent;
+    unsigned long long frames_sent;
+
+    bool connect();
+    bool sendBuffer();
+
+public:
+    Agent(const std::string& address, int port, const std::string& hostname,
+          int keyframe_interval = 60);
+    ~Agent();
+
+    bool send(const SystemMetrics& metrics);
+    void disconnect();
+
+    bool isConnected() const { return fd >= 0; }
+    const std::string& getHostname() const { return hostname; }
+    unsigned long long getBytesSent() const { return bytes_sent; }
+    unsigned long long getFramesSent() const { return frames_sent; }
+};
+
+#endif // AGENT_H
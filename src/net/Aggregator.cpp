@@ -0,0 +1,377 @@
+#include "Aggregator.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const size_t Aggregator::HOST_TOP_K;
+const int Aggregator::DROP_DISCONNECTED_SEC;
+
+namespace {
+    const int MAX_EVENTS = 256;
+}
+
+Aggregator::Aggregator()
+    : listen_fd(-1), epoll_fd(-1), port(0), frames(0), bytes(0), rejected(0) {}
+
+Aggregator::~Aggregator() {
+    for (auto& entry : connections) {
+        close(entry.first);
+    }
+    if (listen_fd >= 0) close(listen_fd);
+    if (epoll_fd >= 0) close(epoll_fd);
+}
+
+bool Aggregator::listen(int listen_port, const std::string& address) {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) return false;
+
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) return false;
+
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(listen_port));
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) return false;
+
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+    if (::listen(listen_fd, SOMAXCONN) != 0) return false;
+
+    socklen_t len = sizeof(addr);
+    if (getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &len) == 0) {
+        port = ntohs(addr.sin_port);
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) == 0;
+}
+
+void Aggregator::acceptAll() {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;     // EAGAIN once the backlog is drained
+
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            continue;
+        }
+
+        Connection& conn = connections[fd];
+        conn.fd = fd;
+    }
+}
+
+void Aggregator::closeConnection(int fd) {
+    auto it = connections.find(fd);
+    if (it == connections.end()) return;
+
+    if (it->second.host >= 0) {
+        Host& host = hosts[it->second.host];
+        host.connections--;
+        // Whatever arrives next must start from a keyframe again
+        host.has_keyframe = false;
+    }
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(it);
+}
+
+bool Aggregator::readConnection(Connection& conn) {
+    uint8_t chunk[65536];
+    while (true) {
+        ssize_t n = recv(conn.fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            conn.buffer.insert(conn.buffer.end(), chunk, chunk + n);
+            bytes += static_cast<unsigned long long>(n);
+            continue;
+        }
+        if (n == 0) return false;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        if (errno == EINTR) continue;
+        return false;
+    }
+
+    // Handle every complete message, then drop the consumed prefix once
+    size_t offset = 0;
+    while (conn.buffer.size() - offset >= Wire::HEADER_SIZE) {
+        uint32_t length = Wire::payloadLength(&conn.buffer[offset]);
+        if (length == 0 || length > Wire::MAX_PAYLOAD) return false;
+        if (conn.buffer.size() - offset - Wire::HEADER_SIZE < length) break;
+
+        if (!handleMessage(conn, &conn.buffer[offset + Wire::HEADER_SIZE], length)) return false;
+        offset += Wire::HEADER_SIZE + length;
+    }
+    conn.buffer.erase(conn.buffer.begin(), conn.buffer.begin() + offset);
+    return true;
+}
+
+bool Aggregator::handleMessage(Connection& conn, const uint8_t* payload, size_t size) {
+    Wire::Reader reader(payload, size);
+    uint8_t type = reader.getByte();
+
+    if (type == Wire::HELLO) {
+        if (reader.getVarint() != Wire::VERSION) return false;
+        reader.getString(scratch_name);
+        if (!reader.good() || scratch_name.empty() || conn.host >= 0) return false;
+        // Host names are single tokens in rankings and recordings
+        for (char& c : scratch_name) {
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') c = '_';
+        }
+
+        auto it = host_index.find(scratch_name);
+        int index;
+        if (it != host_index.end()) {
+            index = it->second;
+        } else if (!free_hosts.empty()) {
+            index = free_hosts.back();
+            free_hosts.pop_back();
+            hosts[index] = Host();
+        } else {
+            index = static_cast<int>(hosts.size());
+            hosts.push_back(Host());
+        }
+        host_index[scratch_name] = index;
+
+        Host& host = hosts[index];
+        host.name = scratch_name;
+        host.connections++;
+        host.has_keyframe = false;
+        host.last_frame = std::chrono::steady_clock::now();
+        conn.host = index;
+        return true;
+    }
+
+    if (type != Wire::KEYFRAME && type != Wire::DELTA) return false;
+    if (conn.host < 0) return false;
+
+    Host& host = hosts[conn.host];
+    bool keyframe = type == Wire::KEYFRAME;
+    if (!keyframe && !host.has_keyframe) {
+        // Nothing to apply the delta to; wait for the next keyframe
+        rejected++;
+        return true;
+    }
+    if (!applyFrame(host, reader, keyframe)) {
+        rejected++;
+        host.has_keyframe = false;
+        return false;
+    }
+    frames++;
+    return true;
+}
+
+bool Aggregator::readProcess(Wire::Reader& reader, int& pid, HostProcess& proc, bool with_name) {
+    pid += static_cast<int>(reader.getVarint());
+    proc.cpu_usage = reader.getPercent();
+    proc.memory_kb = static_cast<long>(reader.getVarint());
+    proc.priority = static_cast<int>(reader.getSigned());
+    if (with_name) {
+        reader.getString(proc.name);
+        // Shown on the fleet view and recorded: no terminal or line control
+        for (char& c : proc.name) {
+            if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) c = '_';
+        }
+    }
+    return reader.good();
+}
+
+bool Aggregator::applyFrame(Host& host, Wire::Reader& reader, bool keyframe) {
+    unsigned long sequence = static_cast<unsigned long>(reader.getVarint());
+    Wire::readSystem(reader, host.system);
+    if (!reader.good()) return false;
+
+    // A delta must directly follow the frame it was computed against
+    if (!keyframe && sequence != host.sequence + 1) {
+        host.has_keyframe = false;
+        return true;
+    }
+
+    HostProcess proc;
+    if (keyframe) {
+        host.processes.clear();
+        uint64_t count = reader.getVarint();
+        int pid = 0;
+        for (uint64_t i = 0; i < count && reader.good(); i++) {
+            if (!readProcess(reader, pid, proc, true)) return false;
+            host.processes[pid] = proc;
+        }
+        host.has_keyframe = true;
+    } else {
+        uint64_t exits = reader.getVarint();
+        int pid = 0;
+        for (uint64_t i = 0; i < exits && reader.good(); i++) {
+            pid += static_cast<int>(reader.getVarint());
+            host.processes.erase(pid);
+        }
+
+        uint64_t spawns = reader.getVarint();
+        pid = 0;
+        for (uint64_t i = 0; i < spawns && reader.good(); i++) {
+            if (!readProcess(reader, pid, proc, true)) return false;
+            host.processes[pid] = proc;
+        }
+
+        uint64_t changes = reader.getVarint();
+        pid = 0;
+        for (uint64_t i = 0; i < changes && reader.good(); i++) {
+            if (!readProcess(reader, pid, proc, false)) return false;
+            auto it = host.processes.find(pid);
+            if (it == host.processes.end()) continue;
+            it->second.cpu_usage = proc.cpu_usage;
+            it->second.memory_kb = proc.memory_kb;
+            it->second.priority = proc.priority;
+        }
+    }
+
+    if (!reader.good() || !reader.atEnd()) return false;
+
+    host.sequence = sequence;
+    host.last_frame = std::chrono::steady_clock::now();
+    host.dirty = true;
+    return true;
+}
+
+size_t Aggregator::poll(int timeout_ms) {
+    if (epoll_fd < 0) return 0;
+
+    unsigned long long frames_before = frames;
+    epoll_event events[MAX_EVENTS];
+    int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+
+    for (int i = 0; i < ready; i++) {
+        int fd = events[i].data.fd;
+        if (fd == listen_fd) {
+            acceptAll();
+            continue;
+        }
+
+        auto it = connections.find(fd);
+        if (it == connections.end()) continue;
+
+        bool keep = !(events[i].events & EPOLLERR);
+        if (keep && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+            keep = readConnection(it->second);
+        }
+        if (!keep) closeConnection(fd);
+    }
+
+    return static_cast<size_t>(frames - frames_before);
+}
+
+void Aggregator::rebuildTop(Host& host) {
+    host.top.clear();
+    for (const auto& entry : host.processes) {
+        const HostProcess& proc = entry.second;
+        if (host.top.size() == HOST_TOP_K && proc.cpu_usage <= host.top.back().cpu_usage) continue;
+
+        FleetProcess item;
+        item.host = host.name;
+        item.pid = entry.first;
+        item.name = proc.name;
+        item.cpu_usage = proc.cpu_usage;
+        item.memory_kb = proc.memory_kb;
+        item.priority = proc.priority;
+
+        // Small sorted insert: K is tiny compared with the process count
+        auto pos = std::upper_bound(host.top.begin(), host.top.end(), item,
+                                    [](const FleetProcess& a, const FleetProcess& b) {
+                                        return a.cpu_usage > b.cpu_usage;
+                                    });
+        host.top.insert(pos, item);
+        if (host.top.size() > HOST_TOP_K) host.top.pop_back();
+    }
+    host.dirty = false;
+}
+
+void Aggregator::dropStaleHosts() {
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < hosts.size(); i++) {
+        Host& host = hosts[i];
+        if (host.name.empty() || host.connections > 0) continue;
+        if (now - host.last_frame < std::chrono::seconds(DROP_DISCONNECTED_SEC)) continue;
+
+        host_index.erase(host.name);
+        host = Host();
+        free_hosts.push_back(static_cast<int>(i));
+    }
+}
+
+void Aggregator::collect(FleetMetrics& fleet, size_t top_hosts, size_t top_processes) {
+    dropStaleHosts();
+
+    auto now = std::chrono::steady_clock::now();
+    fleet = FleetMetrics();
+    fleet.frames = frames;
+    fleet.bytes = bytes;
+    fleet.rejected = rejected;
+
+    host_order.clear();
+    merge.clear();
+    double cpu_sum = 0.0, mem_sum = 0.0;
+    for (size_t i = 0; i < hosts.size(); i++) {
+        Host& host = hosts[i];
+        if (host.name.empty()) continue;
+
+        fleet.host_count++;
+        if (host.connections > 0) fleet.connected_hosts++;
+        if (!host.has_keyframe) continue;
+
+        if (host.dirty) rebuildTop(host);
+        host_order.push_back(i);
+        fleet.process_count += static_cast<long long>(host.processes.size());
+        cpu_sum += host.system.cpu_usage;
+        mem_sum += host.system.mem_usage_percent;
+        for (const auto& proc : host.top) merge.push_back(&proc);
+    }
+
+    if (!host_order.empty()) {
+        fleet.mean_cpu = cpu_sum / host_order.size();
+        fleet.mean_mem_percent = mem_sum / host_order.size();
+    }
+
+    size_t shown_hosts = std::min(top_hosts, host_order.size());
+    std::partial_sort(host_order.begin(), host_order.begin() + shown_hosts, host_order.end(),
+                      [this](size_t a, size_t b) {
+                          return hosts[a].system.cpu_usage > hosts[b].system.cpu_usage;
+                      });
+    fleet.top_hosts.resize(shown_hosts);
+    for (size_t i = 0; i < shown_hosts; i++) {
+        const Host& host = hosts[host_order[i]];
+        HostSummary& summary = fleet.top_hosts[i];
+        summary.name = host.name;
+        summary.cpu_usage = host.system.cpu_usage;
+        summary.mem_usage_percent = host.system.mem_usage_percent;
+        summary.used_mem_kb = host.system.used_mem_kb;
+        summary.total_mem_kb = host.system.total_mem_kb;
+        summary.process_count = static_cast<int>(host.processes.size());
+        summary.connected = host.connections > 0;
+        summary.age_sec = std::chrono::duration<double>(now - host.last_frame).count();
+    }
+
+    size_t shown_procs = std::min(top_processes, merge.size());
+    std::partial_sort(merge.begin(), merge.begin() + shown_procs, merge.end(),
+                      [](const FleetProcess* a, const FleetProcess* b) {
+                          return a->cpu_usage > b->cpu_usage;
+                      });
+    fleet.top_processes.reserve(shown_procs);
+    for (size_t i = 0; i < shown_procs; i++) {
+        fleet.top_processes.push_back(*merge[i]);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+
+#include "FleetMetrics.h"
+#include "Wire.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Receives agent streams and merges them into fleet-wide rankings.
+//
+// Single-threaded and non-blocking: one epoll set holds the listening
+// socket and every agent connection, and poll() drains whatever is ready.
+// Each host keeps a PID -> process map maintained from keyframes and
+// deltas, plus a cached per-host top-K that is only rebuilt when the host
+// sent something new, so collect() merges K entries per host instead of
+// every process in the fleet.
+class Aggregator {
+private:
+    static const size_t HOST_TOP_K = 16;
+    static const int DROP_DISCONNECTED_SEC = 300;
+
+    struct HostProcess {
+        std::string name;
+        double cpu_usage;
+        long memory_kb;
+        int priority;
+    };
+
+    struct Host {
+        std::string name;
+        Wire::SystemFields system;
+        std::unordered_map<int, HostProcess> processes;
+        std::vector<FleetProcess> top;
+        std::chrono::steady_clock::time_point last_frame;
+        unsigned long sequence;
+        int connections;
+        bool has_keyframe;
+        bool dirty;
+
+        Host() : sequence(0), connections(0), has_keyframe(false), dirty(false) {}
+    };
+
+    struct Connection {
+        int fd;
+        int host;       // Index into hosts; -1 until HELLO
+        std::vector<uint8_t> buffer;
+
+        Connection() : fd(-1), host(-1) {}
+    };
+
+    int listen_fd;
+    int epoll_fd;
+    int port;
+    std::unordered_map<int, Connection> connections;
+    std::vector<Host> hosts;
+    std::unordered_map<std::string, int> host_index;
+    std::vector<int> free_hosts;
+    std::vector<const FleetProcess*> merge;
+    std::vector<size_t> host_order;
+    std::string scratch_name;
+    unsigned long long frames;
+    unsigned long long bytes;
+    unsigned long long rejected;
+
+    void acceptAll();
+    bool readConnection(Connection& conn);
+    void closeConnection(int fd);
+    bool handleMessage(Connection& conn, const uint8_t* payload, size_t size);
+    bool applyFrame(Host& host, Wire::Reader& reader, bool keyframe);
+    bool readProcess(Wire::Reader& reader, int& pid, HostProcess& proc, bool with_name);
+    void rebuildTop(Host& host);
+    void dropStaleHosts();
+
+public:
+    Aggregator();
+    ~Aggregator();
+
+    // Binds and listens; port 0 picks an ephemeral port (see getPort())
+    bool listen(int port, const std::string& address = "0.0.0.0");
+    int getPort() const { return port; }
+
+    // Waits up to `timeout_ms` for I/O and handles everything that is
+    // ready. Returns the number of frames applied.
+    size_t poll(int timeout_ms);
+
+    void collect(FleetMetrics& fleet, size_t top_hosts, size_t top_processes);
+
+    size_t getConnectionCount() const { return connections.size(); }
+    size_t getHostCount() const { return host_index.size(); }
+    unsigned long long getFrames() const { return frames; }
+};
+
+#endif // AGGREGATOR_H
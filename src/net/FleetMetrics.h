@@ -0,0 +1,50 @@
+#ifndef FLEETMETRICS_H
+#define FLEETMETRICS_H
+
+#include <string>
+#include <vector>
+
+struct HostSummary {
+    std::string name;
+    double cpu_usage;
+    double mem_usage_percent;
+    long used_mem_kb;
+    long total_mem_kb;
+    int process_count;
+    bool connected;
+    double age_sec;         // Since the last frame from this host
+    
+    HostSummary() : cpu_usage(0.0), mem_usage_percent(0.0), used_mem_kb(0), total_mem_kb(0),
+                    process_count(0), connected(false), age_sec(0.0) {}
+};
+
+struct FleetProcess {
+    std::string host;
+    int pid;
+    std::string name;
+    double cpu_usage;
+    long memory_kb;
+    int priority;
+    
+    FleetProcess() : pid(0), cpu_usage(0.0), memory_kb(0), priority(0) {}
+};
+
+// Fleet-wide view assembled by the Aggregator from many agents
+struct FleetMetrics {
+    int host_count;
+    int connected_hosts;
+    long long process_count;
+    double mean_cpu;
+    double mean_mem_percent;
+    unsigned long long frames;
+    unsigned long long bytes;
+    unsigned long long rejected;    // Malformed frames and deltas without a keyframe
+    
+    std::vector<HostSummary> top_hosts;         // by CPU
+    std::vector<FleetProcess> top_processes;    // by CPU, across all hosts
+    
+    FleetMetrics() : host_count(0), connected_hosts(0), process_count(0), mean_cpu(0.0),
+                     mean_mem_percent(0.0), frames(0), bytes(0), rejected(0) {}
+};
+
+#endif // FLEETMETRICS_H
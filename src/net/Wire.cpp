@@ -0,0 +1,176 @@
+#include "Wire.h"
+#include "../monitor/ProcessTable.h"
+#include <algorithm>
+
+namespace Wire {
+
+Writer::Writer(std::vector<uint8_t>& out) : out(out), start(out.size()) {
+    out.resize(start + HEADER_SIZE);
+}
+
+void Writer::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void Writer::putString(const std::string& value) {
+    putVarint(value.size());
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+void Writer::finish() {
+    uint32_t length = static_cast<uint32_t>(out.size() - start - HEADER_SIZE);
+    for (size_t i = 0; i < HEADER_SIZE; i++) {
+        out[start + i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+}
+
+uint8_t Reader::getByte() {
+    if (pos >= size) {
+        ok = false;
+        return 0;
+    }
+    return data[pos++];
+}
+
+uint64_t Reader::getVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= size) break;
+        uint8_t byte = data[pos++];
+        // The tenth byte only has room for bit 63
+        if (shift == 63 && byte > 1) break;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    ok = false;
+    return 0;
+}
+
+void Reader::getString(std::string& value) {
+    uint64_t length = getVarint();
+    if (!ok || length > size - pos) {
+        ok = false;
+        value.clear();
+        return;
+    }
+    value.assign(reinterpret_cast<const char*>(data + pos), static_cast<size_t>(length));
+    pos += static_cast<size_t>(length);
+}
+
+uint32_t payloadLength(const uint8_t* header) {
+    return static_cast<uint32_t>(header[0]) | static_cast<uint32_t>(header[1]) << 8 |
+           static_cast<uint32_t>(header[2]) << 16 | static_cast<uint32_t>(header[3]) << 24;
+}
+
+void readSystem(Reader& reader, SystemFields& fields) {
+    fields.cpu_usage = reader.getPercent();
+    fields.mem_usage_percent = reader.getPercent();
+    fields.used_mem_kb = static_cast<long>(reader.getVarint());
+    fields.total_mem_kb = static_cast<long>(reader.getVarint());
+    fields.process_count = static_cast<int>(reader.getVarint());
+}
+
+void encodeHello(const std::string& hostname, std::vector<uint8_t>& out) {
+    Writer writer(out);
+    writer.putByte(HELLO);
+    writer.putVarint(VERSION);
+    writer.putString(hostname);
+    writer.finish();
+}
+
+namespace {
+    void putSystem(Writer& writer, const SystemMetrics& metrics) {
+        writer.putPercent(metrics.cpu_usage);
+        writer.putPercent(metrics.mem_usage_percent);
+        writer.putVarint(metrics.used_mem_kb > 0 ? metrics.used_mem_kb : 0);
+        writer.putVarint(metrics.total_mem_kb > 0 ? metrics.total_mem_kb : 0);
+        writer.putVarint(metrics.process_count > 0 ? metrics.process_count : 0);
+    }
+
+    void putProcess(Writer& writer, int& last_pid, int pid, double cpu, long rss, int priority,
+                    const std::string* name) {
+        writer.putVarint(static_cast<uint32_t>(pid - last_pid));
+        last_pid = pid;
+        writer.putPercent(cpu);
+        writer.putVarint(rss > 0 ? rss : 0);
+        writer.putSigned(priority);
+        if (name) writer.putString(*name);
+    }
+}
+
+void encodeFrame(const SystemMetrics& metrics, bool keyframe, std::vector<uint8_t>& out,
+                 EncodeScratch& scratch) {
+    Writer writer(out);
+    unsigned long sequence = metrics.delta ? metrics.delta->sequence : 0;
+
+    if (keyframe && metrics.process_table) {
+        const ProcessTable& table = *metrics.process_table;
+        writer.putByte(KEYFRAME);
+        writer.putVarint(sequence);
+        putSystem(writer, metrics);
+
+        table.rank(SortKey::PID, scratch.order, table.size());
+        writer.putVarint(table.size());
+        int last_pid = 0;
+        for (uint32_t row : scratch.order) {
+            putProcess(writer, last_pid, table.getPid(row), table.getCPU(row), table.getRSS(row),
+                       table.getPriority(row), &table.getName(row));
+        }
+        writer.finish();
+        return;
+    }
+
+    writer.putByte(DELTA);
+    writer.putVarint(sequence);
+    putSystem(writer, metrics);
+
+    if (!metrics.delta) {
+        writer.putVarint(0);
+        writer.putVarint(0);
+        writer.putVarint(0);
+        writer.finish();
+        return;
+    }
+
+    const SnapshotDelta& delta = *metrics.delta;
+    auto by_pid = [](const ProcessInfo* a, const ProcessInfo* b) { return a->pid < b->pid; };
+
+    scratch.pids.clear();
+    for (const auto& proc : delta.exited) scratch.pids.push_back(proc.pid);
+    std::sort(scratch.pids.begin(), scratch.pids.end());
+    writer.putVarint(scratch.pids.size());
+    int last_pid = 0;
+    for (int pid : scratch.pids) {
+        writer.putVarint(static_cast<uint32_t>(pid - last_pid));
+        last_pid = pid;
+    }
+
+    scratch.infos.clear();
+    for (const auto& proc : delta.spawned) scratch.infos.push_back(&proc);
+    std::sort(scratch.infos.begin(), scratch.infos.end(), by_pid);
+    writer.putVarint(scratch.infos.size());
+    last_pid = 0;
+    for (const ProcessInfo* proc : scratch.infos) {
+        putProcess(writer, last_pid, proc->pid, proc->cpu_usage, proc->memory_kb, proc->priority,
+                   &proc->name);
+    }
+
+    scratch.changes.clear();
+    for (const auto& change : delta.changed) scratch.changes.push_back(&change);
+    std::sort(scratch.changes.begin(), scratch.changes.end(),
+              [](const ProcessChange* a, const ProcessChange* b) { return a->pid < b->pid; });
+    writer.putVarint(scratch.changes.size());
+    last_pid = 0;
+    for (const ProcessChange* change : scratch.changes) {
+        putProcess(writer, last_pid, change->pid, change->cpu_usage, change->memory_kb,
+                   change->priority, nullptr);
+    }
+
+    writer.finish();
+}
+
+} // namespace Wire
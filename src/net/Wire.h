@@ -0,0 +1,111 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include "../monitor/ProcessInfo.h"
+#include "../monitor/SnapshotDelta.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary agent -> aggregator protocol.
+//
+// Every message is a 4-byte little-endian payload length followed by the
+// payload. Integers are LEB128 varints (signed ones zigzag-encoded),
+// percentages are sent as hundredths, strings are a varint length plus
+// bytes. Process lists are sorted by PID and each PID is sent as the
+// difference from the previous one.
+//
+//   HELLO     type version hostname
+//   KEYFRAME  type seq system count { pid cpu rss prio name }
+//   DELTA     type seq system exits { pid } spawns { pid cpu rss prio name }
+//             changes { pid cpu rss prio }
+//   system =  cpu mem used_kb total_kb procs
+//
+// A DELTA is only meaningful on top of the previous frame; the agent sends
+// a KEYFRAME first, periodically, and after every reconnect.
+namespace Wire {
+    const uint32_t VERSION = 1;
+    const uint32_t MAX_PAYLOAD = 16 * 1024 * 1024;
+    const size_t HEADER_SIZE = 4;
+
+    enum MessageType {
+        HELLO = 1,
+        KEYFRAME = 2,
+        DELTA = 3
+    };
+
+    class Writer {
+    private:
+        std::vector<uint8_t>& out;
+        size_t start;
+
+    public:
+        // Reserves the length header; finish() fills it in
+        explicit Writer(std::vector<uint8_t>& out);
+
+        void putByte(uint8_t value) { out.push_back(value); }
+        void putVarint(uint64_t value);
+        void putSigned(int64_t value) { putVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63)); }
+        // Hundredths; NaN and negatives go as 0, huge values saturate
+        void putPercent(double value) {
+            putVarint(value > 0.0 ? static_cast<uint64_t>((value < 1e15 ? value : 1e15) * 100.0 + 0.5) : 0);
+        }
+        void putString(const std::string& value);
+        void finish();
+    };
+
+    class Reader {
+    private:
+        const uint8_t* data;
+        size_t size;
+        size_t pos;
+        bool ok;
+
+    public:
+        Reader(const uint8_t* data, size_t size) : data(data), size(size), pos(0), ok(true) {}
+
+        uint8_t getByte();
+        uint64_t getVarint();
+        int64_t getSigned() { uint64_t v = getVarint(); return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+        double getPercent() { return getVarint() / 100.0; }
+        void getString(std::string& value);
+
+        // False once any read ran past the end or hit a malformed varint
+        bool good() const { return ok; }
+        bool atEnd() const { return pos == size; }
+    };
+
+    // System-level fields carried by every frame
+    struct SystemFields {
+        double cpu_usage;
+        double mem_usage_percent;
+        long used_mem_kb;
+        long total_mem_kb;
+        int process_count;
+
+        SystemFields() : cpu_usage(0.0), mem_usage_percent(0.0), used_mem_kb(0), total_mem_kb(0),
+                         process_count(0) {}
+    };
+
+    void readSystem(Reader& reader, SystemFields& fields);
+
+    void encodeHello(const std::string& hostname, std::vector<uint8_t>& out);
+
+    // Scratch vectors reused across calls; kept by the caller
+    struct EncodeScratch {
+        std::vector<uint32_t> order;
+        std::vector<const ProcessInfo*> infos;
+        std::vector<const ProcessChange*> changes;
+        std::vector<int> pids;
+    };
+
+    // Appends one frame built from `metrics`. Keyframes need
+    // metrics.process_table; deltas need metrics.delta.
+    void encodeFrame(const SystemMetrics& metrics, bool keyframe, std::vector<uint8_t>& out,
+                     EncodeScratch& scratch);
+
+    // Reads the payload length from a complete 4-byte header
+    uint32_t payloadLength(const uint8_t* header);
+}
+
+#endif // WIRE_H
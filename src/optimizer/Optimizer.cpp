@@ -1,7 +1,15 @@
 #include "./Optimizer.h"
 #include "../platform/Platform.h"
+#include <algorithm>
 
-Optimizer::Optimizer(int threshold) : cpu_threshold(threshold) {}
+namespace {
+    // Well ahead of default processes (0) without the "always first" of 1000
+    const int OOM_SCORE_BIAS = 500;
+}
+
+Optimizer::Optimizer(int threshold)
+    : cpu_threshold(threshold), anomaly_trigger(false), delay_threshold(0.0), oom_horizon_sec(0.0),
+      numa_affinity(false) {}
 
 std::vector<ProcessInfo> Optimizer::optimizeProcesses(const std::vector<ProcessInfo>& processes) {
     std::vector<ProcessInfo> optimized;
@@ -17,10 +25,134 @@ std::vector<ProcessInfo> Optimizer::optimizeProcesses(const std::vector<ProcessI
     return optimized;
 }
 
+std::vector<ProcessAnomaly> Optimizer::optimizeAnomalies(const std::vector<ProcessAnomaly>& anomalies) {
+    std::vector<ProcessAnomaly> optimized;
+    if (!anomaly_trigger) return optimized;
+    
+    for (const auto& anomaly : anomalies) {
+        // Renicing only helps CPU; memory anomalies are reported, not acted on
+        if (anomaly.type != AnomalyType::CPU_SPIKE) continue;
+        if (anomaly_handled.count(anomaly.pid)) continue;
+        
+        if (optimizeProcess(anomaly.pid, 10)) {
+            anomaly_handled.insert(anomaly.pid);
+            optimized.push_back(anomaly);
+        }
+    }
+    
+    return optimized;
+}
+
+std::vector<ProcessInfo> Optimizer::optimizeContention(const std::vector<ProcessInfo>& processes,
+                                                   const std::vector<SchedInfo>& delayed) {
+    std::vector<ProcessInfo> optimized;
+    if (delay_threshold <= 0.0 || delayed.empty()) return optimized;
+    
+    // `delayed` is ranked, so the first entry decides whether there is contention
+    if (delayed.front().delay_percent < delay_threshold) return optimized;
+    
+    std::set<int> victims;
+    for (const auto& proc : delayed) {
+        if (proc.delay_percent >= delay_threshold) victims.insert(proc.pid);
+    }
+    
+    for (const auto& proc : processes) {
+        // stat priority is 20 + nice; at nice 10 there is nothing left to do
+        if (proc.cpu_usage <= cpu_threshold / 2.0 || proc.priority >= 30) continue;
+        if (victims.count(proc.pid)) continue;
+        
+        if (optimizeProcess(proc.pid, 10)) {
+            optimized.push_back(proc);
+        }
+    }
+    
+    return optimized;
+}
+
+std::vector<SubtreeInfo> Optimizer::optimizeSubtrees(const ProcessTree& tree,
+                                                  const ProcessTable& processes) {
+    std::vector<SubtreeInfo> optimized;
+    tree.findHeavySubtrees(processes, cpu_threshold, heavy_scratch);
+    
+    for (const auto& subtree : heavy_scratch) {
+        if (subtree_handled.count(subtree.pid)) continue;
+        
+        member_scratch.clear();
+        tree.getSubtree(subtree.pid, member_scratch);
+        bool any = false;
+        for (int pid : member_scratch) {
+            size_t row;
+            // stat priority is 20 + nice; members already at nice 10 are left alone
+            if (processes.find(pid, row) && processes.getPriority(row) >= 30) continue;
+            if (optimizeProcess(pid, 10)) any = true;
+        }
+        
+        if (any) {
+            subtree_handled.insert(subtree.pid);
+            optimized.push_back(subtree);
+        }
+    }
+    
+    return optimized;
+}
+
+std::vector<MemoryGrowth> Optimizer::optimizeMemory(const MemoryForecast& forecast,
+                                                     long total_mem_kb) {
+    std::vector<MemoryGrowth> optimized;
+    if (oom_horizon_sec <= 0.0 || forecast.seconds_to_exhaustion < 0.0 ||
+        forecast.seconds_to_exhaustion > oom_horizon_sec) {
+        return optimized;
+    }
+    
+    double host_growth_kb_per_sec = forecast.trend_percent_per_hour / 3600.0 / 100.0 * total_mem_kb;
+    for (const auto& proc : forecast.growing) {
+        if (proc.growth_kb_per_sec < host_growth_kb_per_sec / 10.0) continue;
+        if (oom_handled.count(proc.pid)) continue;
+        
+        if (Platform::setOOMScoreAdjust(proc.pid, OOM_SCORE_BIAS)) {
+            oom_handled.insert(proc.pid);
+            optimized.push_back(proc);
+        }
+    }
+    
+    return optimized;
+}
+
+std::vector<NumaPlacement> Optimizer::optimizeNuma(const std::vector<NumaPlacement>& placements,
+                                                   const std::vector<NumaNodeInfo>& nodes) {
+    std::vector<NumaPlacement> optimized;
+    if (!numa_affinity) return optimized;
+    
+    for (const auto& proc : placements) {
+        if (proc.suggested_node < 0 || numa_handled.count(proc.pid)) continue;
+        
+        auto node = std::find_if(nodes.begin(), nodes.end(), [&proc](const NumaNodeInfo& info) {
+            return info.node == proc.suggested_node;
+        });
+        if (node == nodes.end() || node->cpus.empty() || node->cpu_percent > cpu_threshold) continue;
+        
+        if (Platform::setProcessAffinity(proc.pid, node->cpus)) {
+            numa_handled.insert(proc.pid);
+            optimized.push_back(proc);
+        }
+    }
+    
+    return optimized;
+}
+
 bool Optimizer::optimizeProcess(int pid, int nice_increment) {
     return Platform::setProcessPriority(pid, nice_increment);
 }
 
+void Optimizer::forgetExited(const SnapshotDelta& delta) {
+    for (const auto& proc : delta.exited) {
+        anomaly_handled.erase(proc.pid);
+        subtree_handled.erase(proc.pid);
+        oom_handled.erase(proc.pid);
+        numa_handled.erase(proc.pid);
+    }
+}
+
 void Optimizer::setCPUThreshold(int threshold) {
     cpu_threshold = threshold;
 }
\ No newline at end of file
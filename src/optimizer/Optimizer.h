@@ -2,18 +2,66 @@
 #define OPTIMIZER_H
 
 #include "../monitor/ProcessInfo.h"
+#include "../monitor/SnapshotDelta.h"
+#include "../monitor/ProcessTree.h"
 #include <vector>
+#include <set>
 
 class Optimizer {
 private:
     int cpu_threshold;
+    bool anomaly_trigger;
+    double delay_threshold;
+    double oom_horizon_sec;
+    std::set<int> anomaly_handled;
+    std::set<int> subtree_handled;
+    std::set<int> oom_handled;
+    bool numa_affinity;
+    std::set<int> numa_handled;
+    std::vector<SubtreeInfo> heavy_scratch;
+    std::vector<int> member_scratch;
     
 public:
     Optimizer(int threshold = 80);
     std::vector<ProcessInfo> optimizeProcesses(const std::vector<ProcessInfo>& processes);
+    // Lowers the priority of processes flagged as runaway CPU consumers.
+    // No-op unless the anomaly trigger is enabled.
+    std::vector<ProcessAnomaly> optimizeAnomalies(const std::vector<ProcessAnomaly>& anomalies);
+    // Run-queue contention: once some process spends more than the delay
+    // threshold (% of its time) waiting for a CPU, CPU consumers above half
+    // the CPU threshold are reniced too, sparing the delayed ones. No-op
+    // while the delay threshold is 0 or without scheduler tracking.
+    std::vector<ProcessInfo> optimizeContention(const std::vector<ProcessInfo>& processes,
+                                                const std::vector<SchedInfo>& delayed);
+    // Renices every process of each subtree whose combined CPU exceeds the
+    // threshold while none of its members does on its own (a build's
+    // compilers, a worker pool). Each subtree root is handled once; later
+    // children of a handled subtree inherit its nice value anyway.
+    std::vector<SubtreeInfo> optimizeSubtrees(const ProcessTree& tree, const ProcessTable& processes);
+    // Once host memory is projected to run out within the OOM horizon,
+    // makes the processes behind the growth (each at least a tenth of it)
+    // the OOM killer's preferred victims. Renicing does nothing for memory,
+    // so this only moves oom_score_adj up. No-op while the horizon is 0.
+    std::vector<MemoryGrowth> optimizeMemory(const MemoryForecast& forecast, long total_mem_kb);
+    // Pins each process with a suggested NUMA node to that node's CPUs, so
+    // its threads run next to its memory. Skipped while the node's CPUs
+    // are busier than the CPU threshold; each process is pinned once.
+    // No-op unless NUMA affinity is enabled.
+    std::vector<NumaPlacement> optimizeNuma(const std::vector<NumaPlacement>& placements,
+                                            const std::vector<NumaNodeInfo>& nodes);
     bool optimizeProcess(int pid, int nice_increment = 10);
+    // Drops bookkeeping for processes that exited (or exec'd) this tick
+    void forgetExited(const SnapshotDelta& delta);
     void setCPUThreshold(int threshold);
     int getCPUThreshold() const { return cpu_threshold; }
+    void setAnomalyTrigger(bool enabled) { anomaly_trigger = enabled; }
+    bool getAnomalyTrigger() const { return anomaly_trigger; }
+    void setDelayThreshold(double percent) { delay_threshold = percent; }
+    double getDelayThreshold() const { return delay_threshold; }
+    void setOOMHorizon(double seconds) { oom_horizon_sec = seconds; }
+    double getOOMHorizon() const { return oom_horizon_sec; }
+    void setNumaAffinity(bool enabled) { numa_affinity = enabled; }
+    bool getNumaAffinity() const { return numa_affinity; }
 };
 
 #endif // OPTIMIZER_H
\ No newline at end of file
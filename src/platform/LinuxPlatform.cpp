@@ -1,29 +1,477 @@
 #if defined(__linux__)
 
 #include "Platform.h"
+#include "../utils/Instrumentation.h"
 #include <fstream>
 #include <sstream>
 #include <dirent.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <sys/resource.h>
+#include <sched.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <pwd.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/ioctl.h>
 #include <thread>
 #include <chrono>
 #include <algorithm>
+#include <cstdlib>
+#include <climits>
 
 namespace Platform {
 
-void getCPUStats(long& total, long& idle) {
-    std::ifstream stat("/proc/stat");
-    std::string line;
-    std::getline(stat, line);
+namespace {
+    std::string proc_root = "/proc";
+    int proc_root_fd = -1;
+    
+    // Kept open across scans: rewinddir() re-reads /proc without
+    // reallocating the directory stream
+    DIR* proc_dir = nullptr;
+    
+    int cgroup_root_fd = -2;    // -2: not probed yet, -1: no cgroup2 mount
+    int node_root_fd = -2;      // Same, for /sys/devices/system/node
+    std::string sys_root = "/sys";
+    
+    // getCPUFrequencies() / getThermalZones(): sysfs attributes opened once
+    // and re-read with pread; -1 where a file does not exist
+    struct CPUSensor {
+        int cur_fd;
+        int core_fd;
+        int package_fd;
+        long max_khz;
+        int package;
+    };
+    
+    struct ZoneSensor {
+        int id;
+        int temp_fd;
+        std::string type;
+    };
+    
+    bool sensors_opened = false;
+    std::vector<CPUSensor> cpu_sensors;
+    bool zones_opened = false;
+    std::vector<ZoneSensor> zone_sensors;
+    
+    // getVMStats(): /proc/vmstat keeps its line order for the life of the
+    // kernel, so each line is matched against the key table once and later
+    // reads go straight from line number to counter. A line whose key no
+    // longer ends where it did means the layout changed; it is rebuilt.
+    struct VMStatKey {
+        const char* name;
+        long long VMStats::* field;
+        bool per_zone;          // Also <name>_<zone> on older kernels
+    };
+    
+    const VMStatKey VMSTAT_KEYS[] = {
+        { "pgfault", &VMStats::page_faults, false },
+        { "pgmajfault", &VMStats::major_faults, false },
+        { "pswpin", &VMStats::swap_in, false },
+        { "pswpout", &VMStats::swap_out, false },
+        { "pgscan_kswapd", &VMStats::scan_kswapd, true },
+        { "pgscan_direct", &VMStats::scan_direct, true },
+        { "pgsteal_kswapd", &VMStats::steal_kswapd, true },
+        { "pgsteal_direct", &VMStats::steal_direct, true },
+        { "oom_kill", &VMStats::oom_kills, false }
+    };
+    
+    struct VMStatLine {
+        uint16_t key_len;
+        int8_t key;             // Into VMSTAT_KEYS, or -1
+    };
+    
+    std::vector<VMStatLine> vmstat_layout;
+    
+    // setHoldProcessFiles(): <pid>/stat descriptors kept from the last scan,
+    // sorted by PID, and how many more may be opened
+    struct HeldFile {
+        int pid;
+        int fd;
+        
+        bool operator<(const HeldFile& other) const { return pid < other.pid; }
+    };
+    bool hold_files = false;
+    int hold_requests = 0;
+    std::vector<HeldFile> held_files;
+    std::vector<HeldFile> next_held_files;
+    size_t hold_budget = 0;
+    
+    void releaseHeldFiles() {
+        for (const HeldFile& held : held_files) {
+            if (held.fd < 0) continue;
+            close(held.fd);
+            SYSMON_SYSCALLS(1);
+        }
+        held_files.clear();
+    }
+    
+    int procRootFd() {
+        if (proc_root_fd < 0) {
+            proc_root_fd = open(proc_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        }
+        return proc_root_fd;
+    }
+    
+    // Pure v2 hosts mount the hierarchy at /sys/fs/cgroup; hybrid ones at
+    // /sys/fs/cgroup/unified
+    int cgroupRootFd() {
+        if (cgroup_root_fd == -2) {
+            const char* const roots[] = {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"};
+            cgroup_root_fd = -1;
+            for (const char* root : roots) {
+                int fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (fd < 0) continue;
+                if (faccessat(fd, "cgroup.procs", F_OK, 0) == 0) {
+                    cgroup_root_fd = fd;
+                    break;
+                }
+                close(fd);
+            }
+        }
+        return cgroup_root_fd;
+    }
+    
+    int nodeRootFd() {
+        if (node_root_fd == -2) {
+            std::string path = sys_root + "/devices/system/node";
+            node_root_fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (node_root_fd < 0) node_root_fd = -1;
+        }
+        return node_root_fd;
+    }
+    
+    // Kernel CPU/node lists: "0-3,8-11"
+    void parseList(const char* p, std::vector<int>& out) {
+        out.clear();
+        while (*p >= '0' && *p <= '9') {
+            char* end;
+            long first = strtol(p, &end, 10);
+            long last = first;
+            if (*end == '-') last = strtol(end + 1, &end, 10);
+            for (long i = first; i <= last; i++) out.push_back(static_cast<int>(i));
+            p = *end == ',' ? end + 1 : end;
+        }
+    }
+    
+    // Whole file into a buffer that grows as needed and is kept
+    bool readWholeFile(int dir_fd, const char* path, std::vector<char>& buf, size_t& len) {
+        int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+        SYSMON_SYSCALLS(1);
+        if (fd < 0) return false;
+        len = 0;
+        for (;;) {
+            if (len + 1 >= buf.size()) buf.resize(std::max<size_t>(4096, buf.size() * 2));
+            ssize_t n = read(fd, buf.data() + len, buf.size() - len - 1);
+            SYSMON_SYSCALLS(1);
+            if (n <= 0) break;
+            len += static_cast<size_t>(n);
+        }
+        close(fd);
+        SYSMON_SYSCALLS(1);
+        buf[len] = '\0';
+        return len > 0;
+    }
+    
+    bool readSmallFile(int dir_fd, const char* path, char* buf, size_t size, size_t& len) {
+        int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            SYSMON_SYSCALLS(1);
+            return false;
+        }
+        
+        ssize_t n = read(fd, buf, size - 1);
+        close(fd);
+        SYSMON_SYSCALLS(3);
+        if (n <= 0) return false;
+        
+        buf[n] = '\0';
+        len = static_cast<size_t>(n);
+        return true;
+    }
+    
+    void closeSensors() {
+        for (const CPUSensor& sensor : cpu_sensors) {
+            if (sensor.cur_fd >= 0) close(sensor.cur_fd);
+            if (sensor.core_fd >= 0) close(sensor.core_fd);
+            if (sensor.package_fd >= 0) close(sensor.package_fd);
+        }
+        for (const ZoneSensor& zone : zone_sensors) {
+            if (zone.temp_fd >= 0) close(zone.temp_fd);
+        }
+        cpu_sensors.clear();
+        zone_sensors.clear();
+        sensors_opened = false;
+        zones_opened = false;
+    }
+    
+    // A single integer attribute through a kept descriptor; -1 on failure
+    long long preadNumber(int fd) {
+        if (fd < 0) return -1;
+        char buf[32];
+        ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+        SYSMON_SYSCALLS(1);
+        if (n <= 0) return -1;
+        buf[n] = '\0';
+        return strtoll(buf, nullptr, 10);
+    }
+    
+    // preadNumber() through a kept descriptor that is opened again once if
+    // the read fails (a reloaded driver or removed zone leaves it stale).
+    // If that fails too it stays closed until the sensors are refreshed.
+    // `format` is the path below the sysfs root, with one %d for `index`.
+    long long preadSensor(int& fd, const char* format, int index) {
+        if (fd < 0) return -1;
+        long long value = preadNumber(fd);
+        if (value != -1) return value;
+        
+        close(fd);
+        char relative[128];
+        snprintf(relative, sizeof(relative), format, index);
+        std::string path = sys_root + relative;
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        SYSMON_SYSCALLS(2);
+        value = preadNumber(fd);
+        if (value == -1 && fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+        return value;
+    }
+    
+    long readNumberAt(int dir_fd, const char* path, long fallback) {
+        char buf[64];
+        size_t len;
+        if (!readSmallFile(dir_fd, path, buf, sizeof(buf), len)) return fallback;
+        return strtol(buf, nullptr, 10);
+    }
     
-    std::istringstream ss(line);
-    std::string cpu;
-    long user, nice, system, idle_time, iowait, irq, softirq;
+    void openCPUSensors() {
+        sensors_opened = true;
+        std::string path = sys_root + "/devices/system/cpu";
+        int dir_fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd < 0) return;
+        
+        char buf[4096];
+        size_t len;
+        std::vector<int> present;
+        if (readSmallFile(dir_fd, "present", buf, sizeof(buf), len)) parseList(buf, present);
+        
+        for (int cpu : present) {
+            if (cpu < 0 || cpu >= 65536) continue;
+            if (static_cast<size_t>(cpu) >= cpu_sensors.size()) {
+                CPUSensor none = { -1, -1, -1, 0, 0 };
+                cpu_sensors.resize(cpu + 1, none);
+            }
+            CPUSensor& sensor = cpu_sensors[cpu];
+            char file[96];
+            snprintf(file, sizeof(file), "cpu%d/cpufreq/scaling_cur_freq", cpu);
+            sensor.cur_fd = openat(dir_fd, file, O_RDONLY | O_CLOEXEC);
+            snprintf(file, sizeof(file), "cpu%d/thermal_throttle/core_throttle_count", cpu);
+            sensor.core_fd = openat(dir_fd, file, O_RDONLY | O_CLOEXEC);
+            snprintf(file, sizeof(file), "cpu%d/thermal_throttle/package_throttle_count", cpu);
+            sensor.package_fd = openat(dir_fd, file, O_RDONLY | O_CLOEXEC);
+            snprintf(file, sizeof(file), "cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+            sensor.max_khz = readNumberAt(dir_fd, file, 0);
+            snprintf(file, sizeof(file), "cpu%d/topology/physical_package_id", cpu);
+            sensor.package = static_cast<int>(readNumberAt(dir_fd, file, 0));
+            SYSMON_SYSCALLS(3);
+        }
+        close(dir_fd);
+    }
     
-    ss >> cpu >> user >> nice >> system >> idle_time >> iowait >> irq >> softirq;
+    void openThermalZones() {
+        zones_opened = true;
+        std::string path = sys_root + "/class/thermal";
+        DIR* dir = opendir(path.c_str());
+        if (!dir) return;
+        
+        std::vector<int> ids;
+        while (struct dirent* entry = readdir(dir)) {
+            if (strncmp(entry->d_name, "thermal_zone", 12) == 0) {
+                ids.push_back(atoi(entry->d_name + 12));
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        
+        int dir_fd = dirfd(dir);
+        for (int id : ids) {
+            char file[64];
+            char buf[64];
+            size_t len;
+            ZoneSensor zone;
+            zone.id = id;
+            snprintf(file, sizeof(file), "thermal_zone%d/temp", id);
+            zone.temp_fd = openat(dir_fd, file, O_RDONLY | O_CLOEXEC);
+            SYSMON_SYSCALLS(1);
+            if (zone.temp_fd < 0) continue;
+            snprintf(file, sizeof(file), "thermal_zone%d/type", id);
+            if (readSmallFile(dir_fd, file, buf, sizeof(buf), len)) {
+                zone.type.assign(buf, strcspn(buf, "\n"));
+            } else {
+                zone.type = "zone" + std::to_string(id);
+            }
+            zone_sensors.push_back(zone);
+        }
+        closedir(dir);
+    }
+    
+    const char* skipFields(const char* p, int count) {
+        for (int i = 0; i < count && *p; i++) {
+            while (*p == ' ') p++;
+            while (*p && *p != ' ') p++;
+        }
+        return p;
+    }
+    
+    // Decimal integer after optional blanks; p ends on the first byte
+    // after it
+    long parseLong(const char*& p) {
+        while (*p == ' ' || *p == '\t' || *p == '\n') p++;
+        bool negative = *p == '-';
+        if (negative || *p == '+') p++;
+        long value = 0;
+        while (*p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+        return negative ? -value : value;
+    }
+    
+    bool keyIs(const char* key, size_t len, const char* expected) {
+        return strlen(expected) == len && memcmp(key, expected, len) == 0;
+    }
+    
+    int8_t findVMStatKey(const char* key, size_t len) {
+        const int count = static_cast<int>(sizeof(VMSTAT_KEYS) / sizeof(VMSTAT_KEYS[0]));
+        for (int i = 0; i < count; i++) {
+            const VMStatKey& entry = VMSTAT_KEYS[i];
+            size_t name_len = strlen(entry.name);
+            if (len < name_len || memcmp(key, entry.name, name_len) != 0) continue;
+            if (len == name_len) return static_cast<int8_t>(i);
+            // pgscan_direct_throttle counts stalls, not pages
+            if (entry.per_zone && key[name_len] == '_' && !keyIs(key, len, "pgscan_direct_throttle")) {
+                return static_cast<int8_t>(i);
+            }
+        }
+        return -1;
+    }
+    
+    void resolveVMStatLayout(const char* buf) {
+        vmstat_layout.clear();
+        for (const char* line = buf; line && *line; ) {
+            const char* space = strchr(line, ' ');
+            if (!space) break;
+            VMStatLine entry;
+            entry.key_len = static_cast<uint16_t>(space - line);
+            entry.key = findVMStatKey(line, entry.key_len);
+            vmstat_layout.push_back(entry);
+            line = strchr(space, '\n');
+            if (line) line++;
+        }
+    }
+    
+    // False when the layout no longer matches the buffer
+    bool readVMStatLines(const char* buf, size_t len, VMStats& stats) {
+        stats = VMStats();
+        const char* end = buf + len;
+        size_t index = 0;
+        for (const char* line = buf; line && *line; index++) {
+            if (index >= vmstat_layout.size()) return false;
+            const VMStatLine& entry = vmstat_layout[index];
+            if (line + entry.key_len >= end || line[entry.key_len] != ' ') return false;
+            
+            const char* p = line + entry.key_len + 1;
+            if (entry.key >= 0) stats.*VMSTAT_KEYS[entry.key].field += strtoll(p, nullptr, 10);
+            line = strchr(p, '\n');
+            if (line) line++;
+        }
+        return index == vmstat_layout.size();
+    }
+    
+    // <pid>/stat through a descriptor kept from the previous scan: a
+    // single pread instead of openat/read/close. New processes are opened
+    // and, within the budget, kept for the next scan.
+    bool readHeldStat(int dir_fd, int pid, char* buf, size_t size, size_t& len) {
+        HeldFile key = { pid, -1 };
+        auto it = std::lower_bound(held_files.begin(), held_files.end(), key);
+        int fd = -1;
+        if (it != held_files.end() && it->pid == pid) {
+            fd = it->fd;
+            it->fd = -1;
+        } else {
+            char path[32];
+            snprintf(path, sizeof(path), "%d/stat", pid);
+            fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+            SYSMON_SYSCALLS(1);
+            if (fd < 0) return false;
+        }
+        
+        ssize_t n = pread(fd, buf, size - 1, 0);
+        SYSMON_SYSCALLS(1);
+        // A descriptor of an exited process keeps failing with ESRCH
+        if (n <= 0 || next_held_files.size() >= hold_budget) {
+            close(fd);
+            SYSMON_SYSCALLS(1);
+        } else {
+            HeldFile held = { pid, fd };
+            next_held_files.push_back(held);
+        }
+        if (n <= 0) return false;
+        
+        buf[n] = '\0';
+        len = static_cast<size_t>(n);
+        return true;
+    }
+}
+
+std::mutex& collectorLock() {
+    static std::mutex lock;
+    return lock;
+}
+
+void setProcRoot(const std::string& root) {
+    std::lock_guard<std::mutex> guard(collectorLock());
+    proc_root = root.empty() ? "/proc" : root;
+    releaseHeldFiles();
+    
+    if (proc_root_fd >= 0) {
+        close(proc_root_fd);
+        proc_root_fd = -1;
+    }
+    if (proc_dir) {
+        closedir(proc_dir);
+        proc_dir = nullptr;
+    }
+    vmstat_layout.clear();
+}
+
+const std::string& getProcRoot() {
+    return proc_root;
+}
+
+void setSysRoot(const std::string& root) {
+    std::lock_guard<std::mutex> guard(collectorLock());
+    sys_root = root.empty() ? "/sys" : root;
+    closeSensors();
+    if (node_root_fd >= 0) close(node_root_fd);
+    node_root_fd = -2;
+}
+
+void getCPUStats(long& total, long& idle) {
+    char buf[4096];
+    size_t len;
+    total = 0;
+    idle = 0;
+    if (!readSmallFile(procRootFd(), "stat", buf, sizeof(buf), len)) return;
+    
+    // "cpu  user nice system idle iowait irq softirq ..."
+    const char* p = skipFields(buf, 1);
+    long user = parseLong(p), nice = parseLong(p), system = parseLong(p);
+    long idle_time = parseLong(p), iowait = parseLong(p);
+    long irq = parseLong(p), softirq = parseLong(p);
     
     idle = idle_time + iowait;
     total = user + nice + system + idle_time + iowait + irq + softirq;
@@ -41,93 +489,174 @@ double calculateCPUUsage(long prev_total, long prev_idle, long& new_total, long&
 }
 
 void getMemoryInfo(long& total_kb, long& available_kb, long& used_kb) {
-    std::ifstream meminfo("/proc/meminfo");
-    std::string line;
+    char buf[8192];
+    size_t len;
+    if (!readSmallFile(procRootFd(), "meminfo", buf, sizeof(buf), len)) return;
     
     long mem_free = 0, buffers = 0, cached = 0;
     
-    while (std::getline(meminfo, line)) {
-        std::istringstream ss(line);
-        std::string key;
-        long value;
+    for (const char* line = buf; line && *line; ) {
+        const char* colon = strchr(line, ':');
+        if (!colon) break;
         
-        ss >> key >> value;
+        size_t key_len = static_cast<size_t>(colon - line);
+        const char* p = colon + 1;
+        long value = parseLong(p);
         
-        if (key == "MemTotal:") total_kb = value;
-        else if (key == "MemFree:") mem_free = value;
-        else if (key == "MemAvailable:") available_kb = value;
-        else if (key == "Buffers:") buffers = value;
-        else if (key == "Cached:") cached = value;
+        if (keyIs(line, key_len, "MemTotal")) total_kb = value;
+        else if (keyIs(line, key_len, "MemFree")) mem_free = value;
+        else if (keyIs(line, key_len, "MemAvailable")) available_kb = value;
+        else if (keyIs(line, key_len, "Buffers")) buffers = value;
+        else if (keyIs(line, key_len, "Cached")) cached = value;
+        
+        line = strchr(p, '\n');
+        if (line) line++;
     }
     
     used_kb = total_kb - mem_free - buffers - cached;
 }
 
-std::vector<ProcessData> getProcessList() {
-    std::vector<ProcessData> processes;
-    DIR* dir = opendir("/proc");
+bool getSelfCPUTime(double& seconds) {
+    // One syscall, nothing to parse (unlike /proc/self/stat)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return false;
+    seconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+              (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    return true;
+}
+
+bool getVMStats(VMStats& stats) {
+    static std::vector<char> buf;
+    size_t len;
+    if (!readWholeFile(procRootFd(), "vmstat", buf, len)) return false;
     
-    if (!dir) return processes;
+    if (!readVMStatLines(buf.data(), len, stats)) {
+        resolveVMStatLayout(buf.data());
+        readVMStatLines(buf.data(), len, stats);
+    }
+    return true;
+}
+
+void scanProcesses(ProcessVisitor& visitor) {
+    if (proc_dir) {
+        rewinddir(proc_dir);
+    } else {
+        proc_dir = opendir(proc_root.c_str());
+        if (!proc_dir) return;
+    }
+    
+    static const long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    int dir_fd = dirfd(proc_dir);
+    char path[NAME_MAX + 6];
+    char buf[1024];
+    size_t len;
+    SYSMON_SPLIT(parse_timer, PARSE);
     
     struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
+    while ((entry = readdir(proc_dir)) != nullptr) {
         if (!isdigit(entry->d_name[0])) continue;
         
-        ProcessData proc;
-        proc.pid = std::stoi(entry->d_name);
-        
-        // Get process name
-        std::ifstream comm("/proc/" + std::string(entry->d_name) + "/comm");
-        std::getline(comm, proc.name);
-        
-        // Get memory usage
-        std::ifstream status("/proc/" + std::string(entry->d_name) + "/status");
-        std::string line;
-        while (std::getline(status, line)) {
-            if (line.substr(0, 6) == "VmRSS:") {
-                std::istringstream ss(line.substr(6));
-                ss >> proc.memory_kb;
-                break;
-            }
+        // Everything we need is on the stat line, so one read per process
+        int pid = atoi(entry->d_name);
+        if (hold_files) {
+            if (!readHeldStat(dir_fd, pid, buf, sizeof(buf), len)) continue;
+        } else {
+            snprintf(path, sizeof(path), "%s/stat", entry->d_name);
+            if (!readSmallFile(dir_fd, path, buf, sizeof(buf), len)) continue;
         }
         
-        // Get CPU usage (simplified)
-        std::ifstream stat("/proc/" + std::string(entry->d_name) + "/stat");
-        std::string stat_data;
-        std::getline(stat, stat_data);
-        
-        std::istringstream ss(stat_data);
-        std::string temp;
-        long utime, stime;
-        
-        for (int i = 0; i < 13; i++) ss >> temp;
-        ss >> utime >> stime;
+        SYSMON_SPLIT_BEGIN(parse_timer);
+        // comm may contain spaces and parentheses; it ends at the last ')'
+        const char* open_paren = static_cast<const char*>(memchr(buf, '(', len));
+        const char* close_paren = strrchr(buf, ')');
+        if (!open_paren || !close_paren || close_paren < open_paren) {
+            SYSMON_SPLIT_END(parse_timer);
+            continue;
+        }
         
-        // Simplified CPU calculation
-        proc.cpu_usage = (utime + stime) / 100.0;
+        ProcessSample sample;
+        sample.pid = pid;
+        sample.name = open_paren + 1;
+        sample.name_len = static_cast<size_t>(close_paren - open_paren - 1);
         
-        // Get priority
-        for (int i = 0; i < 4; i++) ss >> temp;
-        ss >> proc.priority;
+        // Fields after comm start at field 3 (state)
+        const char* p = skipFields(close_paren + 1, 1);    // 3
+        sample.ppid = static_cast<int>(parseLong(p));       // 4
+        p = skipFields(p, 7);                               // 5..11
+        sample.major_faults = parseLong(p);                 // 12
+        p = skipFields(p, 1);                               // 13
+        long utime = parseLong(p);                          // 14
+        long stime = parseLong(p);                          // 15
+        p = skipFields(p, 2);                               // 16, 17
+        sample.priority = static_cast<int>(parseLong(p));   // 18
+        p = skipFields(p, 5);                               // 19..23
+        long rss_pages = parseLong(p);                      // 24
         
-        if (proc.memory_kb > 0) {
-            processes.push_back(proc);
-        }
+        sample.cpu_ticks = utime + stime;
+        sample.memory_kb = rss_pages * page_kb;
+        SYSMON_SPLIT_END(parse_timer);
+        visitor.visit(sample);
     }
     
-    closedir(dir);
-    
-    // Sort by CPU usage
-    std::sort(processes.begin(), processes.end(),
-              [](const ProcessData& a, const ProcessData& b) {
-                  return a.memory_kb > b.memory_kb;
-              });
+    if (hold_files) {
+        // Whatever was not carried over belongs to exited processes
+        releaseHeldFiles();
+        std::sort(next_held_files.begin(), next_held_files.end());
+        held_files.swap(next_held_files);
+    }
+}
+
+void setHoldProcessFiles(bool hold) {
+    std::lock_guard<std::mutex> guard(collectorLock());
+    if (!hold) {
+        if (hold_requests > 0 && --hold_requests == 0) {
+            hold_files = false;
+            releaseHeldFiles();
+        }
+        return;
+    }
+    if (hold_requests++ > 0) return;
+    hold_files = true;
     
-    if (processes.size() > 10) {
-        processes.resize(10);
+    // One descriptor per process; take what the hard limit allows and
+    // leave headroom for everything else
+    struct rlimit limit;
+    hold_budget = 0;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        if (limit.rlim_cur != limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+            getrlimit(RLIMIT_NOFILE, &limit);
+        }
+        const rlim_t reserve = 256;
+        if (limit.rlim_cur == RLIM_INFINITY) {
+            hold_budget = 1 << 20;
+        } else if (limit.rlim_cur > reserve) {
+            hold_budget = static_cast<size_t>(limit.rlim_cur - reserve);
+        }
     }
+}
+
+std::vector<ProcessData> getProcessList() {
+    struct Collector : ProcessVisitor {
+        std::vector<ProcessData> processes;
+        
+        void visit(const ProcessSample& sample) {
+            ProcessData proc;
+            proc.pid = sample.pid;
+            proc.ppid = sample.ppid;
+            proc.name.assign(sample.name, sample.name_len);
+            proc.memory_kb = sample.memory_kb;
+            proc.priority = sample.priority;
+            proc.cpu_ticks = sample.cpu_ticks;
+            proc.major_faults = sample.major_faults;
+            processes.push_back(proc);
+        }
+    };
     
-    return processes;
+    Collector collector;
+    scanProcesses(collector);
+    return collector.processes;
 }
 
 bool setProcessPriority(int pid, int nice_value) {
@@ -136,9 +665,476 @@ bool setProcessPriority(int pid, int nice_value) {
         return false; // Need root for negative nice values
     }
     
+    SYSMON_SYSCALLS(1);
     return setpriority(PRIO_PROCESS, pid, nice_value) == 0;
 }
 
+bool getProcessUid(int pid, int& uid) {
+    // /proc/<pid> is owned by the process's real uid
+    char path[32];
+    snprintf(path, sizeof(path), "%d", pid);
+    struct stat info;
+    SYSMON_SYSCALLS(1);
+    if (fstatat(procRootFd(), path, &info, 0) != 0) return false;
+    uid = static_cast<int>(info.st_uid);
+    return true;
+}
+
+bool lookupUser(const std::string& name, int& uid) {
+    // Filters compile outside the collector lock, so not getpwnam()
+    struct passwd entry;
+    struct passwd* pw = nullptr;
+    char buf[4096];
+    if (getpwnam_r(name.c_str(), &entry, buf, sizeof(buf), &pw) != 0 || !pw) return false;
+    uid = static_cast<int>(pw->pw_uid);
+    return true;
+}
+
+bool setOOMScoreAdjust(int pid, int adjust) {
+    char path[64];
+    char value[16];
+    snprintf(path, sizeof(path), "%d/oom_score_adj", pid);
+    int len = snprintf(value, sizeof(value), "%d\n", adjust);
+    
+    SYSMON_SYSCALLS(3);
+    int fd = openat(procRootFd(), path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = write(fd, value, len) == len;
+    close(fd);
+    return ok;
+}
+
+bool getMemoryRollup(int pid, MemoryRollup& rollup) {
+    char path[64];
+    char buf[4096];
+    size_t len;
+    snprintf(path, sizeof(path), "%d/smaps_rollup", pid);
+    if (!readSmallFile(procRootFd(), path, buf, sizeof(buf), len)) return false;
+    
+    rollup.pss_kb = 0;
+    rollup.uss_kb = 0;
+    rollup.swap_kb = 0;
+    bool found = false;
+    
+    // The first line is the "[rollup]" VMA header; the rest are "Key: value kB"
+    for (const char* line = strchr(buf, '\n'); line && *++line; line = strchr(line, '\n')) {
+        const char* colon = strchr(line, ':');
+        if (!colon) break;
+        
+        size_t key_len = static_cast<size_t>(colon - line);
+        const char* p = colon + 1;
+        long value = parseLong(p);
+        
+        if (keyIs(line, key_len, "Pss")) { rollup.pss_kb = value; found = true; }
+        else if (keyIs(line, key_len, "Private_Clean") || keyIs(line, key_len, "Private_Dirty")) rollup.uss_kb += value;
+        else if (keyIs(line, key_len, "Swap")) rollup.swap_kb = value;
+        
+        line = p;
+    }
+    
+    return found;
+}
+
+namespace {
+    bool raw_input = false;
+    struct termios saved_termios;
+}
+
+void restoreInput() {
+    if (raw_input) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+        raw_input = false;
+    }
+}
+
+bool enableRawInput() {
+    if (raw_input) return true;
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved_termios) != 0) return false;
+    
+    // Keep ISIG so Ctrl+C still raises SIGINT
+    struct termios raw = saved_termios;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) return false;
+    
+    raw_input = true;
+    static bool registered = false;
+    if (!registered) {
+        atexit(restoreInput);
+        registered = true;
+    }
+    return true;
+}
+
+namespace {
+    // Cursor keys arrive as ESC [ <code> or ESC O <code>; a lone Escape
+    // has nothing following within a few milliseconds
+    int readEscape() {
+        char seq[8];
+        size_t len = 0;
+        struct pollfd pfd;
+        pfd.fd = STDIN_FILENO;
+        pfd.events = POLLIN;
+        while (len < sizeof(seq) - 1) {
+            pfd.revents = 0;
+            if (poll(&pfd, 1, 25) <= 0 || read(STDIN_FILENO, &seq[len], 1) != 1) break;
+            len++;
+            if (len >= 2 && (seq[len - 1] == '~' || (seq[len - 1] >= 'A' && seq[len - 1] <= 'Z'))) break;
+        }
+        seq[len] = '\0';
+        
+        if (len < 2 || (seq[0] != '[' && seq[0] != 'O')) return 0x1b;
+        const char* code = seq + 1;
+        if (strcmp(code, "A") == 0) return KEY_UP;
+        if (strcmp(code, "B") == 0) return KEY_DOWN;
+        if (strcmp(code, "5~") == 0) return KEY_PAGE_UP;
+        if (strcmp(code, "6~") == 0) return KEY_PAGE_DOWN;
+        if (strcmp(code, "H") == 0 || strcmp(code, "1~") == 0 || strcmp(code, "7~") == 0) return KEY_HOME;
+        if (strcmp(code, "F") == 0 || strcmp(code, "4~") == 0 || strcmp(code, "8~") == 0) return KEY_END;
+        return -1;
+    }
+}
+
+int waitForKey(int timeout_ms) {
+    if (timeout_ms < 0) timeout_ms = 0;
+    if (!raw_input) {
+        sleep(timeout_ms);
+        return -1;
+    }
+    
+    struct pollfd pfd;
+    pfd.fd = STDIN_FILENO;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, timeout_ms) <= 0) return -1;
+    
+    unsigned char key;
+    if (read(STDIN_FILENO, &key, 1) != 1) return -1;
+    return key == 0x1b ? readEscape() : key;
+}
+
+bool getTerminalSize(int& rows, int& columns) {
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_row == 0) return false;
+    rows = size.ws_row;
+    columns = size.ws_col;
+    return true;
+}
+
+bool getProcessCgroup(int pid, std::string& path) {
+    char file[64];
+    char buf[4096];
+    size_t len;
+    snprintf(file, sizeof(file), "%d/cgroup", pid);
+    if (!readSmallFile(procRootFd(), file, buf, sizeof(buf), len)) return false;
+    
+    // The unified hierarchy is the "0::<path>" entry
+    for (const char* line = buf; line && *line; ) {
+        const char* end = strchr(line, '\n');
+        size_t line_len = end ? static_cast<size_t>(end - line) : strlen(line);
+        if (line_len > 3 && memcmp(line, "0::", 3) == 0) {
+            path.assign(line + 3, line_len - 3);
+            return true;
+        }
+        line = end ? end + 1 : nullptr;
+    }
+    return false;
+}
+
+bool getCgroupStats(const std::string& path, CgroupStats& stats) {
+    int root_fd = cgroupRootFd();
+    if (root_fd < 0) return false;
+    
+    stats.cpu_usage_usec = 0;
+    stats.memory_kb = 0;
+    stats.io_read_bytes = 0;
+    stats.io_write_bytes = 0;
+    
+    // openat() wants a relative path; the root group is "."
+    const char* dir = path.c_str();
+    while (*dir == '/') dir++;
+    if (!*dir) dir = ".";
+    
+    char file[512];
+    char buf[4096];
+    size_t len;
+    
+    snprintf(file, sizeof(file), "%s/cpu.stat", dir);
+    if (!readSmallFile(root_fd, file, buf, sizeof(buf), len)) return false;
+    const char* p = strstr(buf, "usage_usec ");
+    if (p) {
+        p += 11;
+        stats.cpu_usage_usec = strtoll(p, nullptr, 10);
+    }
+    
+    snprintf(file, sizeof(file), "%s/memory.current", dir);
+    if (readSmallFile(root_fd, file, buf, sizeof(buf), len)) {
+        stats.memory_kb = static_cast<long>(strtoll(buf, nullptr, 10) / 1024);
+    }
+    
+    // "MAJ:MIN rbytes=N wbytes=N rios=N wios=N dbytes=N dios=N", one line per device
+    snprintf(file, sizeof(file), "%s/io.stat", dir);
+    if (readSmallFile(root_fd, file, buf, sizeof(buf), len)) {
+        for (const char* q = strstr(buf, "rbytes="); q; q = strstr(q, "rbytes=")) {
+            q += 7;
+            stats.io_read_bytes += strtoll(q, nullptr, 10);
+        }
+        for (const char* q = strstr(buf, "wbytes="); q; q = strstr(q, "wbytes=")) {
+            q += 7;
+            stats.io_write_bytes += strtoll(q, nullptr, 10);
+        }
+    }
+    
+    return true;
+}
+
+bool getProcessSchedStats(int pid, SchedStats& stats) {
+    char path[64];
+    char buf[128];
+    size_t len;
+    snprintf(path, sizeof(path), "%d/schedstat", pid);
+    if (!readSmallFile(procRootFd(), path, buf, sizeof(buf), len)) return false;
+    
+    // "run_ns wait_ns timeslices"
+    const char* p = buf;
+    stats.run_ns = parseLong(p);
+    stats.wait_ns = parseLong(p);
+    stats.timeslices = parseLong(p);
+    return true;
+}
+
+bool getCPUSchedStats(std::vector<SchedStats>& cpus) {
+    // Domain lines make this file a few hundred bytes per CPU
+    static std::vector<char> buf(16384);
+    cpus.clear();
+    
+    int fd = openat(procRootFd(), "schedstat", O_RDONLY | O_CLOEXEC);
+    SYSMON_SYSCALLS(1);
+    if (fd < 0) return false;
+    size_t len = 0;
+    for (;;) {
+        if (len + 1 >= buf.size()) buf.resize(buf.size() * 2);
+        ssize_t n = read(fd, buf.data() + len, buf.size() - len - 1);
+        SYSMON_SYSCALLS(1);
+        if (n <= 0) break;
+        len += static_cast<size_t>(n);
+    }
+    close(fd);
+    SYSMON_SYSCALLS(1);
+    buf[len] = '\0';
+    
+    // "cpuN yld_count 0 sched_count sched_goidle ttwu_count ttwu_local
+    //  rq_cpu_time run_delay pcount"
+    for (const char* line = buf.data(); line && *line; ) {
+        if (memcmp(line, "cpu", 3) == 0) {
+            const char* p = skipFields(line, 7);
+            SchedStats stats;
+            stats.run_ns = parseLong(p);
+            stats.wait_ns = parseLong(p);
+            stats.timeslices = parseLong(p);
+            cpus.push_back(stats);
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    return !cpus.empty();
+}
+
+bool getPerCPUStats(std::vector<CPUTicks>& cpus) {
+    // The intr line alone can be tens of KB on big hosts
+    static std::vector<char> buf;
+    size_t len;
+    cpus.clear();
+    if (!readWholeFile(procRootFd(), "stat", buf, len)) return false;
+    
+    for (const char* line = buf.data(); line && *line; ) {
+        if (memcmp(line, "cpu", 3) != 0) break;
+        if (line[3] >= '0' && line[3] <= '9') {
+            const char* p = line + 3;
+            long cpu = parseLong(p);
+            long user = parseLong(p), nice = parseLong(p), system = parseLong(p);
+            long idle_time = parseLong(p), iowait = parseLong(p);
+            long irq = parseLong(p), softirq = parseLong(p);
+            if (cpu >= 0 && cpu < 65536) {
+                if (static_cast<size_t>(cpu) >= cpus.size()) cpus.resize(cpu + 1, CPUTicks());
+                cpus[cpu].idle = idle_time + iowait;
+                cpus[cpu].total = user + nice + system + idle_time + iowait + irq + softirq;
+            }
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    return !cpus.empty();
+}
+
+bool getCPUFrequencies(std::vector<CPUFrequency>& cpus) {
+    if (!sensors_opened) openCPUSensors();
+    cpus.resize(cpu_sensors.size());
+    
+    bool any = false;
+    for (size_t i = 0; i < cpu_sensors.size(); i++) {
+        CPUSensor& sensor = cpu_sensors[i];
+        CPUFrequency& cpu = cpus[i];
+        int number = static_cast<int>(i);
+        long long cur = preadSensor(sensor.cur_fd, "/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", number);
+        cpu.cur_khz = cur > 0 ? static_cast<long>(cur) : 0;
+        cpu.max_khz = sensor.max_khz;
+        cpu.package = sensor.package;
+        cpu.core_throttles = preadSensor(sensor.core_fd,
+                                         "/devices/system/cpu/cpu%d/thermal_throttle/core_throttle_count", number);
+        cpu.package_throttles = preadSensor(sensor.package_fd,
+                                            "/devices/system/cpu/cpu%d/thermal_throttle/package_throttle_count",
+                                            number);
+        any = any || cpu.cur_khz > 0;
+    }
+    return any;
+}
+
+bool getThermalZones(std::vector<ThermalZone>& zones) {
+    if (!zones_opened) openThermalZones();
+    zones.resize(zone_sensors.size());
+    
+    // Millidegrees Celsius
+    for (size_t i = 0; i < zone_sensors.size(); i++) {
+        long long temp = preadSensor(zone_sensors[i].temp_fd, "/class/thermal/thermal_zone%d/temp",
+                                     zone_sensors[i].id);
+        zones[i].type = zone_sensors[i].type;
+        zones[i].celsius = temp == -1 ? 0.0 : temp / 1000.0;
+    }
+    return !zones.empty();
+}
+
+void refreshSensors() {
+    closeSensors();
+}
+
+bool getNumaTopology(std::vector<NumaNode>& nodes) {
+    char buf[4096];
+    size_t len;
+    nodes.clear();
+    int root_fd = nodeRootFd();
+    if (root_fd < 0 || !readSmallFile(root_fd, "online", buf, sizeof(buf), len)) return false;
+    
+    std::vector<int> ids;
+    parseList(buf, ids);
+    for (int id : ids) {
+        NumaNode node;
+        node.node = id;
+        char path[64];
+        snprintf(path, sizeof(path), "node%d/cpulist", id);
+        if (readSmallFile(root_fd, path, buf, sizeof(buf), len)) parseList(buf, node.cpus);
+        nodes.push_back(node);
+    }
+    return !nodes.empty();
+}
+
+bool getNumaNodeStats(int node, NumaNodeStats& stats) {
+    char path[64];
+    char buf[4096];
+    size_t len;
+    int root_fd = nodeRootFd();
+    if (root_fd < 0) return false;
+    
+    // "Node 0 MemTotal:       16333852 kB"
+    snprintf(path, sizeof(path), "node%d/meminfo", node);
+    if (!readSmallFile(root_fd, path, buf, sizeof(buf), len)) return false;
+    stats.total_kb = 0;
+    stats.free_kb = 0;
+    for (const char* line = buf; line && *line; ) {
+        const char* key = skipFields(line, 2);
+        while (*key == ' ') key++;
+        const char* colon = strchr(key, ':');
+        if (colon) {
+            const char* p = colon + 1;
+            size_t key_len = static_cast<size_t>(colon - key);
+            if (keyIs(key, key_len, "MemTotal")) stats.total_kb = parseLong(p);
+            else if (keyIs(key, key_len, "MemFree")) stats.free_kb = parseLong(p);
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    
+    // "numa_hit 123\nnuma_miss 0\n..."
+    snprintf(path, sizeof(path), "node%d/numastat", node);
+    if (!readSmallFile(root_fd, path, buf, sizeof(buf), len)) return false;
+    stats.numa_hit = stats.numa_miss = stats.local_node = stats.other_node = 0;
+    for (const char* line = buf; line && *line; ) {
+        const char* space = strchr(line, ' ');
+        if (space) {
+            const char* p = space;
+            size_t key_len = static_cast<size_t>(space - line);
+            if (keyIs(line, key_len, "numa_hit")) stats.numa_hit = parseLong(p);
+            else if (keyIs(line, key_len, "numa_miss")) stats.numa_miss = parseLong(p);
+            else if (keyIs(line, key_len, "local_node")) stats.local_node = parseLong(p);
+            else if (keyIs(line, key_len, "other_node")) stats.other_node = parseLong(p);
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    return true;
+}
+
+bool getProcessNumaPlacement(int pid, std::vector<long>& node_kb) {
+    // One line per mapping: "7f.. default file=/usr/lib/.. mapped=12 N0=8 N1=4 kernelpagesize_kB=4"
+    static std::vector<char> buf;
+    char path[64];
+    size_t len;
+    node_kb.clear();
+    snprintf(path, sizeof(path), "%d/numa_maps", pid);
+    if (!readWholeFile(procRootFd(), path, buf, len)) return false;
+    
+    char* line = buf.data();
+    while (line && *line) {
+        char* end = strchr(line, '\n');
+        if (end) *end = '\0';
+        
+        const char* size = strstr(line, "kernelpagesize_kB=");
+        long page_kb = size ? strtol(size + 18, nullptr, 10) : 4;
+        for (const char* p = strstr(line, " N"); p; p = strstr(p + 1, " N")) {
+            char* after;
+            long node = strtol(p + 2, &after, 10);
+            if (after == p + 2 || *after != '=' || node < 0 || node >= 4096) continue;
+            long pages = strtol(after + 1, nullptr, 10);
+            if (static_cast<size_t>(node) >= node_kb.size()) node_kb.resize(node + 1, 0);
+            node_kb[node] += pages * page_kb;
+        }
+        line = end ? end + 1 : nullptr;
+    }
+    return true;
+}
+
+bool setProcessAffinity(int pid, const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    if (CPU_COUNT(&set) == 0) return false;
+    
+    // Affinity is per thread; walk the task list
+    char path[64];
+    snprintf(path, sizeof(path), "%d/task", pid);
+    int dir_fd = openat(procRootFd(), path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    SYSMON_SYSCALLS(1);
+    if (dir_fd < 0) return false;
+    DIR* dir = fdopendir(dir_fd);
+    if (!dir) {
+        close(dir_fd);
+        return false;
+    }
+    
+    int pinned = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+        pid_t tid = static_cast<pid_t>(strtol(entry->d_name, nullptr, 10));
+        if (sched_setaffinity(tid, sizeof(set), &set) == 0) pinned++;
+        SYSMON_SYSCALLS(1);
+    }
+    closedir(dir);
+    return pinned > 0;
+}
+
 bool isElevated() {
     return getuid() == 0;
 }
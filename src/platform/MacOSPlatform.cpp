@@ -9,11 +9,35 @@
 #include <libproc.h>
 #include <unistd.h>
 #include <pwd.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/ioctl.h>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 
 namespace Platform {
 
+std::mutex& collectorLock() {
+    static std::mutex lock;
+    return lock;
+}
+
+static std::string proc_root;
+
+void setProcRoot(const std::string& root) {
+    // No procfs here; kept only so callers can be platform-agnostic
+    proc_root = root;
+}
+
+const std::string& getProcRoot() {
+    return proc_root;
+}
+
+void setSysRoot(const std::string& root) {
+}
+
 void getCPUStats(long& total, long& idle) {
     host_cpu_load_info_data_t cpuinfo;
     mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
@@ -71,6 +95,19 @@ void getMemoryInfo(long& total_kb, long& available_kb, long& used_kb) {
     }
 }
 
+bool getSelfCPUTime(double& seconds) {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return false;
+    seconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+              (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    return true;
+}
+
+bool getVMStats(VMStats& stats) {
+    (void)stats;
+    return false;
+}
+
 std::vector<ProcessData> getProcessList() {
     std::vector<ProcessData> processes;
     
@@ -94,12 +131,14 @@ std::vector<ProcessData> getProcessList() {
     for (int i = 0; i < proc_count; i++) {
         ProcessData proc;
         proc.pid = proc_list[i].kp_proc.p_pid;
+        proc.ppid = proc_list[i].kp_eproc.e_ppid;
         proc.name = proc_list[i].kp_proc.p_comm;
         
         // Get memory info
         struct proc_taskinfo ti;
         if (proc_pidinfo(proc.pid, PROC_PIDTASKINFO, 0, &ti, sizeof(ti)) > 0) {
             proc.memory_kb = static_cast<long>(ti.pti_resident_size / 1024);
+            proc.major_faults = static_cast<long>(ti.pti_pageins);
         }
         
         // Simplified CPU usage
@@ -115,17 +154,30 @@ std::vector<ProcessData> getProcessList() {
     
     free(proc_list);
     
-    // Sort by memory
-    std::sort(processes.begin(), processes.end(),
-              [](const ProcessData& a, const ProcessData& b) {
-                  return a.memory_kb > b.memory_kb;
-              });
+    return processes;
+}
+
+void scanProcesses(ProcessVisitor& visitor) {
+    // The native APIs already hand back whole snapshots; adapt them
+    std::vector<ProcessData> processes = getProcessList();
     
-    if (processes.size() > 10) {
-        processes.resize(10);
+    for (const auto& proc : processes) {
+        ProcessSample sample;
+        sample.pid = proc.pid;
+        sample.ppid = proc.ppid;
+        sample.name = proc.name.c_str();
+        sample.name_len = proc.name.size();
+        sample.memory_kb = proc.memory_kb;
+        sample.priority = proc.priority;
+        sample.cpu_ticks = proc.cpu_ticks;
+        sample.major_faults = proc.major_faults;
+        visitor.visit(sample);
     }
-    
-    return processes;
+}
+
+void setHoldProcessFiles(bool hold) {
+    // Nothing is opened per process here
+    (void)hold;
 }
 
 bool setProcessPriority(int pid, int nice_value) {
@@ -137,6 +189,184 @@ bool setProcessPriority(int pid, int nice_value) {
     return setpriority(PRIO_PROCESS, pid, nice_value) == 0;
 }
 
+bool getProcessUid(int pid, int& uid) {
+    struct kinfo_proc info;
+    size_t size = sizeof(info);
+    int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_PID, pid };
+    if (sysctl(mib, 4, &info, &size, nullptr, 0) != 0 || size == 0) return false;
+    uid = static_cast<int>(info.kp_eproc.e_pcred.p_ruid);
+    return true;
+}
+
+bool lookupUser(const std::string& name, int& uid) {
+    struct passwd* pw = getpwnam(name.c_str());
+    if (!pw) return false;
+    uid = static_cast<int>(pw->pw_uid);
+    return true;
+}
+
+bool setOOMScoreAdjust(int pid, int adjust) {
+    // Jetsam priorities are not adjustable from outside
+    (void)pid;
+    (void)adjust;
+    return false;
+}
+
+bool getMemoryRollup(int pid, MemoryRollup& rollup) {
+    // No cheap proportional-set-size source on this platform
+    (void)pid;
+    (void)rollup;
+    return false;
+}
+
+bool getProcessCgroup(int pid, std::string& path) {
+    // cgroups are Linux-only
+    (void)pid;
+    (void)path;
+    return false;
+}
+
+bool getCgroupStats(const std::string& path, CgroupStats& stats) {
+    (void)path;
+    (void)stats;
+    return false;
+}
+
+bool getProcessSchedStats(int pid, SchedStats& stats) {
+    // No per-process run-queue accounting exposed here
+    (void)pid;
+    (void)stats;
+    return false;
+}
+
+bool getCPUSchedStats(std::vector<SchedStats>& cpus) {
+    cpus.clear();
+    return false;
+}
+
+bool getPerCPUStats(std::vector<CPUTicks>& cpus) {
+    cpus.clear();
+    return false;
+}
+
+bool getCPUFrequencies(std::vector<CPUFrequency>& cpus) {
+    cpus.clear();
+    return false;
+}
+
+bool getThermalZones(std::vector<ThermalZone>& zones) {
+    zones.clear();
+    return false;
+}
+
+void refreshSensors() {
+}
+
+bool getNumaTopology(std::vector<NumaNode>& nodes) {
+    nodes.clear();
+    return false;
+}
+
+bool getNumaNodeStats(int node, NumaNodeStats& stats) {
+    return false;
+}
+
+bool getProcessNumaPlacement(int pid, std::vector<long>& node_kb) {
+    node_kb.clear();
+    return false;
+}
+
+bool setProcessAffinity(int pid, const std::vector<int>& cpus) {
+    return false;
+}
+
+namespace {
+    bool raw_input = false;
+    struct termios saved_termios;
+}
+
+void restoreInput() {
+    if (raw_input) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+        raw_input = false;
+    }
+}
+
+bool enableRawInput() {
+    if (raw_input) return true;
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved_termios) != 0) return false;
+    
+    // Keep ISIG so Ctrl+C still raises SIGINT
+    struct termios raw = saved_termios;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) return false;
+    
+    raw_input = true;
+    static bool registered = false;
+    if (!registered) {
+        atexit(restoreInput);
+        registered = true;
+    }
+    return true;
+}
+
+namespace {
+    // Cursor keys arrive as ESC [ <code> or ESC O <code>; a lone Escape
+    // has nothing following within a few milliseconds
+    int readEscape() {
+        char seq[8];
+        size_t len = 0;
+        struct pollfd pfd;
+        pfd.fd = STDIN_FILENO;
+        pfd.events = POLLIN;
+        while (len < sizeof(seq) - 1) {
+            pfd.revents = 0;
+            if (poll(&pfd, 1, 25) <= 0 || read(STDIN_FILENO, &seq[len], 1) != 1) break;
+            len++;
+            if (len >= 2 && (seq[len - 1] == '~' || (seq[len - 1] >= 'A' && seq[len - 1] <= 'Z'))) break;
+        }
+        seq[len] = '\0';
+        
+        if (len < 2 || (seq[0] != '[' && seq[0] != 'O')) return 0x1b;
+        const char* code = seq + 1;
+        if (strcmp(code, "A") == 0) return KEY_UP;
+        if (strcmp(code, "B") == 0) return KEY_DOWN;
+        if (strcmp(code, "5~") == 0) return KEY_PAGE_UP;
+        if (strcmp(code, "6~") == 0) return KEY_PAGE_DOWN;
+        if (strcmp(code, "H") == 0 || strcmp(code, "1~") == 0 || strcmp(code, "7~") == 0) return KEY_HOME;
+        if (strcmp(code, "F") == 0 || strcmp(code, "4~") == 0 || strcmp(code, "8~") == 0) return KEY_END;
+        return -1;
+    }
+}
+
+int waitForKey(int timeout_ms) {
+    if (timeout_ms < 0) timeout_ms = 0;
+    if (!raw_input) {
+        sleep(timeout_ms);
+        return -1;
+    }
+    
+    struct pollfd pfd;
+    pfd.fd = STDIN_FILENO;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, timeout_ms) <= 0) return -1;
+    
+    unsigned char key;
+    if (read(STDIN_FILENO, &key, 1) != 1) return -1;
+    return key == 0x1b ? readEscape() : key;
+}
+
+bool getTerminalSize(int& rows, int& columns) {
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_row == 0) return false;
+    rows = size.ws_row;
+    columns = size.ws_col;
+    return true;
+}
+
 bool isElevated() {
     return getuid() == 0;
 }
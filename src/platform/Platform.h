@@ -3,8 +3,22 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
 
 namespace Platform {
+    // The collectors keep process-wide state (the /proc directory stream,
+    // held descriptors, sensor caches, parse buffers). Whoever collects
+    // holds this; monitors on several threads take turns.
+    std::mutex& collectorLock();
+    
+    // Root of the procfs tree the collectors read (Linux only; other
+    // platforms accept and ignore it). Benchmarks point this at a
+    // synthetic tree.
+    void setProcRoot(const std::string& root);
+    const std::string& getProcRoot();
+    // Likewise for sysfs (CPU frequency, thermal and NUMA readers)
+    void setSysRoot(const std::string& root);
+    
     // CPU functions
     void getCPUStats(long& total, long& idle);
     double calculateCPUUsage(long prev_total, long prev_idle, long& new_total, long& new_idle);
@@ -12,18 +26,209 @@ namespace Platform {
     // Memory functions
     void getMemoryInfo(long& total_kb, long& available_kb, long& used_kb);
     
+    // Paging and reclaim counters (Linux /proc/vmstat), cumulative. Scans
+    // and steals are pages; older kernels only count them per zone, which
+    // are summed. Other platforms return false.
+    struct VMStats {
+        long long page_faults;      // pgfault, minor and major
+        long long major_faults;     // pgmajfault
+        long long swap_in;          // pswpin, pages
+        long long swap_out;         // pswpout
+        long long scan_kswapd;      // pgscan_kswapd
+        long long scan_direct;      // pgscan_direct: allocations stalled on reclaim
+        long long steal_kswapd;     // pgsteal_kswapd
+        long long steal_direct;
+        long long oom_kills;        // oom_kill (4.13+)
+    };
+    
+    bool getVMStats(VMStats& stats);
+    
+    // User + system CPU time this process has used so far, all threads
+    bool getSelfCPUTime(double& seconds);
+    
     // Process functions
     struct ProcessData {
         int pid;
+        int ppid;           // 0 if unknown
         std::string name;
         double cpu_usage;
         long memory_kb;
         int priority;
+        long cpu_ticks;     // Cumulative user+system time, same unit as getCPUStats (0 if unknown)
+        long major_faults;  // Cumulative faults that needed I/O (0 if unknown)
+        
+        ProcessData() : pid(0), ppid(0), cpu_usage(0.0), memory_kb(0), priority(0), cpu_ticks(0),
+                        major_faults(0) {}
     };
     
+    // Returns every visible process, unsorted; ranking is left to the caller
     std::vector<ProcessData> getProcessList();
+    
+    // Allocation-free view of one process. `name` is not NUL-terminated and
+    // only valid for the duration of the visit() call.
+    struct ProcessSample {
+        int pid;
+        int ppid;
+        const char* name;
+        size_t name_len;
+        long memory_kb;
+        int priority;
+        long cpu_ticks;
+        long major_faults;
+    };
+    
+    class ProcessVisitor {
+    public:
+        virtual ~ProcessVisitor() {}
+        virtual void visit(const ProcessSample& sample) = 0;
+    };
+    
+    // Streams every visible process to `visitor` without building any
+    // intermediate containers. This is the collector's hot path.
+    void scanProcesses(ProcessVisitor& visitor);
+    
+    // Keeps every process's stat file open across scans, so a rescan costs
+    // one pread per known process instead of open/read/close. Meant for
+    // short-lived back-to-back samples (one-shot reports): it holds a
+    // descriptor per process, within what RLIMIT_NOFILE allows. Calls are
+    // counted: files stay held until every caller that turned it on has
+    // turned it off again. Other platforms ignore it.
+    void setHoldProcessFiles(bool hold);
+    
     bool setProcessPriority(int pid, int nice_value);
     
+    // Owner of a process (real uid), and a user name's uid. Linux and
+    // macOS only; used by filters, not by the scan itself.
+    bool getProcessUid(int pid, int& uid);
+    bool lookupUser(const std::string& name, int& uid);
+    
+    // Biases the kernel OOM killer's choice (Linux oom_score_adj, -1000 to
+    // 1000). Raising it needs no privileges; other platforms return false.
+    bool setOOMScoreAdjust(int pid, int adjust);
+    
+    // Proportional/unique memory breakdown (Linux smaps_rollup). Expensive:
+    // callers should only request it for a handful of processes per tick.
+    struct MemoryRollup {
+        long pss_kb;
+        long uss_kb;
+        long swap_kb;
+    };
+    
+    bool getMemoryRollup(int pid, MemoryRollup& rollup);
+    
+    // cgroup v2 (unified hierarchy). Paths are relative to the cgroup2
+    // mount, as they appear in /proc/<pid>/cgroup ("/system.slice/sshd.service").
+    // Counters are the kernel's own per-group totals, so one read per group
+    // replaces summing every member process.
+    struct CgroupStats {
+        long long cpu_usage_usec;   // cpu.stat usage_usec (cumulative)
+        long memory_kb;             // memory.current (0 for the root group)
+        long long io_read_bytes;    // io.stat rbytes, summed over devices
+        long long io_write_bytes;   // io.stat wbytes, summed over devices
+    };
+    
+    bool getProcessCgroup(int pid, std::string& path);
+    bool getCgroupStats(const std::string& path, CgroupStats& stats);
+    
+    // Scheduler statistics (Linux schedstat), cumulative: time on a CPU,
+    // time runnable but waiting on a run queue, and timeslices run.
+    // Per-process values cover the main thread only.
+    struct SchedStats {
+        long long run_ns;
+        long long wait_ns;
+        long long timeslices;
+    };
+    
+    bool getProcessSchedStats(int pid, SchedStats& stats);
+    // One entry per CPU, from /proc/schedstat (needs CONFIG_SCHEDSTATS)
+    bool getCPUSchedStats(std::vector<SchedStats>& cpus);
+    
+    // Cumulative ticks of each CPU, indexed by CPU number (/proc/stat cpuN
+    // lines); offline CPUs read as zero
+    struct CPUTicks {
+        long total;
+        long idle;
+    };
+    
+    bool getPerCPUStats(std::vector<CPUTicks>& cpus);
+    
+    // Clock and throttling per CPU (Linux cpufreq and thermal_throttle),
+    // indexed by CPU number. The files are opened on the first call and
+    // kept open; later calls re-read them with one pread each, so a tick
+    // costs no path lookups however many CPUs there are. A file whose read
+    // fails is opened again once, then left closed until refreshSensors().
+    struct CPUFrequency {
+        long cur_khz;               // scaling_cur_freq; 0 without cpufreq
+        long max_khz;               // cpuinfo_max_freq
+        int package;                // physical_package_id
+        long long core_throttles;   // Cumulative; -1 where not exposed (Intel only)
+        long long package_throttles;
+    };
+    
+    bool getCPUFrequencies(std::vector<CPUFrequency>& cpus);
+    
+    // /sys/class/thermal zones, read the same way
+    struct ThermalZone {
+        std::string type;
+        double celsius;
+    };
+    
+    bool getThermalZones(std::vector<ThermalZone>& zones);
+    
+    // Closes the kept sensor files; the next reads scan sysfs again, picking
+    // up hotplugged CPUs, reloaded cpufreq drivers and new thermal zones
+    void refreshSensors();
+    
+    // NUMA topology and counters (Linux /sys/devices/system/node). Node ids
+    // may be sparse. Hosts without the node directories (and the other
+    // platforms) return false.
+    struct NumaNode {
+        int node;
+        std::vector<int> cpus;
+    };
+    
+    // nodeN/meminfo, and nodeN/numastat page counts (cumulative)
+    struct NumaNodeStats {
+        long total_kb;
+        long free_kb;
+        long long numa_hit;     // Allocated here, as the policy preferred
+        long long numa_miss;    // Allocated here although another node was preferred
+        long long local_node;   // Allocated here for a task running on this node
+        long long other_node;   // Allocated here for a task running on another node
+    };
+    
+    bool getNumaTopology(std::vector<NumaNode>& nodes);
+    bool getNumaNodeStats(int node, NumaNodeStats& stats);
+    // Resident memory of a process per node (indexed by node id), summed
+    // over <pid>/numa_maps. This walks the process's page tables: callers
+    // should only ask for a few processes, and not every tick.
+    bool getProcessNumaPlacement(int pid, std::vector<long>& node_kb);
+    // Pins every thread of a process to `cpus`; threads started later
+    // inherit it. Linux only.
+    bool setProcessAffinity(int pid, const std::vector<int>& cpus);
+    
+    // Terminal input. enableRawInput() switches the console to unbuffered,
+    // no-echo key reads (restored by restoreInput() and at exit); it returns
+    // false when stdin is not a terminal.
+    bool enableRawInput();
+    void restoreInput();
+    // Waits up to `timeout_ms` for a key press. Returns the key (a byte, or
+    // one of the Key values for cursor keys), or -1 on timeout. Without raw
+    // input this is equivalent to sleep().
+    int waitForKey(int timeout_ms);
+    
+    enum Key {
+        KEY_UP = 0x100,
+        KEY_DOWN,
+        KEY_PAGE_UP,
+        KEY_PAGE_DOWN,
+        KEY_HOME,
+        KEY_END
+    };
+    
+    // Size of the terminal stdout is attached to
+    bool getTerminalSize(int& rows, int& columns);
+    
     // System functions
     bool isElevated();
     void sleep(int milliseconds);
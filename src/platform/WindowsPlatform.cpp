@@ -11,10 +11,33 @@
 #include <thread>
 #include <shlobj.h>
 #include <algorithm>
+#include <chrono>
+#include <conio.h>
+#include <cstdio>
+#include <io.h>
 
 
 namespace Platform {
 
+std::mutex& collectorLock() {
+    static std::mutex lock;
+    return lock;
+}
+
+static std::string proc_root;
+
+void setProcRoot(const std::string& root) {
+    // No procfs here; kept only so callers can be platform-agnostic
+    proc_root = root;
+}
+
+const std::string& getProcRoot() {
+    return proc_root;
+}
+
+void setSysRoot(const std::string& root) {
+}
+
 static PDH_HQUERY cpuQuery;
 static PDH_HCOUNTER cpuTotal;
 static bool pdhInitialized = false;
@@ -67,6 +90,24 @@ void getMemoryInfo(long& total_kb, long& available_kb, long& used_kb) {
     }
 }
 
+bool getSelfCPUTime(double& seconds) {
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return false;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    // 100 ns units
+    seconds = (k.QuadPart + u.QuadPart) / 1e7;
+    return true;
+}
+
+bool getVMStats(VMStats& stats) {
+    (void)stats;
+    return false;
+}
+
 std::vector<ProcessData> getProcessList() {
     std::vector<ProcessData> processes;
     
@@ -82,6 +123,7 @@ std::vector<ProcessData> getProcessList() {
         do {
             ProcessData proc;
             proc.pid = pe32.th32ProcessID;
+            proc.ppid = pe32.th32ParentProcessID;
             
             // Convert wide string to narrow string
             char name[MAX_PATH];
@@ -106,8 +148,8 @@ std::vector<ProcessData> getProcessList() {
                     ut.LowPart = userTime.dwLowDateTime;
                     ut.HighPart = userTime.dwHighDateTime;
                     
-                    // This is a simplified calculation
-                    proc.cpu_usage = 0.0; // Would need previous values for accurate calculation
+                    // Same millisecond unit as getCPUStats; the monitor turns deltas into a rate
+                    proc.cpu_ticks = static_cast<long>((kt.QuadPart + ut.QuadPart) / 10000);
                 }
                 
                 // Get priority
@@ -125,17 +167,30 @@ std::vector<ProcessData> getProcessList() {
     
     CloseHandle(hSnapshot);
     
-    // Sort by memory (since CPU calculation is simplified)
-    std::sort(processes.begin(), processes.end(),
-              [](const ProcessData& a, const ProcessData& b) {
-                  return a.memory_kb > b.memory_kb;
-              });
+    return processes;
+}
+
+void scanProcesses(ProcessVisitor& visitor) {
+    // The native APIs already hand back whole snapshots; adapt them
+    std::vector<ProcessData> processes = getProcessList();
     
-    if (processes.size() > 10) {
-        processes.resize(10);
+    for (const auto& proc : processes) {
+        ProcessSample sample;
+        sample.pid = proc.pid;
+        sample.ppid = proc.ppid;
+        sample.name = proc.name.c_str();
+        sample.name_len = proc.name.size();
+        sample.memory_kb = proc.memory_kb;
+        sample.priority = proc.priority;
+        sample.cpu_ticks = proc.cpu_ticks;
+        sample.major_faults = proc.major_faults;
+        visitor.visit(sample);
     }
-    
-    return processes;
+}
+
+void setHoldProcessFiles(bool hold) {
+    // Nothing is opened per process here
+    (void)hold;
 }
 
 bool setProcessPriority(int pid, int nice_value) {
@@ -163,6 +218,144 @@ bool setProcessPriority(int pid, int nice_value) {
     return result;
 }
 
+bool getProcessUid(int pid, int& uid) {
+    // Owners are SIDs here, with no numeric id to compare
+    (void)pid;
+    (void)uid;
+    return false;
+}
+
+bool lookupUser(const std::string& name, int& uid) {
+    (void)name;
+    (void)uid;
+    return false;
+}
+
+bool setOOMScoreAdjust(int pid, int adjust) {
+    // No OOM killer to bias
+    (void)pid;
+    (void)adjust;
+    return false;
+}
+
+bool getMemoryRollup(int pid, MemoryRollup& rollup) {
+    // No cheap proportional-set-size source on this platform
+    (void)pid;
+    (void)rollup;
+    return false;
+}
+
+bool getProcessCgroup(int pid, std::string& path) {
+    // cgroups are Linux-only
+    (void)pid;
+    (void)path;
+    return false;
+}
+
+bool getCgroupStats(const std::string& path, CgroupStats& stats) {
+    (void)path;
+    (void)stats;
+    return false;
+}
+
+bool getProcessSchedStats(int pid, SchedStats& stats) {
+    // No per-process run-queue accounting exposed here
+    (void)pid;
+    (void)stats;
+    return false;
+}
+
+bool getCPUSchedStats(std::vector<SchedStats>& cpus) {
+    cpus.clear();
+    return false;
+}
+
+bool getPerCPUStats(std::vector<CPUTicks>& cpus) {
+    cpus.clear();
+    return false;
+}
+
+bool getCPUFrequencies(std::vector<CPUFrequency>& cpus) {
+    cpus.clear();
+    return false;
+}
+
+bool getThermalZones(std::vector<ThermalZone>& zones) {
+    zones.clear();
+    return false;
+}
+
+void refreshSensors() {
+}
+
+bool getNumaTopology(std::vector<NumaNode>& nodes) {
+    nodes.clear();
+    return false;
+}
+
+bool getNumaNodeStats(int node, NumaNodeStats& stats) {
+    return false;
+}
+
+bool getProcessNumaPlacement(int pid, std::vector<long>& node_kb) {
+    node_kb.clear();
+    return false;
+}
+
+bool setProcessAffinity(int pid, const std::vector<int>& cpus) {
+    return false;
+}
+
+namespace {
+    bool raw_input = false;
+}
+
+bool enableRawInput() {
+    // The console delivers keys to _kbhit/_getch without line buffering
+    raw_input = _isatty(_fileno(stdin)) != 0;
+    return raw_input;
+}
+
+void restoreInput() {
+    raw_input = false;
+}
+
+int waitForKey(int timeout_ms) {
+    if (timeout_ms < 0) timeout_ms = 0;
+    if (!raw_input) {
+        sleep(timeout_ms);
+        return -1;
+    }
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        if (_kbhit()) {
+            int key = _getch();
+            if (key != 0 && key != 0xE0) return key;
+            // Cursor keys are a prefix byte and a scan code
+            switch (_getch()) {
+                case 72: return KEY_UP;
+                case 80: return KEY_DOWN;
+                case 73: return KEY_PAGE_UP;
+                case 81: return KEY_PAGE_DOWN;
+                case 71: return KEY_HOME;
+                case 79: return KEY_END;
+                default: return -1;
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline) return -1;
+        Sleep(20);
+    }
+}
+
+bool getTerminalSize(int& rows, int& columns) {
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) return false;
+    rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+    columns = info.srWindow.Right - info.srWindow.Left + 1;
+    return true;
+}
+
 bool isElevated() {
     BOOL isAdmin = FALSE;
     SID_IDENTIFIER_AUTHORITY NtAuthority = SECURITY_NT_AUTHORITY;
@@ -0,0 +1,318 @@
+#include "HistoryQuery.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace {
+    const char* skipSpaces(const char* p, const char* end) {
+        while (p < end && *p == ' ') p++;
+        return p;
+    }
+
+    const char* parseLong(const char* p, const char* end, long long& value) {
+        p = skipSpaces(p, end);
+        bool negative = p < end && *p == '-';
+        if (negative) p++;
+        if (p == end || *p < '0' || *p > '9') return nullptr;
+        long long v = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) v = v * 10 + (*p - '0');
+        value = negative ? -v : v;
+        return p;
+    }
+
+    // The recorder writes fixed-point decimals ("%.2f"); strtod is several
+    // times slower and a week of history has millions of them
+    const char* parseFixed(const char* p, const char* end, double& value) {
+        static const double SCALE[] = { 1.0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6 };
+        p = skipSpaces(p, end);
+        bool negative = p < end && *p == '-';
+        if (negative) p++;
+        long long whole;
+        p = parseLong(p, end, whole);
+        if (!p) return nullptr;
+        double v = static_cast<double>(whole);
+        if (p < end && *p == '.') {
+            long long fraction = 0;
+            int digits = 0;
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+                if (digits < 6) {
+                    fraction = fraction * 10 + (*p - '0');
+                    digits++;
+                }
+            }
+            v += fraction * SCALE[digits];
+        }
+        value = negative ? -v : v;
+        return p;
+    }
+
+    // "<pid> <cpu%> <rss_kb> <prio>[ <name>]"
+    bool parseProcess(const char* p, const char* end, int& pid, double& cpu, long& rss_kb,
+                      const char*& name) {
+        long long v_pid, v_rss, v_prio;
+        if (!(p = parseLong(p, end, v_pid))) return false;
+        if (!(p = parseFixed(p, end, cpu))) return false;
+        if (!(p = parseLong(p, end, v_rss))) return false;
+        if (!(p = parseLong(p, end, v_prio))) return false;
+        pid = static_cast<int>(v_pid);
+        rss_kb = static_cast<long>(v_rss);
+        name = p < end ? p + 1 : end;
+        return true;
+    }
+
+    bool localTime(int64_t ms, std::tm& out) {
+        std::time_t seconds = static_cast<std::time_t>(ms / 1000);
+        std::tm* tm = std::localtime(&seconds);
+        if (!tm) return false;
+        out = *tm;
+        return true;
+    }
+}
+
+HistoryQuery::HistoryQuery(const std::string& recording)
+    : index(recording), key(QueryKey::CPU), top(0), window_frames(0), generation(0) {}
+
+bool HistoryQuery::open() {
+    return index.update();
+}
+
+bool HistoryQuery::ranksAbove(const QueryProcess& a, const QueryProcess& b) const {
+    if (key == QueryKey::RSS) {
+        if (a.peak_rss_kb != b.peak_rss_kb) return a.peak_rss_kb > b.peak_rss_kb;
+        return a.avg_rss_kb > b.avg_rss_kb;
+    }
+    if (a.peak_cpu != b.peak_cpu) return a.peak_cpu > b.peak_cpu;
+    return a.avg_cpu > b.avg_cpu;
+}
+
+void HistoryQuery::flush(Tracked& proc) {
+    // Before the window window_frames is 0 and so is every `since`
+    uint64_t n = window_frames - proc.since;
+    if (n == 0) return;
+    proc.agg.frames += n;
+    proc.cpu_sum += proc.cpu * n;
+    proc.rss_sum += static_cast<double>(proc.rss_kb) * n;
+    proc.agg.peak_cpu = std::max(proc.agg.peak_cpu, proc.cpu);
+    proc.agg.peak_rss_kb = std::max(proc.agg.peak_rss_kb, proc.rss_kb);
+    proc.since = window_frames;
+}
+
+void HistoryQuery::trimFinished(size_t limit) {
+    if (finished.size() <= limit) return;
+    auto cmp = [this](const QueryProcess& a, const QueryProcess& b) { return ranksAbove(a, b); };
+    std::nth_element(finished.begin(), finished.begin() + limit, finished.end(), cmp);
+    finished.resize(limit);
+}
+
+void HistoryQuery::retire(std::unordered_map<int, Tracked>::iterator it) {
+    Tracked& proc = it->second;
+    flush(proc);
+    if (proc.agg.frames > 0) {
+        proc.agg.avg_cpu = proc.cpu_sum / proc.agg.frames;
+        proc.agg.avg_rss_kb = proc.rss_sum / proc.agg.frames;
+        proc.agg.name = proc.name;
+        finished.push_back(proc.agg);
+        // Only the top N can ever be reported; keep the candidate list short
+        if (finished.size() > 4 * top + 256) trimFinished(top);
+    }
+    live.erase(it);
+}
+
+void HistoryQuery::update(int pid, double cpu, long rss_kb, const char* name, const char* name_end) {
+    auto it = live.find(pid);
+    if (it != live.end() && name &&
+        (it->second.name.size() != static_cast<size_t>(name_end - name) ||
+         std::memcmp(it->second.name.data(), name, name_end - name) != 0)) {
+        // Same PID, different program: the recording missed the exit
+        retire(it);
+        it = live.end();
+    }
+
+    if (it == live.end()) {
+        if (!name) return;
+        Tracked& proc = live[pid];
+        proc.name.assign(name, name_end);
+        proc.since = window_frames;
+        proc.agg = QueryProcess();
+        proc.agg.pid = pid;
+        proc.cpu_sum = 0.0;
+        proc.rss_sum = 0.0;
+        proc.cpu = cpu;
+        proc.rss_kb = rss_kb;
+        proc.generation = generation;
+        return;
+    }
+
+    Tracked& proc = it->second;
+    flush(proc);
+    proc.cpu = cpu;
+    proc.rss_kb = rss_kb;
+    proc.generation = generation;
+}
+
+void HistoryQuery::sweep() {
+    // Processes a keyframe did not list have exited
+    for (auto it = live.begin(); it != live.end();) {
+        auto current = it++;
+        if (current->second.generation != generation) retire(current);
+    }
+}
+
+bool HistoryQuery::run(int64_t from_ms, int64_t to_ms, size_t top_n, QueryKey by,
+                       QueryResult& result) {
+    result = QueryResult();
+    result.index_bytes_scanned = index.getScannedBytes();
+    live.clear();
+    finished.clear();
+    key = by;
+    top = top_n;
+    window_frames = 0;
+    generation = 0;
+
+    if (index.empty()) return true;
+
+    RecordingReader reader(index.getPath());
+    if (!reader.isOpen() || !reader.seek(index.seek(from_ms))) return false;
+
+    bool track = top_n > 0;
+    bool pending_sweep = false;
+    bool frame_in_window = false;
+    const char* line;
+    const char* end;
+
+    while (reader.next(line, end)) {
+        if (end - line < 2 || line[1] != ' ') continue;
+        char type = line[0];
+
+        if (type == 'F' || type == 'D') {
+            if (pending_sweep) {
+                sweep();
+                pending_sweep = false;
+            }
+            if (frame_in_window) window_frames++;
+
+            long long ts;
+            double cpu, mem;
+            const char* p = parseLong(line + 2, end, ts);
+            long long sequence;
+            if (p) p = parseLong(p, end, sequence);
+            if (p) p = parseFixed(p, end, cpu);
+            if (p) p = parseFixed(p, end, mem);
+            if (!p) {
+                frame_in_window = false;
+                continue;
+            }
+            if (ts > to_ms) {
+                frame_in_window = false;
+                break;
+            }
+
+            frame_in_window = ts >= from_ms;
+            if (type == 'F') {
+                generation++;
+                pending_sweep = track;
+            }
+            if (frame_in_window) {
+                if (result.frames == 0) result.first_ms = ts;
+                result.last_ms = ts;
+                result.frames++;
+                result.cpu.add(cpu);
+                result.mem.add(mem);
+                result.cpu_sketch.add(cpu);
+                result.mem_sketch.add(mem);
+            }
+            continue;
+        }
+
+        if (!track) continue;
+
+        int pid;
+        double cpu;
+        long rss_kb;
+        const char* name;
+        switch (type) {
+            case 'P':
+            case '+':
+                if (parseProcess(line + 2, end, pid, cpu, rss_kb, name)) {
+                    update(pid, cpu, rss_kb, name, end);
+                }
+                break;
+            case '~':
+                if (parseProcess(line + 2, end, pid, cpu, rss_kb, name)) {
+                    update(pid, cpu, rss_kb, nullptr, nullptr);
+                }
+                break;
+            case '-':
+                if (parseProcess(line + 2, end, pid, cpu, rss_kb, name)) {
+                    auto it = live.find(pid);
+                    if (it != live.end()) retire(it);
+                }
+                break;
+            default:
+                // O/G/H/T and anything newer
+                break;
+        }
+    }
+
+    if (pending_sweep) sweep();
+    if (frame_in_window) window_frames++;
+    while (!live.empty()) retire(live.begin());
+
+    trimFinished(top_n);
+    std::sort(finished.begin(), finished.end(),
+              [this](const QueryProcess& a, const QueryProcess& b) { return ranksAbove(a, b); });
+    result.top.swap(finished);
+    result.bytes_read = reader.getBytesRead();
+    return true;
+}
+
+bool HistoryQuery::parseTime(const std::string& text, int64_t reference_ms, int64_t& out_ms) {
+    if (text.empty()) return false;
+
+    if (text.find_first_not_of("0123456789") == std::string::npos) {
+        out_ms = std::stoll(text);
+        return true;
+    }
+
+    std::tm tm;
+    int year, month, day, hour, minute, second = 0;
+    char sep;
+    if (std::sscanf(text.c_str(), "%d-%d-%d%c%d:%d:%d", &year, &month, &day, &sep,
+                    &hour, &minute, &second) >= 6) {
+        if (sep != ' ' && sep != 'T') return false;
+        std::memset(&tm, 0, sizeof(tm));
+        tm.tm_year = year - 1900;
+        tm.tm_mon = month - 1;
+        tm.tm_mday = day;
+    } else if (std::sscanf(text.c_str(), "%d:%d:%d", &hour, &minute, &second) >= 2) {
+        if (!localTime(reference_ms, tm)) return false;
+    } else {
+        return false;
+    }
+
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = second;
+    tm.tm_isdst = -1;
+    std::time_t seconds = std::mktime(&tm);
+    if (seconds == static_cast<std::time_t>(-1)) return false;
+    out_ms = static_cast<int64_t>(seconds) * 1000;
+
+    // A bare time of day refers to the most recent occurrence
+    if (text.find('-') == std::string::npos && out_ms > reference_ms) {
+        tm.tm_mday -= 1;
+        tm.tm_isdst = -1;
+        out_ms = static_cast<int64_t>(std::mktime(&tm)) * 1000;
+    }
+    return true;
+}
+
+std::string HistoryQuery::formatTime(int64_t ms) {
+    std::tm tm;
+    char text[32];
+    if (!localTime(ms, tm) || std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &tm) == 0) {
+        return std::to_string(ms);
+    }
+    return text;
+}
@@ -0,0 +1,96 @@
+#ifndef HISTORYQUERY_H
+#define HISTORYQUERY_H
+
+#include "RecordingIndex.h"
+#include "../monitor/Statistics.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class QueryKey {
+    CPU,
+    RSS
+};
+
+struct QueryProcess {
+    int pid;
+    std::string name;
+    double peak_cpu;
+    double avg_cpu;
+    long peak_rss_kb;
+    double avg_rss_kb;
+    uint64_t frames;        // Window frames the process was alive in
+
+    QueryProcess() : pid(0), peak_cpu(0.0), avg_cpu(0.0), peak_rss_kb(0), avg_rss_kb(0.0), frames(0) {}
+};
+
+struct QueryResult {
+    uint64_t frames;
+    int64_t first_ms;
+    int64_t last_ms;
+    RunningStats cpu;
+    RunningStats mem;
+    QuantileSketch cpu_sketch;
+    QuantileSketch mem_sketch;
+    std::vector<QueryProcess> top;      // Ranked by peak of the query key
+    uint64_t bytes_read;
+    uint64_t index_bytes_scanned;
+
+    QueryResult() : frames(0), first_ms(0), last_ms(0), bytes_read(0), index_bytes_scanned(0) {}
+};
+
+// Window aggregation over a recording in one forward pass.
+//
+// The index positions the reader on the last keyframe before the window,
+// frames before it only rebuild process state, and reading stops at the
+// first frame past it. Per-process sums are kept lazily: a value is
+// credited for the frames it was in effect when it changes or the process
+// exits, so the cost follows the recorded changes rather than
+// processes x frames.
+class HistoryQuery {
+private:
+    struct Tracked {
+        std::string name;
+        double cpu;
+        long rss_kb;
+        uint64_t since;         // Window frame the current values took effect
+        unsigned long generation;
+        QueryProcess agg;
+        double cpu_sum;
+        double rss_sum;
+    };
+
+    RecordingIndex index;
+    std::unordered_map<int, Tracked> live;
+    std::vector<QueryProcess> finished;
+    QueryKey key;
+    size_t top;
+    uint64_t window_frames;
+    unsigned long generation;
+
+    void flush(Tracked& proc);
+    void retire(std::unordered_map<int, Tracked>::iterator it);
+    void update(int pid, double cpu, long rss_kb, const char* name, const char* name_end);
+    void sweep();
+    void trimFinished(size_t limit);
+    bool ranksAbove(const QueryProcess& a, const QueryProcess& b) const;
+
+public:
+    explicit HistoryQuery(const std::string& recording);
+
+    // Brings the sidecar index up to date; false if the recording is unreadable
+    bool open();
+    const RecordingIndex& getIndex() const { return index; }
+
+    // Aggregates frames with from_ms <= timestamp <= to_ms
+    bool run(int64_t from_ms, int64_t to_ms, size_t top_n, QueryKey by, QueryResult& result);
+
+    // Accepts epoch milliseconds, "YYYY-MM-DD HH:MM[:SS]" (or with 'T'), or
+    // "HH:MM[:SS]" meaning the latest such local time at or before
+    // `reference_ms` (normally the end of the recording)
+    static bool parseTime(const std::string& text, int64_t reference_ms, int64_t& out_ms);
+    static std::string formatTime(int64_t ms);
+};
+
+#endif // HISTORYQUERY_H
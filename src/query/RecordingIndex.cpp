@@ -0,0 +1,216 @@
+#include "RecordingIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    // Recordings outgrow a 32-bit long within days
+    bool seekTo(std::FILE* file, uint64_t offset, int whence = SEEK_SET) {
+#ifdef _WIN32
+        return _fseeki64(file, static_cast<long long>(offset), whence) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), whence) == 0;
+#endif
+    }
+
+    uint64_t tellFrom(std::FILE* file) {
+#ifdef _WIN32
+        return static_cast<uint64_t>(_ftelli64(file));
+#else
+        return static_cast<uint64_t>(ftello(file));
+#endif
+    }
+}
+
+// ---------------------------------------------------------------------------
+// RecordingReader
+// ---------------------------------------------------------------------------
+
+RecordingReader::RecordingReader(const std::string& path, size_t chunk)
+    : file(std::fopen(path.c_str(), "rb")), buffer(chunk), begin(0), end(0),
+      buffer_offset(0), line_offset(0), bytes_read(0), eof(false) {}
+
+RecordingReader::~RecordingReader() {
+    if (file) std::fclose(file);
+}
+
+bool RecordingReader::seek(uint64_t offset) {
+    if (!file) return false;
+    if (!seekTo(file, offset)) return false;
+    begin = end = 0;
+    buffer_offset = offset;
+    eof = false;
+    return true;
+}
+
+bool RecordingReader::fill() {
+    if (eof) return false;
+
+    // Keep the unfinished line and read behind it
+    size_t pending = end - begin;
+    if (pending == buffer.size()) buffer.resize(buffer.size() * 2);
+    if (begin > 0) {
+        std::memmove(buffer.data(), buffer.data() + begin, pending);
+        buffer_offset += begin;
+        begin = 0;
+        end = pending;
+    }
+
+    size_t n = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+    if (n == 0) {
+        eof = true;
+        return false;
+    }
+    end += n;
+    bytes_read += n;
+    return true;
+}
+
+bool RecordingReader::next(const char*& line, const char*& line_end) {
+    for (;;) {
+        const char* start = buffer.data() + begin;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - begin));
+        if (newline) {
+            line = start;
+            line_end = newline;
+            line_offset = buffer_offset + begin;
+            begin += static_cast<size_t>(newline - start) + 1;
+            return true;
+        }
+        if (!fill()) return false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// RecordingIndex
+// ---------------------------------------------------------------------------
+
+namespace {
+    const char INDEX_BANNER[] = "# sysmonitor-index 1";
+
+    // "F <ts_ms> ..." / "D <ts_ms> ..."; false for anything else
+    bool headerTimestamp(const char* line, const char* end, char& type, int64_t& ts) {
+        if (end - line < 3 || (line[0] != 'F' && line[0] != 'D') || line[1] != ' ') return false;
+        int64_t value = 0;
+        const char* p = line + 2;
+        if (p == end || *p < '0' || *p > '9') return false;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) value = value * 10 + (*p - '0');
+        type = line[0];
+        ts = value;
+        return true;
+    }
+}
+
+RecordingIndex::RecordingIndex(const std::string& recording)
+    : path(recording), indexed_bytes(0), first_timestamp(0), last_timestamp(0), scanned_bytes(0) {}
+
+void RecordingIndex::clear() {
+    entries.clear();
+    indexed_bytes = 0;
+    first_timestamp = 0;
+    last_timestamp = 0;
+}
+
+bool RecordingIndex::load() {
+    std::ifstream in(getIndexPath().c_str());
+    if (!in.is_open()) return false;
+
+    std::string banner;
+    if (!std::getline(in, banner) || banner != INDEX_BANNER) return false;
+
+    size_t count = 0;
+    long long bytes = 0, first = 0, last = 0;
+    if (!(in >> bytes >> first >> last >> count)) return false;
+
+    entries.resize(count);
+    for (auto& entry : entries) {
+        long long ts = 0;
+        unsigned long long offset = 0;
+        if (!(in >> ts >> offset)) {
+            clear();
+            return false;
+        }
+        entry.timestamp_ms = ts;
+        entry.offset = offset;
+    }
+
+    indexed_bytes = static_cast<uint64_t>(bytes);
+    first_timestamp = first;
+    last_timestamp = last;
+    return true;
+}
+
+bool RecordingIndex::save() const {
+    std::ofstream out(getIndexPath().c_str(), std::ios::out | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    out << INDEX_BANNER << "\n"
+        << indexed_bytes << " " << first_timestamp << " " << last_timestamp << " "
+        << entries.size() << "\n";
+    for (const auto& entry : entries) {
+        out << entry.timestamp_ms << " " << entry.offset << "\n";
+    }
+    return out.good();
+}
+
+bool RecordingIndex::verify() const {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    bool ok = seekTo(file, 0, SEEK_END) && tellFrom(file) >= indexed_bytes;
+
+    // The newest entry must still point at the keyframe it recorded
+    if (ok && !entries.empty()) {
+        char head[32];
+        const Entry& entry = entries.back();
+        size_t n = 0;
+        if (seekTo(file, entry.offset)) {
+            n = std::fread(head, 1, sizeof(head), file);
+        }
+        char type;
+        int64_t ts;
+        ok = n > 0 && headerTimestamp(head, head + n, type, ts) && type == 'F' &&
+             ts == entry.timestamp_ms;
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+bool RecordingIndex::scan(uint64_t from) {
+    RecordingReader reader(path);
+    if (!reader.isOpen() || !reader.seek(from)) return false;
+
+    const char* line;
+    const char* end;
+    while (reader.next(line, end)) {
+        char type;
+        int64_t ts;
+        if (!headerTimestamp(line, end, type, ts)) continue;
+        if (first_timestamp == 0) first_timestamp = ts;
+        last_timestamp = ts;
+        if (type == 'F') entries.push_back({ ts, reader.getLineOffset() });
+    }
+
+    indexed_bytes = reader.getOffset();
+    scanned_bytes += reader.getBytesRead();
+    return true;
+}
+
+bool RecordingIndex::update() {
+    scanned_bytes = 0;
+    if (!load() || !verify()) clear();
+
+    uint64_t before = indexed_bytes;
+    if (!scan(indexed_bytes)) return false;
+    if (indexed_bytes != before) save();
+    return true;
+}
+
+uint64_t RecordingIndex::seek(int64_t timestamp_ms) const {
+    if (entries.empty()) return 0;
+    auto it = std::upper_bound(entries.begin(), entries.end(), timestamp_ms,
+                               [](int64_t ts, const Entry& entry) { return ts < entry.timestamp_ms; });
+    if (it == entries.begin()) return entries.front().offset;
+    return (it - 1)->offset;
+}
@@ -0,0 +1,88 @@
+#ifndef RECORDINGINDEX_H
+#define RECORDINGINDEX_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Sequential line reader over a recording, in large chunks. Lines are
+// returned without the newline; a trailing partial line (a frame still
+// being written) is never returned.
+class RecordingReader {
+private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    size_t begin;
+    size_t end;
+    uint64_t buffer_offset;
+    uint64_t line_offset;
+    uint64_t bytes_read;
+    bool eof;
+
+    bool fill();
+
+public:
+    explicit RecordingReader(const std::string& path, size_t chunk = 1 << 20);
+    ~RecordingReader();
+
+    bool isOpen() const { return file != nullptr; }
+    bool seek(uint64_t offset);
+    bool next(const char*& line, const char*& line_end);
+
+    // File offset of the line last returned by next()
+    uint64_t getLineOffset() const { return line_offset; }
+    // Offset just past the last complete line returned
+    uint64_t getOffset() const { return buffer_offset + begin; }
+    uint64_t getBytesRead() const { return bytes_read; }
+};
+
+// Sparse time index over a recording: the timestamp and byte offset of
+// every keyframe, which is where a reader can start decoding.
+//
+// The index lives next to the recording as `<file>.idx` and only covers
+// the bytes it has seen; update() indexes whatever was appended since and
+// rebuilds from scratch if the recording was truncated or replaced. If the
+// sidecar cannot be written the index is still built in memory.
+class RecordingIndex {
+public:
+    struct Entry {
+        int64_t timestamp_ms;
+        uint64_t offset;
+    };
+
+private:
+    std::string path;
+    std::vector<Entry> entries;
+    uint64_t indexed_bytes;
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+    uint64_t scanned_bytes;
+
+    bool load();
+    bool save() const;
+    bool verify() const;
+    bool scan(uint64_t from);
+    void clear();
+
+public:
+    explicit RecordingIndex(const std::string& recording);
+
+    bool update();
+
+    // Offset of the last keyframe at or before `timestamp_ms`, or of the
+    // first keyframe when the recording starts later
+    uint64_t seek(int64_t timestamp_ms) const;
+
+    bool empty() const { return entries.empty(); }
+    size_t size() const { return entries.size(); }
+    // Timestamps of the first and last frame headers (keyframe or delta)
+    int64_t getFirstTimestamp() const { return first_timestamp; }
+    int64_t getLastTimestamp() const { return last_timestamp; }
+    // Bytes of the recording read by the last update()
+    uint64_t getScannedBytes() const { return scanned_bytes; }
+    const std::string& getPath() const { return path; }
+    std::string getIndexPath() const { return path + ".idx"; }
+};
+
+#endif // RECORDINGINDEX_H
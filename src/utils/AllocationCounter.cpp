@@ -0,0 +1,16 @@
+#include "AllocationCounter.h"
+#include <atomic>
+
+namespace {
+    std::atomic<unsigned long long> allocations(0);
+}
+
+namespace AllocationCounter {
+    unsigned long long count() {
+        return allocations.load(std::memory_order_relaxed);
+    }
+
+    void record() {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+// Counts every global operator new in the process. The counter itself is
+// part of libsysmonitor; the replacement allocation functions that feed it
+// live in AllocationHooks.cpp, which only executables link (the library
+// must not take over an embedding program's allocator). Without the hooks
+// count() stays 0.
+namespace AllocationCounter {
+    unsigned long long count();
+    void record();
+}
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,160 @@
+#include "Instrumentation.h"
+#ifdef SYSMON_INSTRUMENTATION
+#include "AllocationCounter.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Instrumentation {
+
+std::atomic<uint64_t> syscalls(0);
+
+namespace {
+    // log2(ns) buckets: bucket b holds durations in [2^b, 2^(b+1)) ns
+    const int BUCKETS = 40;
+
+    // Stages are recorded from the sampler, the Monitor background thread
+    // and the exporter/notifier threads at once. Every counter is a relaxed
+    // atomic: each one is exact, and a summary taken while another thread
+    // records may mix that call in for some counters and not others.
+    struct StageData {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> total_ticks;
+        std::atomic<uint64_t> last_ticks;
+        std::atomic<uint64_t> max_ticks;
+        std::atomic<uint64_t> syscalls;
+        std::atomic<uint64_t> allocs;
+        std::atomic<uint64_t> buckets[BUCKETS];
+    };
+
+    // Zero-initialised as a static
+    StageData stages[static_cast<int>(Stage::COUNT)];
+
+    uint64_t load(const std::atomic<uint64_t>& counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    const char* const STAGE_NAMES[] = {
+        "collect", "cpu", "thermal", "memory", "paging", "scan", "parse", "anomaly",
+        "accounting", "forecast", "cgroups", "sched", "numa", "tree", "rank", "statistics", "optimize", "alert", "render", "export"
+    };
+
+    // TSC to nanoseconds, calibrated against steady_clock over the whole
+    // lifetime of the process so far
+    struct Calibration {
+        uint64_t ticks0;
+        std::chrono::steady_clock::time_point time0;
+        std::atomic<double> ns_per_tick;
+
+        Calibration() : ticks0(now()), time0(std::chrono::steady_clock::now()), ns_per_tick(1.0) {}
+    };
+
+    Calibration& calibration() {
+        static Calibration calib;
+        return calib;
+    }
+
+    // Touch the calibration at static-init time so its origin is early
+    const Calibration& calibration_origin = calibration();
+
+    int bucketFor(double ns) {
+        if (ns < 1.0) return 0;
+        int bucket = static_cast<int>(std::log2(ns));
+        return std::min(bucket, BUCKETS - 1);
+    }
+
+    double percentile(const StageData& data, uint64_t calls, double q) {
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * calls));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            uint64_t count = load(data.buckets[b]);
+            seen += count;
+            if (seen >= rank && count > 0) {
+                // Geometric midpoint of the bucket
+                return std::pow(2.0, b + 0.5);
+            }
+        }
+        return 0.0;
+    }
+}
+
+const char* stageName(Stage stage) {
+    int index = static_cast<int>(stage);
+    if (index < 0 || index >= static_cast<int>(Stage::COUNT)) return "unknown";
+    return STAGE_NAMES[index];
+}
+
+double ticksToNanos(uint64_t ticks) {
+#ifdef SYSMON_HAVE_TSC
+    Calibration& calib = calibration();
+    uint64_t elapsed_ticks = now() - calib.ticks0;
+    double elapsed_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - calib.time0).count();
+    // Keep the previous ratio until the window is long enough to be stable
+    if (elapsed_ticks > 0 && elapsed_ns > 1e6) {
+        calib.ns_per_tick.store(elapsed_ns / elapsed_ticks, std::memory_order_relaxed);
+    }
+    return ticks * calib.ns_per_tick.load(std::memory_order_relaxed);
+#else
+    return static_cast<double>(ticks);
+#endif
+}
+
+uint64_t allocationCount() {
+#ifdef SYSMON_INSTRUMENTATION
+    return AllocationCounter::count();
+#else
+    return 0;
+#endif
+}
+
+void record(Stage stage, uint64_t ticks, uint64_t syscall_count, uint64_t alloc_count) {
+    StageData& data = stages[static_cast<int>(stage)];
+    data.calls.fetch_add(1, std::memory_order_relaxed);
+    data.total_ticks.fetch_add(ticks, std::memory_order_relaxed);
+    data.last_ticks.store(ticks, std::memory_order_relaxed);
+    uint64_t max = load(data.max_ticks);
+    while (ticks > max && !data.max_ticks.compare_exchange_weak(max, ticks, std::memory_order_relaxed)) {
+    }
+    data.syscalls.fetch_add(syscall_count, std::memory_order_relaxed);
+    data.allocs.fetch_add(alloc_count, std::memory_order_relaxed);
+    // Bucket in nanoseconds so the histogram does not depend on the TSC rate
+    data.buckets[bucketFor(ticksToNanos(ticks))].fetch_add(1, std::memory_order_relaxed);
+}
+
+void summarize(Stage stage, StageSummary& summary) {
+    const StageData& data = stages[static_cast<int>(stage)];
+    ticksToNanos(0);    // refresh the calibration
+
+    uint64_t calls = load(data.calls);
+    summary.calls = calls;
+    if (calls == 0) {
+        summary.last_us = summary.mean_us = summary.p50_us = summary.p99_us = summary.max_us = 0.0;
+        summary.syscalls_per_call = summary.allocs_per_call = 0.0;
+        return;
+    }
+
+    double ns_per_tick = calibration().ns_per_tick.load(std::memory_order_relaxed);
+    summary.last_us = load(data.last_ticks) * ns_per_tick / 1000.0;
+    summary.mean_us = load(data.total_ticks) * ns_per_tick / 1000.0 / calls;
+    summary.max_us = load(data.max_ticks) * ns_per_tick / 1000.0;
+    summary.p50_us = std::min(percentile(data, calls, 0.50) / 1000.0, summary.max_us);
+    summary.p99_us = std::min(percentile(data, calls, 0.99) / 1000.0, summary.max_us);
+    summary.syscalls_per_call = static_cast<double>(load(data.syscalls)) / calls;
+    summary.allocs_per_call = static_cast<double>(load(data.allocs)) / calls;
+}
+
+void reset() {
+    for (StageData& data : stages) {
+        data.calls.store(0, std::memory_order_relaxed);
+        data.total_ticks.store(0, std::memory_order_relaxed);
+        data.last_ticks.store(0, std::memory_order_relaxed);
+        data.max_ticks.store(0, std::memory_order_relaxed);
+        data.syscalls.store(0, std::memory_order_relaxed);
+        data.allocs.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint64_t>& bucket : data.buckets) bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace Instrumentation
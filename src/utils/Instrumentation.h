@@ -0,0 +1,151 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(SYSMON_INSTRUMENTATION) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define SYSMON_HAVE_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+// Self-instrumentation of the monitor's own hot paths.
+//
+// Stages are timed with SYSMON_STAGE(...), which records wall time, the
+// syscalls counted by the platform readers and the operator new calls made
+// while the scope was active. Everything here compiles to nothing unless
+// the build defines SYSMON_INSTRUMENTATION (CMake ENABLE_INSTRUMENTATION).
+namespace Instrumentation {
+    enum class Stage {
+        COLLECT,        // whole of SystemMonitor::collectMetrics
+        CPU,
+        THERMAL,
+        MEMORY,
+        PAGING,         // /proc/vmstat
+        SCAN,           // directory walk + per-process reads + table update
+        PARSE,          // stat line parsing inside SCAN
+        ANOMALY,
+        ACCOUNTING,
+        FORECAST,
+        CGROUPS,
+        SCHED,
+        NUMA,
+        TREE,
+        RANK,
+        STATISTICS,
+        OPTIMIZE,
+        ALERT,
+        RENDER,
+        EXPORT,
+        COUNT
+    };
+
+    struct StageSummary {
+        unsigned long long calls;
+        double last_us;
+        double mean_us;
+        double p50_us;
+        double p99_us;
+        double max_us;
+        double syscalls_per_call;
+        double allocs_per_call;
+    };
+
+    inline bool enabled() {
+#ifdef SYSMON_INSTRUMENTATION
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const char* stageName(Stage stage);
+
+    // Raw clock ticks: the TSC where available, steady_clock nanoseconds
+    // otherwise. Only differences are meaningful.
+    inline uint64_t now() {
+#ifdef SYSMON_HAVE_TSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    double ticksToNanos(uint64_t ticks);
+
+    extern std::atomic<uint64_t> syscalls;
+
+    inline void addSyscalls(unsigned int count) {
+        syscalls.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    uint64_t allocationCount();
+
+    void record(Stage stage, uint64_t ticks, uint64_t syscall_count, uint64_t alloc_count);
+    void summarize(Stage stage, StageSummary& summary);
+    void reset();
+
+    class ScopedTimer {
+    private:
+        Stage stage;
+        uint64_t start;
+        uint64_t syscalls_start;
+        uint64_t allocs_start;
+
+    public:
+        explicit ScopedTimer(Stage stage)
+            : stage(stage), start(now()),
+              syscalls_start(syscalls.load(std::memory_order_relaxed)),
+              allocs_start(allocationCount()) {}
+
+        ~ScopedTimer() {
+            record(stage, now() - start,
+                   syscalls.load(std::memory_order_relaxed) - syscalls_start,
+                   allocationCount() - allocs_start);
+        }
+    };
+
+    // Accumulates many short intervals (e.g. one per process) and records
+    // them as a single call, so the histogram is not flooded
+    class SplitTimer {
+    private:
+        Stage stage;
+        uint64_t started;
+        uint64_t total;
+
+    public:
+        explicit SplitTimer(Stage stage) : stage(stage), started(0), total(0) {}
+        ~SplitTimer() { record(stage, total, 0, 0); }
+
+        void begin() { started = now(); }
+        void end() { total += now() - started; }
+    };
+}
+
+#define SYSMON_CONCAT_INNER(a, b) a##b
+#define SYSMON_CONCAT(a, b) SYSMON_CONCAT_INNER(a, b)
+
+#ifdef SYSMON_INSTRUMENTATION
+#define SYSMON_STAGE(stage) \
+    ::Instrumentation::ScopedTimer SYSMON_CONCAT(sysmon_stage_, __LINE__)(::Instrumentation::Stage::stage)
+#define SYSMON_SPLIT(name, stage) ::Instrumentation::SplitTimer name(::Instrumentation::Stage::stage)
+#define SYSMON_SPLIT_BEGIN(name) name.begin()
+#define SYSMON_SPLIT_END(name) name.end()
+#define SYSMON_SYSCALLS(count) ::Instrumentation::addSyscalls(count)
+#else
+#define SYSMON_STAGE(stage) ((void)0)
+#define SYSMON_SPLIT(name, stage) ((void)0)
+#define SYSMON_SPLIT_BEGIN(name) ((void)0)
+#define SYSMON_SPLIT_END(name) ((void)0)
+#define SYSMON_SYSCALLS(count) ((void)0)
+#endif
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,78 @@
+#include "Text.h"
+#include <cstdio>
+
+namespace Text {
+
+size_t utf8Length(const char* data, size_t size) {
+    if (size == 0) return 0;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    unsigned char lead = p[0];
+    if (lead < 0x80) return 1;
+
+    // Second-byte bounds rule out overlong forms, surrogates (ED A0..BF)
+    // and anything past U+10FFFF (F4 90..)
+    size_t length;
+    unsigned char low = 0x80, high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) low = 0xA0;
+        if (lead == 0xED) high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) low = 0x90;
+        if (lead == 0xF4) high = 0x8F;
+    } else {
+        return 0;
+    }
+    if (size < length || p[1] < low || p[1] > high) return 0;
+    for (size_t i = 2; i < length; i++) {
+        if (p[i] < 0x80 || p[i] > 0xBF) return 0;
+    }
+    return length;
+}
+
+size_t utf8Prefix(const char* data, size_t size, size_t max_bytes) {
+    size_t end = 0;
+    while (end < size) {
+        size_t length = utf8Length(data + end, size - end);
+        if (length == 0) length = 1;
+        if (end + length > max_bytes) break;
+        end += length;
+    }
+    return end;
+}
+
+void appendJSONString(std::string& out, const std::string& value) {
+    out += '"';
+    const char* data = value.data();
+    size_t size = value.size();
+    size_t i = 0;
+    while (i < size) {
+        unsigned char u = static_cast<unsigned char>(data[i]);
+        if (u == '"' || u == '\\') {
+            out += '\\';
+            out += data[i++];
+        } else if (u < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", u);
+            out += escaped;
+            i++;
+        } else if (u < 0x80) {
+            out += data[i++];
+        } else {
+            size_t length = utf8Length(data + i, size - i);
+            if (length == 0) {
+                out += "\\ufffd";
+                i++;
+            } else {
+                out.append(data + i, length);
+                i += length;
+            }
+        }
+    }
+    out += '"';
+}
+
+} // namespace Text
@@ -0,0 +1,27 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <cstddef>
+#include <string>
+
+// Byte-level text helpers for process names and other strings taken from
+// the kernel, which are arbitrary bytes rather than guaranteed UTF-8.
+namespace Text {
+    // Length (1 to 4) of the well-formed UTF-8 character at the start of
+    // `data`, or 0 if there is none: a stray continuation byte, an overlong
+    // form, a surrogate, a value past U+10FFFF, or a sequence cut short
+    // by `size`
+    size_t utf8Length(const char* data, size_t size);
+
+    // Longest prefix of at most `max_bytes` that does not end inside a
+    // character; invalid bytes count as one character each
+    size_t utf8Prefix(const char* data, size_t size, size_t max_bytes);
+
+    // Appends `value` as a quoted JSON string. Quotes, backslashes and
+    // control characters are escaped, and every byte that is not part of
+    // a well-formed character becomes U+FFFD, so the result is valid JSON
+    // whatever the input.
+    void appendJSONString(std::string& out, const std::string& value);
+}
+
+#endif // TEXT_H
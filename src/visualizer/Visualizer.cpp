@@ -1,4 +1,6 @@
 #include "Visualizer.h"
+#include "../platform/Platform.h"
+#include "../utils/Instrumentation.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -6,7 +8,60 @@
 #include <ctime>
 #include <chrono>
 
-Visualizer::Visualizer() {}
+namespace {
+    // Counts the lines written through std::cout while in scope, so the
+    // process table can take whatever height the panels above leave
+    class LineCounter : public std::streambuf {
+    private:
+        std::streambuf* target;
+        int lines;
+
+    protected:
+        int overflow(int c) override {
+            if (c == '\n') lines++;
+            return c == traits_type::eof() ? traits_type::not_eof(c) : target->sputc(static_cast<char>(c));
+        }
+
+        std::streamsize xsputn(const char* data, std::streamsize len) override {
+            lines += static_cast<int>(std::count(data, data + len, '\n'));
+            return target->sputn(data, len);
+        }
+
+        int sync() override { return target->pubsync(); }
+
+    public:
+        LineCounter() : target(std::cout.rdbuf(this)), lines(0) {}
+        ~LineCounter() { std::cout.rdbuf(target); }
+        int getLines() const { return lines; }
+    };
+
+    const char* sortKeyName(SortKey key) {
+        switch (key) {
+            case SortKey::RSS: return "RSS";
+            case SortKey::PID: return "PID";
+            case SortKey::NAME: return "name";
+            default: return "CPU";
+        }
+    }
+}
+
+Visualizer::Visualizer()
+    : show_overhead(false), view(View::PROCESSES), cpu_history(nullptr), mem_history(nullptr),
+      throttle_history(nullptr), alerts(nullptr), governor(nullptr),
+      sort_key(SortKey::CPU), scroll(0), page_rows(10), overhead_lines(0) {}
+
+void Visualizer::setSortKey(SortKey key) {
+    if (key != sort_key) scroll = 0;
+    sort_key = key;
+}
+
+void Visualizer::scrollBy(long rows) {
+    if (rows < 0 && static_cast<size_t>(-rows) > scroll) {
+        scroll = 0;
+    } else {
+        scroll += rows;
+    }
+}
 
 void Visualizer::clearScreen() {
 #ifdef _WIN32
@@ -22,6 +77,21 @@ std::string Visualizer::getColorCode(double value) {
     return "\033[42m"; // Green background
 }
 
+std::string Visualizer::formatDuration(double seconds) {
+    long total = static_cast<long>(seconds + 0.5);
+    std::ostringstream out;
+    if (total >= 86400) {
+        out << total / 86400 << "d " << total % 86400 / 3600 << "h";
+    } else if (total >= 3600) {
+        out << total / 3600 << "h " << total % 3600 / 60 << "m";
+    } else if (total >= 60) {
+        out << total / 60 << "m " << total % 60 << "s";
+    } else {
+        out << total << "s";
+    }
+    return out.str();
+}
+
 std::string Visualizer::createBar(double percentage, int width) {
     int filled = static_cast<int>((percentage / 100.0) * width);
     std::string bar = "[";
@@ -38,7 +108,106 @@ std::string Visualizer::createBar(double percentage, int width) {
     return bar;
 }
 
-std::string Visualizer::createSparkline(const std::deque<double>& data, int width) {
+void Visualizer::displayThermals(const CPUThermals& thermals) {
+    if (!thermals.available && thermals.hottest_zone < 0) return;
+    
+    std::cout << "│ ";
+    if (thermals.available) {
+        std::cout << "Clock: " << std::fixed << std::setprecision(2) << thermals.avg_mhz / 1000.0 << " GHz";
+        if (thermals.cpus > 1) {
+            std::cout << " (" << thermals.min_mhz / 1000.0 << "-" << thermals.max_mhz / 1000.0 << ")";
+        }
+        if (thermals.nominal_mhz > 0.0) {
+            std::cout << " of " << thermals.nominal_mhz / 1000.0 << " GHz max ("
+                      << std::setprecision(0) << 100.0 * thermals.avg_mhz / thermals.nominal_mhz << "%)";
+        }
+        std::cout << "  ";
+    }
+    if (thermals.hottest_zone >= 0) {
+        const ThermalZoneInfo& zone = thermals.zones[thermals.hottest_zone];
+        std::cout << zone.type << " " << std::setprecision(0) << zone.celsius << "°C";
+    }
+    if (thermals.throttle_events > 0) {
+        std::cout << "  \033[1;31mTHROTTLING: " << thermals.throttled_cpus << " CPUs, "
+                  << thermals.throttle_events << " events\033[0m";
+    }
+    std::cout << "\n" << std::setprecision(1);
+}
+
+void Visualizer::displayPaging(const PagingRates& paging) {
+    if (!paging.available) return;
+    
+    // Reclaim stalling allocations or memory coming back from swap: the
+    // host is short of memory, whatever the usage bar says
+    bool pressure = paging.scan_direct > 0.0 || paging.swap_in > 0.0;
+    std::cout << "│ Paging: " << (pressure ? "\033[1;33m" : "") << std::fixed << std::setprecision(0)
+              << "majflt " << paging.major_faults << "/s  "
+              << "swap in/out " << paging.swap_in << "/" << paging.swap_out << " pg/s  "
+              << "scan k/d " << paging.scan_kswapd << "/" << paging.scan_direct;
+    if (paging.scan_kswapd + paging.scan_direct > 0.0) {
+        std::cout << " (" << paging.reclaimEfficiency() << "% reclaimed)";
+    }
+    if (pressure) std::cout << "\033[0m";
+    if (paging.oom_kills > 0) {
+        std::cout << "  \033[1;31mOOM KILLS: " << paging.oom_kills << "\033[0m";
+    }
+    std::cout << "\n" << std::setprecision(1);
+}
+
+void Visualizer::displayAlerts() {
+    if (!alerts || alerts->empty()) return;
+    
+    std::cout << "\033[1;31m┌─ ALERTS ───────────────────────────────────────────────────────────────┐\033[0m\n";
+    size_t shown = std::min(alerts->size(), static_cast<size_t>(5));
+    for (size_t i = 0; i < shown; i++) {
+        const AlertEvent& alert = (*alerts)[i];
+        std::cout << "│ \033[1;31m" << alert.rule << "\033[0m ";
+        if (alert.pid != 0) {
+            std::cout << alert.process << " (" << alert.pid << ") ";
+        }
+        std::cout << std::fixed << std::setprecision(alert.value >= 100.0 ? 0 : 1) << alert.value << "  ["
+                  << alert.expression << "]  for " << formatDuration(alert.active_sec) << "\n";
+    }
+    if (alerts->size() > shown) {
+        std::cout << "│ ... and " << alerts->size() - shown << " more\n";
+    }
+    std::cout << "\033[1;31m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
+    std::cout << std::setprecision(1);
+}
+
+void Visualizer::displayForecast(const MemoryForecast& forecast) {
+    std::cout << "│ Forecast: ";
+    if (!forecast.ready) {
+        std::cout << "collecting history\n";
+    } else if (forecast.seconds_to_exhaustion < 0.0) {
+        std::cout << "no exhaustion projected (" << std::showpos << std::setprecision(2)
+                  << forecast.trend_percent_per_hour << std::noshowpos << "%/h)\n";
+    } else {
+        // Red inside an hour, yellow inside six
+        const char* color = forecast.seconds_to_exhaustion < 3600 ? "\033[1;31m"
+                          : forecast.seconds_to_exhaustion < 6 * 3600 ? "\033[1;33m" : "";
+        std::cout << color << "full in ~" << formatDuration(forecast.seconds_to_exhaustion)
+                  << "\033[0m (" << std::showpos << std::setprecision(2)
+                  << forecast.trend_percent_per_hour << std::noshowpos << "%/h; regression "
+                  << formatDuration(forecast.regression_seconds) << ", Holt "
+                  << formatDuration(forecast.holt_seconds) << ")\n";
+    }
+    
+    // The two fastest growers; the rest only go to the recording
+    for (size_t i = 0; i < forecast.growing.size() && i < 2; i++) {
+        const MemoryGrowth& proc = forecast.growing[i];
+        std::cout << "│   Growing: " << proc.name << " (" << proc.pid << ") "
+                  << std::setprecision(0) << proc.growth_kb_per_sec << " KB/s, "
+                  << proc.rss_kb / 1024 << " MB";
+        if (proc.seconds_to_exhaustion >= 0.0) {
+            std::cout << ", alone fills the rest in " << formatDuration(proc.seconds_to_exhaustion);
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::setprecision(1);
+}
+
+std::string Visualizer::createSparkline(const std::vector<double>& data, int width) {
     if (data.empty()) return std::string(width, ' ');
     
     const char* bars[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
@@ -65,9 +234,33 @@ std::string Visualizer::createSparkline(const std::deque<double>& data, int widt
     return sparkline;
 }
 
+std::string Visualizer::createEventMarks(const CompressedSeries& series, int width) {
+    // Same tail as the sparkline above it, so marks line up with its ticks
+    history_scratch.clear();
+    series.tail(static_cast<size_t>(width), history_scratch);
+    if (std::find_if(history_scratch.begin(), history_scratch.end(),
+                     [](double value) { return value > 0.0; }) == history_scratch.end()) {
+        return std::string();
+    }
+    
+    std::string marks;
+    for (double value : history_scratch) {
+        marks += value > 0.0 ? "\033[1;31m!\033[0m" : " ";
+    }
+    return marks;
+}
+
+std::string Visualizer::createSparkline(const CompressedSeries& series, int width) {
+    history_scratch.clear();
+    series.tail(static_cast<size_t>(width), history_scratch);
+    return createSparkline(history_scratch, width);
+}
+
 void Visualizer::displayMetrics(const SystemMetrics& metrics, bool show_optimization,
                                 double baseline_cpu, double baseline_mem) {
+    SYSMON_STAGE(RENDER);
     clearScreen();
+    LineCounter counter;
     
     auto now = std::chrono::system_clock::now();
     std::time_t now_c = std::chrono::system_clock::to_time_t(now);
@@ -78,7 +271,22 @@ void Visualizer::displayMetrics(const SystemMetrics& metrics, bool show_optimiza
     
     char time_str[100];
     strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", localtime(&now_c));
-    std::cout << "Time: " << time_str << "\n\n";
+    std::cout << "Time: " << time_str << "\n";
+    if (!filter_text.empty() && metrics.process_table) {
+        std::cout << "Filter: \033[1;36m" << filter_text << "\033[0m  (" << metrics.process_count
+                  << " of " << metrics.process_count + metrics.process_table->getFilteredCount()
+                  << " processes)\n";
+    }
+    if (governor) {
+        std::cout << "Monitor CPU: " << std::fixed << std::setprecision(2) << governor->getUsagePercent()
+                  << "% of a core (budget " << governor->getBudgetPercent() << "%)";
+        if (governor->isDegraded()) {
+            std::cout << (governor->isOverBudget() ? "  \033[1;31m" : "  \033[1;33m") << "reduced: "
+                      << governor->describe() << "\033[0m";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
     
     // CPU Section
     std::cout << "\033[1;33m┌─ CPU USAGE ────────────────────────────────────────────────────────────┐\033[0m\n";
@@ -92,7 +300,23 @@ void Visualizer::displayMetrics(const SystemMetrics& metrics, bool show_optimiza
             std::cout << "(\033[31m↑ " << -improvement << "%\033[0m from baseline)";
         }
     }
-    std::cout << "\n│\n";
+    std::cout << "\n";
+    displayThermals(metrics.cpu_thermals);
+    if (metrics.cpu_summary.samples > 0) {
+        std::cout << "│ Baseline: " << std::setprecision(1) << baseline_cpu << "%  |  "
+                  << "1m avg: " << metrics.cpu_summary.ewma_medium << "%  |  "
+                  << "p50/p95/p99: " << metrics.cpu_summary.p50 << "/"
+                  << metrics.cpu_summary.p95 << "/" << metrics.cpu_summary.p99 << "%\n";
+    }
+    if (cpu_history && cpu_history->size() > 1) {
+        std::cout << "│ History: " << createSparkline(*cpu_history) << "\n";
+        std::string throttled = throttle_history ? createEventMarks(*throttle_history) : "";
+        if (!throttled.empty()) {
+            std::cout << "│ Throttle:" << throttled << "\n";
+        }
+    } else {
+        std::cout << "│\n";
+    }
     std::cout << "│ " << createBar(metrics.cpu_usage, 60) << " " 
               << std::fixed << std::setprecision(1) << metrics.cpu_usage << "%\n";
     std::cout << "\033[1;33m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
@@ -102,28 +326,75 @@ void Visualizer::displayMetrics(const SystemMetrics& metrics, bool show_optimiza
     std::cout << "│ Total: " << metrics.total_mem_kb / 1024 << " MB  |  "
               << "Used: " << metrics.used_mem_kb / 1024 << " MB  |  "
               << "Available: " << metrics.available_mem_kb / 1024 << " MB\n";
-    std::cout << "│\n";
+    if (metrics.mem_summary.samples > 0) {
+        std::cout << "│ Baseline: " << std::fixed << std::setprecision(1) << baseline_mem << "%  |  "
+                  << "p50/p95/p99: " << metrics.mem_summary.p50 << "/"
+                  << metrics.mem_summary.p95 << "/" << metrics.mem_summary.p99 << "%\n";
+    }
+    if (metrics.accounted_processes > 0) {
+        std::cout << "│ Attributable (top " << metrics.accounted_processes << "): "
+                  << "PSS " << metrics.accounted_pss_kb / 1024 << " MB  |  "
+                  << "USS " << metrics.accounted_uss_kb / 1024 << " MB  |  "
+                  << "Swap " << metrics.accounted_swap_kb / 1024 << " MB  "
+                  << "(RSS " << metrics.accounted_rss_kb / 1024 << " MB)\n";
+    }
+    displayPaging(metrics.paging);
+    displayForecast(metrics.memory_forecast);
+    if (mem_history && mem_history->size() > 1) {
+        std::cout << "│ History: " << createSparkline(*mem_history) << "\n";
+    } else {
+        std::cout << "│\n";
+    }
     std::cout << "│ " << createBar(metrics.mem_usage_percent, 60) << " "
               << std::fixed << std::setprecision(1) << metrics.mem_usage_percent << "%\n";
     std::cout << "\033[1;35m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
+    displayAlerts();
     
-    // Top Processes
-    std::cout << "\033[1;32m┌─ TOP PROCESSES (by CPU) ───────────────────────────────────────────────┐\033[0m\n";
-    std::cout << "│ " << std::left << std::setw(8) << "PID"
-              << std::setw(20) << "Name"
-              << std::setw(12) << "CPU %"
-              << std::setw(14) << "Memory (MB)"
-              << std::setw(10) << "Priority" << "│\n";
-    std::cout << "│ " << std::string(64, '─') << "│\n";
+    if (view == View::CGROUPS) {
+        displayCgroups(metrics);
+    } else if (view == View::SCHED) {
+        displaySched(metrics);
+    } else if (view == View::TREE) {
+        displayTree(metrics);
+    } else if (view == View::NUMA) {
+        displayNuma(metrics);
+    } else {
+        // Without a terminal size, the ten rows the table always had
+        int rows = 0;
+        int columns = 0;
+        int table_rows = 10;
+        if (Platform::getTerminalSize(rows, columns)) {
+            table_rows = std::max(5, rows - counter.getLines() - trailerLines(metrics, show_optimization));
+        }
+        displayProcesses(metrics, table_rows);
+    }
     
-    for (const auto& proc : metrics.top_processes) {
-        std::cout << "│ " << std::left << std::setw(8) << proc.pid
-                  << std::setw(20) << proc.name.substr(0, 19)
-                  << std::setw(12) << std::fixed << std::setprecision(1) << proc.cpu_usage
-                  << std::setw(14) << proc.memory_kb / 1024
-                  << std::setw(10) << proc.priority << "│\n";
+    if (!metrics.anomalies.empty()) {
+        std::cout << "\033[1;31m┌─ ANOMALIES ────────────────────────────────────────────────────────────┐\033[0m\n";
+        size_t shown = std::min(metrics.anomalies.size(), static_cast<size_t>(5));
+        for (size_t i = 0; i < shown; i++) {
+            const auto& anomaly = metrics.anomalies[i];
+            std::cout << "│ " << std::left << std::setw(8) << anomaly.pid
+                      << std::setw(18) << anomaly.name.substr(0, 17) << std::fixed << std::setprecision(1);
+            switch (anomaly.type) {
+                case AnomalyType::CPU_SPIKE:
+                    std::cout << "CPU spike " << anomaly.value << "% (normal " << anomaly.expected << "%)";
+                    break;
+                case AnomalyType::RSS_SPIKE:
+                    std::cout << "RSS jump " << anomaly.value / 1024 << " MB (normal "
+                              << anomaly.expected / 1024 << " MB)";
+                    break;
+                case AnomalyType::RSS_LEAK:
+                    std::cout << "RSS growing " << anomaly.value * 60 / 1024 << " MB/min";
+                    break;
+            }
+            std::cout << "\n";
+        }
+        if (metrics.anomalies.size() > shown) {
+            std::cout << "│ ... and " << metrics.anomalies.size() - shown << " more\n";
+        }
+        std::cout << "\033[1;31m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
     }
-    std::cout << "\033[1;32m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
     
     if (show_optimization) {
         std::cout << "\033[1;31m┌─ OPTIMIZATION STATUS ──────────────────────────────────────────────────┐\033[0m\n";
@@ -141,7 +412,358 @@ void Visualizer::displayMetrics(const SystemMetrics& metrics, bool show_optimiza
         std::cout << "\033[1;31m└────────────────────────────────────────────────────────────────────────┘\033[0m\n";
     }
     
-    std::cout << "\n\033[90mPress 'q' to exit  |  'h' for help  |  'o' to toggle optimization\033[0m\n";
+    if (show_overhead) {
+        LineCounter overhead_counter;
+        displayOverhead();
+        overhead_lines = overhead_counter.getLines();
+    }
+    
+    std::cout << "\n\033[90mPress 'q' to exit  |  'h' for help  |  'o' to toggle optimization  |  "
+              << "'g' cgroups  |  'd' sched delay  |  't' tree  |  'n' NUMA  |  'v' overhead\033[0m\n";
+    if (view == View::PROCESSES) {
+        std::cout << "\033[90m↑/↓ PgUp/PgDn Home/End scroll  |  sort: 'P' CPU  'M' RSS  'N' PID  'A' name\033[0m";
+    }
+    std::cout << std::flush;
+}
+
+void Visualizer::displayFleet(const FleetMetrics& fleet, int listen_port) {
+    SYSMON_STAGE(RENDER);
+    clearScreen();
+    
+    auto now = std::chrono::system_clock::now();
+    std::time_t now_c = std::chrono::system_clock::to_time_t(now);
+    char time_str[100];
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", localtime(&now_c));
+    
+    std::cout << "\033[1;36m╔════════════════════════════════════════════════════════════════════════╗\033[0m\n";
+    std::cout << "\033[1;36m║          SYSMONITOR FLEET AGGREGATOR                                   ║\033[0m\n";
+    std::cout << "\033[1;36m╚════════════════════════════════════════════════════════════════════════╝\033[0m\n";
+    std::cout << "Time: " << time_str << "  |  Port: " << listen_port << "\n\n";
+    
+    std::cout << "\033[1;33m┌─ FLEET ────────────────────────────────────────────────────────────────┐\033[0m\n";
+    std::cout << "│ Hosts: " << fleet.connected_hosts << " connected / " << fleet.host_count << " known  |  "
+              << "Processes: " << fleet.process_count << "\n";
+    std::cout << "│ Mean CPU: " << std::fixed << std::setprecision(1) << fleet.mean_cpu << "%  |  "
+              << "Mean memory: " << fleet.mean_mem_percent << "%\n";
+    std::cout << "│ Frames: " << fleet.frames << "  |  Received: " << fleet.bytes / 1024 << " KB  |  "
+              << "Rejected: " << fleet.rejected << "\n";
+    std::cout << "\033[1;33m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
+    
+    std::cout << "\033[1;35m┌─ TOP HOSTS (by CPU) ───────────────────────────────────────────────────┐\033[0m\n";
+    std::cout << "│ " << std::left << std::setw(26) << "Host"
+              << std::setw(8) << "CPU %"
+              << std::setw(8) << "Mem %"
+              << std::setw(12) << "Used (MB)"
+              << std::setw(8) << "Procs"
+              << std::setw(8) << "Age (s)" << "\n";
+    std::cout << "│ " << std::string(68, '-') << "\n";
+    for (const auto& host : fleet.top_hosts) {
+        std::cout << "│ " << std::left << std::setw(26) << host.name.substr(0, 25)
+                  << std::setw(8) << std::setprecision(1) << host.cpu_usage
+                  << std::setw(8) << host.mem_usage_percent
+                  << std::setw(12) << host.used_mem_kb / 1024
+                  << std::setw(8) << host.process_count
+                  << std::setw(8) << std::setprecision(0) << host.age_sec
+                  << (host.connected ? "" : "(offline)") << "\n";
+    }
+    std::cout << "\033[1;35m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
+    
+    std::cout << "\033[1;32m┌─ TOP PROCESSES ACROSS HOSTS (by CPU) ──────────────────────────────────┐\033[0m\n";
+    std::cout << "│ " << std::left << std::setw(20) << "Host"
+              << std::setw(8) << "PID"
+              << std::setw(18) << "Name"
+              << std::setw(8) << "CPU %"
+              << std::setw(10) << "RSS (MB)"
+              << std::setw(6) << "Prio" << "\n";
+    std::cout << "│ " << std::string(68, '-') << "\n";
+    for (const auto& proc : fleet.top_processes) {
+        std::cout << "│ " << std::left << std::setw(20) << proc.host.substr(0, 19)
+                  << std::setw(8) << proc.pid
+                  << std::setw(18) << proc.name.substr(0, 17)
+                  << std::setw(8) << std::setprecision(1) << proc.cpu_usage
+                  << std::setw(10) << proc.memory_kb / 1024
+                  << std::setw(6) << proc.priority << "\n";
+    }
+    std::cout << "\033[1;32m└────────────────────────────────────────────────────────────────────────┘\033[0m\n";
+    
+    if (show_overhead) {
+        displayOverhead();
+    }
+    std::cout << "\n\033[90mPress 'q' to exit  |  'v' for monitor overhead\033[0m\n";
+}
+
+int Visualizer::trailerLines(const SystemMetrics& metrics, bool show_optimization) const {
+    // Table title, header and borders, then the footer
+    int lines = 5 + 3;
+    if (!metrics.anomalies.empty()) {
+        size_t shown = std::min(metrics.anomalies.size(), static_cast<size_t>(5));
+        lines += 3 + static_cast<int>(shown) + (metrics.anomalies.size() > shown ? 1 : 0);
+    }
+    if (show_optimization) {
+        int optimizing = 0;
+        for (const auto& proc : metrics.top_processes) {
+            if (proc.cpu_usage > 80.0) optimizing++;
+        }
+        lines += 2 + std::max(1, optimizing);
+    }
+    // As tall as it was last frame
+    if (show_overhead) lines += overhead_lines;
+    return lines;
+}
+
+void Visualizer::displayProcesses(const SystemMetrics& metrics, int rows) {
+    page_rows = static_cast<size_t>(rows);
+    const ProcessTable* table = metrics.process_table;
+    size_t total = table ? table->size() : 0;
+    scroll = std::min(scroll, total > page_rows ? total - page_rows : 0);
+    size_t last = std::min(total, scroll + page_rows);
+    
+    // Only the visible window is sorted, so this is the same work at any scroll
+    if (table) table->rank(sort_key, order, scroll, last);
+    
+    std::ostringstream title;
+    title << "PROCESSES (by " << sortKeyName(sort_key) << ")  "
+          << (total ? scroll + 1 : 0) << "-" << last << " of " << total;
+    std::string caption = title.str();
+    std::cout << "\033[1;32m┌─ " << caption << " ";
+    for (int i = static_cast<int>(caption.size()); i < 69; i++) std::cout << "─";
+    std::cout << "┐\033[0m\n";
+    std::cout << "│ " << std::left << std::setw(8) << "PID"
+              << std::setw(18) << "Name"
+              << std::setw(8) << "CPU %"
+              << std::setw(10) << "RSS (MB)"
+              << std::setw(10) << "PSS (MB)"
+              << std::setw(6) << "Prio"
+              << std::setw(8) << "MajF/s" << "│\n";
+    std::cout << "│ " << std::string(68, '-') << "│\n";
+    
+    ProcessInfo proc;
+    for (size_t i = scroll; i < last; i++) {
+        table->fill(order[i], proc);
+        std::cout << "│ " << std::left << std::setw(8) << proc.pid
+                  << std::setw(18) << proc.name.substr(0, 17)
+                  << std::setw(8) << std::fixed << std::setprecision(1) << proc.cpu_usage
+                  << std::setw(10) << proc.memory_kb / 1024;
+        
+        // PSS is only measured for the top processes by CPU
+        auto accounted = std::find_if(metrics.top_processes.begin(), metrics.top_processes.end(),
+                                      [&proc](const ProcessInfo& top) { return top.pid == proc.pid; });
+        if (accounted != metrics.top_processes.end() && accounted->mem_accounted) {
+            std::cout << std::setw(10) << accounted->pss_kb / 1024;
+        } else {
+            std::cout << std::setw(10) << "-";
+        }
+        std::cout << std::setw(6) << proc.priority
+                  << std::setw(8) << std::setprecision(0) << proc.major_fault_rate
+                  << std::setprecision(1) << "│\n";
+    }
+    std::cout << "\033[1;32m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
+}
+
+void Visualizer::displayCgroups(const SystemMetrics& metrics) {
+    std::cout << "\033[1;32m┌─ TOP CGROUPS (by CPU) ─────────────────────────────────────────────────┐\033[0m\n";
+    if (metrics.top_cgroups.empty()) {
+        std::cout << "│ No cgroup v2 hierarchy found (or no data yet)\n";
+    } else {
+        std::cout << "│ " << std::left << std::setw(30) << "Group"
+                  << std::setw(8) << "CPU %"
+                  << std::setw(10) << "Mem (MB)"
+                  << std::setw(16) << "IO R/W (KB/s)"
+                  << std::setw(6) << "Procs" << "\n";
+        std::cout << "│ " << std::string(68, '-') << "\n";
+        
+        for (const auto& group : metrics.top_cgroups) {
+            // Keep the tail of long paths: the leaf is the interesting part
+            std::string path = group.path;
+            if (path.size() > 29) path = "..." + path.substr(path.size() - 26);
+            
+            std::ostringstream io;
+            io << std::fixed << std::setprecision(0) << group.io_read_kbps << "/" << group.io_write_kbps;
+            
+            std::cout << "│ " << std::left << std::setw(30) << path
+                      << std::setw(8) << std::fixed << std::setprecision(1) << group.cpu_usage
+                      << std::setw(10) << group.memory_kb / 1024
+                      << std::setw(16) << io.str()
+                      << std::setw(6) << group.process_count << "\n";
+        }
+        if (metrics.cgroup_count > static_cast<int>(metrics.top_cgroups.size())) {
+            std::cout << "│ ... and " << metrics.cgroup_count - metrics.top_cgroups.size() << " more\n";
+        }
+    }
+    std::cout << "\033[1;32m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
+}
+
+void Visualizer::displaySched(const SystemMetrics& metrics) {
+    std::cout << "\033[1;32m┌─ TOP SCHEDULING DELAY ─────────────────────────────────────────────────┐\033[0m\n";
+    if (!metrics.cpu_sched.empty()) {
+        std::cout << "│ Run queue: " << std::fixed << std::setprecision(2) << metrics.runqueue_waiting
+                  << " tasks waiting on average\n";
+        
+        // Four CPUs per line; big hosts only show the first 16
+        size_t shown_cpus = std::min(metrics.cpu_sched.size(), static_cast<size_t>(16));
+        for (size_t i = 0; i < shown_cpus; i++) {
+            const CPUSchedInfo& cpu = metrics.cpu_sched[i];
+            if (i % 4 == 0) std::cout << "│ ";
+            std::ostringstream cell;
+            cell << "cpu" << i << " " << std::fixed << std::setprecision(0) << cpu.busy_percent
+                 << "%/" << cpu.wait_percent << "%w";
+            std::cout << std::left << std::setw(17) << cell.str();
+            if (i % 4 == 3 || i + 1 == shown_cpus) std::cout << "\n";
+        }
+        std::cout << "│\n";
+    }
+    
+    if (metrics.top_sched.empty()) {
+        std::cout << "│ No schedstat data yet (or no process waited for a CPU)\n";
+    } else {
+        std::cout << "│ " << std::left << std::setw(8) << "PID"
+                  << std::setw(22) << "Name"
+                  << std::setw(10) << "Delay %"
+                  << std::setw(14) << "Avg wait (us)"
+                  << std::setw(10) << "Slices/s"
+                  << std::setw(8) << "CPU %" << "\n";
+        std::cout << "│ " << std::string(68, '-') << "\n";
+        
+        for (const auto& proc : metrics.top_sched) {
+            std::cout << "│ " << std::left << std::setw(8) << proc.pid
+                      << std::setw(22) << proc.name.substr(0, 21)
+                      << std::setw(10) << std::fixed << std::setprecision(1) << proc.delay_percent
+                      << std::setw(14) << std::setprecision(0) << proc.avg_wait_us
+                      << std::setw(10) << proc.slices_per_sec
+                      << std::setw(8) << std::setprecision(1) << proc.cpu_usage << "\n";
+        }
+    }
+    std::cout << "\033[1;32m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
+}
+
+void Visualizer::displayTree(const SystemMetrics& metrics) {
+    std::cout << "\033[1;32m┌─ PROCESS TREE (by subtree CPU) ────────────────────────────────────────┐\033[0m\n";
+    if (metrics.process_tree.empty()) {
+        std::cout << "│ No process tree yet\n";
+    } else {
+        std::cout << "│ " << std::left << std::setw(8) << "PID"
+                  << std::setw(30) << "Name"
+                  << std::setw(8) << "Self %"
+                  << std::setw(8) << "Tree %"
+                  << std::setw(10) << "Tree MB"
+                  << std::setw(6) << "Procs" << "\n";
+        std::cout << "│ " << std::string(68, '-') << "\n";
+        
+        for (const auto& node : metrics.process_tree) {
+            // Folded subtrees are marked with '+' and their hidden child count
+            std::string label = std::string(node.depth * 2, ' ') + (node.hidden_children > 0 ? "+ " : "  ")
+                                + node.name;
+            if (node.hidden_children > 0) label += " (" + std::to_string(node.hidden_children) + ")";
+            if (label.size() > 29) label = label.substr(0, 28) + "~";
+            
+            std::cout << "│ " << std::left << std::setw(8) << node.pid
+                      << std::setw(30) << label
+                      << std::setw(8) << std::fixed << std::setprecision(1) << node.cpu_usage
+                      << std::setw(8) << node.subtree_cpu
+                      << std::setw(10) << node.subtree_rss_kb / 1024
+                      << std::setw(6) << node.subtree_processes << "\n";
+        }
+    }
+    std::cout << "\033[1;32m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
+}
+
+void Visualizer::displayNuma(const SystemMetrics& metrics) {
+    std::cout << "\033[1;32m┌─ NUMA NODES ───────────────────────────────────────────────────────────┐\033[0m\n";
+    if (metrics.numa_nodes.empty()) {
+        std::cout << "│ No NUMA topology found (/sys/devices/system/node)\n";
+    } else {
+        std::cout << "│ " << std::left << std::setw(6) << "Node"
+                  << std::setw(6) << "CPUs"
+                  << std::setw(8) << "CPU %"
+                  << std::setw(18) << "Used/Total (MB)"
+                  << std::setw(11) << "Local pg/s"
+                  << std::setw(12) << "Remote pg/s"
+                  << std::setw(8) << "Miss/s" << "\n";
+        std::cout << "│ " << std::string(68, '-') << "\n";
+        
+        for (const auto& node : metrics.numa_nodes) {
+            std::ostringstream memory;
+            memory << (node.total_kb - node.free_kb) / 1024 << "/" << node.total_kb / 1024;
+            // Remote allocations are the cross-node traffic to chase
+            bool remote = node.remote_pages_per_sec > node.local_pages_per_sec / 10.0 &&
+                          node.remote_pages_per_sec > 0.0;
+            std::cout << "│ " << std::left << std::setw(6) << node.node
+                      << std::setw(6) << node.cpus.size()
+                      << std::setw(8) << std::fixed << std::setprecision(1) << node.cpu_percent
+                      << std::setw(18) << memory.str()
+                      << std::setw(11) << std::setprecision(0) << node.local_pages_per_sec
+                      << (remote ? "\033[1;33m" : "") << std::setw(12) << node.remote_pages_per_sec
+                      << (remote ? "\033[0m" : "")
+                      << std::setw(8) << node.miss_pages_per_sec << "\n";
+        }
+        
+        if (metrics.numa_nodes.size() > 1) {
+            std::cout << "│\n";
+            if (metrics.numa_placements.empty()) {
+                std::cout << "│ No placement data yet\n";
+            } else {
+                std::cout << "│ " << std::left << std::setw(8) << "PID"
+                          << std::setw(18) << "Name"
+                          << std::setw(10) << "RSS (MB)"
+                          << std::setw(22) << "Per node (MB)"
+                          << "Home" << "\n";
+                for (const auto& proc : metrics.numa_placements) {
+                    std::ostringstream spread;
+                    for (size_t node = 0; node < proc.node_kb.size(); node++) {
+                        if (proc.node_kb[node] == 0) continue;
+                        spread << "N" << node << "=" << proc.node_kb[node] / 1024 << " ";
+                    }
+                    std::string per_node = spread.str();
+                    if (per_node.size() > 21) per_node = per_node.substr(0, 20) + "~";
+                    
+                    std::cout << "│ " << std::left << std::setw(8) << proc.pid
+                              << std::setw(18) << proc.name.substr(0, 17)
+                              << std::setw(10) << proc.rss_kb / 1024
+                              << std::setw(22) << per_node
+                              << "N" << proc.home_node << " " << std::setprecision(0)
+                              << proc.home_percent << "%";
+                    if (proc.suggested_node >= 0) {
+                        std::cout << "  \033[1;36m→ pin to N" << proc.suggested_node << "\033[0m";
+                    }
+                    std::cout << "\n";
+                }
+            }
+        }
+    }
+    std::cout << "\033[1;32m└────────────────────────────────────────────────────────────────────────┘\033[0m\n\n";
+}
+
+void Visualizer::displayOverhead() {
+    std::cout << "\n\033[1;34m┌─ MONITOR OVERHEAD ─────────────────────────────────────────────────────┐\033[0m\n";
+    if (!Instrumentation::enabled()) {
+        std::cout << "│ Instrumentation is compiled out (ENABLE_INSTRUMENTATION=OFF)\n";
+    } else {
+        std::cout << "│ " << std::left << std::setw(12) << "Stage"
+                  << std::right << std::setw(8) << "Calls"
+                  << std::setw(10) << "Last us"
+                  << std::setw(10) << "p50 us"
+                  << std::setw(10) << "p99 us"
+                  << std::setw(9) << "Sys/op"
+                  << std::setw(9) << "Alloc/op" << "\n";
+        std::cout << "│ " << std::string(68, '-') << "\n";
+        
+        Instrumentation::StageSummary summary;
+        for (int i = 0; i < static_cast<int>(Instrumentation::Stage::COUNT); i++) {
+            Instrumentation::Stage stage = static_cast<Instrumentation::Stage>(i);
+            Instrumentation::summarize(stage, summary);
+            if (summary.calls == 0) continue;
+            
+            std::cout << "│ " << std::left << std::setw(12) << Instrumentation::stageName(stage)
+                      << std::right << std::setw(8) << summary.calls << std::fixed << std::setprecision(0)
+                      << std::setw(10) << summary.last_us
+                      << std::setw(10) << summary.p50_us
+                      << std::setw(10) << summary.p99_us << std::setprecision(1)
+                      << std::setw(9) << summary.syscalls_per_call
+                      << std::setw(9) << summary.allocs_per_call << "\n";
+        }
+        std::cout << std::left;
+    }
+    std::cout << "\033[1;34m└────────────────────────────────────────────────────────────────────────┘\033[0m\n";
 }
 
 void Visualizer::showHelpOverlay() {
@@ -155,5 +777,15 @@ void Visualizer::showHelpOverlay() {
     std::cout << "\033[1;36m║\033[0m  +/-         -  Adjust update interval            \033[1;36m║\033[0m\n";
     std::cout << "\033[1;36m║\033[0m  h           -  Show this help                    \033[1;36m║\033[0m\n";
     std::cout << "\033[1;36m║\033[0m  s           -  Save snapshot                     \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  g           -  Switch process/cgroup view        \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  d           -  Switch process/sched delay view   \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  t           -  Switch process/tree view          \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  [ / ]       -  Fold/unfold one tree level        \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  n           -  Switch process/NUMA view          \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  v           -  Toggle monitor overhead panel     \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  ↑/↓ j/k     -  Scroll the process table          \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  PgUp/PgDn   -  Scroll one screen                 \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  Home/End    -  First/last process                \033[1;36m║\033[0m\n";
+    std::cout << "\033[1;36m║\033[0m  P/M/N/A     -  Sort by CPU/RSS/PID/name          \033[1;36m║\033[0m\n";
     std::cout << "\033[1;36m╚════════════════════════════════════════════════════╝\033[0m\n\n";
 }
\ No newline at end of file
@@ -4,25 +4,95 @@
 #ifndef VISUALIZER_H
 #define VISUALIZER_H
 
+#include "../alert/AlertEngine.h"
 #include "../monitor/ProcessInfo.h"
+#include "../monitor/CompressedSeries.h"
+#include "../monitor/OverheadGovernor.h"
+#include "../monitor/ProcessTable.h"
+#include "../net/FleetMetrics.h"
 #include <string>
-#include <deque>
+#include <vector>
 
 class Visualizer {
+public:
+    enum class View {
+        PROCESSES,
+        CGROUPS,
+        SCHED,
+        TREE,
+        NUMA
+    };
+
 private:
     static const int GRAPH_WIDTH = 60;
     static const int GRAPH_HEIGHT = 15;
+    bool show_overhead;
+    View view;
+    const CompressedSeries* cpu_history;
+    const CompressedSeries* mem_history;
+    const CompressedSeries* throttle_history;
+    std::vector<double> history_scratch;
+    std::string filter_text;
+    const std::vector<AlertEvent>* alerts;
+    const OverheadGovernor* governor;
+    // Process view: a window over the whole table, ranked on demand
+    SortKey sort_key;
+    size_t scroll;
+    size_t page_rows;
+    std::vector<uint32_t> order;
+    int overhead_lines;
     
     std::string createBar(double percentage, int width = 50);
-    std::string createSparkline(const std::deque<double>& data, int width = GRAPH_WIDTH);
+    std::string createSparkline(const std::vector<double>& data, int width = GRAPH_WIDTH);
+    std::string createSparkline(const CompressedSeries& series, int width = GRAPH_WIDTH);
     std::string getColorCode(double value);
+    std::string formatDuration(double seconds);
+    void displayForecast(const MemoryForecast& forecast);
+    void displayThermals(const CPUThermals& thermals);
+    void displayPaging(const PagingRates& paging);
+    void displayAlerts();
+    std::string createEventMarks(const CompressedSeries& series, int width = GRAPH_WIDTH);
+    void displayOverhead();
+    int trailerLines(const SystemMetrics& metrics, bool show_optimization) const;
+    void displayProcesses(const SystemMetrics& metrics, int rows);
+    void displayCgroups(const SystemMetrics& metrics);
+    void displaySched(const SystemMetrics& metrics);
+    void displayTree(const SystemMetrics& metrics);
+    void displayNuma(const SystemMetrics& metrics);
     
 public:
     Visualizer();
     void displayMetrics(const SystemMetrics& metrics, bool show_optimization, 
                        double baseline_cpu, double baseline_mem);
+    void displayFleet(const FleetMetrics& fleet, int listen_port);
     void clearScreen();
     void showHelpOverlay();
+    void setShowOverhead(bool show) { show_overhead = show; }
+    void toggleOverhead() { show_overhead = !show_overhead; }
+    bool getShowOverhead() const { return show_overhead; }
+    // Shown in the header while the process table is filtered
+    void setFilter(const std::string& text) { filter_text = text; }
+    void setView(View value) { view = value; }
+    // Re-sorting and scrolling only re-rank the table already collected;
+    // call displayMetrics() again with the same metrics to redraw
+    void setSortKey(SortKey key);
+    SortKey getSortKey() const { return sort_key; }
+    void scrollBy(long rows);
+    void scrollPages(long pages) { scrollBy(pages * static_cast<long>(page_rows)); }
+    void scrollHome() { scroll = 0; }
+    void scrollEnd() { scroll = static_cast<size_t>(-1); }
+    View getView() const { return view; }
+    // Draws a sparkline of the most recent samples under each usage bar
+    void setHistory(const CompressedSeries* cpu, const CompressedSeries* mem) {
+        cpu_history = cpu;
+        mem_history = mem;
+    }
+    // Marks ticks with throttling under the CPU history
+    void setThrottleHistory(const CompressedSeries* throttle) { throttle_history = throttle; }
+    // Alerts panel under the memory panel, shown while any alert fires
+    void setAlerts(const std::vector<AlertEvent>* firing) { alerts = firing; }
+    // Monitor CPU against its budget in the header, and what was shed
+    void setGovernor(const OverheadGovernor* value) { governor = value; }
 };
 
 #endif // VISUALIZER_H
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef TESTHARNESS_H
+#define TESTHARNESS_H
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Just enough of a test framework for ctest: TEST(name) registers a case,
+// CHECK/CHECK_EQ record a failure and carry on, REQUIRE stops the case.
+// Each test_*.cpp is linked with TestMain.cpp into its own executable.
+namespace test {
+
+struct Case {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<Case>& cases() {
+    static std::vector<Case> registered;
+    return registered;
+}
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) {
+        Case entry = { name, run };
+        cases().push_back(entry);
+    }
+};
+
+struct Abort {};
+
+inline void fail(const char* file, int line, const std::string& message) {
+    std::cerr << file << ":" << line << ": " << message << "\n";
+    failures()++;
+}
+
+template <typename A, typename B>
+void checkEqual(const A& actual, const B& expected, const char* expression, const char* file, int line) {
+    if (actual == expected) return;
+    std::ostringstream out;
+    out << expression << ": got " << actual << ", expected " << expected;
+    fail(file, line, out.str());
+}
+
+// Bit-exact for doubles, so NaN == NaN and -0.0 != 0.0
+inline bool sameBits(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    return a == b && std::signbit(a) == std::signbit(b);
+}
+
+} // namespace test
+
+#define TEST(name) \
+    static void name(); \
+    static test::Registrar name##_registrar(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { if (!(condition)) test::fail(__FILE__, __LINE__, "CHECK(" #condition ") failed"); } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    test::checkEqual((actual), (expected), #actual, __FILE__, __LINE__)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double check_a = (actual), check_e = (expected); \
+        if (!(std::fabs(check_a - check_e) <= (tolerance))) { \
+            std::ostringstream check_out; \
+            check_out << #actual << ": got " << check_a << ", expected " << check_e << " +- " << (tolerance); \
+            test::fail(__FILE__, __LINE__, check_out.str()); \
+        } \
+    } while (0)
+
+#define REQUIRE(condition) \
+    do { \
+        if (!(condition)) { \
+            test::fail(__FILE__, __LINE__, "REQUIRE(" #condition ") failed"); \
+            throw test::Abort(); \
+        } \
+    } while (0)
+
+#endif // TESTHARNESS_H
@@ -0,0 +1,23 @@
+#include "TestHarness.h"
+#include <cstring>
+#include <exception>
+
+// Runs every registered case, or only those whose name contains argv[1]
+int main(int argc, char* argv[]) {
+    const char* only = argc > 1 ? argv[1] : nullptr;
+    int run = 0;
+    for (const test::Case& entry : test::cases()) {
+        if (only && !std::strstr(entry.name, only)) continue;
+        int before = test::failures();
+        try {
+            entry.run();
+        } catch (const test::Abort&) {
+        } catch (const std::exception& e) {
+            test::fail(__FILE__, __LINE__, std::string(entry.name) + " threw: " + e.what());
+        }
+        std::cout << (test::failures() == before ? "[ ok ] " : "[FAIL] ") << entry.name << "\n";
+        run++;
+    }
+    std::cout << run << " cases, " << test::failures() << " failed checks\n";
+    return test::failures() == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,389 @@
+#include "TestHarness.h"
+#include "alert/AlertEngine.h"
+#include "monitor/ProcessTable.h"
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    typedef AlertEngine::Metric Metric;
+    typedef AlertEngine::Aggregate Aggregate;
+    typedef AlertEngine::Compare Compare;
+
+    struct RuleCase {
+        const char* line;
+        Metric metric;
+        Aggregate aggregate;
+        double window_sec;
+        Compare compare;
+        double threshold;
+        double for_sec;
+    };
+
+    const RuleCase RULE_CASES[] = {
+        { "cpu_hot: cpu p95 over 5m > 90 for 1m",
+          Metric::CPU, Aggregate::QUANTILE, 300, Compare::GT, 90, 60 },
+        { "leak: proc.rss rate over 1m > 100M/min",
+          Metric::PROC_RSS, Aggregate::RATE, 60, Compare::GT, 100.0 * 1024 / 60, 0 },
+        { "thrashing: majflt avg over 30s > 200",
+          Metric::MAJFLT, Aggregate::AVG, 30, Compare::GT, 200, 0 },
+        { "oom: oom > 0",
+          Metric::OOM, Aggregate::LATEST, 0, Compare::GT, 0, 0 },
+        { "  low mem :mem.available<512mb",
+          Metric::MEM_AVAILABLE, Aggregate::LATEST, 0, Compare::LT, 512 * 1024, 0 },
+        { "busy: cpu>=50%",
+          Metric::CPU, Aggregate::LATEST, 0, Compare::GE, 50, 0 },
+        { "hot: temp max over 1h >= 85.5 for 30",
+          Metric::TEMP, Aggregate::MAX, 3600, Compare::GE, 85.5, 30 },
+        { "idle: proc.cpu min over 10 <= 5% for 2min",
+          Metric::PROC_CPU, Aggregate::MIN, 10, Compare::LE, 5, 120 },
+        { "any: procs != 0",
+          Metric::PROCS, Aggregate::LATEST, 0, Compare::NE, 0, 0 },
+        { "exact: throttle == 3",
+          Metric::THROTTLE, Aggregate::LATEST, 0, Compare::EQ, 3, 0 },
+        { "swapping: swap rate over 1m > 10/s",
+          Metric::SWAP, Aggregate::RATE, 60, Compare::GT, 10, 0 },
+        { "scanning: scan.direct rate over 1h > 3600/h\r",
+          Metric::DIRECT_SCAN, Aggregate::RATE, 3600, Compare::GT, 1, 0 },
+        { "faults: proc.majflt avg over 1m > 1",
+          Metric::PROC_MAJFLT, Aggregate::AVG, 60, Compare::GT, 1, 0 },
+        { "big: proc.rss > 1.5g",
+          Metric::PROC_RSS, Aggregate::LATEST, 0, Compare::GT, 1.5 * 1024 * 1024, 0 },
+    };
+
+    struct ErrorCase {
+        const char* line;
+        const char* error;      // Expected in the message
+    };
+
+    const ErrorCase ERROR_CASES[] = {
+        { "cpu > 90", "expected 'name: condition'" },
+        { ": cpu > 90", "missing rule name" },
+        { "x: bogus > 1", "unknown metric 'bogus'" },
+        { "x:", "unknown metric ''" },
+        { "x: cpu p100 over 1m > 1", "bad percentile 'p100'" },
+        { "x: cpu p9x over 1m > 1", "bad percentile" },
+        { "x: proc.cpu p95 over 1m > 1", "only kept for host metrics" },
+        { "x: cpu avg > 1", "expected 'over <window>' after 'avg'" },
+        { "x: cpu avg over 0s > 1", "bad window '0s'" },
+        { "x: cpu avg over 5d > 1", "bad window '5d'" },
+        { "x: cpu avg over nan > 1", "bad window 'nan'" },
+        { "x: cpu 90", "expected a comparison, got '90'" },
+        { "x: cpu = 90", "expected a comparison, got '='" },
+        { "x: cpu >", "bad threshold ''" },
+        { "x: cpu > 1G", "bad threshold '1G'" },
+        { "x: cpu > nan", "bad threshold 'nan'" },
+        { "x: procs > 5%", "bad threshold '5%'" },
+        { "x: mem.available < 1Q", "bad threshold '1Q'" },
+        { "x: mem.available < 1\xe9", "bad threshold" },     // Non-ASCII unit
+        { "x: mem.available < 1\xc3\xa9", "bad threshold" },
+        { "x: cpu > 1/min", "bad threshold '1/min'" },
+        { "x: majflt rate over 1m > 1/d", "bad threshold '1/d'" },
+        { "x: cpu > 1 for", "bad duration ''" },
+        { "x: cpu > 1 for -5s", "bad duration '-5s'" },
+        { "x: cpu > 1 whenever", "unexpected 'whenever'" },
+        { "x: cpu > 1 for 1m again", "unexpected 'again'" },
+    };
+
+    // A host rule fed one value a second from t = 0
+    struct HostCase {
+        const char* line;
+        std::vector<double> values;
+        int fires;              // Tick of the FIRING event, -1 for none
+        int resolves;           // Tick of the RESOLVED event, -1 for none
+    };
+
+    const HostCase HOST_CASES[] = {
+        { "a: cpu > 50", { 10, 60, 60, 10 }, 1, 3 },
+        { "a: cpu >= 60", { 10, 60, 60, 10 }, 1, 3 },
+        { "a: cpu < 50", { 60, 60, 60 }, -1, -1 },
+        // Pending for the `for` duration, and a gap restarts it
+        { "a: cpu > 50 for 2", { 10, 60, 60, 60, 10 }, 3, 4 },
+        { "a: cpu > 50 for 2", { 60, 60, 10, 60, 60, 60 }, 5, -1 },
+        { "a: cpu > 50 for 2", { 60, 60, 10, 60, 60 }, -1, -1 },
+        // Windowed rules stay quiet until the window has filled
+        { "a: cpu avg over 3 > 50", { 100, 100, 100, 0, 0, 0 }, 3, 4 },
+        { "a: cpu max over 3 > 50", { 0, 0, 100, 0, 0, 0, 0 }, 3, 5 },
+        { "a: cpu max over 3 > 50", { 100, 0, 0, 0, 0 }, -1, -1 },
+        { "a: cpu min over 3 < 10", { 50, 50, 50, 5, 5, 5, 50, 50, 50 }, 3, 8 },
+        { "a: cpu p50 over 3 > 50", { 100, 0, 100, 0, 100, 100, 0, 0, 0 }, 4, 7 },
+        { "a: procs rate over 2 > 5", { 0, 10, 20, 30, 30, 30 }, 2, 4 },
+        { "a: procs rate over 2 > 5/min", { 0, 0, 1, 1, 1 }, 2, 3 },
+        { "a: majflt avg over 2 > 5 for 1", { 10, 10, 10, 10, 0, 0 }, 3, 4 },
+    };
+
+    void setHost(Metric metric, double value, SystemMetrics& metrics) {
+        switch (metric) {
+            case Metric::CPU: metrics.cpu_usage = value; break;
+            case Metric::PROCS: metrics.process_count = static_cast<int>(value); break;
+            case Metric::MAJFLT: metrics.paging.major_faults = value; break;
+            default: break;
+        }
+    }
+
+    std::string describe(const char* line, const char* what, int tick) {
+        std::ostringstream message;
+        message << "\"" << line << "\": " << what << " at tick " << tick;
+        return message.str();
+    }
+
+    // Scans a hand-built process list into `table`, one second apart
+    struct ScriptedTable {
+        ProcessTable table;
+        SystemMetrics metrics;
+
+        void scan(const std::vector<Platform::ProcessSample>& samples) {
+            table.beginScan(100, 1, 1.0);
+            for (const Platform::ProcessSample& sample : samples) table.visit(sample);
+            table.endScan();
+            metrics.process_table = &table;
+            metrics.delta = &table.getDelta();
+        }
+    };
+
+    Platform::ProcessSample sample(int pid, const char* name, long rss_kb) {
+        Platform::ProcessSample value;
+        value.pid = pid;
+        value.ppid = 1;
+        value.name = name;
+        value.name_len = std::strlen(name);
+        value.memory_kb = rss_kb;
+        value.priority = 20;
+        value.cpu_ticks = 0;
+        value.major_faults = 0;
+        return value;
+    }
+}
+
+TEST(rule_table) {
+    for (const RuleCase& entry : RULE_CASES) {
+        AlertEngine engine;
+        std::string error;
+        if (!engine.compile(entry.line, error)) {
+            test::fail(__FILE__, __LINE__, std::string("compile(\"") + entry.line + "\"): " + error);
+            continue;
+        }
+        REQUIRE(engine.getRules().size() == 1);
+        const AlertEngine::Rule& rule = engine.getRules()[0];
+        if (rule.metric != entry.metric || rule.aggregate != entry.aggregate ||
+            rule.compare != entry.compare) {
+            test::fail(__FILE__, __LINE__, std::string("compile(\"") + entry.line + "\"): wrong rule shape");
+        }
+        CHECK_NEAR(rule.window_sec, entry.window_sec, 1e-9);
+        CHECK_NEAR(rule.threshold, entry.threshold, 1e-9);
+        CHECK_NEAR(rule.for_sec, entry.for_sec, 1e-9);
+    }
+
+    AlertEngine engine;
+    std::string error;
+    REQUIRE(engine.compile("  low mem :  mem.available<512mb  ", error));
+    CHECK_EQ(engine.getRules()[0].name, std::string("low mem"));
+    CHECK_EQ(engine.getRules()[0].text, std::string("mem.available<512mb"));
+    REQUIRE(engine.compile("x: cpu p99.9 over 1m > 1", error));
+    CHECK_NEAR(engine.getRules()[0].quantile, 0.999, 1e-12);
+}
+
+TEST(error_table) {
+    for (const ErrorCase& entry : ERROR_CASES) {
+        AlertEngine engine;
+        std::string error;
+        if (engine.compile(entry.line, error)) {
+            test::fail(__FILE__, __LINE__, std::string("compile(\"") + entry.line + "\"): got valid");
+            continue;
+        }
+        if (error.compare(0, 8, "line 1: ") != 0 || error.find(entry.error) == std::string::npos) {
+            std::ostringstream message;
+            message << "compile(\"" << entry.line << "\"): error \"" << error << "\" lacks \""
+                    << entry.error << "\"";
+            test::fail(__FILE__, __LINE__, message.str());
+        }
+        CHECK(engine.empty());
+    }
+}
+
+TEST(compile_document) {
+    AlertEngine engine;
+    std::string error;
+    const char* rules =
+        "# host\n"
+        "\n"
+        "cpu_hot: cpu p95 over 5m > 90 for 1m\n"
+        "   # indented comment\n"
+        "leak: proc.rss rate over 1m > 100M/min\n";
+    REQUIRE(engine.compile(rules, error));
+    CHECK_EQ(engine.getRules().size(), static_cast<size_t>(2));
+    CHECK_EQ(engine.getSource(), std::string(rules));
+
+    // Errors name the line and leave the rules alone
+    CHECK(!engine.compile("a: cpu > 1\n\nb: cpu >< 1\n", error));
+    CHECK_EQ(error, std::string("line 3: expected a comparison, got '><'"));
+    CHECK(!engine.compile("a: cpu > 1\n# x\na: mem > 1\n", error));
+    CHECK_EQ(error, std::string("line 3: duplicate rule 'a'"));
+    CHECK_EQ(engine.getRules().size(), static_cast<size_t>(2));
+    CHECK_EQ(engine.getRules()[1].name, std::string("leak"));
+
+    REQUIRE(engine.compile("# nothing\n", error));
+    CHECK(engine.empty());
+}
+
+TEST(host_windows) {
+    for (const HostCase& entry : HOST_CASES) {
+        AlertEngine engine;
+        std::string error;
+        if (!engine.compile(entry.line, error)) {
+            test::fail(__FILE__, __LINE__, std::string(entry.line) + ": " + error);
+            continue;
+        }
+        Metric metric = engine.getRules()[0].metric;
+
+        int fired = -1;
+        int resolved = -1;
+        for (size_t tick = 0; tick < entry.values.size(); tick++) {
+            SystemMetrics metrics;
+            setHost(metric, entry.values[tick], metrics);
+            std::vector<AlertEvent> events;
+            engine.evaluate(metrics, static_cast<double>(tick), 1000 + tick, events);
+            for (const AlertEvent& event : events) {
+                int& seen = event.state == AlertEvent::State::FIRING ? fired : resolved;
+                if (seen >= 0) test::fail(__FILE__, __LINE__, describe(entry.line, "repeated event", tick));
+                seen = static_cast<int>(tick);
+                CHECK_EQ(event.rule, std::string("a"));
+                CHECK_EQ(event.pid, 0);
+                CHECK_EQ(event.timestamp_ms, static_cast<int64_t>(1000 + tick));
+            }
+            bool firing = fired >= 0 && resolved < 0;
+            if (engine.getFiring().size() != (firing ? 1u : 0u)) {
+                test::fail(__FILE__, __LINE__, describe(entry.line, "getFiring() out of step", tick));
+            }
+        }
+        if (fired != entry.fires) {
+            test::fail(__FILE__, __LINE__, describe(entry.line, "fired", fired) + ", expected " +
+                       std::to_string(entry.fires));
+        }
+        if (resolved != entry.resolves) {
+            test::fail(__FILE__, __LINE__, describe(entry.line, "resolved", resolved) + ", expected " +
+                       std::to_string(entry.resolves));
+        }
+    }
+}
+
+TEST(event_fields) {
+    AlertEngine engine;
+    std::string error;
+    REQUIRE(engine.compile("hot: cpu avg over 2 > 50 for 1", error));
+
+    std::vector<AlertEvent> events;
+    const double values[] = { 80, 80, 80, 80, 80, 80, 80, 0, 0, 0 };
+    for (int tick = 0; tick < 10; tick++) {
+        SystemMetrics metrics;
+        metrics.cpu_usage = values[tick];
+        engine.evaluate(metrics, tick * 0.5, tick, events);
+    }
+    // Filled at 2 s and pending for a second; resolves once the zeros pull
+    // the average under
+    REQUIRE(events.size() == 2);
+    const AlertEvent& fired = events[0];
+    CHECK(fired.state == AlertEvent::State::FIRING);
+    CHECK_EQ(fired.rule, std::string("hot"));
+    CHECK_EQ(fired.expression, std::string("cpu avg over 2 > 50 for 1"));
+    CHECK_EQ(fired.value, 80.0);
+    CHECK_EQ(fired.threshold, 50.0);
+    CHECK_EQ(fired.active_sec, 1.0);
+    CHECK_EQ(fired.timestamp_ms, static_cast<int64_t>(6));
+    const AlertEvent& resolved = events[1];
+    CHECK(resolved.state == AlertEvent::State::RESOLVED);
+    CHECK_EQ(resolved.value, 40.0);
+    CHECK_EQ(resolved.active_sec, 2.0);
+    CHECK_EQ(resolved.timestamp_ms, static_cast<int64_t>(8));
+}
+
+TEST(process_windows) {
+    AlertEngine engine;
+    std::string error;
+    REQUIRE(engine.compile("leak: proc.rss rate over 6 > 1M/min\nbig: proc.rss > 40M", error));
+    ScriptedTable scripted;
+    std::vector<Platform::ProcessSample> samples;
+
+    // One process grows 1 MB a second, one holds still; the rate needs
+    // all six panes
+    std::vector<AlertEvent> events;
+    int leak_fired = -1;
+    int big_fired = -1;
+    for (int tick = 0; tick < 10; tick++) {
+        samples.clear();
+        samples.push_back(sample(100, "leaky", 1024L * (10 + tick)));
+        samples.push_back(sample(200, "steady", 50 * 1024));
+        scripted.scan(samples);
+        events.clear();
+        engine.evaluate(scripted.metrics, tick, tick, events);
+        for (const AlertEvent& event : events) {
+            CHECK(event.state == AlertEvent::State::FIRING);
+            if (event.rule == "leak") {
+                CHECK_EQ(event.pid, 100);
+                CHECK_EQ(event.process, std::string("leaky"));
+                CHECK_NEAR(event.value, 1024.0, 1e-9);
+                if (leak_fired < 0) leak_fired = tick;
+            } else {
+                CHECK_EQ(event.pid, 200);
+                CHECK_EQ(event.process, std::string("steady"));
+                if (big_fired < 0) big_fired = tick;
+            }
+        }
+    }
+    CHECK_EQ(leak_fired, 6);
+    CHECK_EQ(big_fired, 0);
+    REQUIRE(engine.getFiring().size() == 2);
+    CHECK_EQ(engine.getFiring()[0].rule, std::string("leak"));
+    CHECK_EQ(engine.getFiring()[1].pid, 200);
+    CHECK_EQ(engine.getTrackedWindows(), static_cast<size_t>(2));
+
+    // An exit resolves and drops the window
+    samples.erase(samples.begin());
+    scripted.scan(samples);
+    events.clear();
+    engine.evaluate(scripted.metrics, 10, 10, events);
+    REQUIRE(events.size() == 1);
+    CHECK_EQ(events[0].rule, std::string("leak"));
+    CHECK(events[0].state == AlertEvent::State::RESOLVED);
+    CHECK_EQ(events[0].pid, 100);
+    CHECK_EQ(events[0].process, std::string("leaky"));
+    CHECK_EQ(engine.getTrackedWindows(), static_cast<size_t>(1));
+
+    // A missed tick may hide a reused PID: per-process alerts resolve and
+    // start over
+    scripted.scan(samples);
+    scripted.scan(samples);
+    events.clear();
+    engine.evaluate(scripted.metrics, 12, 12, events);
+    REQUIRE(events.size() == 2);
+    CHECK(events[0].state == AlertEvent::State::RESOLVED);
+    CHECK(events[1].state == AlertEvent::State::FIRING);
+    CHECK_EQ(events[1].pid, 200);
+    CHECK_EQ(events[1].active_sec, 0.0);
+}
+
+TEST(recompile_forgets_state) {
+    AlertEngine engine;
+    std::string error;
+    REQUIRE(engine.compile("a: cpu avg over 2 > 50", error));
+    std::vector<AlertEvent> events;
+    for (int tick = 0; tick < 4; tick++) {
+        SystemMetrics metrics;
+        metrics.cpu_usage = 90;
+        engine.evaluate(metrics, tick, tick, events);
+    }
+    CHECK_EQ(events.size(), static_cast<size_t>(1));
+    CHECK_EQ(engine.getFiring().size(), static_cast<size_t>(1));
+
+    REQUIRE(engine.compile("a: cpu avg over 2 > 50", error));
+    CHECK(engine.getFiring().empty());
+    events.clear();
+    SystemMetrics metrics;
+    metrics.cpu_usage = 90;
+    engine.evaluate(metrics, 4, 4, events);
+    engine.evaluate(metrics, 5, 5, events);
+    CHECK(events.empty());
+    engine.evaluate(metrics, 6, 6, events);
+    CHECK_EQ(events.size(), static_cast<size_t>(1));
+}
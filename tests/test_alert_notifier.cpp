@@ -0,0 +1,87 @@
+#include "TestHarness.h"
+#include "alert/AlertNotifier.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    std::vector<AlertEvent> events(int count) {
+        std::vector<AlertEvent> batch(count);
+        for (int i = 0; i < count; i++) {
+            batch[i].rule = "test";
+            batch[i].expression = std::string(2000, 'x');
+            batch[i].pid = i + 1;
+        }
+        return batch;
+    }
+
+    bool settle(const AlertNotifier& notifier, unsigned long long count, double limit_sec) {
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(static_cast<long long>(limit_sec * 1000.0));
+        while (notifier.getDelivered() + notifier.getFailed() < count) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+
+    bool exists(const std::string& path) {
+        return access(path.c_str(), F_OK) == 0;
+    }
+
+    double since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TEST(hook_that_ignores_stdin) {
+    // Most of these exit before the event is written; that must neither
+    // raise SIGPIPE nor count as a failure
+    AlertNotifier notifier("exit 0", "");
+    notifier.post(events(40));
+    REQUIRE(settle(notifier, 40, 20.0));
+    CHECK_EQ(notifier.getDelivered(), 40ull);
+    CHECK_EQ(notifier.getFailed(), 0ull);
+}
+
+TEST(hook_sees_event) {
+    std::string marker = "test_alert_notifier-" + std::to_string(getpid()) + ".seen";
+    AlertNotifier notifier("read line && [ \"$SYSMON_ALERT_PID\" = 1 ] && echo noise && "
+                           "echo noise >&2 && : > " + marker, "");
+    notifier.post(events(1));
+    REQUIRE(settle(notifier, 1, 10.0));
+    CHECK_EQ(notifier.getDelivered(), 1ull);
+    CHECK(exists(marker));
+    std::remove(marker.c_str());
+}
+
+TEST(timeout_kills_process_group) {
+    std::string marker = "test_alert_notifier-" + std::to_string(getpid()) + ".late";
+    {
+        // The shell waits on a child; killing only the shell leaves it
+        AlertNotifier notifier("(sleep 1; : > " + marker + ") ; wait", "", 0.2);
+        notifier.post(events(1));
+        REQUIRE(settle(notifier, 1, 10.0));
+        CHECK_EQ(notifier.getFailed(), 1ull);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    CHECK(!exists(marker));
+    std::remove(marker.c_str());
+}
+
+TEST(destructor_does_not_wait_for_hook) {
+    std::string marker = "test_alert_notifier-" + std::to_string(getpid()) + ".stopped";
+    auto start = std::chrono::steady_clock::now();
+    {
+        AlertNotifier notifier("sleep 2; : > " + marker, "", 10.0);
+        notifier.post(events(3));
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    CHECK(since(start) < 1.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+    CHECK(!exists(marker));
+    std::remove(marker.c_str());
+}
@@ -0,0 +1,167 @@
+#include "TestHarness.h"
+#include "monitor/CompressedSeries.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+    uint64_t bitsOf(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    std::vector<CompressedSeries::Sample> decodeAll(const CompressedSeries& series) {
+        std::vector<CompressedSeries::Sample> out;
+        for (size_t block = 0; block < series.getBlockCount(); block++) series.decodeBlock(block, out);
+        return out;
+    }
+
+    // Lossless series must give back every timestamp and every value bit
+    void checkRoundTrip(const std::vector<CompressedSeries::Sample>& input) {
+        CompressedSeries series;
+        for (const auto& sample : input) series.append(sample.timestamp_ms, sample.value);
+        CHECK_EQ(series.size(), input.size());
+        
+        std::vector<CompressedSeries::Sample> output = decodeAll(series);
+        REQUIRE(output.size() == input.size());
+        for (size_t i = 0; i < input.size(); i++) {
+            CHECK_EQ(output[i].timestamp_ms, input[i].timestamp_ms);
+            CHECK_EQ(bitsOf(output[i].value), bitsOf(input[i].value));
+        }
+    }
+}
+
+TEST(special_values_round_trip_bit_exact) {
+    const double values[] = {
+        0.0, -0.0, 1.0, -1.0,
+        std::numeric_limits<double>::quiet_NaN(),
+        -std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::lowest(),
+        std::numeric_limits<double>::min(),
+        std::numeric_limits<double>::denorm_min(),
+        -std::numeric_limits<double>::denorm_min(),
+        std::numeric_limits<double>::epsilon(),
+        1.0, 1.0, 1.0,
+        0.1, 0.2, 0.30000000000000004
+    };
+    std::vector<CompressedSeries::Sample> input;
+    int64_t timestamp = 1700000000000LL;
+    for (double value : values) {
+        input.push_back({ timestamp, value });
+        timestamp += 1000;
+    }
+    checkRoundTrip(input);
+}
+
+TEST(timestamp_deltas_hit_every_bucket_and_the_escape) {
+    // Delta-of-delta 0, then each bucket's edges, then beyond 12 bits
+    const int64_t dods[] = { 0, 0, 7, -8, 8, -9, 255, -256, 256, -257, 2047, -2048, 2048, -2049,
+                             1LL << 40, -(1LL << 40), 3, 0, -3 };
+    std::vector<CompressedSeries::Sample> input;
+    int64_t timestamp = 0;
+    int64_t delta = 1000;
+    input.push_back({ timestamp, 1.0 });
+    for (int64_t dod : dods) {
+        delta += dod;
+        timestamp += delta;
+        input.push_back({ timestamp, 1.0 });
+    }
+    checkRoundTrip(input);
+}
+
+TEST(extreme_and_unordered_timestamps_round_trip) {
+    std::vector<CompressedSeries::Sample> input;
+    input.push_back({ std::numeric_limits<int64_t>::min(), 1.0 });
+    input.push_back({ std::numeric_limits<int64_t>::max(), 2.0 });
+    input.push_back({ 0, 3.0 });
+    input.push_back({ -1, 4.0 });
+    input.push_back({ std::numeric_limits<int64_t>::min(), 5.0 });
+    input.push_back({ std::numeric_limits<int64_t>::min() + 1, 6.0 });
+    input.push_back({ 5, 7.0 });
+    input.push_back({ 5, 7.0 });
+    checkRoundTrip(input);
+}
+
+TEST(random_series_round_trip_across_blocks) {
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int> jitter(-5, 5);
+    std::uniform_real_distribution<double> noise(-1.0, 1.0);
+    std::vector<CompressedSeries::Sample> input;
+    int64_t timestamp = 1700000000000LL;
+    double value = 50.0;
+    for (size_t i = 0; i < CompressedSeries::BLOCK_SAMPLES * 3 + 17; i++) {
+        timestamp += 1000 + jitter(rng);
+        // Mix of unchanged values, small drifts and raw 64-bit noise
+        if (i % 5 == 1) value += noise(rng);
+        if (i % 97 == 0) {
+            uint64_t bits = rng();
+            std::memcpy(&value, &bits, sizeof(value));
+        }
+        input.push_back({ timestamp, value });
+    }
+    checkRoundTrip(input);
+}
+
+TEST(grid_series_keep_values_within_half_a_step) {
+    CompressedSeries series(0, 0.01);
+    std::vector<double> input;
+    for (int i = 0; i < 3000; i++) {
+        double value = 100.0 * ((i * 7919) % 10007) / 10007.0;
+        input.push_back(value);
+        series.append(i * 1000, value);
+    }
+    std::vector<CompressedSeries::Sample> output = decodeAll(series);
+    REQUIRE(output.size() == input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        CHECK_EQ(output[i].timestamp_ms, static_cast<int64_t>(i) * 1000);
+        CHECK_NEAR(output[i].value, input[i], 0.005 + 1e-9);
+    }
+    
+    CompressedSeries special(0, 0.01);
+    special.append(0, std::numeric_limits<double>::infinity());
+    special.append(1, std::numeric_limits<double>::quiet_NaN());
+    special.append(2, -0.004);
+    output = decodeAll(special);
+    REQUIRE(output.size() == 3u);
+    CHECK(output[0].value == std::numeric_limits<double>::infinity());
+    CHECK(std::isnan(output[1].value));
+    CHECK_EQ(output[2].value, 0.0);
+}
+
+TEST(retention_drops_whole_blocks_and_tail_spans_them) {
+    const size_t keep = CompressedSeries::BLOCK_SAMPLES + 10;
+    CompressedSeries series(keep);
+    const size_t appended = CompressedSeries::BLOCK_SAMPLES * 4 + 3;
+    for (size_t i = 0; i < appended; i++) series.append(static_cast<int64_t>(i), static_cast<double>(i));
+    
+    CHECK(series.size() >= keep);
+    CHECK(series.size() < keep + CompressedSeries::BLOCK_SAMPLES);
+    std::vector<CompressedSeries::Sample> all = decodeAll(series);
+    REQUIRE(all.size() == series.size());
+    CHECK_EQ(all.back().value, static_cast<double>(appended - 1));
+    CHECK_EQ(all.front().value, static_cast<double>(appended - series.size()));
+    
+    // Crosses a block boundary
+    std::vector<double> tail;
+    series.tail(20, tail);
+    REQUIRE(tail.size() == 20u);
+    for (size_t i = 0; i < tail.size(); i++) CHECK_EQ(tail[i], static_cast<double>(appended - 20 + i));
+    
+    tail.clear();
+    series.tail(series.size() + 100, tail);
+    CHECK_EQ(tail.size(), series.size());
+    
+    series.clear();
+    CHECK(series.empty());
+    series.append(1, -2.5);
+    tail.clear();
+    series.tail(5, tail);
+    REQUIRE(tail.size() == 1u);
+    CHECK_EQ(tail[0], -2.5);
+}
@@ -0,0 +1,42 @@
+#include "TestHarness.h"
+#include "utils/Instrumentation.h"
+#include <thread>
+#include <vector>
+
+using Instrumentation::Stage;
+
+TEST(concurrent_records_are_all_counted) {
+    if (!Instrumentation::enabled()) return;
+    Instrumentation::reset();
+    
+    const int THREADS = 4;
+    const int CALLS = 20000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.push_back(std::thread([t]() {
+            for (int i = 0; i < CALLS; i++) {
+                Instrumentation::record(Stage::EXPORT, 1000 + t, 2, 1);
+            }
+        }));
+    }
+    for (std::thread& thread : threads) thread.join();
+    
+    Instrumentation::StageSummary summary;
+    Instrumentation::summarize(Stage::EXPORT, summary);
+    CHECK_EQ(summary.calls, static_cast<unsigned long long>(THREADS * CALLS));
+    CHECK_NEAR(summary.syscalls_per_call, 2.0, 1e-9);
+    CHECK_NEAR(summary.allocs_per_call, 1.0, 1e-9);
+    CHECK(summary.max_us >= summary.mean_us);
+    CHECK(summary.p99_us <= summary.max_us);
+}
+
+TEST(reset_clears_every_stage) {
+    if (!Instrumentation::enabled()) return;
+    Instrumentation::record(Stage::RENDER, 500, 1, 1);
+    Instrumentation::reset();
+    Instrumentation::StageSummary summary;
+    for (int i = 0; i < static_cast<int>(Stage::COUNT); i++) {
+        Instrumentation::summarize(static_cast<Stage>(i), summary);
+        CHECK_EQ(summary.calls, 0ull);
+    }
+}
@@ -0,0 +1,243 @@
+#include "TestHarness.h"
+#include "ProcfsFixture.h"
+#include "platform/Platform.h"
+#include "sysmonitor/Monitor.h"
+#include "sysmonitor/sysmonitor.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    const int PROCESSES = 300;
+    const int TICKS = 40;
+
+    // Points the collectors at a synthetic tree for the life of a case
+    struct FixtureScope {
+        ProcfsFixture fixture;
+
+        FixtureScope()
+            : fixture("test_monitor_api-" + std::to_string(getpid()), PROCESSES) {
+            REQUIRE(fixture.generate());
+            Platform::setProcRoot(fixture.getRoot());
+        }
+
+        ~FixtureScope() {
+            Platform::setProcRoot("");
+        }
+    };
+
+    // What one tick looked like, checked on the main thread afterwards
+    struct TickResult {
+        size_t rows;
+        size_t unique_pids;
+        bool names_valid;
+    };
+
+    TickResult inspect(const sysmonitor::Snapshot& snapshot) {
+        TickResult result;
+        result.rows = snapshot.size();
+        std::vector<int> pids(snapshot.pids(), snapshot.pids() + snapshot.size());
+        std::sort(pids.begin(), pids.end());
+        result.unique_pids = static_cast<size_t>(std::unique(pids.begin(), pids.end()) - pids.begin());
+        result.names_valid = true;
+        for (size_t row = 0; row < snapshot.size(); row++) {
+            size_t length = 0;
+            const char* name = snapshot.name(row, &length);
+            if (!name || length == 0 || length > 15) result.names_valid = false;
+        }
+        return result;
+    }
+
+    void tickRepeatedly(const sysmonitor::Monitor::Options& options, std::vector<TickResult>& results) {
+        sysmonitor::Monitor monitor(options);
+        for (int i = 0; i < TICKS; i++) {
+            results.push_back(inspect(monitor.tick()));
+        }
+    }
+
+    void checkResults(const std::vector<TickResult>& results) {
+        CHECK_EQ(results.size(), static_cast<size_t>(TICKS));
+        for (const TickResult& result : results) {
+            CHECK_EQ(result.rows, static_cast<size_t>(PROCESSES));
+            CHECK_EQ(result.unique_pids, static_cast<size_t>(PROCESSES));
+            CHECK(result.names_valid);
+        }
+    }
+}
+
+TEST(two_monitors_tick_concurrently) {
+    FixtureScope scope;
+    std::vector<TickResult> first, second;
+    sysmonitor::Monitor::Options held;
+    held.hold_process_files = true;
+
+    std::thread a(tickRepeatedly, sysmonitor::Monitor::Options(), std::ref(first));
+    std::thread b(tickRepeatedly, held, std::ref(second));
+    a.join();
+    b.join();
+
+    checkResults(first);
+    checkResults(second);
+}
+
+TEST(background_and_foreground_monitors) {
+    FixtureScope scope;
+    sysmonitor::Monitor background;
+    std::vector<TickResult> background_results;
+    std::mutex results_lock;
+    background.addCallback([&](const sysmonitor::Snapshot& snapshot) {
+        std::lock_guard<std::mutex> guard(results_lock);
+        background_results.push_back(inspect(snapshot));
+    });
+    REQUIRE(background.start(1));
+
+    std::vector<TickResult> foreground;
+    tickRepeatedly(sysmonitor::Monitor::Options(), foreground);
+    background.stop();
+
+    checkResults(foreground);
+    std::lock_guard<std::mutex> guard(results_lock);
+    CHECK(!background_results.empty());
+    for (const TickResult& result : background_results) {
+        CHECK_EQ(result.rows, static_cast<size_t>(PROCESSES));
+        CHECK_EQ(result.unique_pids, static_cast<size_t>(PROCESSES));
+    }
+}
+
+TEST(filter_applies_from_next_tick) {
+    FixtureScope scope;
+    sysmonitor::Monitor monitor;
+    std::string error;
+    CHECK(!monitor.setFilter("rss >> 1", &error));
+    CHECK(!error.empty());
+
+    // An expression that matches nothing in the fixture
+    REQUIRE(monitor.setFilter("name==no-such-process", &error));
+    const sysmonitor::Snapshot& filtered = monitor.tick();
+    CHECK_EQ(filtered.size(), static_cast<size_t>(0));
+    CHECK_EQ(filtered.system().filtered_count, static_cast<size_t>(PROCESSES));
+
+    REQUIRE(monitor.setFilter("", &error));
+    const sysmonitor::Snapshot& cleared = monitor.tick();
+    CHECK_EQ(cleared.size(), static_cast<size_t>(PROCESSES));
+    CHECK_EQ(cleared.system().filtered_count, static_cast<size_t>(0));
+}
+
+TEST(c_api_host_sample) {
+    FixtureScope scope;
+    sysmon_monitor* monitor = sysmon_create(nullptr);
+    REQUIRE(monitor != nullptr);
+    CHECK_EQ(sysmon_set_filter(monitor, "rss >> 1"), -1);
+    const sysmon_snapshot* snapshot = sysmon_tick(monitor);
+    REQUIRE(snapshot != nullptr);
+
+    sysmon_host host;
+    sysmon_host_info(snapshot, &host);
+    CHECK(host.interval_ms >= 0.0);
+    CHECK_EQ(host.filtered_count, static_cast<size_t>(0));
+    CHECK(host.paging_available != 0);
+    CHECK_EQ(sysmon_process_count(snapshot), static_cast<size_t>(PROCESSES));
+    CHECK(sysmon_major_fault_rate(snapshot) != nullptr);
+    sysmon_destroy(monitor);
+}
+
+namespace {
+    // What a callback managed to do through its own Monitor
+    struct Reentry {
+        std::mutex lock;
+        int ticks;
+        size_t history;
+        size_t read_rows;
+        bool filter_set;
+
+        Reentry() : ticks(0), history(0), read_rows(0), filter_set(false) {}
+    };
+
+    void reenter(sysmonitor::Monitor& monitor, Reentry& seen) {
+        std::vector<double> samples;
+        size_t history = monitor.history(sysmonitor::Series::CPU, 10, samples);
+        size_t rows = 0;
+        monitor.read([&rows](const sysmonitor::Snapshot& snapshot) { rows = snapshot.size(); });
+        bool filter_set = monitor.setFilter("");
+
+        std::lock_guard<std::mutex> guard(seen.lock);
+        seen.ticks++;
+        seen.history = history;
+        seen.read_rows = rows;
+        seen.filter_set = filter_set;
+    }
+
+    void tickInCallback(const sysmon_snapshot*, void* user) {
+        sysmon_monitor* monitor = static_cast<sysmon_monitor*>(user);
+        double samples[10];
+        sysmon_history(monitor, SYSMON_SERIES_CPU, samples, 10);
+        sysmon_read(monitor, [](const sysmon_snapshot*, void*) {}, nullptr);
+        sysmon_set_filter(monitor, "");
+    }
+}
+
+TEST(callbacks_call_back_into_monitor) {
+    FixtureScope scope;
+    sysmonitor::Monitor monitor;
+    Reentry seen;
+    monitor.addCallback([&](const sysmonitor::Snapshot&) { reenter(monitor, seen); });
+    for (int i = 0; i < 3; i++) monitor.tick();
+    CHECK_EQ(seen.ticks, 3);
+    CHECK(seen.history >= 3);
+    CHECK_EQ(seen.read_rows, static_cast<size_t>(PROCESSES));
+    CHECK(seen.filter_set);
+}
+
+TEST(background_callbacks_call_back_into_monitor) {
+    FixtureScope scope;
+    sysmonitor::Monitor monitor;
+    Reentry seen;
+    monitor.addCallback([&](const sysmonitor::Snapshot&) { reenter(monitor, seen); });
+    REQUIRE(monitor.start(1));
+    for (int i = 0; i < 500; i++) {
+        {
+            std::lock_guard<std::mutex> guard(seen.lock);
+            if (seen.ticks >= 3) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    monitor.stop();
+
+    std::lock_guard<std::mutex> guard(seen.lock);
+    CHECK(seen.ticks >= 3);
+    CHECK(seen.history >= 3);
+    CHECK_EQ(seen.read_rows, static_cast<size_t>(PROCESSES));
+    CHECK(seen.filter_set);
+}
+
+TEST(c_api_callbacks_call_back_into_monitor) {
+    FixtureScope scope;
+    sysmon_monitor* monitor = sysmon_create(nullptr);
+    REQUIRE(monitor != nullptr);
+    REQUIRE(sysmon_add_callback(monitor, tickInCallback, monitor) > 0);
+    CHECK(sysmon_tick(monitor) != nullptr);
+    CHECK(sysmon_tick(monitor) != nullptr);
+    sysmon_destroy(monitor);
+}
+
+TEST(c_api_hold_process_files) {
+    FixtureScope scope;
+    sysmon_options options;
+    options.hold_process_files = 7;
+    sysmon_default_options(&options);
+    CHECK_EQ(options.hold_process_files, 0);
+
+    options.hold_process_files = 1;
+    sysmon_monitor* monitor = sysmon_create(&options);
+    REQUIRE(monitor != nullptr);
+    for (int i = 0; i < 3; i++) {
+        const sysmon_snapshot* snapshot = sysmon_tick(monitor);
+        REQUIRE(snapshot != nullptr);
+        CHECK_EQ(sysmon_process_count(snapshot), static_cast<size_t>(PROCESSES));
+    }
+    sysmon_destroy(monitor);
+}
@@ -0,0 +1,190 @@
+#include "TestHarness.h"
+#include "monitor/OverheadGovernor.h"
+#include "monitor/SystemMonitor.h"
+#include <string>
+#include <vector>
+
+namespace {
+    typedef OverheadGovernor::Level Level;
+
+    // CPU seconds one tick costs at each level
+    struct Load {
+        double full;
+        double top_k;
+        double detail;
+
+        double at(Level level) const {
+            return level == Level::FULL ? full : level == Level::TOP_K ? top_k : detail;
+        }
+    };
+
+    // Feeds the governor synthetic CPU time: each tick costs what the load
+    // says for the current level, and the clock moves by the interval the
+    // governor asked for
+    struct Driver {
+        SystemMonitor monitor;
+        OverheadGovernor governor;
+        double cpu_sec;
+        double now_sec;
+        std::vector<Level> levels;      // After each tick
+        int changes;
+
+        Driver(double budget_percent, double interval_sec, double max_stretch = 16.0)
+            : governor(budget_percent, interval_sec, max_stretch), cpu_sec(1.0), now_sec(100.0),
+              changes(0) {
+            governor.update(monitor, cpu_sec, now_sec);
+        }
+
+        void run(const Load& load, int ticks) {
+            for (int i = 0; i < ticks; i++) {
+                cpu_sec += load.at(governor.getLevel());
+                now_sec += governor.getInterval();
+                if (governor.update(monitor, cpu_sec, now_sec)) changes++;
+                levels.push_back(governor.getLevel());
+            }
+        }
+
+        // How often the level moved over the last `ticks` ticks
+        int levelChangesIn(int ticks) const {
+            int moved = 0;
+            for (size_t i = levels.size() - ticks + 1; i < levels.size(); i++) {
+                if (levels[i] != levels[i - 1]) moved++;
+            }
+            return moved;
+        }
+    };
+}
+
+TEST(under_budget_stays_full) {
+    Driver driver(5.0, 1.0);
+    const size_t full_top_k = driver.monitor.getMemoryAccounting().getTopK();
+    driver.run(Load{ 0.02, 0.01, 0.005 }, 100);
+    CHECK(driver.governor.getLevel() == Level::FULL);
+    CHECK_EQ(driver.governor.getInterval(), 1.0);
+    CHECK_EQ(driver.changes, 0);
+    CHECK(!driver.governor.isDegraded());
+    CHECK(!driver.governor.isOverBudget());
+    CHECK_NEAR(driver.governor.getUsagePercent(), 2.0, 1e-6);
+    CHECK_EQ(driver.governor.describe(), std::string("full fidelity"));
+    CHECK_EQ(driver.monitor.getMemoryAccounting().getTopK(), full_top_k);
+}
+
+TEST(sheds_one_step_at_a_time) {
+    Driver driver(5.0, 1.0);
+    driver.run(Load{ 0.08, 0.06, 0.04 }, 2);
+    CHECK(driver.governor.getLevel() == Level::FULL);
+
+    // Each step waits for the cost to settle before the next
+    driver.run(Load{ 0.08, 0.06, 0.04 }, 1);
+    CHECK(driver.governor.getLevel() == Level::TOP_K);
+    CHECK_EQ(driver.monitor.getMemoryAccounting().getTopK(), static_cast<size_t>(3));
+    CHECK_EQ(driver.monitor.getMemoryAccounting().getReadsPerTick(), static_cast<size_t>(1));
+    CHECK(!driver.monitor.getDetailSuspended());
+    driver.run(Load{ 0.08, 0.06, 0.04 }, 2);
+    CHECK(driver.governor.getLevel() == Level::TOP_K);
+    driver.run(Load{ 0.08, 0.06, 0.04 }, 1);
+    CHECK(driver.governor.getLevel() == Level::DETAIL);
+    CHECK(driver.monitor.getDetailSuspended());
+
+    // Under budget at DETAIL: no stretching, and nothing to restore
+    driver.run(Load{ 0.08, 0.06, 0.04 }, 100);
+    CHECK(driver.governor.getLevel() == Level::DETAIL);
+    CHECK_EQ(driver.governor.getInterval(), 1.0);
+    CHECK_EQ(driver.changes, 2);
+    CHECK(driver.governor.isDegraded());
+    CHECK(!driver.governor.isOverBudget());
+    CHECK_EQ(driver.governor.describe(), std::string("PSS accounting top-3, detail collectors paused"));
+}
+
+TEST(stretches_when_nothing_is_left_to_shed) {
+    Driver driver(5.0, 1.0);
+    driver.run(Load{ 0.2, 0.15, 0.1 }, 50);
+    CHECK(driver.governor.getLevel() == Level::DETAIL);
+    // 0.1 s a tick at 5% of a core
+    CHECK_NEAR(driver.governor.getInterval(), 2.0, 1e-6);
+    CHECK_NEAR(driver.governor.getUsagePercent(), 5.0, 0.01);
+    CHECK(!driver.governor.isOverBudget());
+    CHECK_EQ(driver.governor.describe(),
+             std::string("PSS accounting top-3, detail collectors paused, interval 2.0s"));
+
+    Driver capped(5.0, 1.0, 1.5);
+    capped.run(Load{ 0.2, 0.15, 0.1 }, 50);
+    CHECK_NEAR(capped.governor.getInterval(), 1.5, 1e-6);
+    CHECK(capped.governor.isOverBudget());
+}
+
+TEST(recovers_when_load_drops) {
+    Driver driver(5.0, 1.0);
+    const size_t full_top_k = driver.monitor.getMemoryAccounting().getTopK();
+    driver.run(Load{ 0.2, 0.15, 0.1 }, 50);
+    REQUIRE(driver.governor.getLevel() == Level::DETAIL);
+
+    // The host quietens: the interval comes back as soon as the smoothed
+    // cost fits, the levels one at a time after that
+    driver.run(Load{ 0.02, 0.015, 0.01 }, 3);
+    CHECK_EQ(driver.governor.getInterval(), 1.0);
+    CHECK(driver.governor.getLevel() == Level::DETAIL);
+    driver.run(Load{ 0.02, 0.015, 0.01 }, 100);
+    CHECK(driver.governor.getLevel() == Level::FULL);
+    CHECK(!driver.governor.isDegraded());
+    CHECK(!driver.monitor.getDetailSuspended());
+    CHECK_EQ(driver.monitor.getMemoryAccounting().getTopK(), full_top_k);
+    CHECK_EQ(driver.levelChangesIn(80), 0);
+}
+
+TEST(does_not_restore_a_level_it_would_shed) {
+    // FULL is over budget, TOP_K well under: the measured ratio (2x) says
+    // restoring FULL would not fit, so it stays at TOP_K
+    Driver driver(5.0, 1.0);
+    driver.run(Load{ 0.06, 0.03, 0.02 }, 200);
+    CHECK(driver.governor.getLevel() == Level::TOP_K);
+    CHECK_EQ(driver.changes, 1);
+
+    // Until the load really drops
+    driver.run(Load{ 0.03, 0.015, 0.01 }, 20);
+    CHECK(driver.governor.getLevel() == Level::FULL);
+    driver.run(Load{ 0.03, 0.015, 0.01 }, 100);
+    CHECK_EQ(driver.changes, 2);
+}
+
+TEST(ratio_measured_on_a_further_step_down) {
+    // TOP_K is still over budget when its ratio (1.5x) is measured, so
+    // DETAIL is taken on the same tick; its ratio (4x) comes three ticks on
+    Driver driver(5.0, 1.0);
+    driver.run(Load{ 0.12, 0.08, 0.02 }, 6);
+    REQUIRE(driver.governor.getLevel() == Level::DETAIL);
+    driver.run(Load{ 0.12, 0.08, 0.02 }, 50);
+    CHECK(driver.governor.getLevel() == Level::DETAIL);
+    CHECK_EQ(driver.changes, 2);
+
+    // At half the load TOP_K would cost 0.04, over the 0.035 recovery
+    // mark: stay
+    driver.run(Load{ 0.06, 0.04, 0.01 }, 50);
+    CHECK(driver.governor.getLevel() == Level::DETAIL);
+
+    // At a quarter, DETAIL's ratio allows TOP_K (0.02), and TOP_K's own
+    // (measured before DETAIL was taken) allows FULL (0.03)
+    driver.run(Load{ 0.03, 0.02, 0.005 }, 50);
+    CHECK(driver.governor.getLevel() == Level::FULL);
+    CHECK_EQ(driver.changes, 4);
+    CHECK_EQ(driver.levelChangesIn(30), 0);
+}
+
+TEST(clock_edge_cases) {
+    Driver driver(5.0, 1.0);
+    // A clock that stands still is not divided by, and the CPU time spent
+    // meanwhile counts towards the next tick
+    driver.run(Load{ 0.02, 0.01, 0.01 }, 5);
+    driver.cpu_sec += 1.0;
+    CHECK(!driver.governor.update(driver.monitor, driver.cpu_sec, driver.now_sec));
+    CHECK_NEAR(driver.governor.getUsagePercent(), 2.0, 1e-6);
+    driver.run(Load{ 0.02, 0.01, 0.01 }, 1);
+    CHECK_NEAR(driver.governor.getUsagePercent(), 2.0 + 0.3 * 100.0, 1e-6);
+
+    // CPU time going backwards counts as no work
+    Driver backwards(5.0, 1.0);
+    backwards.run(Load{ 0.2, 0.2, 0.2 }, 2);
+    backwards.cpu_sec = 0.0;
+    backwards.run(Load{ 0.0, 0.0, 0.0 }, 30);
+    CHECK(backwards.governor.getLevel() == Level::FULL);
+}
@@ -0,0 +1,241 @@
+#include "TestHarness.h"
+#include "monitor/ProcessFilter.h"
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace {
+    struct CompileCase {
+        const char* expression;
+        bool valid;
+        const char* error;      // Expected in the message when invalid
+    };
+
+    const CompileCase COMPILE_CASES[] = {
+        { "", true, "" },
+        { "   \t\n", true, "" },
+        { "pid==1", true, "" },
+        { "  ppid != 1  ", true, "" },
+        { "cpu>=50", true, "" },
+        { "cpu>=50%", true, "" },
+        { "rss>1K", true, "" },
+        { "rss>1kb", true, "" },
+        { "rss>=1.5G", true, "" },
+        { "rss<2T", true, "" },
+        { "prio<=20 && nice<0", true, "" },
+        { "priority==20", true, "" },
+        { "user==0 || uid!=1000", true, "" },
+        { "name==bash", true, "" },
+        { "name~^java", true, "" },
+        { "name!~\"^(bash|sh)$\"", true, "" },
+        { "name=='Web Content'", true, "" },
+        { "name==\"say \\\"hi\\\"\"", true, "" },
+        { "!name~kworker && (cpu>1 || rss>1G)", true, "" },
+        { "((pid>1))", true, "" },
+        { "name~(a|b) && pid>1", true, "" },
+        { "bogus>1", false, "unknown field 'bogus'" },
+        { "pid", false, "expected an operator" },
+        { "pid==", false, "expected a value" },
+        { "pid=1", false, "expected an operator" },
+        { "pid==abc", false, "invalid number 'abc'" },
+        { "pid==1K", false, "invalid number" },
+        { "cpu>5M", false, "invalid number" },
+        { "rss>1Q", false, "invalid number" },
+        { "rss>1\xe9", false, "invalid number" },     // Non-ASCII unit
+        { "rss>1\xc3\xa9", false, "invalid number" },
+        { "cpu>nan", false, "invalid number" },
+        { "name>abc", false, "operator not supported" },
+        { "user<5", false, "operator not supported" },
+        { "pid~1", false, "operator not supported" },
+        { "name~[", false, "invalid regular expression" },
+        { "name==\"open", false, "expected a value" },
+        { "(pid>1", false, "expected ')'" },
+        { "pid>1)", false, "unexpected ')'" },
+        { "pid>1 &&", false, "expected a field name" },
+        { "&& pid>1", false, "expected a field name" },
+        { "pid>1 pid<5", false, "unexpected 'pid<5'" },
+        { "user==no-such-user-here", false, "unknown user" },
+    };
+
+    struct Process {
+        int pid;
+        int ppid;
+        const char* name;
+        long rss_kb;
+        int priority;
+        double cpu;
+        int uid;
+    };
+
+    const Process INIT = { 1, 0, "systemd", 12000, 20, 0.0, 0 };
+    const Process SHELL = { 4242, 4000, "bash", 800, 20, 0.5, 1000 };
+    const Process JAVA = { 9000, 1, "java", 4L * 1024 * 1024, 20, 180.0, 1000 };
+    const Process BROWSER = { 7000, 1, "Web Content", 900 * 1024, 25, 12.0, 1000 };
+    const Process KWORKER = { 30, 2, "kworker/0:1", 0, 0, 0.0, 0 };
+    const Process ACCENT = { 8000, 1, "caf\xc3\xa9", 2048, 39, 3.0, 1000 };
+
+    struct MatchCase {
+        const char* expression;
+        const Process* process;
+        bool expected;
+    };
+
+    const MatchCase MATCH_CASES[] = {
+        { "", &JAVA, true },
+        { "pid==1", &INIT, true },
+        { "pid==1", &SHELL, false },
+        { "pid!=1", &SHELL, true },
+        { "ppid==1", &JAVA, true },
+        { "cpu>100", &JAVA, true },
+        { "cpu>100", &BROWSER, false },
+        { "cpu>=12%", &BROWSER, true },
+        { "cpu<1", &SHELL, true },
+        { "rss>1G", &JAVA, true },
+        { "rss>=4G", &JAVA, true },
+        { "rss>4G", &JAVA, false },
+        { "rss<1M", &SHELL, true },
+        { "rss>1M", &SHELL, false },
+        { "rss==0", &KWORKER, true },
+        { "prio==25", &BROWSER, true },
+        { "nice==5", &BROWSER, true },
+        { "nice<0", &KWORKER, true },
+        { "nice>=19", &ACCENT, true },
+        { "user==0", &INIT, true },
+        { "user==0", &SHELL, false },
+        { "uid!=0", &SHELL, true },
+        { "name==bash", &SHELL, true },
+        { "name==bas", &SHELL, false },
+        { "name!=bash", &SHELL, false },
+        { "name=='Web Content'", &BROWSER, true },
+        { "name==Web", &BROWSER, false },
+        { "name~^java", &JAVA, true },
+        { "name~java$", &JAVA, true },
+        { "name~^java$", &JAVA, true },
+        { "name~av", &JAVA, true },
+        { "name~^av", &JAVA, false },
+        { "name~\"^(bash|sh)$\"", &SHELL, true },
+        { "name~\"^(bash|sh)$\"", &JAVA, false },
+        { "name!~\"^(bash|sh)$\"", &JAVA, true },
+        { "name~^kworker/\\d+:\\d+$", &KWORKER, true },
+        { "name~^kworker/\\d+:\\d+$", &INIT, false },
+        { "name~caf\xc3\xa9", &ACCENT, true },
+        { "name~^Web.Content$", &BROWSER, true },
+        { "!name~kworker", &KWORKER, false },
+        { "!name~kworker", &INIT, true },
+        { "!!pid==1", &INIT, true },
+        { "pid==1 || pid==4242", &SHELL, true },
+        { "pid==1 || pid==4242", &JAVA, false },
+        { "cpu>1 && rss>1G", &JAVA, true },
+        { "cpu>1 && rss>1G", &BROWSER, false },
+        { "user==1000 && (cpu>100 || name==bash)", &SHELL, true },
+        { "user==1000 && (cpu>100 || name==bash)", &JAVA, true },
+        { "user==1000 && (cpu>100 || name==bash)", &BROWSER, false },
+        { "user==1000 && (cpu>100 || name==bash)", &INIT, false },
+        { "!(pid==1 || pid==30) && ppid==1", &JAVA, true },
+        { "!(pid==1 || pid==30) && ppid==1", &KWORKER, false },
+        // && binds tighter than ||
+        { "pid==1 || pid==9000 && cpu<1", &INIT, true },
+        { "pid==1 || pid==9000 && cpu<1", &JAVA, false },
+        { "(pid==1 || pid==9000) && cpu<1", &JAVA, false },
+        { "(pid==1 || pid==9000) && cpu>1", &JAVA, true },
+    };
+
+    ProcessFilter::Candidate candidate(const Process& process) {
+        ProcessFilter::Candidate value;
+        value.pid = process.pid;
+        value.ppid = process.ppid;
+        value.name = process.name;
+        value.name_len = std::strlen(process.name);
+        value.rss_kb = process.rss_kb;
+        value.priority = process.priority;
+        value.cpu = process.cpu;
+        value.uid = process.uid;
+        return value;
+    }
+}
+
+TEST(compile_table) {
+    for (const CompileCase& entry : COMPILE_CASES) {
+        ProcessFilter filter;
+        std::string error;
+        bool valid = filter.compile(entry.expression, error);
+        if (valid != entry.valid) {
+            std::ostringstream message;
+            message << "compile(\"" << entry.expression << "\"): got " << (valid ? "valid" : "invalid: " + error);
+            test::fail(__FILE__, __LINE__, message.str());
+        } else if (!valid && error.find(entry.error) == std::string::npos) {
+            std::ostringstream message;
+            message << "compile(\"" << entry.expression << "\"): error \"" << error << "\" lacks \""
+                    << entry.error << "\"";
+            test::fail(__FILE__, __LINE__, message.str());
+        }
+    }
+}
+
+TEST(match_table) {
+    for (const MatchCase& entry : MATCH_CASES) {
+        ProcessFilter filter;
+        std::string error;
+        if (!filter.compile(entry.expression, error)) {
+            test::fail(__FILE__, __LINE__, std::string("compile(\"") + entry.expression + "\"): " + error);
+            continue;
+        }
+        ProcessFilter::Candidate process = candidate(*entry.process);
+        // Twice: the second run goes through the regex memo
+        for (int round = 0; round < 2; round++) {
+            if (filter.matches(process) != entry.expected) {
+                std::ostringstream message;
+                message << "\"" << entry.expression << "\" on " << entry.process->name << " (round "
+                        << round << "): expected " << (entry.expected ? "match" : "no match");
+                test::fail(__FILE__, __LINE__, message.str());
+            }
+        }
+    }
+}
+
+TEST(failed_compile_keeps_program) {
+    ProcessFilter filter;
+    std::string error;
+    REQUIRE(filter.compile("name==bash", error));
+    CHECK(!filter.compile("name==", error));
+    CHECK_EQ(filter.getText(), std::string("name==bash"));
+
+    ProcessFilter::Candidate shell = candidate(SHELL);
+    ProcessFilter::Candidate java = candidate(JAVA);
+    CHECK(filter.matches(shell));
+    CHECK(!filter.matches(java));
+
+    // Blank clears it
+    REQUIRE(filter.compile("  ", error));
+    CHECK(filter.empty());
+    CHECK(filter.matches(java));
+}
+
+TEST(flags_and_limits) {
+    ProcessFilter filter;
+    std::string error;
+    REQUIRE(filter.compile("cpu>1 || name==x", error));
+    CHECK(filter.usesCPU());
+    CHECK(!filter.usesUser());
+    REQUIRE(filter.compile("user==0", error));
+    CHECK(filter.usesUser());
+    CHECK(!filter.usesCPU());
+    // One instruction per test, however the tests combine
+    REQUIRE(filter.compile("!(pid==1 || pid==2) && (ppid==1 || !name~x)", error));
+    CHECK_EQ(filter.getInstructionCount(), static_cast<size_t>(4));
+
+    std::string nested(65, '(');
+    nested += "pid==1" + std::string(65, ')');
+    CHECK(!filter.compile(nested, error));
+    CHECK(error.find("nested too deeply") != std::string::npos);
+    std::string negated(65, '!');
+    CHECK(!filter.compile(negated + "pid==1", error));
+
+    std::string shallow(64, '(');
+    shallow += "pid==1" + std::string(64, ')');
+    CHECK(filter.compile(shallow, error));
+
+    std::string huge(5000, ' ');
+    CHECK(!filter.compile("pid==1" + huge, error));
+    CHECK(error.find("longer than") != std::string::npos);
+}
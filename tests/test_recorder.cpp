@@ -0,0 +1,85 @@
+#include "TestHarness.h"
+#include "exporter/Recorder.h"
+#include "monitor/SnapshotDelta.h"
+#include "query/HistoryQuery.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+    const char* RECORDING = "test_recorder.rec";
+
+    ProcessInfo process(int pid, const std::string& name, double cpu, long rss_kb) {
+        ProcessInfo proc;
+        proc.pid = pid;
+        proc.name = name;
+        proc.cpu_usage = cpu;
+        proc.memory_kb = rss_kb;
+        return proc;
+    }
+
+    void removeRecording() {
+        std::remove(RECORDING);
+        std::remove((std::string(RECORDING) + ".idx").c_str());
+    }
+
+    // A keyframe with a name that tries to inject a keyframe header and a
+    // phantom row, then a delta spawning a process with other controls
+    void writeHostileRecording() {
+        removeRecording();
+        Recorder recorder(RECORDING, Recorder::Mode::DELTA);
+        REQUIRE(recorder.isOpen());
+        
+        SystemMetrics keyframe;
+        keyframe.cpu_usage = 10.0;
+        keyframe.process_count = 2;
+        keyframe.top_processes.push_back(process(1, "init", 1.0, 1000));
+        keyframe.top_processes.push_back(process(2, "evil\nF 0 0 0 0 0 0 0\nP 666 99.00 1 0 ghost", 5.0, 2000));
+        recorder.writeFrame(keyframe);
+        
+        SnapshotDelta delta;
+        delta.sequence = 1;
+        delta.spawned.push_back(process(3, std::string("tab\tcr\r\x1b[31mnul\0end", 19), 2.0, 3000));
+        SystemMetrics next;
+        next.cpu_usage = 20.0;
+        next.process_count = 3;
+        next.delta = &delta;
+        recorder.writeFrame(next);
+    }
+}
+
+TEST(control_characters_never_start_a_record) {
+    writeHostileRecording();
+    std::ifstream in(RECORDING);
+    std::string line;
+    int headers = 0;
+    int rows = 0;
+    while (std::getline(in, line)) {
+        REQUIRE(!line.empty());
+        for (char c : line) CHECK(static_cast<unsigned char>(c) >= 0x20 && c != 0x7f);
+        if (line[0] == 'F' || line[0] == 'D') headers++;
+        if (line[0] == 'P' || line[0] == '+') rows++;
+        CHECK(line.compare(0, 5, "P 666") != 0);
+    }
+    CHECK_EQ(headers, 2);
+    CHECK_EQ(rows, 3);
+    removeRecording();
+}
+
+TEST(names_round_trip_through_a_query) {
+    writeHostileRecording();
+    HistoryQuery query(RECORDING);
+    REQUIRE(query.open());
+    QueryResult result;
+    REQUIRE(query.run(0, INT64_MAX, 10, QueryKey::RSS, result));
+    
+    CHECK_EQ(result.frames, 2u);
+    REQUIRE(result.top.size() == 3u);
+    CHECK_EQ(result.top[0].pid, 3);
+    CHECK_EQ(result.top[0].name, std::string("tab_cr__[31mnul_end"));
+    CHECK_EQ(result.top[1].pid, 2);
+    CHECK_EQ(result.top[1].name, std::string("evil_F 0 0 0 0 0 0 0_P 666 99.00 1 0 ghost"));
+    CHECK_EQ(result.top[2].name, std::string("init"));
+    removeRecording();
+}
@@ -0,0 +1,106 @@
+#include "TestHarness.h"
+#include "ProcfsFixture.h"
+#include "monitor/SystemMonitor.h"
+#include "platform/Platform.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    // Enough processes that the round-robin sweep needs many ticks to come
+    // back to any one of them
+    const int PROCESSES = 1000;
+    const int TICKS = 24;
+
+    struct FixtureScope {
+        ProcfsFixture fixture;
+
+        FixtureScope()
+            : fixture("test_sched_monitor-" + std::to_string(getpid()), PROCESSES) {
+            REQUIRE(fixture.generate());
+            Platform::setProcRoot(fixture.getRoot());
+        }
+
+        ~FixtureScope() {
+            Platform::setProcRoot("");
+        }
+    };
+
+    // Above any wait the fixture generates, so the first rewrite already
+    // counts as waiting
+    const long long WAIT_BASE_NS = 1LL << 50;
+
+    // The fixture's stat files never change, so every process sits at 0%
+    // CPU; this one's run-queue wait keeps growing regardless
+    void starve(const std::string& root, int pid, long long wait_ns) {
+        std::ofstream out(root + "/" + std::to_string(pid) + "/schedstat");
+        out << 1000000 << " " << wait_ns << " " << 1 << "\n";
+    }
+
+    bool shown(const SystemMetrics& metrics, int pid) {
+        for (const SchedInfo& info : metrics.top_sched) {
+            if (info.pid == pid) return true;
+        }
+        return false;
+    }
+}
+
+TEST(starved_process_stays_in_view) {
+    FixtureScope scope;
+    SystemMonitor monitor;
+    monitor.setSchedTracking(true);
+    monitor.collectMetrics();
+
+    // A row in the middle of the table, so the sweep reaches it late
+    const ProcessTable& table = monitor.getProcessTable();
+    REQUIRE(table.size() == static_cast<size_t>(PROCESSES));
+    int pid = table.getPid(table.size() / 2);
+
+    long long wait_ns = WAIT_BASE_NS;
+    int first_seen = -1;
+    int missed_after = 0;
+    for (int tick = 0; tick < TICKS; tick++) {
+        wait_ns += 50000000;
+        starve(scope.fixture.getRoot(), pid, wait_ns);
+        SystemMetrics metrics = monitor.collectMetrics();
+        CHECK_EQ(table.getCPU(table.size() / 2), 0.0);
+        if (shown(metrics, pid)) {
+            if (first_seen < 0) first_seen = tick;
+        } else if (first_seen >= 0) {
+            missed_after++;
+        }
+    }
+
+    // Found by the sweep within one pass over the table, then never lost
+    CHECK(first_seen >= 0);
+    CHECK(first_seen <= PROCESSES / 128 + 1);
+    CHECK_EQ(missed_after, 0);
+}
+
+TEST(watch_ends_when_waiting_stops) {
+    FixtureScope scope;
+    SystemMonitor monitor;
+    monitor.setSchedTracking(true);
+    monitor.collectMetrics();
+
+    const ProcessTable& table = monitor.getProcessTable();
+    int pid = table.getPid(table.size() / 2);
+    unsigned long reads_before = 0;
+
+    long long wait_ns = WAIT_BASE_NS;
+    bool seen = false;
+    for (int tick = 0; tick < TICKS && !seen; tick++) {
+        wait_ns += 50000000;
+        starve(scope.fixture.getRoot(), pid, wait_ns);
+        seen = shown(monitor.collectMetrics(), pid);
+    }
+    REQUIRE(seen);
+
+    // No new waiting: the next read finds nothing and the watch is dropped,
+    // so the tick after that reads only the sweep
+    CHECK(!shown(monitor.collectMetrics(), pid));
+    reads_before = monitor.getSchedMonitor().getSchedstatReads();
+    monitor.collectMetrics();
+    CHECK_EQ(monitor.getSchedMonitor().getSchedstatReads() - reads_before, 128ul);
+}
@@ -0,0 +1,120 @@
+#include "TestHarness.h"
+#include "exporter/ShmPublisher.h"
+#include "monitor/ProcessTable.h"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    void addProcess(ProcessTable& table, int pid, const std::string& name) {
+        Platform::ProcessSample sample;
+        sample.pid = pid;
+        sample.ppid = 1;
+        sample.name = name.data();
+        sample.name_len = name.size();
+        sample.memory_kb = 1024;
+        sample.priority = 20;
+        sample.cpu_ticks = 0;
+        sample.major_faults = 0;
+        table.visit(sample);
+    }
+}
+
+TEST(names_truncate_on_character_boundaries) {
+    std::string accents;
+    for (int i = 0; i < 9; i++) accents += "\xc3\xa9";
+    std::string emoji = "abcdefghijklm\xf0\x9f\x98\x80";
+    std::string exact = "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe6\x97\xa5\xe6\x9c\xac";
+
+    ProcessTable table;
+    table.beginScan(100, 1);
+    addProcess(table, 10, accents);
+    addProcess(table, 11, emoji);
+    addProcess(table, 12, exact);
+    addProcess(table, 13, "short");
+    table.endScan();
+
+    SystemMetrics metrics;
+    metrics.total_mem_kb = 1024 * 1024;
+    metrics.process_table = &table;
+
+    std::string name = "sysmonitor-test-" + std::to_string(getpid());
+    ShmPublisher publisher(name, 16);
+    REQUIRE(publisher.isOpen());
+    publisher.publish(metrics);
+
+    sysmon_shm_reader reader;
+    REQUIRE(sysmon_shm_open(&reader, name.c_str()) == 0);
+    sysmon_shm_system system;
+    sysmon_shm_process rows[16];
+    uint32_t count = 0;
+    int status = sysmon_shm_read(&reader, &system, rows, 16, &count);
+    sysmon_shm_close(&reader);
+    unlink(publisher.getPath().c_str());
+    REQUIRE(status == 0);
+    REQUIRE(count == 4);
+
+    for (uint32_t i = 0; i < count; i++) {
+        std::string published(rows[i].name);
+        switch (rows[i].pid) {
+        case 10: CHECK_EQ(published, accents.substr(0, 14)); break;
+        case 11: CHECK_EQ(published, std::string("abcdefghijklm")); break;
+        case 12: CHECK_EQ(published, exact); break;
+        case 13: CHECK_EQ(published, std::string("short")); break;
+        default: CHECK(false);
+        }
+    }
+}
+
+TEST(reader_waits_out_a_long_update) {
+    ProcessTable table;
+    table.beginScan(100, 1);
+    addProcess(table, 10, "worker");
+    table.endScan();
+    SystemMetrics metrics;
+    metrics.process_table = &table;
+
+    std::string name = "sysmonitor-test-" + std::to_string(getpid());
+    ShmPublisher publisher(name, 16);
+    REQUIRE(publisher.isOpen());
+    publisher.publish(metrics);
+
+    // Holds the counter odd far longer than the reader spins, as publishing
+    // a large table does
+    int fd = open(publisher.getPath().c_str(), O_RDWR);
+    REQUIRE(fd >= 0);
+    void* map = mmap(nullptr, sizeof(sysmon_shm_header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    REQUIRE(map != MAP_FAILED);
+    sysmon_shm_header* header = static_cast<sysmon_shm_header*>(map);
+    __atomic_fetch_add(&header->sequence, 1, __ATOMIC_RELEASE);
+    std::thread writer([header] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        __atomic_fetch_add(&header->sequence, 1, __ATOMIC_RELEASE);
+    });
+
+    sysmon_shm_reader reader;
+    REQUIRE(sysmon_shm_open(&reader, name.c_str()) == 0);
+    sysmon_shm_system system;
+    sysmon_shm_process rows[16];
+    uint32_t count = 0;
+    CHECK_EQ(sysmon_shm_read(&reader, &system, rows, 16, &count), 0);
+    CHECK_EQ(count, 1u);
+    writer.join();
+
+    // A writer that exits mid-update is not waited for
+    __atomic_fetch_add(&header->sequence, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->writer_pid, 0, __ATOMIC_RELAXED);
+    auto start = std::chrono::steady_clock::now();
+    CHECK_EQ(sysmon_shm_read(&reader, &system, rows, 16, &count), 1);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(SYSMON_SHM_WAIT_MS / 2));
+
+    sysmon_shm_close(&reader);
+    munmap(map, sizeof(sysmon_shm_header));
+    unlink(publisher.getPath().c_str());
+}
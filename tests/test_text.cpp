@@ -0,0 +1,106 @@
+#include "TestHarness.h"
+#include "exporter/SnapshotReport.h"
+#include "utils/Text.h"
+#include <sstream>
+#include <string>
+
+namespace {
+    struct LengthCase {
+        const char* bytes;
+        size_t size;
+        size_t expected;
+    };
+
+    // Well-formed characters of each length at the edges of their ranges,
+    // then every way a sequence can be malformed
+    const LengthCase LENGTH_CASES[] = {
+        { "A", 1, 1 },
+        { "\x7f", 1, 1 },
+        { "\xc2\x80", 2, 2 },               // U+0080
+        { "\xdf\xbf", 2, 2 },               // U+07FF
+        { "\xe0\xa0\x80", 3, 3 },           // U+0800
+        { "\xed\x9f\xbf", 3, 3 },           // U+D7FF
+        { "\xee\x80\x80", 3, 3 },           // U+E000
+        { "\xef\xbf\xbd", 3, 3 },           // U+FFFD
+        { "\xf0\x90\x80\x80", 4, 4 },       // U+10000
+        { "\xf4\x8f\xbf\xbf", 4, 4 },       // U+10FFFF
+        { "\x80", 1, 0 },                   // Stray continuation byte
+        { "\xbf", 1, 0 },
+        { "\xc0\x80", 2, 0 },               // Overlong NUL
+        { "\xc1\xbf", 2, 0 },               // Overlong U+007F
+        { "\xe0\x9f\xbf", 3, 0 },           // Overlong U+07FF
+        { "\xf0\x8f\xbf\xbf", 4, 0 },       // Overlong U+FFFF
+        { "\xed\xa0\x80", 3, 0 },           // Surrogate U+D800
+        { "\xed\xbf\xbf", 3, 0 },           // Surrogate U+DFFF
+        { "\xf4\x90\x80\x80", 4, 0 },       // U+110000
+        { "\xf5\x80\x80\x80", 4, 0 },
+        { "\xff", 1, 0 },
+        { "\xe2\x82", 2, 0 },               // Cut short
+        { "\xe2\x82\xac", 2, 0 },           // Cut short by the size
+        { "\xe2\x28\xa1", 3, 0 },           // Bad continuation
+        { "\xf0\x90\x80\x41", 4, 0 },
+        { "", 0, 0 },
+    };
+
+    std::string json(const std::string& value) {
+        std::string out;
+        Text::appendJSONString(out, value);
+        return out;
+    }
+}
+
+TEST(utf8_length_table) {
+    for (const LengthCase& entry : LENGTH_CASES) {
+        size_t length = Text::utf8Length(entry.bytes, entry.size);
+        if (length != entry.expected) {
+            std::ostringstream message;
+            message << "utf8Length of case " << (&entry - LENGTH_CASES) << ": got " << length
+                    << ", expected " << entry.expected;
+            test::fail(__FILE__, __LINE__, message.str());
+        }
+    }
+}
+
+TEST(utf8_prefix_keeps_characters_whole) {
+    // Nine two-byte characters into 15 bytes: seven fit
+    std::string accents;
+    for (int i = 0; i < 9; i++) accents += "\xc3\xa9";
+    CHECK_EQ(Text::utf8Prefix(accents.data(), accents.size(), 15), static_cast<size_t>(14));
+
+    // Three-byte characters fit exactly
+    std::string kanji = "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e";
+    CHECK_EQ(Text::utf8Prefix(kanji.data(), kanji.size(), 15), static_cast<size_t>(15));
+    CHECK_EQ(Text::utf8Prefix(kanji.data(), kanji.size(), 14), static_cast<size_t>(12));
+
+    // A four-byte character straddling the limit is left out entirely
+    std::string emoji = "abcdefghijklm\xf0\x9f\x98\x80";
+    CHECK_EQ(Text::utf8Prefix(emoji.data(), emoji.size(), 15), static_cast<size_t>(13));
+
+    // Invalid bytes are single characters; short input is kept whole
+    std::string broken = "\xff\xfe\x80";
+    CHECK_EQ(Text::utf8Prefix(broken.data(), broken.size(), 2), static_cast<size_t>(2));
+    CHECK_EQ(Text::utf8Prefix("abc", 3, 15), static_cast<size_t>(3));
+    CHECK_EQ(Text::utf8Prefix("abc", 3, 0), static_cast<size_t>(0));
+}
+
+TEST(json_string_escaping) {
+    CHECK_EQ(json(""), std::string("\"\""));
+    CHECK_EQ(json("kworker/0:1"), std::string("\"kworker/0:1\""));
+    CHECK_EQ(json("a\"b\\c"), std::string("\"a\\\"b\\\\c\""));
+    CHECK_EQ(json(std::string("\n\t\x1b\0", 4)), std::string("\"\\u000a\\u0009\\u001b\\u0000\""));
+
+    // Well-formed characters pass through untouched
+    CHECK_EQ(json("caf\xc3\xa9 \xf0\x9f\x98\x80"), std::string("\"caf\xc3\xa9 \xf0\x9f\x98\x80\""));
+
+    // Each malformed byte becomes one replacement character
+    CHECK_EQ(json("a\xffz"), std::string("\"a\\ufffdz\""));
+    CHECK_EQ(json("\xc3"), std::string("\"\\ufffd\""));
+    CHECK_EQ(json("\xed\xa0\x80"), std::string("\"\\ufffd\\ufffd\\ufffd\""));
+    CHECK_EQ(json("\xc0\x80"), std::string("\"\\ufffd\\ufffd\""));
+    CHECK_EQ(json("\xe2\x82\x41"), std::string("\"\\ufffd\\ufffdA\""));
+
+    // The report's writer produces the same bytes
+    std::ostringstream out;
+    SnapshotReport::writeJSONString(out, "a\xffz");
+    CHECK_EQ(out.str(), std::string("\"a\\ufffdz\""));
+}
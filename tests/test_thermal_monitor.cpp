@@ -0,0 +1,138 @@
+#include "TestHarness.h"
+#include "monitor/ThermalMonitor.h"
+#include "platform/Platform.h"
+#include <cstdio>
+#include <fstream>
+#include <ftw.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    int removeEntry(const char* path, const struct stat*, int, struct FTW*) {
+        return std::remove(path);
+    }
+
+    // A synthetic sysfs: CPUs with cpufreq and throttle counters, and
+    // thermal zones, under a root the collectors are pointed at
+    struct SysfsScope {
+        std::string root;
+
+        SysfsScope() : root("test_thermal_monitor-" + std::to_string(getpid())) {
+            makeDir("");
+            makeDir("/devices");
+            makeDir("/devices/system");
+            makeDir("/devices/system/cpu");
+            makeDir("/class");
+            makeDir("/class/thermal");
+            Platform::setSysRoot(root);
+        }
+
+        ~SysfsScope() {
+            Platform::setSysRoot("");
+            nftw(root.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+        }
+
+        void makeDir(const std::string& path) {
+            ::mkdir((root + path).c_str(), 0755);
+        }
+
+        // Replaces the file, so descriptors kept on the old one go stale
+        void write(const std::string& path, const std::string& content) {
+            std::string full = root + path;
+            std::remove(full.c_str());
+            std::ofstream(full.c_str()) << content << "\n";
+        }
+
+        void addCPU(int cpu, long khz) {
+            std::string base = "/devices/system/cpu/cpu" + std::to_string(cpu);
+            makeDir(base);
+            makeDir(base + "/cpufreq");
+            makeDir(base + "/thermal_throttle");
+            makeDir(base + "/topology");
+            write(base + "/cpufreq/scaling_cur_freq", std::to_string(khz));
+            write(base + "/cpufreq/cpuinfo_max_freq", "3000000");
+            write(base + "/thermal_throttle/core_throttle_count", "5");
+            write(base + "/thermal_throttle/package_throttle_count", "9");
+            write(base + "/topology/physical_package_id", "0");
+            write("/devices/system/cpu/present", "0-" + std::to_string(cpu));
+        }
+
+        void addZone(int zone, long millidegrees) {
+            std::string base = "/class/thermal/thermal_zone" + std::to_string(zone);
+            makeDir(base);
+            write(base + "/type", "zone" + std::to_string(zone));
+            write(base + "/temp", std::to_string(millidegrees));
+        }
+    };
+}
+
+TEST(failed_read_closes_until_refresh) {
+    SysfsScope sysfs;
+    sysfs.addZone(0, 40000);
+    sysfs.addZone(1, 55000);
+    // A directory opens fine but every read of it fails, like an attribute
+    // whose driver went away
+    std::string temp = sysfs.root + "/class/thermal/thermal_zone0/temp";
+    std::remove(temp.c_str());
+    ::mkdir(temp.c_str(), 0755);
+
+    std::vector<Platform::ThermalZone> zones;
+    REQUIRE(Platform::getThermalZones(zones));
+    REQUIRE(zones.size() == 2);
+    CHECK_EQ(zones[0].celsius, 0.0);
+    CHECK_EQ(zones[1].celsius, 55.0);
+
+    // The one re-open failed as well, so the zone stays dark for now
+    ::rmdir(temp.c_str());
+    sysfs.write("/class/thermal/thermal_zone0/temp", "41000");
+    REQUIRE(Platform::getThermalZones(zones));
+    CHECK_EQ(zones[0].celsius, 0.0);
+
+    Platform::refreshSensors();
+    REQUIRE(Platform::getThermalZones(zones));
+    CHECK_EQ(zones[0].celsius, 41.0);
+    CHECK_EQ(zones[1].celsius, 55.0);
+}
+
+TEST(monitor_rescans_sysfs_periodically) {
+    SysfsScope sysfs;
+    sysfs.addCPU(0, 2000000);
+    sysfs.addCPU(1, 2000000);
+    sysfs.addZone(0, 50000);
+
+    ThermalMonitor monitor;
+    CPUThermals thermals;
+    monitor.update(thermals);
+    REQUIRE(thermals.available);
+    CHECK_EQ(thermals.cpus, 2);
+    CHECK_EQ(thermals.zones.size(), static_cast<size_t>(1));
+
+    // A CPU comes online, a zone appears and cpu0's attribute is replaced
+    // (as when the cpufreq driver is reloaded)
+    sysfs.addCPU(2, 1000000);
+    sysfs.addZone(1, 70000);
+    sysfs.write("/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", "3000000");
+
+    int ticks = 1;
+    while (thermals.cpus == 2 && ticks < 100) {
+        monitor.update(thermals);
+        ticks++;
+        if (thermals.cpus == 2) {
+            CHECK_EQ(thermals.zones.size(), static_cast<size_t>(1));
+            CHECK_EQ(thermals.avg_mhz, 2000.0);
+        }
+    }
+    CHECK_EQ(ticks, 60);
+    CHECK_EQ(thermals.cpus, 3);
+    CHECK_EQ(thermals.zones.size(), static_cast<size_t>(2));
+    CHECK_EQ(thermals.max_mhz, 3000.0);
+    CHECK_EQ(thermals.min_mhz, 1000.0);
+    CHECK_EQ(thermals.hottest_zone, 1);
+    // The counters did not move, and a re-scan is not throttling
+    CHECK_EQ(thermals.throttle_events, 0LL);
+
+    monitor.update(thermals);
+    CHECK_EQ(thermals.throttle_events, 0LL);
+    CHECK_EQ(thermals.cpus, 3);
+}
@@ -0,0 +1,241 @@
+#include "TestHarness.h"
+#include "net/Wire.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+    // Payload of a single message, header checked and stripped
+    std::vector<uint8_t> payloadOf(const std::vector<uint8_t>& message) {
+        REQUIRE(message.size() >= Wire::HEADER_SIZE);
+        uint32_t length = Wire::payloadLength(message.data());
+        REQUIRE(length == message.size() - Wire::HEADER_SIZE);
+        return std::vector<uint8_t>(message.begin() + Wire::HEADER_SIZE, message.end());
+    }
+}
+
+TEST(varints_round_trip_at_every_length_boundary) {
+    std::vector<uint64_t> values;
+    for (int bits = 0; bits <= 64; bits += 7) {
+        uint64_t edge = bits == 63 ? (1ull << 63) : (bits < 64 ? (1ull << bits) : 0);
+        if (edge > 0) {
+            values.push_back(edge - 1);
+            values.push_back(edge);
+        }
+    }
+    values.push_back(0);
+    values.push_back(std::numeric_limits<uint32_t>::max());
+    values.push_back(std::numeric_limits<uint64_t>::max());
+    
+    std::vector<uint8_t> message;
+    Wire::Writer writer(message);
+    for (uint64_t value : values) writer.putVarint(value);
+    writer.finish();
+    
+    std::vector<uint8_t> payload = payloadOf(message);
+    Wire::Reader reader(payload.data(), payload.size());
+    for (uint64_t value : values) CHECK_EQ(reader.getVarint(), value);
+    CHECK(reader.good());
+    CHECK(reader.atEnd());
+}
+
+TEST(varint_lengths_are_minimal) {
+    const uint64_t values[] = { 0, 127, 128, 16383, 16384, std::numeric_limits<uint64_t>::max() };
+    const size_t lengths[] = { 1, 1, 2, 2, 3, 10 };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        std::vector<uint8_t> message;
+        Wire::Writer writer(message);
+        writer.putVarint(values[i]);
+        CHECK_EQ(message.size() - Wire::HEADER_SIZE, lengths[i]);
+    }
+}
+
+TEST(zigzag_round_trips_signed_extremes) {
+    const int64_t values[] = {
+        0, 1, -1, 63, -64, 64, -65, 20, -20,
+        std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max(),
+        std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(),
+        std::numeric_limits<int64_t>::min() + 1
+    };
+    std::vector<uint8_t> message;
+    Wire::Writer writer(message);
+    for (int64_t value : values) writer.putSigned(value);
+    writer.finish();
+    
+    std::vector<uint8_t> payload = payloadOf(message);
+    Wire::Reader reader(payload.data(), payload.size());
+    for (int64_t value : values) CHECK_EQ(reader.getSigned(), value);
+    CHECK(reader.good());
+    CHECK(reader.atEnd());
+}
+
+TEST(zigzag_keeps_small_magnitudes_to_one_byte) {
+    const int64_t values[] = { -64, -1, 0, 1, 63 };
+    for (int64_t value : values) {
+        std::vector<uint8_t> message;
+        Wire::Writer writer(message);
+        writer.putSigned(value);
+        CHECK_EQ(message.size() - Wire::HEADER_SIZE, 1u);
+    }
+}
+
+TEST(percentages_round_to_hundredths_and_clamp) {
+    const double inputs[] = {
+        0.0, 12.345, 99.994, 100.0, -5.0, -0.0,
+        std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity(),
+        1e300
+    };
+    const double expected[] = { 0.0, 12.35, 99.99, 100.0, 0.0, 0.0, 0.0, 1e15, 0.0, 1e15 };
+    std::vector<uint8_t> message;
+    Wire::Writer writer(message);
+    for (double value : inputs) writer.putPercent(value);
+    writer.finish();
+    
+    std::vector<uint8_t> payload = payloadOf(message);
+    Wire::Reader reader(payload.data(), payload.size());
+    for (double value : expected) CHECK_NEAR(reader.getPercent(), value, 1e-9);
+    CHECK(reader.good());
+}
+
+TEST(strings_round_trip_with_any_bytes) {
+    const std::string values[] = {
+        "", "host-1", std::string("nul\0inside", 10), std::string(300, 'x'), "\xff\xfe utf8 \xc3\xa9"
+    };
+    std::vector<uint8_t> message;
+    Wire::Writer writer(message);
+    for (const std::string& value : values) writer.putString(value);
+    writer.finish();
+    
+    std::vector<uint8_t> payload = payloadOf(message);
+    Wire::Reader reader(payload.data(), payload.size());
+    std::string read;
+    for (const std::string& value : values) {
+        reader.getString(read);
+        CHECK(read == value);
+    }
+    CHECK(reader.good());
+    CHECK(reader.atEnd());
+}
+
+TEST(truncated_and_malformed_input_is_rejected) {
+    // Continuation bit set on the last byte
+    const uint8_t truncated[] = { 0x80, 0x80 };
+    Wire::Reader a(truncated, sizeof(truncated));
+    CHECK_EQ(a.getVarint(), 0u);
+    CHECK(!a.good());
+    
+    // Eleven bytes: longer than any 64-bit value
+    std::vector<uint8_t> overlong(10, 0x80);
+    overlong.push_back(0x01);
+    Wire::Reader b(overlong.data(), overlong.size());
+    b.getVarint();
+    CHECK(!b.good());
+    
+    // Ten bytes whose last one sets bits past 63
+    std::vector<uint8_t> overflow(9, 0xff);
+    overflow.push_back(0x02);
+    Wire::Reader c(overflow.data(), overflow.size());
+    c.getVarint();
+    CHECK(!c.good());
+    
+    // String length past the end of the payload
+    const uint8_t short_string[] = { 0x05, 'a', 'b' };
+    Wire::Reader d(short_string, sizeof(short_string));
+    std::string value = "kept?";
+    d.getString(value);
+    CHECK(!d.good());
+    CHECK(value.empty());
+    
+    // Reads past the end stay failed
+    Wire::Reader e(nullptr, 0);
+    CHECK_EQ(e.getByte(), 0);
+    CHECK(!e.good());
+}
+
+TEST(delta_frames_decode_back_to_the_same_changes) {
+    SnapshotDelta delta;
+    delta.sequence = 41;
+    ProcessInfo spawned;
+    spawned.pid = 4000000;
+    spawned.name = "worker";
+    spawned.cpu_usage = 3.25;
+    spawned.memory_kb = 123456;
+    spawned.priority = -20;
+    delta.spawned.push_back(spawned);
+    spawned.pid = 17;
+    spawned.name = "early";
+    spawned.priority = 39;
+    delta.spawned.push_back(spawned);
+    ProcessInfo exited;
+    exited.pid = 900;
+    delta.exited.push_back(exited);
+    exited.pid = 12;
+    delta.exited.push_back(exited);
+    ProcessChange change;
+    change.pid = 55;
+    change.cpu_usage = 50.5;
+    change.memory_kb = 0;
+    change.priority = 0;
+    delta.changed.push_back(change);
+    
+    SystemMetrics metrics;
+    metrics.cpu_usage = 42.42;
+    metrics.mem_usage_percent = 61.0;
+    metrics.used_mem_kb = 6000000;
+    metrics.total_mem_kb = 16000000;
+    metrics.process_count = 312;
+    metrics.delta = &delta;
+    
+    std::vector<uint8_t> message;
+    Wire::EncodeScratch scratch;
+    Wire::encodeFrame(metrics, false, message, scratch);
+    std::vector<uint8_t> payload = payloadOf(message);
+    
+    Wire::Reader reader(payload.data(), payload.size());
+    CHECK_EQ(reader.getByte(), static_cast<uint8_t>(Wire::DELTA));
+    CHECK_EQ(reader.getVarint(), 41u);
+    Wire::SystemFields system;
+    Wire::readSystem(reader, system);
+    CHECK_NEAR(system.cpu_usage, 42.42, 1e-9);
+    CHECK_NEAR(system.mem_usage_percent, 61.0, 1e-9);
+    CHECK_EQ(system.used_mem_kb, 6000000);
+    CHECK_EQ(system.total_mem_kb, 16000000);
+    CHECK_EQ(system.process_count, 312);
+    
+    // Exits, sorted, PID-delta encoded
+    REQUIRE(reader.getVarint() == 2u);
+    int pid = 0;
+    pid += static_cast<int>(reader.getVarint());
+    CHECK_EQ(pid, 12);
+    pid += static_cast<int>(reader.getVarint());
+    CHECK_EQ(pid, 900);
+    
+    REQUIRE(reader.getVarint() == 2u);
+    pid = 0;
+    std::string name;
+    pid += static_cast<int>(reader.getVarint());
+    CHECK_EQ(pid, 17);
+    CHECK_NEAR(reader.getPercent(), 3.25, 1e-9);
+    CHECK_EQ(reader.getVarint(), 123456u);
+    CHECK_EQ(reader.getSigned(), 39);
+    reader.getString(name);
+    CHECK_EQ(name, std::string("early"));
+    pid += static_cast<int>(reader.getVarint());
+    CHECK_EQ(pid, 4000000);
+    reader.getPercent();
+    reader.getVarint();
+    CHECK_EQ(reader.getSigned(), -20);
+    reader.getString(name);
+    CHECK_EQ(name, std::string("worker"));
+    
+    REQUIRE(reader.getVarint() == 1u);
+    CHECK_EQ(static_cast<int>(reader.getVarint()), 55);
+    CHECK_NEAR(reader.getPercent(), 50.5, 1e-9);
+    CHECK_EQ(reader.getVarint(), 0u);
+    CHECK_EQ(reader.getSigned(), 0);
+    CHECK(reader.good());
+    CHECK(reader.atEnd());
+}